@@ -30,7 +30,8 @@ ListenConnection::ListenConnection(SOCKET sfd,
                                    event_base* b,
                                    in_port_t port,
                                    sa_family_t fam,
-                                   const interface& interf)
+                                   const interface& interf,
+                                   LIBEVENT_THREAD* worker)
     : Connection(sfd, b),
       registered_in_libevent(false),
       family(fam),
@@ -38,6 +39,7 @@ ListenConnection::ListenConnection(SOCKET sfd,
       ssl(!interf.ssl.cert.empty()),
       management(interf.management),
       protocol(interf.protocol),
+      worker(worker),
       ev(event_new(b, sfd, EV_READ | EV_PERSIST, listen_event_handler,
                    reinterpret_cast<void*>(this))) {
 
@@ -63,7 +65,8 @@ const Protocol ListenConnection::getProtocol() const {
 }
 
 void ListenConnection::enable() {
-    if (!registered_in_libevent) {
+    std::lock_guard<std::mutex> guard(registration_mutex);
+    if (ev && !registered_in_libevent) {
         LOG_NOTICE(this, "%u Listen on %s", getId(), getSockname().c_str());
         if (listen(getSocketDescriptor(), backlog) == SOCKET_ERROR) {
             LOG_WARNING(this,
@@ -84,6 +87,7 @@ void ListenConnection::enable() {
 }
 
 void ListenConnection::disable() {
+    std::lock_guard<std::mutex> guard(registration_mutex);
     if (registered_in_libevent) {
         if (getSocketDescriptor() != INVALID_SOCKET) {
             /*
@@ -107,6 +111,12 @@ void ListenConnection::disable() {
     }
 }
 
+void ListenConnection::releaseEvent() {
+    disable();
+    std::lock_guard<std::mutex> guard(registration_mutex);
+    ev.reset();
+}
+
 void ListenConnection::runEventLoop(short) {
     if (!server_events.empty()) {
         LOG_WARNING(this,
@@ -20,6 +20,7 @@
 
 #include <cJSON_utils.h>
 #include <memory>
+#include <mutex>
 
 /**
  * The ListenConnection class is used by the "server sockets" in memcached.
@@ -36,7 +37,8 @@ public:
                      event_base* b,
                      in_port_t port,
                      sa_family_t fam,
-                     const struct interface &interf);
+                     const struct interface &interf,
+                     LIBEVENT_THREAD* worker);
 
     virtual ~ListenConnection();
 
@@ -54,6 +56,22 @@ public:
         return management;
     }
 
+    /**
+     * Get the worker thread owning this (SO_REUSEPORT) listen socket, and
+     * which should serve the clients accepted on it. nullptr if the socket
+     * is owned by the dispatcher thread, which hands accepted clients over
+     * to the worker threads.
+     */
+    LIBEVENT_THREAD* getWorker() const {
+        return worker;
+    }
+
+    /**
+     * Remove the socket from libevent and release the event. Must be
+     * called before the event base the socket was created on is freed.
+     */
+    void releaseEvent();
+
     /**
      * Get the details for this connection to put in the portnumber
      * file so that the test framework may pick up the port numbers
@@ -67,6 +85,14 @@ protected:
     const bool ssl;
     const bool management;
     const Protocol protocol;
+    LIBEVENT_THREAD* const worker;
+
+    /**
+     * With per-worker listen sockets any of the worker threads (on a
+     * failure to accept) and the dispatcher thread may enable / disable
+     * the socket
+     */
+    std::mutex registration_mutex;
 
     struct EventDeleter {
         void operator()(struct event* ev) {
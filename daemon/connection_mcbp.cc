@@ -29,6 +29,7 @@
 #include <platform/strerror.h>
 #include <platform/timeutils.h>
 #include <utilities/protocol2text.h>
+#include <algorithm>
 #include <cctype>
 #include <exception>
 
@@ -338,7 +339,7 @@ int McbpConnection::recv(char* dest, size_t nbytes) {
     return res;
 }
 
-int McbpConnection::sendmsg(struct msghdr* m) {
+int McbpConnection::sendmsg(struct msghdr* m, int flags) {
     int res = 0;
     if (ssl.isEnabled()) {
         for (int ii = 0; ii < int(m->msg_iovlen); ++ii) {
@@ -357,7 +358,7 @@ int McbpConnection::sendmsg(struct msghdr* m) {
         ssl.drainBioSendPipe(socketDescriptor);
         return res;
     } else {
-        res = int(::sendmsg(socketDescriptor, m, 0));
+        res = int(::sendmsg(socketDescriptor, m, flags));
         if (res > 0) {
             totalSend += res;
         }
@@ -430,7 +431,11 @@ McbpConnection::TransmitResult McbpConnection::transmit() {
         ssize_t res;
         struct msghdr* m = &msglist[msgcurr];
 
-        res = sendmsg(m);
+        if (zerocopyIov.empty()) {
+            res = sendmsg(m, 0);
+        } else {
+            res = sendmsgZerocopy(m);
+        }
         auto error = GetLastNetworkError();
         if (res > 0) {
             get_thread_stats(this)->bytes_written += res;
@@ -666,11 +671,115 @@ int McbpConnection::sslWrite(const char* src, size_t nbytes) {
     return ret;
 }
 
+int McbpConnection::sendmsgZerocopy(struct msghdr* m) {
+#ifdef HAVE_MSG_ZEROCOPY
+    // Forget about the entries we're done sending
+    const size_t first = size_t(m->msg_iov - iov.data());
+    zerocopyIov.erase(
+            zerocopyIov.begin(),
+            std::lower_bound(zerocopyIov.begin(), zerocopyIov.end(), first));
+
+    if (zerocopyIov.empty() ||
+        zerocopyIov.front() >= first + m->msg_iovlen) {
+        return sendmsg(m, 0);
+    }
+
+    struct msghdr chunk = *m;
+    if (zerocopyIov.front() != first) {
+        chunk.msg_iovlen = zerocopyIov.front() - first;
+        return sendmsg(&chunk, 0);
+    }
+
+    chunk.msg_iovlen = 1;
+    const int res = sendmsg(&chunk, MSG_ZEROCOPY);
+    if (res >= 0) {
+        zerocopySends.sent();
+    }
+    return res;
+#else
+    return sendmsg(m, 0);
+#endif
+}
+
+bool McbpConnection::shouldSendZerocopy(size_t len) {
+#ifdef HAVE_MSG_ZEROCOPY
+    const auto threshold = settings.getSendZerocopyThreshold();
+    if (threshold == 0 || len < threshold || ssl.isEnabled()) {
+        return false;
+    }
+
+    if (zerocopy == Zerocopy::Unknown) {
+        const int enable = 1;
+        if (setsockopt(socketDescriptor,
+                       SOL_SOCKET,
+                       SO_ZEROCOPY,
+                       &enable,
+                       sizeof(enable)) == 0) {
+            zerocopy = Zerocopy::Enabled;
+        } else {
+            LOG_INFO(this,
+                     "%u: Failed to enable SO_ZEROCOPY: %s",
+                     getId(),
+                     cb_strerror().c_str());
+            zerocopy = Zerocopy::Unsupported;
+        }
+    }
+    return zerocopy == Zerocopy::Enabled;
+#else
+    (void)len;
+    return false;
+#endif
+}
+
+void McbpConnection::reapZerocopyCompletions() {
+    zerocopySends.reap(socketDescriptor);
+}
+
+void McbpConnection::releaseTransmittedItems() {
+    if (zerocopySends.allComplete() || reservedItems.empty()) {
+        releaseReservedItems();
+        return;
+    }
+
+    zerocopySends.keep(bucketEngine, reservedItems);
+}
+
+void McbpConnection::holdZerocopyItems() {
+    // The items of a response we were part way through sending may be
+    // referenced by its MSG_ZEROCOPY sends too
+    releaseTransmittedItems();
+    if (socketDescriptor != INVALID_SOCKET) {
+        reapZerocopyCompletions();
+    }
+    zerocopySends.holdBucket(size_t(getBucketIndex()));
+}
+
+void McbpConnection::closeSocket() {
+    if (socketDescriptor == INVALID_SOCKET) {
+        return;
+    }
+
+    releaseTransmittedItems();
+    reapZerocopyCompletions();
+    if (zerocopySends.empty()) {
+        safe_close(socketDescriptor);
+    } else if (getThread() != nullptr) {
+        zerocopySends.holdBucket(size_t(getBucketIndex()));
+        getThread()->zerocopy_reaper->add(socketDescriptor,
+                                          std::move(zerocopySends));
+    } else {
+        ZerocopyReaper::resetSocket(socketDescriptor);
+        zerocopySends.releaseAll();
+    }
+    socketDescriptor = INVALID_SOCKET;
+}
+
 void McbpConnection::addMsgHdr(bool reset) {
     if (reset) {
         msgcurr = 0;
         msglist.clear();
         iovused = 0;
+        zerocopyIov.clear();
     }
 
     msglist.emplace_back();
@@ -713,6 +822,27 @@ void McbpConnection::addIov(const void* buf, size_t len) {
     m->msg_iovlen++;
 }
 
+void McbpConnection::addZerocopyIov(const void* buf, size_t len) {
+    addIov(buf, len);
+    if (len > 0 && shouldSendZerocopy(len)) {
+        zerocopyIov.push_back(iovused - 1);
+    }
+}
+
+void McbpConnection::addItemValueIov(cb::unique_item_ptr& item,
+                                     const item_info& info,
+                                     cb::const_char_buffer value) {
+    const auto* begin = static_cast<const char*>(info.value[0].iov_base);
+    const auto* end = begin + info.value[0].iov_len;
+    if (value.data() >= begin && value.data() + value.size() <= end &&
+        shouldSendZerocopy(value.size()) && reserveItem(item.get())) {
+        item.release();
+        addZerocopyIov(value.data(), value.size());
+    } else {
+        addIov(value.data(), value.size());
+    }
+}
+
 void McbpConnection::ensureIovSpace() {
     if (iovused < iov.size()) {
         // There is still size in the list
@@ -759,6 +889,7 @@ McbpConnection::McbpConnection(SOCKET sfd,
 
 McbpConnection::~McbpConnection() {
     releaseReservedItems();
+    zerocopySends.releaseAll();
     for (auto* ptr : temp_alloc) {
         cb_free(ptr);
     }
@@ -934,6 +1065,12 @@ bool McbpConnection::processServerEvents() {
 }
 
 void McbpConnection::runEventLoop(short which) {
+    if (!zerocopySends.allComplete() || !zerocopySends.empty()) {
+        // The completion notifications make the socket readable (with an
+        // error), so they must be consumed before we wait for more input
+        reapZerocopyCompletions();
+    }
+
     conn_loan_buffers(this);
     currentEvent = which;
     numEvents = max_reqs_per_event;
@@ -25,6 +25,7 @@
 #include "log_macros.h"
 #include "settings.h"
 #include "statemachine_mcbp.h"
+#include "zerocopy.h"
 
 #include <cJSON.h>
 #include <cbsasl/cbsasl.h>
@@ -38,6 +39,7 @@
 
 #include <array>
 #include <chrono>
+#include <deque>
 #include <memory>
 #include <string>
 #include <vector>
@@ -246,9 +248,10 @@ public:
      * Send data over the socket
      *
      * @param m the message header to send
+     * @param flags the flags to pass to sendmsg (ignored for SSL)
      * @return the number of bytes sent, or -1 for an error
      */
-    int sendmsg(struct msghdr* m);
+    int sendmsg(struct msghdr* m, int flags);
 
     enum class TransmitResult {
         /** All done writing. */
@@ -326,6 +329,60 @@ public:
      */
     void addIov(const void* buf, size_t len);
 
+    /**
+     * Add a chunk of item memory to the IO vector to send. If the chunk is
+     * large enough (see Settings::getSendZerocopyThreshold) it is sent with
+     * MSG_ZEROCOPY, so the item must be held through reserveItem (the
+     * kernel may read the memory until it reports the send complete).
+     *
+     * @param buf pointer to the data to send
+     * @param len number of bytes to send
+     * @throws std::bad_alloc
+     */
+    void addZerocopyIov(const void* buf, size_t len);
+
+    /**
+     * Add the value of an item to the IO vector to send. If the value is
+     * large enough to be sent with MSG_ZEROCOPY the connection takes over
+     * the reference to the item (and releases it once the kernel is done
+     * with it); otherwise the caller must keep the item until the response
+     * is sent.
+     *
+     * @param item the item
+     * @param info the item info for the item
+     * @param value the value to send; may be the item's value or part of
+     *              it, or data outside the item (e.g. an inflated copy of
+     *              the value) which isn't sent with MSG_ZEROCOPY
+     * @throws std::bad_alloc
+     */
+    void addItemValueIov(cb::unique_item_ptr& item,
+                         const item_info& info,
+                         cb::const_char_buffer value);
+
+    /**
+     * Release the items reserved for the response which has just been
+     * transmitted. Items referenced by data sent with MSG_ZEROCOPY are kept
+     * until the kernel reports the send as complete.
+     */
+    void releaseTransmittedItems();
+
+    /**
+     * Make the items kept for MSG_ZEROCOPY sends (and those of a partially
+     * sent response) hold a reference to the current bucket, so it isn't
+     * deleted before they're released. Used when the connection leaves the
+     * bucket; the items are still released (to their own engine) as the
+     * sends complete.
+     */
+    void holdZerocopyItems();
+
+    /**
+     * Close the socket of the connection. Should MSG_ZEROCOPY sends still
+     * be outstanding, the socket and the items they reference are handed
+     * over to the thread's ZerocopyReaper, which closes the socket once the
+     * sends are complete rather than us waiting for them.
+     */
+    void closeSocket();
+
     /**
      * Release all of the items we've saved a reference to
      */
@@ -452,6 +509,14 @@ public:
         tracingEnabled = enable;
     }
 
+    bool isGetMultiSupported() const {
+        return getMultiSupported;
+    }
+
+    void setGetMultiSupported(bool enable) {
+        getMultiSupported = enable;
+    }
+
     bool isEwouldblock() const {
         return ewouldblock;
     }
@@ -615,6 +680,9 @@ protected:
     /** Is Tracing enabled for this connection? */
     bool tracingEnabled = false;
 
+    /** Has the client negotiated the GetMulti command? */
+    bool getMultiSupported = false;
+
     /** The maximum requests we can process in a worker thread timeslice */
     int max_reqs_per_event =
             settings.getRequestsPerEventNotification(EventPriority::Default);
@@ -663,6 +731,25 @@ protected:
      */
     std::vector<void*> reservedItems;
 
+    /**
+     * Is SO_ZEROCOPY enabled on the socket. It is enabled the first time
+     * we've got something to send with MSG_ZEROCOPY.
+     */
+    enum class Zerocopy : uint8_t { Unknown, Enabled, Unsupported };
+    Zerocopy zerocopy = Zerocopy::Unknown;
+
+    /**
+     * Indexes (into iov) of the entries to send with MSG_ZEROCOPY, in
+     * increasing order
+     */
+    std::vector<size_t> zerocopyIov;
+
+    /**
+     * The sendmsg calls made with MSG_ZEROCOPY, and the items referenced by
+     * them which are kept until the kernel reports the sends as complete
+     */
+    ZerocopySends zerocopySends;
+
     /**
      * A vector of temporary allocations that should be freed when the
      * the connection is done sending all of the data. Use pushTempAlloc to
@@ -701,6 +788,29 @@ protected:
      */
     void ensureIovSpace();
 
+    /**
+     * Should a chunk of item memory of the given size be sent with
+     * MSG_ZEROCOPY. Enables SO_ZEROCOPY on the socket the first time.
+     */
+    bool shouldSendZerocopy(size_t len);
+
+    /**
+     * Send (the start of) the message, which contains entries to send with
+     * MSG_ZEROCOPY. The flag applies to all of the data passed to sendmsg,
+     * but only the marked entries are backed by memory we keep until the
+     * kernel is done with it. The entries up to the next marked one are
+     * therefore sent as normal, and each marked entry on its own with
+     * MSG_ZEROCOPY.
+     */
+    int sendmsgZerocopy(struct msghdr* m);
+
+    /**
+     * Read the MSG_ZEROCOPY completion notifications from the socket error
+     * queue, and release the items which are no longer referenced by the
+     * kernel.
+     */
+    void reapZerocopyCompletions();
+
     /**
      * Read data over the SSL connection
      *
@@ -61,7 +61,8 @@ static ListenConnection* allocate_listen_connection(SOCKET sfd,
                                                     event_base* base,
                                                     in_port_t port,
                                                     sa_family_t family,
-                                                    const struct interface& interf);
+                                                    const struct interface& interf,
+                                                    LIBEVENT_THREAD* worker);
 
 static void release_connection(Connection *c);
 
@@ -166,6 +167,7 @@ void run_event_loop(Connection* c, short which) {
     auto* thread = c->getThread();
     if (thread != nullptr) {
         scheduler_info[thread->index].add(ns);
+        thread->num_events.fetch_add(1, std::memory_order_relaxed);
     }
 
     if (c->shouldDelete()) {
@@ -177,8 +179,10 @@ ListenConnection* conn_new_server(const SOCKET sfd,
                                   in_port_t parent_port,
                                   sa_family_t family,
                                   const struct interface& interf,
-                                  struct event_base* base) {
-    auto* c = allocate_listen_connection(sfd, base, parent_port, family, interf);
+                                  struct event_base* base,
+                                  LIBEVENT_THREAD* worker) {
+    auto* c = allocate_listen_connection(
+            sfd, base, parent_port, family, interf, worker);
     if (c == nullptr) {
         return nullptr;
     }
@@ -249,6 +253,10 @@ static void conn_cleanup(McbpConnection& connection) {
     connection.getCookieObject().reset();
     connection.setEngineStorage(nullptr);
 
+    auto* thread = connection.getThread();
+    if (thread != nullptr) {
+        thread->num_connections--;
+    }
     connection.setThread(nullptr);
     cb_assert(connection.getNext() == nullptr);
     connection.setSocketDescriptor(INVALID_SOCKET);
@@ -427,11 +435,12 @@ static ListenConnection* allocate_listen_connection(SOCKET sfd,
                                                     event_base* base,
                                                     in_port_t port,
                                                     sa_family_t family,
-                                                    const struct interface& interf) {
+                                                    const struct interface& interf,
+                                                    LIBEVENT_THREAD* worker) {
     ListenConnection *ret = nullptr;
 
     try {
-        ret = new ListenConnection(sfd, base, port, family, interf);
+        ret = new ListenConnection(sfd, base, port, family, interf, worker);
         std::lock_guard<std::mutex> lock(connections.mutex);
         connections.conns.push_back(ret);
         stats.conn_structs++;
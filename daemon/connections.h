@@ -79,12 +79,15 @@ Connection* conn_new(const SOCKET sfd,
  * @param family the address family used for the port
  * @param interf the interface description
  * @param base the event base to use for the socket
+ * @param worker the worker thread owning the socket (and serving the clients
+ *               accepted on it), or nullptr if owned by the dispatcher
  */
 ListenConnection* conn_new_server(const SOCKET sfd,
                                   in_port_t parent_port,
                                   sa_family_t family,
                                   const struct interface& interf,
-                                  struct event_base* base);
+                                  struct event_base* base,
+                                  LIBEVENT_THREAD* worker);
 
 /*
  * Closes a connection. Afterwards the connection is invalid (can no longer
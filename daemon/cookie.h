@@ -416,14 +416,36 @@ public:
         enableTracing = enable;
     }
 
+    /**
+     * Get the tracer for the command. The phases of every command are
+     * traced (and added to the bucket's timings once the command is
+     * complete); the engine only adds its spans when the client enabled
+     * tracing.
+     */
     cb::tracing::Tracer& getTracer() {
         return tracer;
     }
 
+    /**
+     * Get the opcode of the command we're transmitting the response for.
+     * The packet itself is consumed from the input buffer once it's
+     * executed, so it's no longer available at that point.
+     */
+    uint8_t getTransmitOpcode() const {
+        return transmitOpcode;
+    }
+
+    void setTransmitOpcode(uint8_t opcode) {
+        transmitOpcode = opcode;
+    }
+
 protected:
     bool enableTracing = false;
     cb::tracing::Tracer tracer;
 
+    /// The opcode of the command we're transmitting the response for
+    uint8_t transmitOpcode = 0;
+
     /**
      * The connection object this cookie is bound to
      */
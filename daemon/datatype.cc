@@ -38,6 +38,7 @@ bool Datatype::isSupported(cb::mcbp::Feature feature) {
     case cb::mcbp::Feature::ClustermapChangeNotification:
     case cb::mcbp::Feature::UnorderedExecution:
     case cb::mcbp::Feature::Tracing:
+    case cb::mcbp::Feature::GetMulti:
         throw std::invalid_argument("Datatype::isSupported invalid feature:" +
                                     std::to_string(int(feature)));
     }
@@ -67,6 +68,7 @@ void Datatype::enable(cb::mcbp::Feature feature) {
     case cb::mcbp::Feature::ClustermapChangeNotification:
     case cb::mcbp::Feature::UnorderedExecution:
     case cb::mcbp::Feature::Tracing:
+    case cb::mcbp::Feature::GetMulti:
         throw std::invalid_argument("Datatype::enable invalid feature:" +
                                     std::to_string(int(feature)));
     }
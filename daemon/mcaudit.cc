@@ -26,6 +26,8 @@
 #include <cJSON.h>
 #include <memcached/isotime.h>
 
+#include <cctype>
+
 static std::atomic_bool audit_enabled{false};
 
 static const int First = MEMCACHED_AUDIT_OPENED_DCP_CONNECTION;
@@ -255,6 +257,10 @@ namespace audit {
 namespace document {
 
 void add(const Cookie& cookie, Operation operation) {
+    add(cookie, operation, cookie.getRequest().getKey());
+}
+
+void add(const Cookie& cookie, Operation operation, cb::const_byte_buffer key) {
     uint32_t id = 0;
     switch (operation) {
     case Operation::Read:
@@ -283,8 +289,14 @@ void add(const Cookie& cookie, Operation operation) {
     const auto& connection = cookie.getConnection();
     auto root = create_memcached_audit_object(&connection);
     cJSON_AddStringToObject(root.get(), "bucket", connection.getBucket().name);
-    cJSON_AddStringToObject(
-            root.get(), "key", cookie.getPrintableRequestKey().c_str());
+    std::string printableKey{reinterpret_cast<const char*>(key.data()),
+                             key.size()};
+    for (auto& ii : printableKey) {
+        if (!std::isgraph(ii)) {
+            ii = '.';
+        }
+    }
+    cJSON_AddStringToObject(root.get(), "key", printableKey.c_str());
 
     switch (operation) {
     case Operation::Read:
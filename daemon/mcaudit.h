@@ -102,6 +102,12 @@ enum class Operation {
     Delete
 };
 void add(const Cookie& c, Operation operation);
+
+/**
+ * Add an audit event for the given key, for commands operating on other
+ * keys than the one in the request header (e.g. GetMulti)
+ */
+void add(const Cookie& c, Operation operation, cb::const_byte_buffer key);
 }
 }
 }
@@ -210,6 +210,26 @@ bool mcbp_response_handler(const void* key, uint16_t keylen,
     return true;
 }
 
+/**
+ * Add the time the command spent in the given phase (if it ever entered
+ * that phase) to the timings of the bucket, and the aggregated timings
+ * for all buckets.
+ */
+static void mcbp_collect_phase_timing(Cookie& cookie,
+                                      uint8_t opcode,
+                                      cb::tracing::TraceCode phase) {
+    std::chrono::microseconds duration;
+    if (!cookie.getTracer().getDuration(phase, duration)) {
+        return;
+    }
+
+    all_buckets[0].timings.collect(opcode, phase, duration);
+    const auto bucketid = cookie.getConnection().getBucketIndex();
+    if (bucketid != 0) {
+        all_buckets[bucketid].timings.collect(opcode, phase, duration);
+    }
+}
+
 void mcbp_collect_timings(Cookie& cookie) {
     auto* c = &cookie.getConnection();
     if (c->isDCP()) {
@@ -221,7 +241,8 @@ void mcbp_collect_timings(Cookie& cookie) {
         return;
     }
     const auto opcode = cookie.getHeader().getOpcode();
-    const auto elapsed_ns = ProcessClock::now() - cookie.getStart();
+    const auto now = ProcessClock::now();
+    const auto elapsed_ns = now - cookie.getStart();
     // aggregated timing for all buckets
     all_buckets[0].timings.collect(opcode, elapsed_ns);
 
@@ -235,8 +256,30 @@ void mcbp_collect_timings(Cookie& cookie) {
         all_buckets[bucketid].timings.collect(opcode, elapsed_ns);
     }
 
+    // The time spent in each of the phases up until now. The response
+    // is transmitted later on, so that phase is collected once it's sent
+    auto& tracer = cookie.getTracer();
+    tracer.end(cb::tracing::TraceCode::REQUEST, now);
+    for (const auto phase : Timings::phases) {
+        if (phase != cb::tracing::TraceCode::TRANSMIT) {
+            mcbp_collect_phase_timing(cookie, opcode, phase);
+        }
+    }
+    if (c->getState() == McbpStateMachine::State::send_data) {
+        cookie.setTransmitOpcode(opcode);
+        tracer.begin(cb::tracing::TraceCode::TRANSMIT, now);
+    }
+
     // Log operations taking longer than 0.5s
     const auto elapsed_ms =
             std::chrono::duration_cast<std::chrono::milliseconds>(elapsed_ns);
     cookie.maybeLogSlowCommand(elapsed_ms);
 }
+
+void mcbp_collect_transmit_timings(Cookie& cookie) {
+    if (cookie.getTracer().end(cb::tracing::TraceCode::TRANSMIT)) {
+        mcbp_collect_phase_timing(cookie,
+                                  cookie.getTransmitOpcode(),
+                                  cb::tracing::TraceCode::TRANSMIT);
+    }
+}
@@ -41,6 +41,7 @@
 #include "protocol/mcbp/get_context.h"
 #include "protocol/mcbp/get_locked_context.h"
 #include "protocol/mcbp/get_meta_context.h"
+#include "protocol/mcbp/get_multi_context.h"
 #include "protocol/mcbp/mutation_context.h"
 #include "protocol/mcbp/rbac_reload_command_context.h"
 #include "protocol/mcbp/remove_context.h"
@@ -191,6 +192,10 @@ static void get_executor(Cookie& cookie) {
     process_bin_get(cookie);
 }
 
+static void get_multi_executor(Cookie& cookie) {
+    cookie.obtainContext<GetMultiCommandContext>(cookie).drive();
+}
+
 static void get_meta_executor(Cookie& cookie) {
     process_bin_get_meta(cookie);
 }
@@ -628,6 +633,7 @@ void initialize_mbcp_lookup_map() {
     handlers[PROTOCOL_BINARY_CMD_GETQ] = get_executor;
     handlers[PROTOCOL_BINARY_CMD_GETK] = get_executor;
     handlers[PROTOCOL_BINARY_CMD_GETKQ] = get_executor;
+    handlers[PROTOCOL_BINARY_CMD_GET_MULTI] = get_multi_executor;
     handlers[PROTOCOL_BINARY_CMD_GET_META] = get_meta_executor;
     handlers[PROTOCOL_BINARY_CMD_GETQ_META] = get_meta_executor;
     handlers[PROTOCOL_BINARY_CMD_GAT] = gat_executor;
@@ -699,6 +705,27 @@ void initialize_mbcp_lookup_map() {
     handlers[PROTOCOL_BINARY_CMD_ADJUST_TIMEOFDAY] = adjust_timeofday_executor;
 }
 
+/**
+ * Execute a request which passed the privilege check and validation,
+ * tracing the time spent validating and executing it (and when the
+ * command blocks, the start of the wait for the engine to notify us).
+ */
+static void execute_validated_request(Cookie& cookie, uint8_t opcode) {
+    auto& tracer = cookie.getTracer();
+    auto now = ProcessClock::now();
+    tracer.end(cb::tracing::TraceCode::VALIDATE, now);
+    tracer.begin(cb::tracing::TraceCode::EXECUTE, now);
+
+    handlers[opcode](cookie);
+
+    now = ProcessClock::now();
+    tracer.end(cb::tracing::TraceCode::EXECUTE, now);
+    if (cookie.isEwouldblock()) {
+        // Ended by notify_io_complete
+        tracer.begin(cb::tracing::TraceCode::WOULDBLOCK, now);
+    }
+}
+
 static void execute_request_packet(Cookie& cookie,
                                    const cb::mcbp::Request& request) {
     auto* c = &cookie.getConnection();
@@ -706,10 +733,14 @@ static void execute_request_packet(Cookie& cookie,
     static McbpPrivilegeChains privilegeChains;
     protocol_binary_response_status result;
 
+    auto& tracer = cookie.getTracer();
+    tracer.begin(cb::tracing::TraceCode::VALIDATE);
+
     const auto opcode = request.opcode;
     const auto res = privilegeChains.invoke(opcode, cookie);
     switch (res) {
     case cb::rbac::PrivilegeAccess::Fail:
+        tracer.end(cb::tracing::TraceCode::VALIDATE);
         LOG_WARNING(c,
                     "%u %s: no access to command %s",
                     c->getId(), c->getDescription().c_str(),
@@ -735,6 +766,7 @@ static void execute_request_packet(Cookie& cookie,
         }
 
         if (result != PROTOCOL_BINARY_RESPONSE_SUCCESS) {
+            tracer.end(cb::tracing::TraceCode::VALIDATE);
             LOG_NOTICE(c,
                        "%u: Invalid format specified for %s - %d - "
                            "closing connection",
@@ -745,9 +777,10 @@ static void execute_request_packet(Cookie& cookie,
             return;
         }
 
-        handlers[opcode](cookie);
+        execute_validated_request(cookie, opcode);
         return;
     case cb::rbac::PrivilegeAccess::Stale:
+        tracer.end(cb::tracing::TraceCode::VALIDATE);
         if (c->remapErrorCode(ENGINE_AUTH_STALE) == ENGINE_DISCONNECT) {
             c->setState(McbpStateMachine::State::closing);
         } else {
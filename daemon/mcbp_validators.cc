@@ -771,6 +771,47 @@ static protocol_binary_response_status get_validator(const Cookie& cookie)
     return PROTOCOL_BINARY_RESPONSE_SUCCESS;
 }
 
+static protocol_binary_response_status get_multi_validator(
+        const Cookie& cookie) {
+    auto req = static_cast<protocol_binary_request_no_extras*>(
+            cookie.getPacketAsVoidPtr());
+    uint32_t blen = ntohl(req->message.header.request.bodylen);
+
+    if (req->message.header.request.magic != PROTOCOL_BINARY_REQ ||
+        req->message.header.request.extlen != 0 ||
+        req->message.header.request.keylen != 0 || blen == 0 ||
+        req->message.header.request.vbucket != 0 ||
+        req->message.header.request.datatype != PROTOCOL_BINARY_RAW_BYTES ||
+        req->message.header.request.cas != 0) {
+        return PROTOCOL_BINARY_RESPONSE_EINVAL;
+    }
+
+    // The value is a list of entries; each is the vbucket and the length of
+    // the key (both 16 bit in network byte order) followed by the key.
+    const auto value = cookie.getRequest().getValue();
+    size_t offset = 0;
+    while (offset < value.size()) {
+        if (value.size() - offset < 2 * sizeof(uint16_t)) {
+            return PROTOCOL_BINARY_RESPONSE_EINVAL;
+        }
+        uint16_t klen;
+        memcpy(&klen, value.data() + offset + sizeof(uint16_t), sizeof(klen));
+        klen = ntohs(klen);
+        offset += 2 * sizeof(uint16_t);
+        if (klen == 0 || value.size() - offset < klen) {
+            return PROTOCOL_BINARY_RESPONSE_EINVAL;
+        }
+        offset += klen;
+    }
+
+    if (!cookie.getConnection().isGetMultiSupported()) {
+        // The client must negotiate GetMulti with HELLO first
+        return PROTOCOL_BINARY_RESPONSE_NOT_SUPPORTED;
+    }
+
+    return PROTOCOL_BINARY_RESPONSE_SUCCESS;
+}
+
 static protocol_binary_response_status gat_validator(const Cookie& cookie) {
     auto req = static_cast<protocol_binary_request_no_extras*>(
             cookie.getPacketAsVoidPtr());
@@ -1408,6 +1449,7 @@ void McbpValidatorChains::initializeMcbpValidatorChains(McbpValidatorChains& cha
     chains.push_unique(PROTOCOL_BINARY_CMD_GETQ, get_validator);
     chains.push_unique(PROTOCOL_BINARY_CMD_GETK, get_validator);
     chains.push_unique(PROTOCOL_BINARY_CMD_GETKQ, get_validator);
+    chains.push_unique(PROTOCOL_BINARY_CMD_GET_MULTI, get_multi_validator);
     chains.push_unique(PROTOCOL_BINARY_CMD_GAT, gat_validator);
     chains.push_unique(PROTOCOL_BINARY_CMD_GATQ, gat_validator);
     chains.push_unique(PROTOCOL_BINARY_CMD_TOUCH, gat_validator);
@@ -182,7 +182,31 @@ static void set_stats_reset_time(void)
     }
 }
 
+void bucket_add_reference(size_t index) {
+    Bucket& b = all_buckets.at(index);
+    std::lock_guard<std::mutex> guard(b.mutex);
+    b.clients++;
+}
+
+void bucket_release_reference(size_t index) {
+    Bucket& b = all_buckets.at(index);
+    std::lock_guard<std::mutex> guard(b.mutex);
+    b.clients--;
+
+    if (b.clients == 0 && b.state == BucketState::Destroying) {
+        b.cond.notify_one();
+    }
+}
+
 void disassociate_bucket(Connection& connection) {
+    // Items kept for MSG_ZEROCOPY sends must be released to the engine
+    // they came from once the kernel is done with them, so they keep the
+    // bucket alive until then
+    auto* mcbp = dynamic_cast<McbpConnection*>(&connection);
+    if (mcbp != nullptr) {
+        mcbp->holdZerocopyItems();
+    }
+
     Bucket& b = all_buckets.at(connection.getBucketIndex());
     std::lock_guard<std::mutex> guard(b.mutex);
     b.clients--;
@@ -949,7 +973,12 @@ bool conn_listening(ListenConnection *c)
         return false;
     }
 
-    dispatch_conn_new(sfd, c->getParentPort());
+    auto* worker = c->getWorker();
+    if (worker == nullptr) {
+        dispatch_conn_new(sfd, c->getParentPort());
+    } else {
+        dispatch_conn_local(worker, sfd, c->getParentPort());
+    }
 
     return false;
 }
@@ -1057,7 +1086,7 @@ void event_handler(evutil_socket_t fd, short which, void *arg) {
 /**
  * The listen_event_handler is the callback from libevent when someone is
  * connecting to one of the server sockets. It runs in the context of the
- * listen thread
+ * listen thread (or the owning worker thread for per-worker listen sockets)
  */
 void listen_event_handler(evutil_socket_t, short which, void *arg) {
     auto *c = reinterpret_cast<ListenConnection *>(arg);
@@ -1068,6 +1097,12 @@ void listen_event_handler(evutil_socket_t, short which, void *arg) {
     }
 
     if (memcached_shutdown) {
+        if (c->getWorker() != nullptr) {
+            // The worker thread stops once its clients are disconnected;
+            // just stop accepting new ones
+            c->disable();
+            return;
+        }
         // Someone requested memcached to shut down. The listen thread should
         // be stopped immediately.
         LOG_NOTICE(NULL, "Stopping listen thread");
@@ -1158,7 +1193,9 @@ static void maximize_sndbuf(const SOCKET sfd) {
     }
 }
 
-static SOCKET new_server_socket(struct addrinfo *ai, bool tcp_nodelay) {
+static SOCKET new_server_socket(struct addrinfo *ai,
+                                bool tcp_nodelay,
+                                bool reuseport) {
     SOCKET sfd;
 
     sfd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
@@ -1199,6 +1236,18 @@ static SOCKET new_server_socket(struct addrinfo *ai, bool tcp_nodelay) {
 #endif
 
     setsockopt(sfd, SOL_SOCKET, SO_REUSEADDR, flags_ptr, sizeof(flags));
+#ifdef SO_REUSEPORT
+    if (reuseport) {
+        error = setsockopt(sfd, SOL_SOCKET, SO_REUSEPORT, flags_ptr,
+                           sizeof(flags));
+        if (error != 0) {
+            LOG_WARNING(NULL, "setsockopt(SO_REUSEPORT): %s",
+                        strerror(errno));
+            safe_close(sfd);
+            return INVALID_SOCKET;
+        }
+    }
+#endif
     error = setsockopt(sfd, SOL_SOCKET, SO_KEEPALIVE, flags_ptr,
                        sizeof(flags));
     if (error != 0) {
@@ -1275,6 +1324,100 @@ static void add_listening_port(const struct interface *interf, in_port_t port, s
     }
 }
 
+/**
+ * Should each worker thread own SO_REUSEPORT listen sockets, and accept its
+ * own clients (instead of the dispatcher thread accepting all clients)
+ */
+static bool use_per_worker_listen() {
+#ifdef SO_REUSEPORT
+    return settings.isPerWorkerListen();
+#else
+    if (settings.isPerWorkerListen()) {
+        LOG_WARNING(nullptr,
+                    "per_worker_listen is not supported on this platform");
+    }
+    return false;
+#endif
+}
+
+/**
+ * Create the listen connection for a bound server socket and add it to the
+ * list of listening connections
+ *
+ * @param sfd the bound socket
+ * @param port the port number in use
+ * @param family the address family for the port
+ * @param interf the interface description used to create the port
+ * @param worker the worker thread owning the socket, or nullptr if owned
+ *               by the dispatcher thread
+ */
+static void add_listen_connection(SOCKET sfd,
+                                  in_port_t port,
+                                  sa_family_t family,
+                                  const struct interface& interf,
+                                  LIBEVENT_THREAD* worker) {
+    auto* base = (worker == nullptr) ? main_base : worker->base;
+    auto* lconn = conn_new_server(sfd, port, family, interf, base, worker);
+    if (lconn == nullptr) {
+        FATAL_ERROR(EXIT_FAILURE, "Failed to create listening connection");
+    }
+
+    lconn->setNext(listen_conn);
+    listen_conn = lconn;
+
+    stats.daemon_conns++;
+    stats.curr_conns.fetch_add(1, std::memory_order_relaxed);
+    add_listening_port(&interf, port, family);
+}
+
+/**
+ * Create an SO_REUSEPORT socket for each of the remaining worker threads
+ * (worker 0 owns the socket already bound to the address), bound to the
+ * same address and port. The kernel spreads incoming connections across
+ * the sockets, so each worker accepts its own clients.
+ *
+ * @param ai the address the first socket is bound to
+ * @param port the port number the first socket is bound to (which may
+ *             have been picked by the OS)
+ * @param interf the interface description used to create the port
+ */
+static void add_worker_listen_sockets(struct addrinfo* ai,
+                                      in_port_t port,
+                                      const struct interface& interf) {
+    struct sockaddr_storage addr;
+    memcpy(&addr, ai->ai_addr, ai->ai_addrlen);
+    if (ai->ai_family == AF_INET) {
+        reinterpret_cast<struct sockaddr_in*>(&addr)->sin_port = htons(port);
+    } else if (ai->ai_family == AF_INET6) {
+        reinterpret_cast<struct sockaddr_in6*>(&addr)->sin6_port =
+                htons(port);
+    }
+
+    for (int ii = 1; ii < settings.getNumWorkerThreads(); ++ii) {
+        SOCKET sfd = new_server_socket(ai, interf.tcp_nodelay, true);
+        if (sfd == INVALID_SOCKET) {
+            LOG_WARNING(nullptr,
+                        "Failed to create listen socket for worker %d",
+                        ii);
+            continue;
+        }
+
+        if (bind(sfd,
+                 reinterpret_cast<struct sockaddr*>(&addr),
+                 (socklen_t)ai->ai_addrlen) == SOCKET_ERROR) {
+            log_errcode_error(EXTENSION_LOG_WARNING,
+                              nullptr,
+                              "Failed to bind worker listen socket: %s",
+                              GetLastNetworkError());
+            safe_close(sfd);
+            continue;
+        }
+
+        add_listen_connection(
+                sfd, port, ai->ai_family, interf, get_worker_thread(ii));
+    }
+}
+
 /**
  * Create a socket and bind it to a specific port number
  * @param interface the interface to bind to
@@ -1305,6 +1448,8 @@ static int server_socket(const struct interface *interf) {
         host = interf->host.c_str();
     }
 
+    const bool per_worker = use_per_worker_listen();
+
     struct addrinfo *ai;
     int error = getaddrinfo(host, port_buf.c_str(), &hints, &ai);
     if (error != 0) {
@@ -1322,7 +1467,8 @@ static int server_socket(const struct interface *interf) {
     }
 
     for (struct addrinfo* next = ai; next; next = next->ai_next) {
-        if ((sfd = new_server_socket(next, interf->tcp_nodelay)) == INVALID_SOCKET) {
+        if ((sfd = new_server_socket(next, interf->tcp_nodelay, per_worker)) ==
+            INVALID_SOCKET) {
             /* getaddrinfo can return "junk" addresses,
              * we make sure at least one works before erroring.
              */
@@ -1360,18 +1506,20 @@ static int server_socket(const struct interface *interf) {
             }
         }
 
-        auto* lconn = conn_new_server(sfd, listenport, next->ai_addr->sa_family,
-                                      *interf, main_base);
-        if (lconn == nullptr) {
-            FATAL_ERROR(EXIT_FAILURE, "Failed to create listening connection");
+        if (per_worker) {
+            add_listen_connection(sfd,
+                                  listenport,
+                                  next->ai_addr->sa_family,
+                                  *interf,
+                                  get_worker_thread(0));
+            add_worker_listen_sockets(next, listenport, *interf);
+        } else {
+            add_listen_connection(sfd,
+                                  listenport,
+                                  next->ai_addr->sa_family,
+                                  *interf,
+                                  nullptr);
         }
-
-        lconn->setNext(listen_conn);
-        listen_conn = lconn;
-
-        stats.daemon_conns++;
-        stats.curr_conns.fetch_add(1, std::memory_order_relaxed);
-        add_listening_port(interf, listenport, next->ai_addr->sa_family);
     }
 
     freeaddrinfo(ai);
@@ -1435,6 +1583,12 @@ static void create_listen_sockets(bool management) {
                                            " illegal objects: " +
                                        to_string(c->toJSON(), false));
             }
+            auto* worker = lc->getWorker();
+            if (worker != nullptr && worker->index != 0) {
+                // Per-worker listen sockets share the address and port of
+                // the one owned by the first worker
+                continue;
+            }
             cJSON_AddItemToArray(array.get(), lc->getDetails().release());
         }
 
@@ -1452,6 +1606,21 @@ static void create_listen_sockets(bool management) {
     }
 }
 
+/**
+ * Release the libevent handles of all of the listen connections. The
+ * connection objects themselves are released with all other connections,
+ * but per-worker listen sockets use the worker threads' event bases which
+ * are freed before that.
+ */
+static void release_listen_events() {
+    for (auto* c = listen_conn; c != nullptr; c = c->getNext()) {
+        auto* lc = dynamic_cast<ListenConnection*>(c);
+        if (lc != nullptr) {
+            lc->releaseEvent();
+        }
+    }
+}
+
 #ifdef WIN32
 // Unfortunately we don't have signal handlers on windows
 static bool install_signal_handlers() {
@@ -2857,6 +3026,9 @@ extern "C" int memcached_main(int argc, char **argv) {
     LOG_NOTICE(NULL, "Releasing client resources");
     close_all_connections();
 
+    LOG_NOTICE(NULL, "Releasing listen sockets");
+    release_listen_events();
+
     LOG_NOTICE(NULL, "Releasing bucket resources");
     cleanup_buckets();
 
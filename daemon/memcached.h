@@ -2,6 +2,7 @@
 #ifndef MEMCACHED_H
 #define MEMCACHED_H
 
+#include <atomic>
 #include <functional>
 #include <mutex>
 #include <vector>
@@ -71,12 +72,14 @@ enum class ThreadType {
 
 class Connection;
 class ConnectionQueue;
+class ZerocopyReaper;
 
 struct LIBEVENT_THREAD {
     cb_thread_t thread_id;      /* unique ID of this thread */
     struct event_base *base;    /* libevent handle this thread uses */
     struct event notify_event;  /* listen event for notify pipe */
-    SOCKET notify[2];           /* notification pipes */
+    SOCKET notify[2];           /* notification pipes (for worker threads
+                                   both are the same eventfd if available) */
     ConnectionQueue *new_conn_queue; /* queue of new connections to handle */
     cb_mutex_t mutex;      /* Mutex to lock protect access to the pending_io */
     bool is_locked;
@@ -105,6 +108,39 @@ struct LIBEVENT_THREAD {
     int deleting_buckets;
 
     JSON_checker::Validator *validator;
+
+    /**
+     * Number of client connections bound to this thread, including the
+     * ones dispatched to it which are still waiting in new_conn_queue.
+     */
+    std::atomic<uint32_t> num_connections;
+
+    /**
+     * Number of connection events (calls to run_event_loop) this thread
+     * has processed. Used to pick the least loaded thread for new
+     * connections when load aware connection placement is enabled.
+     */
+    std::atomic<uint64_t> num_events;
+
+    /**
+     * Set when the thread has been notified and hasn't started processing
+     * the notification yet. Further notifications before that are coalesced
+     * into the pending one (the thread will pick up the new work when it
+     * runs) instead of each signalling the thread.
+     */
+    std::atomic<bool> notify_pending;
+
+    /// Number of times the thread was signalled (woken up) by other threads
+    std::atomic<uint64_t> wakeups;
+
+    /// Number of notifications coalesced into an already pending wakeup
+    std::atomic<uint64_t> wakeups_coalesced;
+
+    /**
+     * Closes the sockets of the thread's closed connections once their
+     * MSG_ZEROCOPY sends are complete.
+     */
+    ZerocopyReaper* zerocopy_reaper;
 };
 
 #define LOCK_THREAD(t) \
@@ -158,6 +194,43 @@ void threads_cleanup(void);
 
 void dispatch_conn_new(SOCKET sfd, int parent_port);
 
+/**
+ * Bind a connection accepted on one of the worker thread's own listen
+ * sockets directly to that thread. Must be called from the worker thread.
+ */
+void dispatch_conn_local(LIBEVENT_THREAD* me, SOCKET sfd, int parent_port);
+
+/**
+ * Get the worker thread with the given index
+ * (0 <= index < settings.getNumWorkerThreads())
+ */
+LIBEVENT_THREAD* get_worker_thread(int index);
+
+/**
+ * Snapshot of the load of a worker thread, as used by the connection
+ * placement policy.
+ */
+struct WorkerLoad {
+    /// Connections bound to (or queued for) the thread
+    uint32_t connections;
+    /// Total number of connection events processed by the thread
+    uint64_t events;
+    /// Events per second processed by the thread over the last interval
+    uint64_t eventRate;
+    /// Total number of times the thread was woken up by other threads
+    uint64_t wakeups;
+    /// Total number of notifications coalesced into a pending wakeup
+    uint64_t wakeupsCoalesced;
+    /// Wakeups per second over the last interval
+    uint64_t wakeupRate;
+};
+
+/**
+ * Get the current load of each of the worker threads (indexed by thread
+ * index).
+ */
+std::vector<WorkerLoad> get_worker_load();
+
 /* Lock wrappers for cache functions that are called from main loop. */
 int is_listen_thread(void);
 
@@ -185,6 +258,12 @@ void listen_event_handler(evutil_socket_t, short, void *);
 
 void mcbp_collect_timings(Cookie& cookie);
 
+/**
+ * Collect the time spent transmitting the response for the command (if
+ * mcbp_collect_timings started timing it)
+ */
+void mcbp_collect_transmit_timings(Cookie& cookie);
+
 void log_socket_error(EXTENSION_LOG_LEVEL severity,
                       const void* client_cookie,
                       const char* prefix);
@@ -282,6 +361,14 @@ void shutdown_server(void);
 bool associate_bucket(Connection& connection, const char* name);
 void disassociate_bucket(Connection& connection);
 
+/**
+ * Take a reference to the bucket (counted as one of its clients), keeping
+ * it from being deleted until the reference is released. Used for the items
+ * of a connection which has left the bucket but can't release them yet.
+ */
+void bucket_add_reference(size_t index);
+void bucket_release_reference(size_t index);
+
 bool is_listen_disabled(void);
 uint64_t get_listen_disabled_num(void);
 
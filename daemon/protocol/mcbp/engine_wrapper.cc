@@ -187,6 +187,26 @@ cb::EngineErrorItemPair bucket_get(Cookie& cookie,
     return ret;
 }
 
+std::vector<cb::EngineErrorItemPair> bucket_get_multi(
+        Cookie& cookie,
+        const std::vector<cb::GetMultiKey>& keys,
+        DocStateFilter documentStateFilter) {
+    TRACE_SCOPE(get_server_api(), &cookie, cb::tracing::TraceCode::GETMULTI);
+    auto& c = cookie.getConnection();
+    auto ret = c.getBucketEngine()->get_multi(
+            c.getBucketEngineAsV0(), &cookie, keys, documentStateFilter);
+    for (const auto& result : ret) {
+        if (result.first == cb::engine_errc::disconnect) {
+            LOG_INFO(&c,
+                     "%u: %s bucket_get_multi return ENGINE_DISCONNECT",
+                     c.getId(),
+                     c.getDescription().c_str());
+            break;
+        }
+    }
+    return ret;
+}
+
 cb::EngineErrorItemPair bucket_get_if(
         Cookie& cookie,
         const DocKey& key,
@@ -74,6 +74,11 @@ cb::EngineErrorItemPair bucket_get(
         uint16_t vbucket,
         DocStateFilter documentStateFilter = DocStateFilter::Alive);
 
+std::vector<cb::EngineErrorItemPair> bucket_get_multi(
+        Cookie& cookie,
+        const std::vector<cb::GetMultiKey>& keys,
+        DocStateFilter documentStateFilter = DocStateFilter::Alive);
+
 cb::EngineErrorItemPair bucket_get_if(
         Cookie& cookie,
         const DocKey& key,
@@ -127,7 +127,7 @@ ENGINE_ERROR_CODE GatCommandContext::sendResponse() {
     // Add the flags
     connection.addIov(&info.flags, sizeof(info.flags));
     // Add the value
-    connection.addIov(payload.buf, payload.len);
+    connection.addItemValueIov(it, info, payload);
     connection.setState(McbpStateMachine::State::send_data);
     cb::audit::document::add(cookie, cb::audit::document::Operation::Read);
     state = State::Done;
@@ -106,7 +106,7 @@ ENGINE_ERROR_CODE GetCommandContext::sendResponse() {
         connection.addIov(info.key, info.nkey);
     }
 
-    connection.addIov(payload.buf, payload.len);
+    connection.addItemValueIov(it, info, payload);
     connection.setState(McbpStateMachine::State::send_data);
     cb::audit::document::add(cookie, cb::audit::document::Operation::Read);
 
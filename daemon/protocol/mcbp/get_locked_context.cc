@@ -96,7 +96,7 @@ ENGINE_ERROR_CODE GetLockedCommandContext::sendResponse() {
     // Add the flags
     connection.addIov(&info.flags, sizeof(info.flags));
     // Add the value
-    connection.addIov(payload.buf, payload.len);
+    connection.addItemValueIov(it, info, payload);
     connection.setState(McbpStateMachine::State::send_data);
 
     STATS_INCR(&connection, cmd_lock);
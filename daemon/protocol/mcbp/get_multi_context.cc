@@ -0,0 +1,249 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2017 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#include "engine_errc_2_mcbp.h"
+#include "engine_wrapper.h"
+#include "get_multi_context.h"
+
+#include <daemon/buckets.h>
+#include <daemon/mc_time.h>
+#include <daemon/mcaudit.h>
+#include <daemon/mcbp.h>
+#include <xattr/utils.h>
+
+GetMultiCommandContext::GetMultiCommandContext(Cookie& cookie)
+    : SteppableCommandContext(cookie), state(State::GetItems) {
+    // The validator checked that the value is a well formed list of
+    // (vbucket, keylen, key) entries
+    const auto value = cookie.getRequest().getValue();
+    const auto ns = connection.getDocNamespace();
+
+    size_t count = 0;
+    for (size_t offset = 0; offset < value.size(); ++count) {
+        uint16_t klen;
+        memcpy(&klen, value.data() + offset + sizeof(uint16_t), sizeof(klen));
+        offset += 2 * sizeof(uint16_t) + ntohs(klen);
+    }
+
+    entries.reserve(count);
+    for (size_t offset = 0; offset < value.size();) {
+        uint16_t vbucket;
+        uint16_t klen;
+        memcpy(&vbucket, value.data() + offset, sizeof(vbucket));
+        memcpy(&klen, value.data() + offset + sizeof(uint16_t), sizeof(klen));
+        offset += 2 * sizeof(uint16_t);
+        entries.emplace_back(DocKey{value.data() + offset, ntohs(klen), ns},
+                             ntohs(vbucket));
+        offset += ntohs(klen);
+    }
+}
+
+ENGINE_ERROR_CODE GetMultiCommandContext::getItems() {
+    std::vector<cb::GetMultiKey> keys;
+    std::vector<Entry*> pending;
+    for (auto& entry : entries) {
+        if (entry.status == cb::engine_errc::would_block) {
+            keys.push_back({entry.key, entry.vbucket});
+            pending.push_back(&entry);
+        }
+    }
+
+    auto results = bucket_get_multi(cookie, keys);
+    if (results.size() != pending.size()) {
+        LOG_WARNING(&connection,
+                    "%u: GetMulti: engine returned %" PRIu64
+                    " results for %" PRIu64 " keys",
+                    connection.getId(),
+                    uint64_t(results.size()),
+                    uint64_t(pending.size()));
+        return ENGINE_FAILED;
+    }
+
+    bool blocked = false;
+    for (size_t ii = 0; ii < results.size(); ++ii) {
+        auto& entry = *pending[ii];
+        switch (results[ii].first) {
+        case cb::engine_errc::would_block:
+            blocked = true;
+            break;
+        case cb::engine_errc::disconnect:
+            return ENGINE_DISCONNECT;
+        default:
+            entry.status = results[ii].first;
+            entry.it = std::move(results[ii].second);
+        }
+    }
+
+    if (blocked) {
+        // The engine notifies us once all of the blocked keys are available
+        return ENGINE_EWOULDBLOCK;
+    }
+
+    state = State::SendResponse;
+    return ENGINE_SUCCESS;
+}
+
+void GetMultiCommandContext::addResponseHeader(
+        protocol_binary_response_header& header,
+        cb::mcbp::Status status,
+        uint8_t extlen,
+        uint16_t keylen,
+        uint32_t bodylen,
+        protocol_binary_datatype_t datatype,
+        uint64_t cas) {
+    memset(&header, 0, sizeof(header));
+    header.response.magic = (uint8_t)PROTOCOL_BINARY_RES;
+    header.response.opcode = PROTOCOL_BINARY_CMD_GET_MULTI;
+    header.response.keylen = htons(keylen);
+    header.response.extlen = extlen;
+    header.response.datatype = datatype;
+    header.response.status = htons(uint16_t(status));
+    header.response.bodylen = htonl(bodylen);
+    header.response.opaque = cookie.getHeader().getOpaque();
+    header.response.cas = htonll(cas);
+
+    ++connection.getBucket().responseCounters[uint16_t(status)];
+    connection.addIov(header.bytes, sizeof(header.bytes));
+}
+
+ENGINE_ERROR_CODE GetMultiCommandContext::addItem(Entry& entry) {
+    if (!bucket_get_item_info(cookie, entry.it.get(), &entry.info)) {
+        LOG_WARNING(&connection,
+                    "%u: Failed to get item info",
+                    connection.getId());
+        return ENGINE_FAILED;
+    }
+
+    auto& info = entry.info;
+    entry.payload = {static_cast<const char*>(info.value[0].iov_base),
+                     info.value[0].iov_len};
+    protocol_binary_datatype_t datatype = info.datatype;
+
+    if (mcbp::datatype::is_snappy(datatype) &&
+        (mcbp::datatype::is_xattr(datatype) ||
+         !connection.isSnappyEnabled())) {
+        try {
+            entry.inflated = std::make_unique<cb::compression::Buffer>();
+            if (!cb::compression::inflate(cb::compression::Algorithm::Snappy,
+                                          entry.payload,
+                                          *entry.inflated)) {
+                LOG_WARNING(&connection,
+                            "%u: Failed to inflate item",
+                            connection.getId());
+                return ENGINE_FAILED;
+            }
+        } catch (const std::bad_alloc&) {
+            return ENGINE_ENOMEM;
+        }
+        entry.payload = *entry.inflated;
+        datatype &= ~PROTOCOL_BINARY_DATATYPE_SNAPPY;
+    }
+
+    if (mcbp::datatype::is_xattr(datatype)) {
+        entry.payload = cb::xattr::get_body(entry.payload);
+        datatype &= ~PROTOCOL_BINARY_DATATYPE_XATTR;
+    }
+
+    datatype = connection.getEnabledDatatypes(datatype);
+
+    addResponseHeader(entry.header,
+                      cb::mcbp::Status::Success,
+                      sizeof(info.flags),
+                      info.nkey,
+                      sizeof(info.flags) + info.nkey + entry.payload.len,
+                      datatype,
+                      info.cas);
+    connection.addIov(&info.flags, sizeof(info.flags));
+    connection.addIov(info.key, info.nkey);
+    connection.addItemValueIov(entry.it, info, entry.payload);
+
+    cb::audit::document::add(cookie,
+                             cb::audit::document::Operation::Read,
+                             {entry.key.data(), entry.key.size()});
+    STATS_HIT(&connection, get);
+
+    auto* topkeys = connection.getBucket().topkeys;
+    if (topkeys != nullptr) {
+        topkeys->updateKey(entry.key.data(),
+                           entry.key.size(),
+                           mc_time_get_current_time());
+    }
+
+    return ENGINE_SUCCESS;
+}
+
+ENGINE_ERROR_CODE GetMultiCommandContext::sendResponse() {
+    connection.addMsgHdr(true);
+
+    for (auto& entry : entries) {
+        if (entry.status == cb::engine_errc::success) {
+            auto ret = addItem(entry);
+            if (ret != ENGINE_SUCCESS) {
+                // Drop the responses we've added so far; the caller sends
+                // the error response for the whole command
+                connection.addMsgHdr(true);
+                return ret;
+            }
+        } else if (entry.status == cb::engine_errc::no_such_key) {
+            STATS_MISS(&connection, get);
+        } else {
+            auto code = connection.remapErrorCode(
+                    ENGINE_ERROR_CODE(entry.status));
+            if (code == ENGINE_DISCONNECT) {
+                return ENGINE_DISCONNECT;
+            }
+            addResponseHeader(entry.header,
+                              cb::mcbp::to_status(cb::engine_errc(code)),
+                              0,
+                              uint16_t(entry.key.size()),
+                              uint32_t(entry.key.size()),
+                              PROTOCOL_BINARY_RAW_BYTES,
+                              0);
+            connection.addIov(entry.key.data(), entry.key.size());
+        }
+    }
+
+    // Terminate the batch with an empty response
+    addResponseHeader(terminator,
+                      cb::mcbp::Status::Success,
+                      0,
+                      0,
+                      0,
+                      PROTOCOL_BINARY_RAW_BYTES,
+                      0);
+    connection.setState(McbpStateMachine::State::send_data);
+
+    state = State::Done;
+    return ENGINE_SUCCESS;
+}
+
+ENGINE_ERROR_CODE GetMultiCommandContext::step() {
+    ENGINE_ERROR_CODE ret;
+    do {
+        switch (state) {
+        case State::GetItems:
+            ret = getItems();
+            break;
+        case State::SendResponse:
+            ret = sendResponse();
+            break;
+        case State::Done:
+            return ENGINE_SUCCESS;
+        }
+    } while (ret == ENGINE_SUCCESS);
+
+    return ret;
+}
@@ -0,0 +1,115 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2017 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#pragma once
+
+#include <mcbp/protocol/header.h>
+#include <mcbp/protocol/status.h>
+#include <platform/compress.h>
+#include "../../memcached.h"
+#include "steppable_command_context.h"
+
+#include <memory>
+#include <vector>
+
+/**
+ * The GetMultiCommandContext is a state machine used by the memcached
+ * core to implement the GetMulti operation; fetching a batch of keys
+ * with a single call to the engine (and a single notification when the
+ * engine needs to fetch some of them from disk).
+ */
+class GetMultiCommandContext : public SteppableCommandContext {
+public:
+    // The internal states. Look at the function headers below to
+    // for the functions with the same name to figure out what each
+    // state does
+    enum class State : uint8_t { GetItems, SendResponse, Done };
+
+    explicit GetMultiCommandContext(Cookie& cookie);
+
+protected:
+    /**
+     * Keep running the state machine.
+     *
+     * @return A standard engine error code (if SUCCESS we've changed the
+     *         the connections state to one of the appropriate states (send
+     *         data, or start processing the next command)
+     */
+    ENGINE_ERROR_CODE step() override;
+
+    /**
+     * Look up all of the keys we don't have a result for yet in the
+     * underlying engine. If the engine needs to fetch some of them from disk
+     * it returns would_block for those keys (and notifies the cookie once
+     * when all of them are available), and we'll retry just those keys -
+     * which then gets each of them its own status.
+     *
+     * @return ENGINE_EWOULDBLOCK if the underlying engine needs to block
+     *         ENGINE_SUCCESS if we want to continue to run the state diagram
+     *         a standard engine error code if something goes wrong
+     */
+    ENGINE_ERROR_CODE getItems();
+
+    /**
+     * Craft up the response messages and send them to the client; one
+     * response (as for GETK) for each key found, an error response with the
+     * key for each key which failed (other than those which don't exist),
+     * and finally an empty response to terminate the batch. The responses
+     * point directly into the items (or the inflated copies of them) held
+     * by the command context.
+     *
+     * @return ENGINE_DISCONNECT, ENGINE_FAILED, ENGINE_ENOMEM or
+     *         ENGINE_SUCCESS
+     */
+    ENGINE_ERROR_CODE sendResponse();
+
+private:
+    struct Entry {
+        Entry(const DocKey& key, uint16_t vbucket)
+            : key(key), vbucket(vbucket) {
+        }
+
+        const DocKey key;
+        const uint16_t vbucket;
+        cb::engine_errc status = cb::engine_errc::would_block;
+        cb::unique_item_ptr it;
+        item_info info;
+        cb::const_char_buffer payload;
+        std::unique_ptr<cb::compression::Buffer> inflated;
+        protocol_binary_response_header header;
+    };
+
+    /**
+     * Fill in the given response header, and add it to the message to send
+     */
+    void addResponseHeader(protocol_binary_response_header& header,
+                           cb::mcbp::Status status,
+                           uint8_t extlen,
+                           uint16_t keylen,
+                           uint32_t bodylen,
+                           protocol_binary_datatype_t datatype,
+                           uint64_t cas);
+
+    ENGINE_ERROR_CODE addItem(Entry& entry);
+
+    /// One entry per key in the request. Never resized after construction,
+    /// as the message we send points into the entries.
+    std::vector<Entry> entries;
+
+    protocol_binary_response_header terminator;
+
+    State state;
+};
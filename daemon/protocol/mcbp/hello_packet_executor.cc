@@ -49,6 +49,7 @@ void process_hello_packet_executor(Cookie& cookie) {
     connection.setClustermapChangeNotificationSupported(false);
     connection.setAgentName(key);
     connection.setTracingEnabled(false);
+    connection.setGetMultiSupported(false);
 
     if (!key.empty()) {
         log_buffer.append("[");
@@ -155,6 +156,13 @@ void process_hello_packet_executor(Cookie& cookie) {
             added = true;
             break;
 
+        case cb::mcbp::Feature::GetMulti:
+            if (!connection.isGetMultiSupported()) {
+                connection.setGetMultiSupported(true);
+                added = true;
+            }
+            break;
+
         } // end switch
 
         if (added) {
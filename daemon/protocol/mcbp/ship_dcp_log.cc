@@ -286,8 +286,8 @@ static ENGINE_ERROR_CODE dcp_message_mutation(
         // Add the key
         c->addIov(info.key, info.nkey);
 
-        // Add the value
-        c->addIov(buffer.buf, buffer.len);
+        // Add the value (the item is reserved until the send completes)
+        c->addZerocopyIov(buffer.buf, buffer.len);
 
         // Add the optional meta section
         if (nmeta > 0) {
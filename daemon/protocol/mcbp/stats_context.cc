@@ -34,6 +34,7 @@
 #include <platform/sized_buffer.h>
 #include <utilities/protocol2text.h>
 
+#include <algorithm>
 #include <numeric>
 
 // Generic add_stat<T>. Uses std::to_string which requires heap allocation.
@@ -227,6 +228,24 @@ static ENGINE_ERROR_CODE server_stats(ADD_STAT add_stat_callback,
         add_stat(cookie, add_stat_callback, "rejected_conns", stats.rejected_conns);
         add_stat(cookie, add_stat_callback, "threads", settings.getNumWorkerThreads());
         add_stat(cookie, add_stat_callback, "conn_yields", thread_stats.conn_yields);
+
+        uint64_t wakeups = 0;
+        uint64_t wakeups_coalesced = 0;
+        uint64_t wakeup_rate = 0;
+        for (const auto& load : get_worker_load()) {
+            wakeups += load.wakeups;
+            wakeups_coalesced += load.wakeupsCoalesced;
+            wakeup_rate += load.wakeupRate;
+        }
+        add_stat(cookie, add_stat_callback, "worker_wakeups", wakeups);
+        add_stat(cookie,
+                 add_stat_callback,
+                 "worker_wakeups_coalesced",
+                 wakeups_coalesced);
+        add_stat(cookie,
+                 add_stat_callback,
+                 "worker_wakeups_per_sec",
+                 wakeup_rate);
         add_stat(cookie, add_stat_callback, "rbufs_allocated",
                  thread_stats.rbufs_allocated);
         add_stat(cookie, add_stat_callback, "rbufs_loaned",
@@ -403,6 +422,18 @@ static void process_stat_settings(ADD_STAT add_stat_callback, Cookie& cookie) {
              add_stat_callback,
              "collections_prototype",
              settings.isCollectionsPrototypeEnabled());
+    add_stat(cookie,
+             add_stat_callback,
+             "load_aware_connection_placement",
+             settings.isLoadAwareConnectionPlacement());
+    add_stat(cookie,
+             add_stat_callback,
+             "per_worker_listen",
+             settings.isPerWorkerListen());
+    add_stat(cookie,
+             add_stat_callback,
+             "send_zerocopy_threshold",
+             settings.getSendZerocopyThreshold());
 }
 
 static void append_bin_stats(const char* key,
@@ -540,6 +571,63 @@ static ENGINE_ERROR_CODE stat_sched_executor(const std::string& arg,
     }
 }
 
+/**
+ * Handler for the <code>stats worker_load</code> used to get the number
+ * of connections, the event rate and the wakeups of each of the worker
+ * threads, and how unevenly the load is spread across them.
+ *
+ * @param arg - should be empty
+ * @param cookie the command context
+ */
+static ENGINE_ERROR_CODE stat_worker_load_executor(const std::string& arg,
+                                                   Cookie& cookie) {
+    if (!arg.empty()) {
+        return ENGINE_EINVAL;
+    }
+
+    const auto load = get_worker_load();
+    uint64_t total_rate = 0;
+    uint64_t max_rate = 0;
+    for (size_t ii = 0; ii < load.size(); ++ii) {
+        const std::string prefix = "worker_" + std::to_string(ii) + ":";
+        add_stat(cookie,
+                 append_stats,
+                 (prefix + "connections").c_str(),
+                 load[ii].connections);
+        add_stat(cookie,
+                 append_stats,
+                 (prefix + "events").c_str(),
+                 load[ii].events);
+        add_stat(cookie,
+                 append_stats,
+                 (prefix + "events_per_sec").c_str(),
+                 load[ii].eventRate);
+        add_stat(cookie,
+                 append_stats,
+                 (prefix + "wakeups").c_str(),
+                 load[ii].wakeups);
+        add_stat(cookie,
+                 append_stats,
+                 (prefix + "wakeups_coalesced").c_str(),
+                 load[ii].wakeupsCoalesced);
+        add_stat(cookie,
+                 append_stats,
+                 (prefix + "wakeups_per_sec").c_str(),
+                 load[ii].wakeupRate);
+        total_rate += load[ii].eventRate;
+        max_rate = std::max(max_rate, load[ii].eventRate);
+    }
+
+    // The busiest worker's event rate as a percentage of the mean event
+    // rate; 100 means the load is perfectly balanced.
+    uint64_t imbalance = 100;
+    if (total_rate > 0) {
+        imbalance = max_rate * 100 * load.size() / total_rate;
+    }
+    add_stat(cookie, append_stats, "imbalance_pct", imbalance);
+    return ENGINE_SUCCESS;
+}
+
 /**
  * Handler for the <code>stats settings</code> used to get the current
  * settings.
@@ -728,6 +816,52 @@ static ENGINE_ERROR_CODE stat_subdoc_execute_executor(const std::string& arg,
     }
 }
 
+/**
+ * Handler for the <code>stats phase_timings</code> command used to get the
+ * histograms of the time spent in each phase (validate, execute,
+ * wouldblock, notify and transmit) of the commands used in the selected
+ * bucket (or all buckets if no bucket is selected).
+ *
+ * @param arg - should be empty
+ * @param cookie the command context
+ */
+static ENGINE_ERROR_CODE stat_phase_timings_executor(const std::string& arg,
+                                                     Cookie& cookie) {
+    if (!arg.empty()) {
+        return ENGINE_EINVAL;
+    }
+
+    const auto index = cookie.getConnection().getBucketIndex();
+    if (index == 0) {
+        // You need the Stats privilege to see the aggregate of all buckets
+        auto ret = mcbp::checkPrivilege(cookie, cb::rbac::Privilege::Stats);
+        if (ret != ENGINE_SUCCESS) {
+            return ret;
+        }
+    }
+
+    auto& timings = all_buckets[index].timings;
+    for (int ii = 0; ii < MAX_NUM_OPCODES; ++ii) {
+        const auto opcode = uint8_t(ii);
+        for (const auto phase : Timings::phases) {
+            const auto hist = timings.generate(opcode, phase);
+            if (hist.empty()) {
+                continue;
+            }
+            const char* name = memcached_opcode_2_text(opcode);
+            const std::string key =
+                    (name ? std::string(name) : std::to_string(ii)) + ":" +
+                    to_string(phase);
+            append_stats(key.data(),
+                         key.size(),
+                         hist.data(),
+                         hist.size(),
+                         &cookie);
+        }
+    }
+    return ENGINE_SUCCESS;
+}
+
 static ENGINE_ERROR_CODE stat_responses_json_executor(const std::string& arg,
                                                       Cookie& cookie) {
     try {
@@ -827,6 +961,7 @@ ENGINE_ERROR_CODE StatsCommandContext::step() {
     static std::unordered_map<std::string, struct stat_handler> handlers = {
             {"reset", {true, stat_reset_executor}},
             {"worker_thread_info", {false, stat_sched_executor}},
+            {"worker_load", {false, stat_worker_load_executor}},
             {"settings", {false, stat_settings_executor}},
             {"audit", {true, stat_audit_executor}},
             {"bucket_details", {true, stat_bucket_details_executor}},
@@ -835,6 +970,7 @@ ENGINE_ERROR_CODE StatsCommandContext::step() {
             {"topkeys", {false, stat_topkeys_executor}},
             {"topkeys_json", {false, stat_topkeys_json_executor}},
             {"subdoc_execute", {false, stat_subdoc_execute_executor}},
+            {"phase_timings", {false, stat_phase_timings_executor}},
             {"responses", {false, stat_responses_json_executor}},
             {"tracing", {true, stat_tracing_executor}}};
 
@@ -50,6 +50,7 @@ Settings::Settings()
       default_reqs_per_event(00),
       max_packet_size(0),
       topkeys_size(0),
+      per_worker_listen(false),
       maxconns(0) {
 
     verbose.store(0);
@@ -216,6 +217,61 @@ static void handle_topkeys_enabled(Settings& s, cJSON* obj) {
     }
 }
 
+/**
+ * Handle the "load_aware_connection_placement" tag in the settings
+ *
+ *  The value must be a boolean value
+ *
+ * @param s the settings object to update
+ * @param obj the object in the configuration
+ */
+static void handle_load_aware_connection_placement(Settings& s, cJSON* obj) {
+    if (obj->type == cJSON_True) {
+        s.setLoadAwareConnectionPlacement(true);
+    } else if (obj->type == cJSON_False) {
+        s.setLoadAwareConnectionPlacement(false);
+    } else {
+        throw std::invalid_argument(
+                "\"load_aware_connection_placement\" must be a boolean value");
+    }
+}
+
+/**
+ * Handle the "per_worker_listen" tag in the settings
+ *
+ *  The value must be a boolean value
+ *
+ * @param s the settings object to update
+ * @param obj the object in the configuration
+ */
+static void handle_per_worker_listen(Settings& s, cJSON* obj) {
+    if (obj->type == cJSON_True) {
+        s.setPerWorkerListen(true);
+    } else if (obj->type == cJSON_False) {
+        s.setPerWorkerListen(false);
+    } else {
+        throw std::invalid_argument(
+                "\"per_worker_listen\" must be a boolean value");
+    }
+}
+
+/**
+ * Handle the "send_zerocopy_threshold" tag in the settings
+ *
+ *  The value must be a non-negative integer (the size in bytes)
+ *
+ * @param s the settings object to update
+ * @param obj the object in the configuration
+ */
+static void handle_send_zerocopy_threshold(Settings& s, cJSON* obj) {
+    if (obj->type != cJSON_Number || obj->valueint < 0) {
+        throw std::invalid_argument(
+                "\"send_zerocopy_threshold\" must be a non-negative "
+                "integer");
+    }
+    s.setSendZerocopyThreshold(size_t(obj->valueint));
+}
+
 /**
  * Handle "default_reqs_per_event", "reqs_per_event_high_priority",
  * "reqs_per_event_med_priority" and "reqs_per_event_low_priority" tag in
@@ -665,7 +721,11 @@ void Settings::reconfigure(const unique_cJSON_ptr& json) {
             {"client_cert_auth", handle_client_cert_auth},
             {"collections_prototype", handle_collections_prototype},
             {"opcode_attributes_override", handle_opcode_attributes_override},
-            {"topkeys_enabled", handle_topkeys_enabled}};
+            {"topkeys_enabled", handle_topkeys_enabled},
+            {"load_aware_connection_placement",
+             handle_load_aware_connection_placement},
+            {"per_worker_listen", handle_per_worker_listen},
+            {"send_zerocopy_threshold", handle_send_zerocopy_threshold}};
 
     cJSON* obj = json->child;
     while (obj != nullptr) {
@@ -932,6 +992,12 @@ void Settings::updateSettings(const Settings& other, bool apply) {
                 "topkeys_size can't be changed dynamically");
         }
     }
+    if (other.has.per_worker_listen) {
+        if (other.per_worker_listen != per_worker_listen) {
+            throw std::invalid_argument(
+                    "per_worker_listen can't be changed dynamically");
+        }
+    }
     if (other.has.sasl_mechanisms) {
         if (other.sasl_mechanisms != sasl_mechanisms) {
             throw std::invalid_argument(
@@ -1287,6 +1353,31 @@ void Settings::updateSettings(const Settings& other, bool apply) {
         }
         setTopkeysEnabled(other.isTopkeysEnabled());
     }
+
+    if (other.has.load_aware_connection_placement) {
+        if (other.isLoadAwareConnectionPlacement() !=
+            isLoadAwareConnectionPlacement()) {
+            if (other.isLoadAwareConnectionPlacement()) {
+                logit(EXTENSION_LOG_NOTICE,
+                      "Enable load aware connection placement");
+            } else {
+                logit(EXTENSION_LOG_NOTICE,
+                      "Disable load aware connection placement");
+            }
+        }
+        setLoadAwareConnectionPlacement(
+                other.isLoadAwareConnectionPlacement());
+    }
+
+    if (other.has.send_zerocopy_threshold) {
+        if (other.getSendZerocopyThreshold() != getSendZerocopyThreshold()) {
+            logit(EXTENSION_LOG_NOTICE,
+                  "Change send zerocopy threshold from %zu to %zu",
+                  getSendZerocopyThreshold(),
+                  other.getSendZerocopyThreshold());
+            setSendZerocopyThreshold(other.getSendZerocopyThreshold());
+        }
+    }
 }
 
 void Settings::logit(EXTENSION_LOG_LEVEL level, const char* fmt, ...) {
@@ -697,6 +697,20 @@ public:
         has.topkeys_size = true;
     }
 
+    /**
+     * Should each worker thread accept clients on its own (SO_REUSEPORT)
+     * listen sockets instead of having the dispatcher thread accept all
+     * clients and hand them over to the workers
+     */
+    bool isPerWorkerListen() const {
+        return per_worker_listen;
+    }
+
+    void setPerWorkerListen(bool enabled) {
+        Settings::per_worker_listen = enabled;
+        has.per_worker_listen = true;
+    }
+
     /**
      * Get the list of available SASL Mechanisms
      *
@@ -866,6 +880,33 @@ public:
         notify_changed("topkeys_enabled");
     }
 
+    /**
+     * Get the minimum size of an item value to send with MSG_ZEROCOPY
+     * (0 means never)
+     */
+    size_t getSendZerocopyThreshold() const {
+        return send_zerocopy_threshold.load(std::memory_order_relaxed);
+    }
+
+    void setSendZerocopyThreshold(size_t threshold) {
+        Settings::send_zerocopy_threshold.store(threshold,
+                                                std::memory_order_relaxed);
+        has.send_zerocopy_threshold = true;
+        notify_changed("send_zerocopy_threshold");
+    }
+
+    bool isLoadAwareConnectionPlacement() const {
+        return load_aware_connection_placement.load(
+                std::memory_order_acquire);
+    }
+
+    void setLoadAwareConnectionPlacement(bool enabled) {
+        Settings::load_aware_connection_placement.store(
+                enabled, std::memory_order_release);
+        has.load_aware_connection_placement = true;
+        notify_changed("load_aware_connection_placement");
+    }
+
 protected:
 
     /**
@@ -976,6 +1017,11 @@ protected:
      */
     int topkeys_size;
 
+    /**
+     * Does each worker thread own SO_REUSEPORT listen sockets
+     */
+    bool per_worker_listen;
+
     /**
      * The available sasl mechanism list
      */
@@ -1027,6 +1073,18 @@ protected:
      */
     std::atomic_bool topkeys_enabled{false};
 
+    /**
+     * Should new connections be bound to the least loaded worker thread
+     * (instead of round-robin)
+     */
+    std::atomic_bool load_aware_connection_placement{false};
+
+    /**
+     * Item values of at least this size are sent with MSG_ZEROCOPY
+     * (0 disables the use of MSG_ZEROCOPY)
+     */
+    std::atomic<size_t> send_zerocopy_threshold{0};
+
 public:
     /**
      * Flags for each of the above config options, indicating if they were
@@ -1067,6 +1125,9 @@ public:
         bool collections_prototype;
         bool opcode_attributes_override;
         bool topkeys_enabled;
+        bool load_aware_connection_placement;
+        bool per_worker_listen;
+        bool send_zerocopy_threshold;
     } has;
 
 protected:
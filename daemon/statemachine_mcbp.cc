@@ -354,6 +354,10 @@ bool conn_execute(McbpConnection& connection) {
 
     auto& cookie = connection.getCookieObject();
 
+    // If we're resuming a blocked command, it's no longer waiting for
+    // the worker thread to pick up the notification
+    cookie.getTracer().end(cb::tracing::TraceCode::NOTIFY);
+
     mcbp_execute_packet(cookie);
 
     if (connection.isEwouldblock()) {
@@ -464,7 +468,8 @@ bool conn_send_data(McbpConnection& connection) {
     case McbpConnection::TransmitResult::Complete:
         // Release all allocated resources
         connection.releaseTempAlloc();
-        connection.releaseReservedItems();
+        connection.releaseTransmittedItems();
+        mcbp_collect_transmit_timings(connection.getCookieObject());
 
         // We're done sending the response to the client. Enter the next
         // state in the state machine
@@ -546,8 +551,10 @@ bool conn_closing(McbpConnection& connection) {
 
     /* We don't want any network notifications anymore.. */
     connection.unregisterEvent();
-    safe_close(connection.getSocketDescriptor());
-    connection.setSocketDescriptor(INVALID_SOCKET);
+
+    // The kernel reports the completion of MSG_ZEROCOPY sends on the socket,
+    // so it may be kept open (by the thread's reaper) until they're done
+    connection.closeSocket();
 
     // Release all reserved items!
     connection.releaseReservedItems();
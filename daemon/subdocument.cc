@@ -1657,7 +1657,17 @@ static void subdoc_multi_lookup_response(Cookie& cookie,
             connection.addIov(reinterpret_cast<void*>(header), header_sz);
 
             if (result_len != 0) {
-                connection.addIov(mloc.at, mloc.length);
+                if (op.traits.mcbpCommand == PROTOCOL_BINARY_CMD_GET &&
+                    context.fetchedItem) {
+                    // The whole document body may be sent straight from the
+                    // item (with MSG_ZEROCOPY), in which case the connection
+                    // takes over the item.
+                    connection.addItemValueIov(context.fetchedItem,
+                                               context.getInputItemInfo(),
+                                               {mloc.at, mloc.length});
+                } else {
+                    connection.addIov(mloc.at, mloc.length);
+                }
             }
             response_buf.moveOffset(header_sz);
         }
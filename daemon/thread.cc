@@ -17,10 +17,18 @@
 #include <fcntl.h>
 #include <platform/cb_malloc.h>
 #include <platform/platform.h>
+#include <platform/processclock.h>
 #include <platform/strerror.h>
+#include <utilities/thread_slot.h>
+#include <algorithm>
+#include <limits>
 #include <queue>
 #include <memory>
 
+#ifdef HAVE_EVENTFD
+#include <sys/eventfd.h>
+#endif
+
 #define ITEMS_PER_ALLOC 64
 
 extern std::atomic<bool> memcached_shutdown;
@@ -153,6 +161,36 @@ bool create_notification_pipe(LIBEVENT_THREAD *me)
     return true;
 }
 
+/*
+ * Create the channel other threads use to notify a worker thread. Where
+ * available this is an eventfd; a single counter which may be signalled
+ * and drained with one system call regardless of how many notifications
+ * are pending, and which doesn't need a buffer in the kernel.
+ */
+static bool create_worker_notifier(LIBEVENT_THREAD* me) {
+#ifdef HAVE_EVENTFD
+    int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd == -1) {
+        log_system_error(EXTENSION_LOG_WARNING, NULL,
+                         "Can't create notify eventfd: %s");
+        return false;
+    }
+    me->notify[0] = me->notify[1] = fd;
+    return true;
+#else
+    return create_notification_pipe(me);
+#endif
+}
+
+static void release_worker_notifier(LIBEVENT_THREAD* me) {
+#ifdef HAVE_EVENTFD
+    close(me->notify[0]);
+#else
+    safe_close(me->notify[0]);
+    safe_close(me->notify[1]);
+#endif
+}
+
 static void setup_dispatcher(struct event_base *main_base,
                              void (*dispatcher_callback)(evutil_socket_t, short, void *))
 {
@@ -212,6 +250,12 @@ static void setup_thread(LIBEVENT_THREAD *me) {
     } catch (const std::bad_alloc&) {
         FATAL_ERROR(EXIT_FAILURE, "Failed to allocate memory for JSON validator");
     }
+
+    try {
+        me->zerocopy_reaper = new ZerocopyReaper(me->base);
+    } catch (const std::bad_alloc&) {
+        FATAL_ERROR(EXIT_FAILURE, "Failed to allocate memory for zerocopy reaper");
+    }
 }
 
 /*
@@ -223,6 +267,7 @@ static void worker_libevent(void *arg) {
     /* Any per-thread setup can happen here; thread_init() will block until
      * all threads have finished initializing.
      */
+    cb::setThreadSlot(size_t(me->index));
 
     cb_mutex_enter(&init_lock);
     init_count++;
@@ -245,6 +290,7 @@ static int number_of_pending(Connection *c, Connection *list) {
     return rv;
 }
 
+#ifndef HAVE_EVENTFD
 static void drain_notification_channel(evutil_socket_t fd)
 {
     /* Every time we want to notify a thread, we send 1 byte to its
@@ -268,6 +314,19 @@ static void drain_notification_channel(evutil_socket_t fd)
                          "Can't read from libevent pipe: %s");
     }
 }
+#endif
+
+static void drain_worker_notifier(evutil_socket_t fd) {
+#ifdef HAVE_EVENTFD
+    eventfd_t value;
+    if (eventfd_read(fd, &value) == -1 && errno != EAGAIN) {
+        log_system_error(EXTENSION_LOG_WARNING, NULL,
+                         "Can't read from notify eventfd: %s");
+    }
+#else
+    drain_notification_channel(fd);
+#endif
+}
 
 void dispatch_new_connections(LIBEVENT_THREAD* me) {
     std::unique_ptr<ConnectionQueueItem> item;
@@ -276,10 +335,22 @@ void dispatch_new_connections(LIBEVENT_THREAD* me) {
             LOG_WARNING(nullptr, "Failed to dispatch event for socket %ld",
                         long(item->sfd));
             safe_close(item->sfd);
+            me->num_connections--;
         }
     }
 }
 
+void dispatch_conn_local(LIBEVENT_THREAD* me, SOCKET sfd, int parent_port) {
+    me->num_connections++;
+    MEMCACHED_CONN_DISPATCH(sfd, (uintptr_t)me->thread_id);
+    if (conn_new(sfd, parent_port, me->base, me) == nullptr) {
+        LOG_WARNING(nullptr, "Failed to dispatch event for socket %ld",
+                    long(sfd));
+        safe_close(sfd);
+        me->num_connections--;
+    }
+}
+
 /*
  * Processes an incoming "handle a new connection" item. This is called when
  * input arrives on the libevent wakeup pipe.
@@ -293,7 +364,10 @@ static void thread_libevent_process(evutil_socket_t fd, short which, void *arg)
     // tries to notify us while we're doing the work below (so we don't have
     // to care about race conditions for stuff people try to notify us
     // about.
-    drain_notification_channel(fd);
+    drain_worker_notifier(fd);
+    // Any notification from now on must wake us up again; those which
+    // arrived before this will be handled by the work below.
+    me->notify_pending.store(false);
 
     if (memcached_shutdown) {
         // Someone requested memcached to shut down. The listen thread should
@@ -423,9 +497,19 @@ static void enlist_conn(Connection *c, Connection **list) {
 
 void notify_io_complete(gsl::not_null<const void*> void_cookie,
                         ENGINE_ERROR_CODE status) {
-    auto* cookie = reinterpret_cast<const Cookie*>(void_cookie.get());
+    auto* cookie =
+            reinterpret_cast<Cookie*>(const_cast<void*>(void_cookie.get()));
     cookie->validate();
 
+    // The blocked command may continue once the worker thread picks it up.
+    // (Notifications for other reasons, or which arrive before the
+    // command returned EWOULDBLOCK aren't traced.)
+    auto& tracer = cookie->getTracer();
+    const auto now = ProcessClock::now();
+    if (tracer.end(cb::tracing::TraceCode::WOULDBLOCK, now)) {
+        tracer.begin(cb::tracing::TraceCode::NOTIFY, now);
+    }
+
     LIBEVENT_THREAD* thr = cookie->getConnection().getThread();
     if (thr == nullptr) {
         throw std::runtime_error(
@@ -453,15 +537,113 @@ void notify_io_complete(gsl::not_null<const void*> void_cookie,
 /* Which thread we assigned a connection to most recently. */
 static int last_thread = -1;
 
+/*
+ * The event and wakeup rates of each worker thread, sampled (at most) once
+ * a second from the LIBEVENT_THREAD counters. Protected by load_mutex.
+ */
+struct LoadSample {
+    uint64_t events = 0;
+    uint64_t eventRate = 0;
+    uint64_t wakeups = 0;
+    uint64_t wakeupRate = 0;
+};
+static std::mutex load_mutex;
+static ProcessClock::time_point load_sample_time;
+static std::vector<LoadSample> load_samples;
+
+static void sample_worker_load() {
+    const auto now = ProcessClock::now();
+    const auto elapsed = now - load_sample_time;
+    if (elapsed < std::chrono::seconds(1)) {
+        return;
+    }
+
+    load_samples.resize(nthreads);
+    using namespace std::chrono;
+    const auto ms = std::max(
+            int64_t(1), int64_t(duration_cast<milliseconds>(elapsed).count()));
+    for (int ii = 0; ii < nthreads; ++ii) {
+        auto& sample = load_samples[ii];
+        const uint64_t events = threads[ii].num_events.load();
+        sample.eventRate = (events - sample.events) * 1000 / ms;
+        sample.events = events;
+        const uint64_t wakeups = threads[ii].wakeups.load();
+        sample.wakeupRate = (wakeups - sample.wakeups) * 1000 / ms;
+        sample.wakeups = wakeups;
+    }
+    load_sample_time = now;
+}
+
+std::vector<WorkerLoad> get_worker_load() {
+    std::lock_guard<std::mutex> guard(load_mutex);
+    sample_worker_load();
+
+    std::vector<WorkerLoad> ret(nthreads);
+    for (int ii = 0; ii < nthreads; ++ii) {
+        ret[ii].connections = threads[ii].num_connections.load();
+        ret[ii].events = threads[ii].num_events.load();
+        ret[ii].eventRate = load_samples[ii].eventRate;
+        ret[ii].wakeups = threads[ii].wakeups.load();
+        ret[ii].wakeupsCoalesced = threads[ii].wakeups_coalesced.load();
+        ret[ii].wakeupRate = load_samples[ii].wakeupRate;
+    }
+    return ret;
+}
+
+/*
+ * Pick the worker thread with the least load for a new connection.
+ *
+ * The load of a thread is the rate of events it is currently processing
+ * plus the expected load of the connections bound to it (including those
+ * still queued), each counted as the average event rate of a connection.
+ * The connection count means that a burst of new connections (arriving
+ * faster than we sample the event rates) is still spread across the
+ * threads. Ties are broken round-robin.
+ */
+static int pick_least_loaded_thread() {
+    const auto load = get_worker_load();
+
+    uint64_t total_rate = 0;
+    uint64_t total_connections = 0;
+    for (const auto& l : load) {
+        total_rate += l.eventRate;
+        total_connections += l.connections;
+    }
+    const uint64_t connection_rate = std::max(
+            uint64_t(1),
+            total_rate / std::max(uint64_t(1), total_connections));
+
+    int tid = 0;
+    uint64_t lowest = std::numeric_limits<uint64_t>::max();
+    for (int ii = 1; ii <= nthreads; ++ii) {
+        const int candidate = (last_thread + ii) % nthreads;
+        const auto& l = load[candidate];
+        const uint64_t score = l.eventRate + l.connections * connection_rate;
+        if (score < lowest) {
+            lowest = score;
+            tid = candidate;
+        }
+    }
+    return tid;
+}
+
 /*
  * Dispatches a new connection to another thread. This is only ever called
  * from the main thread, or because of an incoming connection.
  */
 void dispatch_conn_new(SOCKET sfd, int parent_port) {
-    int tid = (last_thread + 1) % settings.getNumWorkerThreads();
+    int tid;
+    if (settings.isLoadAwareConnectionPlacement()) {
+        tid = pick_least_loaded_thread();
+    } else {
+        tid = (last_thread + 1) % settings.getNumWorkerThreads();
+    }
     LIBEVENT_THREAD* thread = threads + tid;
     last_thread = tid;
 
+    // Account for the connection before it is visible to the worker, so
+    // the worker never sees the count drop below zero
+    thread->num_connections++;
     try {
         std::unique_ptr<ConnectionQueueItem> item(
             new ConnectionQueueItem(sfd, parent_port));
@@ -470,6 +652,7 @@ void dispatch_conn_new(SOCKET sfd, int parent_port) {
         LOG_WARNING(nullptr,
                     "dispatch_conn_new: Failed to dispatch new connection: %s",
                     e.what());
+        thread->num_connections--;
         safe_close(sfd);
         return ;
     }
@@ -478,6 +661,10 @@ void dispatch_conn_new(SOCKET sfd, int parent_port) {
     notify_thread(thread);
 }
 
+LIBEVENT_THREAD* get_worker_thread(int index) {
+    return threads + index;
+}
+
 /*
  * Returns true if this is the thread that listens for new TCP connections.
  */
@@ -526,7 +713,7 @@ void thread_init(int nthr, struct event_base *main_base,
     setup_dispatcher(main_base, dispatcher_callback);
 
     for (i = 0; i < nthreads; i++) {
-        if (!create_notification_pipe(&threads[i])) {
+        if (!create_worker_notifier(&threads[i])) {
             FATAL_ERROR(EXIT_FAILURE, "Cannot create notification pipe");
         }
         threads[i].index = i;
@@ -563,8 +750,8 @@ void threads_cleanup(void)
 {
     int ii;
     for (ii = 0; ii < nthreads; ++ii) {
-        safe_close(threads[ii].notify[0]);
-        safe_close(threads[ii].notify[1]);
+        release_worker_notifier(&threads[ii]);
+        delete threads[ii].zerocopy_reaper;
         event_base_free(threads[ii].base);
         threads[ii].read.reset();
         threads[ii].write.reset();
@@ -605,7 +792,39 @@ void threads_initiate_bucket_deletion(void)
     }
 }
 
+/*
+ * Notify a worker thread, unless a notification is already pending (in
+ * which case the worker will see the new work when it runs).
+ */
+static void notify_worker(LIBEVENT_THREAD* thread) {
+    if (thread->notify_pending.exchange(true)) {
+        thread->wakeups_coalesced.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    thread->wakeups.fetch_add(1, std::memory_order_relaxed);
+#ifdef HAVE_EVENTFD
+    if (eventfd_write(thread->notify[1], 1) == -1) {
+        log_system_error(EXTENSION_LOG_WARNING, NULL,
+                         "Failed to notify thread: %s");
+    }
+#else
+    if (send(thread->notify[1], "", 1, 0) != 1 &&
+            !is_blocking(GetLastNetworkError())) {
+        log_socket_error(EXTENSION_LOG_WARNING, NULL,
+                         "Failed to notify thread: %s");
+    }
+#endif
+}
+
 void notify_thread(LIBEVENT_THREAD *thread) {
+    if (thread->type == ThreadType::GENERAL) {
+        notify_worker(thread);
+        return;
+    }
+
+    // The dispatcher counts the notifications it receives (see
+    // dispatch_event_handler), so they can't be coalesced
     if (send(thread->notify[1], "", 1, 0) != 1 &&
             !is_blocking(GetLastNetworkError())) {
         log_socket_error(EXTENSION_LOG_WARNING, NULL,
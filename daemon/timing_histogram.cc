@@ -20,54 +20,44 @@
 #include <cJSON.h>
 #include <cJSON_utils.h>
 #include <platform/platform.h>
+#include <utilities/thread_slot.h>
 
 #include <atomic>
 #include <chrono>
-#include <functional>
-#include <sstream>
+#include <cmath>
 #include <string>
 
 TimingHistogram::TimingHistogram() {
-    reset();
+    for (auto& shard : shards) {
+        shard.store(nullptr);
+    }
 }
 
-TimingHistogram::TimingHistogram(const TimingHistogram &other) {
-    *this = other;
+TimingHistogram::TimingHistogram(const TimingHistogram &other)
+    : TimingHistogram() {
+    *this += other;
 }
 
-template <template <typename ...Args> class F>
-void TimingHistogram::arith_op(TimingHistogram& a, const TimingHistogram& b) {
-    a.ns = F<uint32_t>()(a.ns, b.ns);
-
-    size_t idx;
-    size_t len = a.usec.size();
-    for (idx = 0; idx < len; ++idx) {
-        a.usec[idx] = F<uint32_t>()(a.usec[idx], b.usec[idx]);
-    }
-
-    len = a.msec.size();
-    for (idx = 0; idx < len; ++idx) {
-        a.msec[idx] = F<uint32_t>()(a.msec[idx], b.msec[idx]);
+TimingHistogram::~TimingHistogram() {
+    for (auto& shard : shards) {
+        delete shard.load();
     }
-
-    len = a.halfsec.size();
-    for (idx = 0; idx < len; ++idx) {
-        a.halfsec[idx] = F<uint32_t>()(a.halfsec[idx], b.halfsec[idx]);
-    }
-
-    len = a.wayout.size();
-    for (idx = 0; idx < len; ++idx) {
-        a.wayout[idx] = F<uint32_t>()(a.wayout[idx], b.wayout[idx]);
-    }
-    a.total = F<uint64_t>()(a.total, b.total);
 }
 
-template <typename T>
-struct identity {
-    T operator() (const T& a, const T& b) {
-        return b;
+TimingHistogram::Shard& TimingHistogram::getShard() {
+    auto& slot = shards[cb::getThreadSlot() % NumShards];
+    auto* shard = slot.load(std::memory_order_acquire);
+    if (shard == nullptr) {
+        auto* created = new Shard();
+        if (slot.compare_exchange_strong(shard, created)) {
+            shard = created;
+        } else {
+            // Another thread sharing the slot beat us to it
+            delete created;
+        }
     }
-};
+    return *shard;
+}
 
 /**
  * This isn't completely accurate, but it's only called whenever we're
@@ -76,7 +66,10 @@ struct identity {
  * don't care <em>THAT</em> much for being accurate..
  */
 TimingHistogram& TimingHistogram::operator=(const TimingHistogram& other) {
-    TimingHistogram::arith_op<identity>(*this, other);
+    if (this != &other) {
+        reset();
+        *this += other;
+    }
     return *this;
 }
 
@@ -85,59 +78,96 @@ TimingHistogram& TimingHistogram::operator=(const TimingHistogram& other) {
  * called whenever we're grabbing the stats.
  */
 TimingHistogram& TimingHistogram::operator+=(const TimingHistogram& other) {
-    TimingHistogram::arith_op<std::plus>(*this, other);
+    Shard* dst = nullptr;
+    for (const auto& slot : other.shards) {
+        const auto* src = slot.load(std::memory_order_acquire);
+        if (src == nullptr) {
+            continue;
+        }
+        if (dst == nullptr) {
+            dst = &getShard();
+        }
+        for (size_t ii = 0; ii < NumBuckets; ++ii) {
+            dst->buckets[ii].fetch_add(src->buckets[ii]);
+        }
+        dst->total.fetch_add(src->total);
+    }
     return *this;
 }
 
 void TimingHistogram::reset(void) {
-    ns = 0;
-    for (auto& us : usec) {
-        us.reset();
+    // Keep the shards; a thread may be recording into one of them
+    for (auto& slot : shards) {
+        auto* shard = slot.load(std::memory_order_acquire);
+        if (shard != nullptr) {
+            for (auto& bucket : shard->buckets) {
+                bucket.reset();
+            }
+            shard->total.reset();
+        }
     }
-    for (auto& ms : msec) {
-        ms.reset();
+}
+
+size_t TimingHistogram::getBucketIndex(uint64_t usec) {
+    if (usec < LinearBuckets) {
+        return usec;
     }
-    for (auto& hs : halfsec) {
-        hs.reset();
+
+    // Position of the most significant bit (at least 5 as usec >= 32);
+    // the next four bits select the sub bucket.
+    size_t msb = 63;
+    while ((usec & (uint64_t(1) << msb)) == 0) {
+        --msb;
     }
-    for (auto& wo: wayout) {
-        wo.reset();
+    if (msb >= MaxBits) {
+        return NumBuckets - 1;
     }
-    total.reset();
+    return LinearBuckets + (msb - 5) * SubBuckets +
+           ((usec >> (msb - 4)) & (SubBuckets - 1));
+}
+
+uint64_t TimingHistogram::getBucketLow(size_t index) {
+    if (index < LinearBuckets) {
+        return index;
+    }
+    const auto range = (index - LinearBuckets) / SubBuckets;
+    const auto sub = (index - LinearBuckets) % SubBuckets;
+    return (SubBuckets + sub) << (range + 1);
+}
+
+uint64_t TimingHistogram::getBucketHigh(size_t index) {
+    if (index < LinearBuckets) {
+        return index;
+    }
+    if (index == NumBuckets - 1) {
+        return 0;
+    }
+    const auto range = (index - LinearBuckets) / SubBuckets;
+    return getBucketLow(index) + (uint64_t(1) << (range + 1)) - 1;
 }
 
 void TimingHistogram::add(const std::chrono::nanoseconds nsec) {
     using namespace std::chrono;
-    using halfseconds = duration<long long, std::ratio<1, 2>>;
-
-    auto us = duration_cast<microseconds>(nsec);
-    auto ms = duration_cast<milliseconds>(us);
-    auto hs = duration_cast<halfseconds>(ms);
-
-    if (us.count() == 0) {
-        ns++;
-    } else if (us.count() < 1000) {
-        usec[us.count() / 10]++;
-    } else if (ms.count() < 50) {
-        msec[ms.count()]++;
-    } else if (hs.count() < 10) {
-        halfsec[hs.count()]++;
-    } else {
-        // [5-9], [10-19], [20-39], [40-79], [80-inf].
-        auto sec = duration_cast<seconds>(hs);
-        if (sec.count() < 10) {
-            wayout[0]++;
-        } else if (sec.count() < 20) {
-            wayout[1]++;
-        } else if (sec.count() < 40) {
-            wayout[2]++;
-        } else if (sec.count() < 80) {
-            wayout[3]++;
-        } else {
-            wayout[4]++;
+    const auto us = duration_cast<microseconds>(nsec).count();
+
+    auto& shard = getShard();
+    shard.buckets[getBucketIndex(us < 0 ? 0 : uint64_t(us))]++;
+    shard.total++;
+}
+
+std::array<uint64_t, TimingHistogram::NumBuckets>
+TimingHistogram::getCounts() {
+    std::array<uint64_t, NumBuckets> counts;
+    counts.fill(0);
+    for (const auto& slot : shards) {
+        const auto* shard = slot.load(std::memory_order_acquire);
+        if (shard != nullptr) {
+            for (size_t ii = 0; ii < NumBuckets; ++ii) {
+                counts[ii] += shard->buckets[ii];
+            }
         }
     }
-    total++;
+    return counts;
 }
 
 std::string TimingHistogram::to_string(void) {
@@ -148,39 +178,55 @@ std::string TimingHistogram::to_string(void) {
         throw std::bad_alloc();
     }
 
-    cJSON_AddNumberToObject(root, "ns", get_ns());
-
-    cJSON *array = cJSON_CreateArray();
-    for (auto &us : usec) {
-        cJSON *obj = cJSON_CreateNumber(us);
-        cJSON_AddItemToArray(array, obj);
+    // Use the sum of the merged counts rather than the totals, so the
+    // percentiles are consistent with the buckets
+    const auto counts = getCounts();
+    uint64_t total = 0;
+    for (const auto count : counts) {
+        total += count;
     }
-    cJSON_AddItemToObject(root, "us", array);
-
-    array = cJSON_CreateArray();
-    size_t len = msec.size();
-    // element 0 isn't used
-    for (size_t ii = 1; ii < len; ii++) {
-        cJSON *obj = cJSON_CreateNumber(get_msec(ii));
-        cJSON_AddItemToArray(array, obj);
+    cJSON_AddNumberToObject(root, "total", total);
+
+    static const std::array<std::pair<const char*, double>, 6> percentiles = {
+            {{"50", 50.0},
+             {"90", 90.0},
+             {"99", 99.0},
+             {"99.9", 99.9},
+             {"99.99", 99.99},
+             {"100", 100.0}}};
+
+    cJSON* obj = cJSON_CreateObject();
+    if (total > 0) {
+        uint64_t cumulative = 0;
+        size_t index = 0;
+        for (const auto& percentile : percentiles) {
+            const auto wanted = uint64_t(
+                    std::ceil(double(total) * percentile.second / 100.0));
+            while (cumulative + counts[index] < wanted) {
+                cumulative += counts[index];
+                ++index;
+            }
+            // The overflow bucket has no upper bound; report its lower bound
+            const auto value = index == NumBuckets - 1 ? getBucketLow(index)
+                                                       : getBucketHigh(index);
+            cJSON_AddNumberToObject(obj, percentile.first, value);
+        }
     }
-    cJSON_AddItemToObject(root, "ms", array);
-
-    array = cJSON_CreateArray();
-    for (auto &hs : halfsec) {
-        cJSON *obj = cJSON_CreateNumber(hs);
-        cJSON_AddItemToArray(array, obj);
+    cJSON_AddItemToObject(root, "percentiles", obj);
+
+    cJSON* array = cJSON_CreateArray();
+    for (size_t ii = 0; ii < NumBuckets; ++ii) {
+        if (counts[ii] != 0) {
+            cJSON* bucket = cJSON_CreateArray();
+            cJSON_AddItemToArray(bucket, cJSON_CreateNumber(getBucketLow(ii)));
+            cJSON_AddItemToArray(bucket,
+                                 cJSON_CreateNumber(getBucketHigh(ii)));
+            cJSON_AddItemToArray(bucket, cJSON_CreateNumber(counts[ii]));
+            cJSON_AddItemToArray(array, bucket);
+        }
     }
-    cJSON_AddItemToObject(root, "500ms", array);
+    cJSON_AddItemToObject(root, "buckets", array);
 
-    cJSON_AddNumberToObject(root, "5s-9s", get_wayout(0));
-    cJSON_AddNumberToObject(root, "10s-19s", get_wayout(1));
-    cJSON_AddNumberToObject(root, "20s-39s", get_wayout(2));
-    cJSON_AddNumberToObject(root, "40s-79s", get_wayout(3));
-    cJSON_AddNumberToObject(root, "80s-inf", get_wayout(4));
-
-    // for backwards compatibility, add the old wayouts
-    cJSON_AddNumberToObject(root, "wayout", aggregate_wayout());
     char *ptr = cJSON_PrintUnformatted(root);
     std::string ret(ptr);
     cJSON_Free(ptr);
@@ -188,36 +234,13 @@ std::string TimingHistogram::to_string(void) {
     return ret;
 }
 
-/* get functions of Timings class */
-
-uint32_t TimingHistogram::get_ns() {
-    return ns;
-}
-
-uint32_t TimingHistogram::get_usec(const uint8_t index) {
-    return usec[index];
-}
-
-uint32_t TimingHistogram::get_msec(const uint8_t index) {
-    return msec[index];
-}
-
-uint32_t TimingHistogram::get_halfsec(const uint8_t index) {
-    return halfsec[index];
-}
-
-uint32_t TimingHistogram::get_wayout(const uint8_t index) {
-    return wayout[index];
-}
-
-uint32_t TimingHistogram::aggregate_wayout() {
-    uint32_t ret = 0;
-    for (auto &wo : wayout) {
-        ret += wo;
+uint64_t TimingHistogram::get_total() {
+    uint64_t ret = 0;
+    for (const auto& slot : shards) {
+        const auto* shard = slot.load(std::memory_order_acquire);
+        if (shard != nullptr) {
+            ret += shard->total;
+        }
     }
     return ret;
 }
-
-uint32_t TimingHistogram::get_total() {
-    return total;
-}
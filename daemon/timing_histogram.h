@@ -19,56 +19,91 @@
 #include <platform/platform.h>
 #include <relaxed_atomic.h>
 #include <array>
+#include <atomic>
 #include <chrono>
 #include <string>
 
 /** Records timings of some event, accumulating them in a histogram.
  *
- * Histogram has buckets of approximately exponentially increasing sizes:
+ * The histogram is log-linear (like HdrHistogram) with microsecond
+ * resolution:
  *
- *     - Less than or equal to 1 microsecond (µs)
- *     - [10-19], [20-29], ..., [900-999] µs
- *     - 1, 2, ..., 49 ms
- *     - 500, 1000, 1500, ... 4500 ms
- *     - [5-9], [10-19], [20-39], [40-79], [80-inf] seconds.
+ *     - 0, 1, 2, ..., 31 µs
+ *     - then each power of two range ([32-63], [64-127], ... µs) is
+ *       split into 16 equally sized buckets; so the width of a bucket is
+ *       at most 1/16 of its lower bound
+ *     - everything from 2^27 µs (~134 s) up in a single overflow bucket.
  *
+ * To avoid the threads recording timings contending on the same cache
+ * lines, the counts are spread over a number of shards (each thread
+ * records into the shard for its thread slot), which are merged when the
+ * histogram is read. The shards are allocated the first time they are
+ * used, as most histograms (e.g. of the opcodes never used in a bucket)
+ * are never recorded into.
  */
 class TimingHistogram {
 public:
+    /// Number of buckets below the first log-linear range
+    static const size_t LinearBuckets = 32;
+    /// Number of buckets each power of two range is split into
+    static const size_t SubBuckets = 16;
+    /// Values of 2^MaxBits µs and above go in the overflow bucket
+    static const size_t MaxBits = 27;
+    static const size_t NumBuckets =
+            LinearBuckets + (MaxBits - 5) * SubBuckets + 1;
+
     TimingHistogram(void);
     TimingHistogram(const TimingHistogram &other);
     TimingHistogram& operator=(const TimingHistogram &other);
     TimingHistogram& operator+=(const TimingHistogram& other);
+    ~TimingHistogram();
 
     void reset(void);
     void add(const std::chrono::nanoseconds nsec);
+
+    /**
+     * Get the histogram as a JSON string:
+     *
+     *     {
+     *       "total": 1234,
+     *       "percentiles": {"50": 12, "90": 40, "99": 120, "99.9": 700,
+     *                       "99.99": 1500, "100": 1790},
+     *       "buckets": [[0, 1, 7], [12, 12, 900], ..., [1728, 1791, 1]]
+     *     }
+     *
+     * Where each (non-empty) bucket is [lowest µs, highest µs, count]
+     * (highest is 0 for the overflow bucket), and the percentiles are the
+     * upper bound of the bucket containing the given percentile (in µs).
+     */
     std::string to_string(void);
-    uint32_t get_ns();
-    uint32_t get_usec(const uint8_t index);
-    uint32_t get_msec(const uint8_t index);
-    uint32_t get_halfsec(const uint8_t index);
-    uint32_t get_wayout(const uint8_t index);
-    uint32_t get_total();
 
-    uint32_t aggregate_wayout();
+    uint64_t get_total();
+
+    /// The bucket a value (in µs) is recorded in
+    static size_t getBucketIndex(uint64_t usec);
+
+    /// The lowest value (in µs) recorded in the given bucket
+    static uint64_t getBucketLow(size_t index);
+
+    /// The highest value (in µs) recorded in the given bucket (or 0 for the
+    /// overflow bucket)
+    static uint64_t getBucketHigh(size_t index);
+
+    /// Get the count of each bucket (merged over all of the shards)
+    std::array<uint64_t, NumBuckets> getCounts();
 
 private:
-    // This helper is used for operator overloads. It is supplied a
-    // class such as std::plus, std::minus; with the first argument (of
-    // the class's function) being the current value and the second being
-    // the new value.
-    template <template <typename ...Args> class F>
-    static void arith_op(TimingHistogram& dst, const TimingHistogram& src);
+    // Number of shards the counts are spread over. Threads beyond this
+    // number share shards with others (so the counts remain atomic).
+    static const size_t NumShards = 16;
+
+    struct Shard {
+        std::array<Couchbase::RelaxedAtomic<uint32_t>, NumBuckets> buckets;
+        Couchbase::RelaxedAtomic<uint64_t> total;
+    };
+
+    // Get the calling thread's shard (allocating it if needed)
+    Shard& getShard();
 
-    /* We collect timings for <=1 us */
-    Couchbase::RelaxedAtomic<uint32_t> ns;
-    /* We collect timings per 10usec */
-    std::array<Couchbase::RelaxedAtomic<uint32_t>, 100> usec;
-    /* we collect timings from 0-49 ms (entry 0 is never used!) */
-    std::array<Couchbase::RelaxedAtomic<uint32_t>, 50> msec;
-    std::array<Couchbase::RelaxedAtomic<uint32_t>, 10> halfsec;
-    // wayout use the following buckets:
-    // [5-9], [10-19], [20-39], [40-79], [80-inf].
-    std::array<Couchbase::RelaxedAtomic<uint32_t>, 5> wayout;
-    Couchbase::RelaxedAtomic<uint64_t> total;
+    std::array<std::atomic<Shard*>, NumShards> shards;
 };
@@ -19,12 +19,53 @@
 #include <platform/platform.h>
 #include "timing_histogram.h"
 
+#include <stdexcept>
+
+const std::array<cb::tracing::TraceCode, Timings::NumPhases> Timings::phases =
+        {{cb::tracing::TraceCode::VALIDATE,
+          cb::tracing::TraceCode::EXECUTE,
+          cb::tracing::TraceCode::WOULDBLOCK,
+          cb::tracing::TraceCode::NOTIFY,
+          cb::tracing::TraceCode::TRANSMIT}};
+
+static size_t getPhaseIndex(cb::tracing::TraceCode phase) {
+    for (size_t ii = 0; ii < Timings::phases.size(); ++ii) {
+        if (Timings::phases[ii] == phase) {
+            return ii;
+        }
+    }
+    throw std::invalid_argument("getPhaseIndex: Unknown phase " +
+                                to_string(phase));
+}
+
 Timings::Timings() {
+    for (auto& slot : phaseTimings) {
+        slot.store(nullptr);
+    }
     reset();
 }
 
+Timings::~Timings() {
+    for (auto& slot : phaseTimings) {
+        delete slot.load();
+    }
+}
+
 Timings& Timings::operator=(const Timings& other) {
     timings = other.timings;
+    for (int ii = 0; ii < MAX_NUM_OPCODES; ++ii) {
+        const auto* src = other.phaseTimings[ii].load();
+        if (src != nullptr) {
+            getPhaseTimings(uint8_t(ii)) = *src;
+        } else {
+            auto* dst = phaseTimings[ii].load();
+            if (dst != nullptr) {
+                for (auto& histogram : *dst) {
+                    histogram.reset();
+                }
+            }
+        }
+    }
     interval_latency_lookups = other.interval_latency_lookups;
     interval_latency_mutations = other.interval_latency_mutations;
     return *this;
@@ -33,6 +74,12 @@ Timings& Timings::operator=(const Timings& other) {
 void Timings::reset(void) {
     for (int ii = 0; ii < MAX_NUM_OPCODES; ++ii) {
         timings[ii].reset();
+        auto* phase = phaseTimings[ii].load();
+        if (phase != nullptr) {
+            for (auto& histogram : *phase) {
+                histogram.reset();
+            }
+        }
     }
 
     {
@@ -50,10 +97,44 @@ void Timings::collect(const uint8_t opcode,
     interval.duration_ns += nsec.count();
 }
 
+void Timings::collect(const uint8_t opcode,
+                      cb::tracing::TraceCode phase,
+                      const std::chrono::nanoseconds nsec) {
+    getPhaseTimings(opcode)[getPhaseIndex(phase)].add(nsec);
+}
+
+Timings::PhaseTimings& Timings::getPhaseTimings(const uint8_t opcode) {
+    auto* ret = phaseTimings[opcode].load(std::memory_order_acquire);
+    if (ret == nullptr) {
+        auto* created = new PhaseTimings();
+        if (phaseTimings[opcode].compare_exchange_strong(
+                    ret, created, std::memory_order_acq_rel)) {
+            ret = created;
+        } else {
+            // Someone else beat us to it
+            delete created;
+        }
+    }
+    return *ret;
+}
+
 std::string Timings::generate(const uint8_t opcode) {
     return timings[opcode].to_string();
 }
 
+std::string Timings::generate(const uint8_t opcode,
+                              cb::tracing::TraceCode phase) {
+    auto* phaseTiming = phaseTimings[opcode].load(std::memory_order_acquire);
+    if (phaseTiming == nullptr) {
+        return {};
+    }
+    auto& histogram = (*phaseTiming)[getPhaseIndex(phase)];
+    if (histogram.get_total() == 0) {
+        return {};
+    }
+    return histogram.to_string();
+}
+
 static const uint8_t timings_mutations[] = {
     PROTOCOL_BINARY_CMD_ADD,
     PROTOCOL_BINARY_CMD_ADDQ,
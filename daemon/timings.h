@@ -18,12 +18,14 @@
 
 #include <platform/platform.h>
 #include <array>
+#include <atomic>
 #include <string>
 #include <mutex>
 #include <cstdint>
 
 #include "timing_histogram.h"
 #include "timing_interval.h"
+#include "tracing/tracetypes.h"
 
 #define MAX_NUM_OPCODES 0x100
 
@@ -32,14 +34,37 @@
  */
 class Timings {
 public:
+    /// The phases of a command we keep a histogram of the time spent in
+    static const size_t NumPhases = 5;
+    static const std::array<cb::tracing::TraceCode, NumPhases> phases;
+
     Timings(void);
     Timings& operator=(const Timings& other);
     Timings(const Timings&) = delete;
+    ~Timings();
 
     void reset(void);
     void collect(const uint8_t opcode, const std::chrono::nanoseconds nsec);
+
+    /**
+     * Record the time spent in one of the phases of a command
+     *
+     * @param opcode the command
+     * @param phase one of the codes in Timings::phases
+     * @param nsec the time spent in the phase
+     */
+    void collect(const uint8_t opcode,
+                 cb::tracing::TraceCode phase,
+                 const std::chrono::nanoseconds nsec);
     void sample(std::chrono::seconds sample_interval);
     std::string generate(const uint8_t opcode);
+
+    /**
+     * Get the histogram of the time spent in the given phase of a command
+     * (as generated by TimingHistogram::to_string), or an empty string
+     * if the phase was never recorded for the command.
+     */
+    std::string generate(const uint8_t opcode, cb::tracing::TraceCode phase);
     uint64_t get_aggregated_mutation_stats();
     uint64_t get_aggregated_retrival_stats();
 
@@ -56,4 +81,13 @@ private:
     cb::sampling::IntervalSeries interval_latency_mutations;
     std::array<TimingHistogram, MAX_NUM_OPCODES> timings;
     std::array<cb::sampling::Interval, MAX_NUM_OPCODES> interval_counters;
+
+    using PhaseTimings = std::array<TimingHistogram, NumPhases>;
+
+    // Get the phase histograms for the opcode (allocating them if needed)
+    PhaseTimings& getPhaseTimings(const uint8_t opcode);
+
+    // The phase histograms are allocated the first time an opcode is used,
+    // as most opcodes are never used in a bucket
+    std::array<std::atomic<PhaseTimings*>, MAX_NUM_OPCODES> phaseTimings;
 };
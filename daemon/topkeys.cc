@@ -18,12 +18,15 @@
 #include "config.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <sys/types.h>
 #include <stdexcept>
 #include <stdlib.h>
 #include <inttypes.h>
 #include <platform/platform.h>
+#include <utilities/thread_slot.h>
+#include <unordered_map>
 
 #include "topkeys.h"
 
@@ -32,138 +35,153 @@
  *
  * === TopKeys ===
  *
- * The TopKeys class is split into NUM_SHARDS shards, each which owns
- * 1/NUM_SHARDS of the keyspace. This is to allow some level of
- * concurrent access - each shard has a mutex guarding all access.
- * Other than that the TopKeys class is pretty uninteresting - it
- * simply passes on requests to the correct Shard, and when statistics
- * are requested it aggregates information from each shard.
+ * Every GET / SET etc. updates the topkeys, so to avoid the worker
+ * threads contending with each other the TopKeys class has one Sketch
+ * per worker thread; each thread only updates its own Sketch. Other than
+ * that the TopKeys class is pretty uninteresting - it simply passes on
+ * requests to the calling thread's Sketch, and when statistics are
+ * requested it merges the counts of each key from all of the Sketches
+ * and reports the most accessed keys.
  *
- * === TopKeys::Shard ===
+ * === TopKeys::Sketch ===
  *
- * This is where the action happens. Each Shard maintains an ordered
- * list of key names and related statistics, orded by when they were
- * last accessed. There is a fixed number of keys each Shard tracks.
-
- * Given we generally track only a small number of keys per shard (10
- * by default), it's highly likely that any one key access will 'miss'
- * - i.e. not find an existing topkey. Therefore this class is
- * optimized for that case, attempting to minimise memory allocation
- * in steady-state.
+ * This is where the action happens. Each Sketch implements the
+ * Space-Saving algorithm (Metwally et al, "Efficient Computation of
+ * Frequent and Top-k Elements in Data Streams"); it tracks a fixed
+ * number of keys with an access count for each. When a key which isn't
+ * tracked is accessed and the Sketch is full, the least accessed key is
+ * replaced by the new key which takes over its count (plus one). This
+ * over-estimates the count of a newly tracked key, but guarantees any
+ * key accessed more often than 1/max_keys of all accesses is tracked.
  *
- * Internally Shard consists of a vector of topkey_t, storing the
- * current max_keys top_keys, and a list of topkey_t pointers, used to
- * main the current most -> least recently used ordering:
-
- * max_keys elements. Each element is a tuple of
- * {hash(key), key, topkey_stats}:
- *
- *
- *       vector<topkey_t>
- *   +----------+-------------+---------------+
- *   | size_t   | std::string | topkey_item_t |
- *   +----------+-------------+---------------+
- *   | <hash 1> | <key 1>     | stats 1       | <--- Node1
- *   | <hash 2> | <key 2>     | stats 2       | <--- Node2
- *   | <hash 3> | <key 3>     | stats 3       | <--- Node3
- *   . ....                                   .
- *   | <hash N> | <key N>     | stats N       | <--- NodeN
- *   +----------------------------------------+
- *
- *   Node3 <---> Node1 <---> ... <---> Node2
- *   ^^^                               ^^^
- *   MRU                               LRU
+ * The counters are stored in a min-heap ordered by access count (so the
+ * key to replace is always at the front), with the hashes of the keys
+ * in a separate vector in the same order:
  *
+ *       vector<Counter> heap           vector<size_t> hashes
+ *   +-------------+---------------+    +----------+
+ *   | std::string | topkey_item_t |    | size_t   |
+ *   +-------------+---------------+    +----------+
+ *   | <key 1>     | stats 1       |    | <hash 1> |  <--- least accessed
+ *   | <key 2>     | stats 2       |    | <hash 2> |
+ *   . ....                        .    . ....     .
+ *   | <key N>     | stats N       |    | <hash N> |
+ *   +-----------------------------+    +----------+
  *
  * Upon a key 'hit', TopKeys::updateKey() is called. That hashes the
- * key, and finds the Shard responsible for that
- * key. TopKeys::Shard::updateKey() is then called.
+ * key, and calls Sketch::updateKey() on the calling thread's Sketch.
  *
- * Shard::updateKey() iterates over the vector, searching for a hash
- * match with an existing element, using the actual key string to
- * validate (in case of a hash collision). If it is found, then the
- * stats are simply updated.  If it is not found, then the
- * least-recently-used element is selected as a 'victim' and it's
- * contents is replaced by the incoming key.  Finally the linked-list
- * is updated to move the updated element to the head of the list.
+ * Sketch::updateKey() scans the hashes for a match with an existing
+ * element, using the actual key string to validate (in case of a hash
+ * collision). If it is found, its count is incremented and it is moved
+ * down the heap. If it is not found, then the front element is selected
+ * as a 'victim' and its contents is replaced by the incoming key (or a
+ * new element is added if the Sketch isn't full yet).
  */
 
-
-TopKeys::TopKeys(int mkeys) {
-    for (auto& shard : shards) {
-        shard.setMaxKeys(mkeys);
+TopKeys::TopKeys(int mkeys)
+    : max_keys(size_t(mkeys) * KEYS_PER_MKEY) {
+    const auto threads = std::max(settings.getNumWorkerThreads(), 1);
+    for (int ii = 0; ii < threads; ++ii) {
+        sketches.emplace_back(new Sketch(max_keys));
     }
 }
 
 TopKeys::~TopKeys() {
 }
 
-TopKeys::Shard& TopKeys::getShard(size_t key_hash) {
-    /* This is special-cased for 8 */
-    static_assert(NUM_SHARDS == 8,
-                  "Topkeys::getShard() special-cased for SHARDS==8");
-    return shards[key_hash & 0x7];
+TopKeys::Sketch& TopKeys::getSketch() {
+    // One Sketch per worker thread (see cb::getThreadSlot())
+    return *sketches[cb::getThreadSlot() % sketches.size()];
 }
 
-TopKeys::Shard::topkey_t*
-TopKeys::Shard::searchForKey(size_t key_hash,
-                             const cb::const_char_buffer& key) {
+TopKeys::Sketch::Sketch(size_t mkeys) : max_keys(mkeys) {
+    heap.reserve(max_keys);
+    hashes.reserve(max_keys);
+}
 
-    for (auto& topkey : storage) {
-        if (topkey.first.hash == key_hash) {
+size_t TopKeys::Sketch::searchForKey(size_t key_hash,
+                                     const cb::const_char_buffer& key) {
+    for (size_t ii = 0; ii < hashes.size(); ++ii) {
+        if (hashes[ii] == key_hash) {
             // Double-check with full compare
-            if (topkey.first.key.compare(0, topkey.first.key.size(),
-                                         key.buf, key.len) == 0) {
+            const auto& topkey = heap[ii].key;
+            if (topkey.compare(0, topkey.size(), key.buf, key.len) == 0) {
                 // Match found.
-                return &topkey;
+                return ii;
             }
         }
     }
-    return nullptr;
+    return heap.size();
+}
+
+void TopKeys::Sketch::swap(size_t a, size_t b) {
+    std::swap(heap[a], heap[b]);
+    std::swap(hashes[a], hashes[b]);
+}
+
+void TopKeys::Sketch::siftDown(size_t pos) {
+    for (;;) {
+        auto smallest = pos;
+        for (auto child = 2 * pos + 1; child <= 2 * pos + 2; ++child) {
+            if (child < heap.size() &&
+                heap[child].item.ti_access_count <
+                        heap[smallest].item.ti_access_count) {
+                smallest = child;
+            }
+        }
+        if (smallest == pos) {
+            return;
+        }
+        swap(pos, smallest);
+        pos = smallest;
+    }
+}
+
+void TopKeys::Sketch::siftUp(size_t pos) {
+    while (pos > 0) {
+        const auto parent = (pos - 1) / 2;
+        if (heap[parent].item.ti_access_count <=
+            heap[pos].item.ti_access_count) {
+            return;
+        }
+        swap(pos, parent);
+        pos = parent;
+    }
 }
 
-bool TopKeys::Shard::updateKey(const cb::const_char_buffer& key,
-                               size_t key_hash,
-                               const rel_time_t ct) {
+bool TopKeys::Sketch::updateKey(const cb::const_char_buffer& key,
+                                size_t key_hash,
+                                const rel_time_t ct) {
     try {
         std::lock_guard<std::mutex> lock(mutex);
 
-        topkey_t* found_key = searchForKey(key_hash, key);
+        auto pos = searchForKey(key_hash, key);
 
-        if (found_key == NULL) {
+        if (pos == heap.size()) {
             // Key not found.
-            if (storage.size() == max_keys) {
-                // Re-use the lowest keys' storage.
-                found_key = list.back();
-                found_key->first.hash = key_hash;
-                found_key->first.key.assign(key.buf, key.len);
-                found_key->second = topkey_item_t(ct);
-
-                // Move back element to the front, shuffling down the
-                // rest.
-                list.splice(list.begin(), list, --list.end());
-
+            if (heap.size() == max_keys) {
+                // Re-use the least accessed key's counter; the new key
+                // inherits its access count.
+                pos = 0;
+                auto& victim = heap.front();
+                victim.key.assign(key.buf, key.len);
+                victim.item.ti_ctime = ct;
+                hashes.front() = key_hash;
             } else {
-                // add a new element to the storage array.
-
-                storage.emplace_back(
-                    std::make_pair(KeyId{key_hash,
-                                         std::string(key.buf, key.len)},
-                                   topkey_item_t(ct)));
-                found_key = &storage.back();
-
-                // Insert the new item to the front of the list
-                list.push_front(found_key);
+                // add a new element to the heap. Its access count is
+                // still zero, so it moves all the way up to the front.
+                heap.push_back(Counter{std::string(key.buf, key.len),
+                                       topkey_item_t(ct)});
+                hashes.push_back(key_hash);
+                siftUp(pos);
+                pos = 0;
             }
-        } else {
-            // Found - shuffle to the front.
-            auto it = std::find(list.begin(), list.end(),
-                                found_key);
-            list.splice(list.begin(), list, it);
         }
 
         // Increment access count.
-        found_key->second.ti_access_count++;
+        heap[pos].item.ti_access_count++;
+        siftDown(pos);
         return true;
 
     } catch (const std::bad_alloc&) {
@@ -184,7 +202,7 @@ void TopKeys::doUpdateKey(const void* key,
         std::hash<cb::const_char_buffer > hash_fn;
         const size_t key_hash = hash_fn(key_buf);
 
-        getShard(key_hash).updateKey(key_buf, key_hash, operation_time);
+        getSketch().updateKey(key_buf, key_hash, operation_time);
     } catch (const std::bad_alloc&) {
         // Failed to increment topkeys, continue...
     }
@@ -256,9 +274,7 @@ ENGINE_ERROR_CODE TopKeys::doStats(const void* cookie,
                                    ADD_STAT add_stat) {
     struct tk_context context(cookie, add_stat, current_time, nullptr);
 
-    for (auto& shard : shards) {
-        shard.accept_visitor(tk_iterfunc, &context);
-    }
+    accept_visitor(tk_iterfunc, &context);
 
     return ENGINE_SUCCESS;
 }
@@ -279,18 +295,57 @@ ENGINE_ERROR_CODE TopKeys::do_json_stats(cJSON* object,
     struct tk_context context(nullptr, nullptr, current_time, topkeys);
 
     /* Collate the topkeys JSON object */
-    for (auto& shard : shards) {
-        shard.accept_visitor(tk_jsonfunc, &context);
-    }
+    accept_visitor(tk_jsonfunc, &context);
 
     cJSON_AddItemToObject(object, "topkeys", topkeys);
     return ENGINE_SUCCESS;
 }
 
-void TopKeys::Shard::accept_visitor(iterfunc_t visitor_func,
-                                    void* visitor_ctx) {
+static void tk_mergefunc(const std::string& key,
+                         const topkey_item_t& it,
+                         void* arg) {
+    auto& merged =
+            *static_cast<std::unordered_map<std::string, topkey_item_t>*>(arg);
+    auto result = merged.emplace(key, it);
+    if (!result.second) {
+        auto& item = result.first->second;
+        item.ti_access_count += it.ti_access_count;
+        item.ti_ctime = std::min(item.ti_ctime, it.ti_ctime);
+    }
+}
+
+void TopKeys::accept_visitor(iterfunc_t visitor_func, void* visitor_ctx) {
+    // Sum up the counts of each key over all of the sketches
+    std::unordered_map<std::string, topkey_item_t> merged;
+    for (auto& sketch : sketches) {
+        sketch->accept_visitor(tk_mergefunc, &merged);
+    }
+
+    std::vector<std::pair<const std::string, topkey_item_t>*> keys;
+    keys.reserve(merged.size());
+    for (auto& entry : merged) {
+        keys.push_back(&entry);
+    }
+
+    const auto count = std::min(keys.size(), max_keys);
+    std::partial_sort(keys.begin(),
+                      keys.begin() + count,
+                      keys.end(),
+                      [](const std::pair<const std::string, topkey_item_t>* a,
+                         const std::pair<const std::string, topkey_item_t>* b) {
+                          return a->second.ti_access_count >
+                                 b->second.ti_access_count;
+                      });
+
+    for (size_t ii = 0; ii < count; ++ii) {
+        visitor_func(keys[ii]->first, keys[ii]->second, visitor_ctx);
+    }
+}
+
+void TopKeys::Sketch::accept_visitor(iterfunc_t visitor_func,
+                                     void* visitor_ctx) {
     std::lock_guard<std::mutex> lock(mutex);
-    for (const auto key : list) {
-        visitor_func(key->first.key, key->second, visitor_ctx);
+    for (const auto& counter : heap) {
+        visitor_func(counter.key, counter.item, visitor_ctx);
     }
 }
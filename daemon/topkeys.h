@@ -18,20 +18,20 @@
 
 #include "settings.h"
 
-#include <array>
 #include <platform/sized_buffer.h>
 #include <memcached/engine.h>
 #include <cJSON.h>
 
+#include <cstdint>
+#include <memory>
 #include <mutex>
-#include <list>
 #include <string>
 #include <vector>
 
 /*
  * TopKeys
  *
- * Tracks the top N most recently accessed keys. The details are
+ * Tracks the N most frequently accessed keys. The details are
  * accessible by a stats call, which is used by ns_server to print the
  * top keys list in the GUI.
  */
@@ -50,8 +50,8 @@ struct topkey_item_t {
 class TopKeys {
 public:
     /* Constructor.
-     * @param mkeys Number of keys stored in each shard (i.e. up to
-     * mkeys * SHARDS will be tracked).
+     * @param mkeys Controls the number of keys tracked; up to
+     * mkeys * KEYS_PER_MKEY keys are tracked (and reported).
      */
     explicit TopKeys(int mkeys);
     ~TopKeys();
@@ -104,79 +104,81 @@ protected:
     ENGINE_ERROR_CODE do_json_stats(cJSON* object, rel_time_t current_time);
 
 private:
-    // Number of shards the keyspace is broken into. Permits some level of
-    // concurrent update (there is one mutex per shard).
-    static const int NUM_SHARDS = 8;
+    // Number of keys tracked (per Sketch) for each of the mkeys requested.
+    static const int KEYS_PER_MKEY = 8;
 
-    class Shard;
+    class Sketch;
 
-    Shard& getShard(size_t key_hash);
+    // Returns the Sketch owned by the calling thread.
+    Sketch& getSketch();
 
-    // One of N Shards which the keyspace has been broken
-    // into.
-    // Responsible for tracking the top {mkeys} within it's keyspace.
-    class Shard {
-    public:
+    typedef void (*iterfunc_t)(const std::string& key,
+                               const topkey_item_t& it,
+                               void* arg);
 
-        void setMaxKeys(int mkeys) {
-            max_keys = mkeys;
-            storage.reserve(max_keys);
-            // reallocating storage invalidates the LRU list.
-            list.clear();
-        }
+    /* Merge the Sketches and invoke the given callback function for each
+     * of the top keys, from the most to the least frequently accessed.
+     */
+    void accept_visitor(iterfunc_t visitor_func, void* visitor_ctx);
+
+    // Space-Saving heavy hitter sketch of the keys accessed by one worker
+    // thread. Tracks the access count of the (up to) max_keys most
+    // frequently accessed keys.
+    class Sketch {
+    public:
+        explicit Sketch(size_t mkeys);
 
-        // Updates the topkey 'ranking' for the specified key.
-        // If the item does not exist it will be created (with it's creation
-        // time set to operation_time), otherwise the existing item will be
-        // updated.
+        // Counts an access of the specified key. If the key isn't tracked
+        // and the sketch is full, it replaces the least accessed key (and
+        // inherits its count as an upper bound of its own count).
         // On success returns true, If insufficient memory to create a
         // new item, returns false.
         bool updateKey(const cb::const_char_buffer& key,
                        size_t key_hash,
                        rel_time_t operation_time);
 
-        typedef void (*iterfunc_t)(const std::string& key,
-                                   const topkey_item_t& it,
-                                   void *arg);
-
-        /* For each key in this shard, invoke the given callback function.
+        /* For each key in this sketch, invoke the given callback function.
          */
         void accept_visitor(iterfunc_t visitor_func, void* visitor_ctx);
 
     private:
-
-        struct KeyId {
-            size_t hash;
+        struct Counter {
             std::string key;
+            topkey_item_t item;
         };
 
-        // Pair of the key's string and the statistics related to it.
-        typedef std::pair<KeyId, topkey_item_t> topkey_t;
+        // Returns the position of the given key in the heap, or heap.size()
+        // if it isn't tracked.
+        size_t searchForKey(size_t hash, const cb::const_char_buffer& key);
 
-        // An ordered list of topkey_t*, used for LRU.
-        typedef std::list<topkey_t*> key_history_t;
+        // Restore the heap order after the counter at pos was incremented.
+        void siftDown(size_t pos);
 
-        // Vector topket_t, used for actual topke storage.
-        typedef std::vector<topkey_t> key_storage_t;
+        // Restore the heap order after a counter was added at pos.
+        void siftUp(size_t pos);
 
-        // Searches for the given key. If found returns a pointer to the
-        // topkey_t, else returns NULL.
-        topkey_t* searchForKey(size_t hash, const cb::const_char_buffer& key);
+        void swap(size_t a, size_t b);
 
-        // Maxumum numbers of keys to be tracked per shard.
-        unsigned int max_keys;
+        // Maximum number of keys to be tracked by this sketch.
+        size_t max_keys;
 
-        // mutex to serial access to this shard.
+        // Serialises the owning worker thread with stats requests (and any
+        // other thread which happens to share the sketch); in practice this
+        // is uncontended.
         std::mutex mutex;
 
-        // list of keys, ordered from most-recently used (front) to least recently
-        // used (back).
-        key_history_t list;
+        // Min-heap of the tracked keys ordered by access count, so the
+        // least accessed key (the one to replace) is at the front.
+        std::vector<Counter> heap;
 
-        // Underlying topkey storage.
-        key_storage_t storage;
+        // The hash of the key at each position of the heap; kept separately
+        // so the search for a key scans contiguous memory.
+        std::vector<size_t> hashes;
     };
 
-    // array of topkey shards.
-    std::array<Shard, NUM_SHARDS> shards;
+    // One Sketch per worker thread.
+    std::vector<std::unique_ptr<Sketch>> sketches;
+
+    // Number of keys reported by the stats.
+    const size_t max_keys;
 };
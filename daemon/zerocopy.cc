@@ -0,0 +1,202 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2018 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#include "config.h"
+#include "zerocopy.h"
+#include "memcached.h"
+
+#include <cinttypes>
+#include <cstring>
+#include <new>
+
+#ifdef __linux__
+#include <netinet/in.h>
+#endif
+
+const std::chrono::milliseconds ZerocopyReaper::limit{1000};
+const std::chrono::milliseconds ZerocopyReaper::interval{10};
+
+ZerocopySends::ZerocopySends(ZerocopySends&& other)
+    : sends(other.sends),
+      completed(other.completed),
+      entries(std::move(other.entries)) {
+    other.entries.clear();
+    other.completed = other.sends;
+}
+
+ZerocopySends::~ZerocopySends() {
+    releaseAll();
+}
+
+void ZerocopySends::keep(ENGINE_HANDLE_V1* engine,
+                         std::vector<void*>& items) {
+    entries.push_back({sends, engine, std::move(items), -1});
+    items.clear();
+}
+
+void ZerocopySends::reap(SOCKET sfd) {
+#ifdef HAVE_MSG_ZEROCOPY
+    while (completed != sends) {
+        char control[128];
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        if (::recvmsg(sfd, &msg, MSG_ERRQUEUE) == -1) {
+            // Nothing (more) in the error queue
+            break;
+        }
+
+        for (auto* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr;
+             cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (!((cmsg->cmsg_level == SOL_IP &&
+                   cmsg->cmsg_type == IP_RECVERR) ||
+                  (cmsg->cmsg_level == SOL_IPV6 &&
+                   cmsg->cmsg_type == IPV6_RECVERR))) {
+                continue;
+            }
+            const auto* serr = reinterpret_cast<const struct sock_extended_err*>(
+                    CMSG_DATA(cmsg));
+            if (serr->ee_errno == 0 &&
+                serr->ee_origin == SO_EE_ORIGIN_ZEROCOPY) {
+                // Sends [ee_info, ee_data] are complete. TCP completes
+                // them in order, so everything up to ee_data is done.
+                completed = serr->ee_data + 1;
+            }
+        }
+    }
+#else
+    (void)sfd;
+#endif
+
+    while (!entries.empty() &&
+           int32_t(completed - entries.front().sends) >= 0) {
+        release(entries.front());
+        entries.pop_front();
+    }
+}
+
+void ZerocopySends::holdBucket(size_t bucketIndex) {
+    // The entries are released in order, so the last one holding the
+    // reference covers all of the others from the bucket. Should it already
+    // hold one, no items have been kept since we last left a bucket.
+    if (entries.empty() || entries.back().bucketIndex != -1) {
+        return;
+    }
+    bucket_add_reference(bucketIndex);
+    entries.back().bucketIndex = int(bucketIndex);
+}
+
+void ZerocopySends::releaseAll() {
+    for (auto& entry : entries) {
+        release(entry);
+    }
+    entries.clear();
+    completed = sends;
+}
+
+void ZerocopySends::release(Entry& entry) {
+    ENGINE_HANDLE* handle = reinterpret_cast<ENGINE_HANDLE*>(entry.engine);
+    for (auto* it : entry.items) {
+        entry.engine->release(handle, it);
+    }
+    entry.items.clear();
+    if (entry.bucketIndex != -1) {
+        bucket_release_reference(size_t(entry.bucketIndex));
+        entry.bucketIndex = -1;
+    }
+}
+
+ZerocopyReaper::ZerocopyReaper(struct event_base* base) {
+    if (base != nullptr) {
+        timer = evtimer_new(base, timerCallback, this);
+        if (timer == nullptr) {
+            throw std::bad_alloc();
+        }
+    }
+}
+
+ZerocopyReaper::~ZerocopyReaper() {
+    for (auto& entry : pending) {
+        resetSocket(entry.sfd);
+        entry.sends.releaseAll();
+    }
+    if (timer != nullptr) {
+        event_free(timer);
+    }
+}
+
+void ZerocopyReaper::add(SOCKET sfd, ZerocopySends&& sends) {
+    pending.push_back(
+            {sfd, std::move(sends), std::chrono::steady_clock::now() + limit});
+    schedule();
+}
+
+void ZerocopyReaper::poll() {
+    const auto now = std::chrono::steady_clock::now();
+    auto iter = pending.begin();
+    while (iter != pending.end()) {
+        iter->sends.reap(iter->sfd);
+        if (iter->sends.empty()) {
+            safe_close(iter->sfd);
+        } else if (now >= iter->deadline) {
+            LOG_WARNING(nullptr,
+                        "MSG_ZEROCOPY sends on socket %d still outstanding "
+                        "after %" PRId64 "ms; resetting the connection",
+                        int(iter->sfd),
+                        int64_t(limit.count()));
+            resetSocket(iter->sfd);
+            iter->sends.releaseAll();
+        } else {
+            ++iter;
+            continue;
+        }
+        iter = pending.erase(iter);
+    }
+    schedule();
+}
+
+void ZerocopyReaper::timerCallback(evutil_socket_t, short, void* arg) {
+    auto* reaper = reinterpret_cast<ZerocopyReaper*>(arg);
+    reaper->scheduled = false;
+    reaper->poll();
+}
+
+void ZerocopyReaper::schedule() {
+    if (timer == nullptr || scheduled || pending.empty()) {
+        return;
+    }
+    struct timeval tv;
+    tv.tv_sec = 0;
+    tv.tv_usec = long(
+            std::chrono::duration_cast<std::chrono::microseconds>(interval)
+                    .count());
+    if (evtimer_add(timer, &tv) == 0) {
+        scheduled = true;
+    }
+}
+
+void ZerocopyReaper::resetSocket(SOCKET sfd) {
+    struct linger linger;
+    linger.l_onoff = 1;
+    linger.l_linger = 0;
+    setsockopt(sfd,
+               SOL_SOCKET,
+               SO_LINGER,
+               reinterpret_cast<const char*>(&linger),
+               sizeof(linger));
+    safe_close(sfd);
+}
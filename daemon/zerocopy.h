@@ -0,0 +1,206 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2018 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#pragma once
+
+#include <event.h>
+#include <memcached/engine.h>
+#include <platform/platform.h>
+
+#include <chrono>
+#include <deque>
+#include <list>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <linux/errqueue.h>
+#if defined(MSG_ZEROCOPY) && defined(SO_ZEROCOPY) && \
+        defined(SO_EE_ORIGIN_ZEROCOPY)
+#define HAVE_MSG_ZEROCOPY 1
+#endif
+#endif
+
+/**
+ * The MSG_ZEROCOPY sends made on a socket, and the items referenced by
+ * them. The kernel may read an item's memory until it reports the send as
+ * complete (on the socket's error queue), so the items are kept until
+ * then.
+ */
+class ZerocopySends {
+public:
+    ZerocopySends() = default;
+    ZerocopySends(const ZerocopySends&) = delete;
+    ZerocopySends(ZerocopySends&& other);
+    ~ZerocopySends();
+
+    /// Record a sendmsg call made with MSG_ZEROCOPY
+    void sent() {
+        ++sends;
+    }
+
+    /// @return true if the kernel has reported all of the sends complete
+    bool allComplete() const {
+        return sends == completed;
+    }
+
+    /// @return true if there are no items kept for the sends
+    bool empty() const {
+        return entries.empty();
+    }
+
+    /**
+     * Keep the given items (which are moved out of the vector), referenced
+     * by the sends made so far, until those sends complete.
+     *
+     * @param engine the engine to release the items to
+     */
+    void keep(ENGINE_HANDLE_V1* engine, std::vector<void*>& items);
+
+    /**
+     * Read the completion notifications queued on the socket's error
+     * queue (without blocking), and release the items of the sends which
+     * are complete.
+     */
+    void reap(SOCKET sfd);
+
+    /**
+     * Make the items kept so far (which came from the given bucket) hold
+     * a reference to the bucket until they're released, so that it isn't
+     * deleted while the kernel may still read them. Used when the
+     * connection leaves the bucket (or is closed) before the sends are
+     * complete.
+     */
+    void holdBucket(size_t bucketIndex);
+
+    /// Release all of the items, whether or not their sends are complete
+    void releaseAll();
+
+    uint32_t getSends() const {
+        return sends;
+    }
+
+    uint32_t getCompleted() const {
+        return completed;
+    }
+
+    /// @return the number of groups of items kept
+    size_t size() const {
+        return entries.size();
+    }
+
+    /// @return the number of sends the first group of items is kept for
+    uint32_t frontSends() const {
+        return entries.front().sends;
+    }
+
+    /// @return the number of sends the last group of items is kept for
+    uint32_t backSends() const {
+        return entries.back().sends;
+    }
+
+private:
+    /**
+     * Items which are kept until the kernel reports the first "sends"
+     * MSG_ZEROCOPY sends as complete.
+     */
+    struct Entry {
+        uint32_t sends;
+        ENGINE_HANDLE_V1* engine;
+        std::vector<void*> items;
+        /// Index of the bucket the entry holds a reference to (if any)
+        int bucketIndex;
+    };
+
+    void release(Entry& entry);
+
+    /**
+     * Number of sendmsg calls made with MSG_ZEROCOPY (which is also the
+     * sequence number the kernel uses for the next one)
+     */
+    uint32_t sends = 0;
+
+    /// Number of sends the kernel has reported as complete
+    uint32_t completed = 0;
+
+    std::deque<Entry> entries;
+};
+
+/**
+ * Closes the sockets of a worker thread's closed connections which still
+ * have MSG_ZEROCOPY sends outstanding. Waiting for the sends to complete
+ * could block the thread, so the connection hands its socket (and items)
+ * over instead, and the reaper polls for the completions from the thread's
+ * event loop. Once they're all complete the socket is closed and the items
+ * released; should that take too long the socket is reset (which discards
+ * the data still queued to send) and the items released anyway.
+ */
+class ZerocopyReaper {
+public:
+    /**
+     * @param base the event base of the thread to poll from, or nullptr
+     *             to leave the polling to the caller (see poll)
+     */
+    explicit ZerocopyReaper(struct event_base* base);
+    ZerocopyReaper(const ZerocopyReaper&) = delete;
+    ~ZerocopyReaper();
+
+    /**
+     * Take over the socket of a closed connection, and the items kept for
+     * the MSG_ZEROCOPY sends made on it.
+     */
+    void add(SOCKET sfd, ZerocopySends&& sends);
+
+    /**
+     * Reap the completions of all of the sockets, and close those which
+     * are done (or have run out of time).
+     */
+    void poll();
+
+    /// @return the number of sockets waiting for sends to complete
+    size_t size() const {
+        return pending.size();
+    }
+
+    /// How long we'll wait for a socket's sends to complete
+    static const std::chrono::milliseconds limit;
+
+    /// How often the sockets are polled
+    static const std::chrono::milliseconds interval;
+
+    /**
+     * Close the socket with a reset rather than the normal shutdown, which
+     * discards the data still queued to send. Once it's closed no more is
+     * transmitted from the memory of the items referenced by its sends.
+     */
+    static void resetSocket(SOCKET sfd);
+
+protected:
+    struct Pending {
+        SOCKET sfd;
+        ZerocopySends sends;
+        std::chrono::steady_clock::time_point deadline;
+    };
+
+    static void timerCallback(evutil_socket_t, short, void* arg);
+
+    void schedule();
+
+    std::list<Pending> pending;
+
+    struct event* timer = nullptr;
+    bool scheduled = false;
+};
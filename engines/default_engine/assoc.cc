@@ -4,6 +4,8 @@
  *
  */
 #include "config.h"
+#include <array>
+#include <atomic>
 #include <fcntl.h>
 #include <errno.h>
 #include <mutex>
@@ -20,12 +22,29 @@
 #define hashsize(n) ((size_t)1<<(n))
 #define hashmask(n) (hashsize(n)-1)
 
+/*
+ * The hashtable is protected by a fixed number of lock stripes rather than
+ * a single mutex; bucket N is protected by stripe N % lock_stripes. The
+ * number of stripes is a power of two which never exceeds the size of the
+ * table, so a bucket in the old table and the buckets in the new table its
+ * items move to during expansion are always protected by the same stripe.
+ */
+static const size_t lock_stripes = 1024;
+
 struct Assoc {
     Assoc(unsigned int hp) : hashpower(hp) {
         primary_hashtable.resize(hashsize(hashpower));
     }
 
-    /* how many powers of 2's worth of buckets we use */
+    /* The mutex protecting the buckets for the given hash value */
+    std::mutex& getStripe(uint32_t hash) {
+        return stripes[hash & (lock_stripes - 1)].mutex;
+    }
+
+    /*
+     * how many powers of 2's worth of buckets we use. Only changed while
+     * holding all of the stripes.
+     */
     unsigned int hashpower;
 
 
@@ -39,27 +58,65 @@ struct Assoc {
     std::vector<hash_item*> old_hashtable;
 
     /* Number of items in the hash table. */
-    unsigned int hash_items{0};
+    std::atomic<unsigned int> hash_items{0};
 
-    /* Flag: Are we in the middle of expanding now? */
+    /*
+     * Flag: Are we in the middle of expanding now? Only changed while
+     * holding all of the stripes.
+     */
     bool expanding{false};
 
+    /*
+     * Flag: Is a thread growing the table? Set from when the new table is
+     * allocated until all of the items is moved over to it, and ensures
+     * that only one thread expands the table at the time.
+     */
+    std::atomic<bool> resizing{false};
+
     /*
      * During expansion we migrate values with bucket granularity; this is how
      * far we've gotten so far. Ranges from 0 .. hashsize(hashpower - 1) - 1.
+     * A bucket is migrated while holding its stripe, so the value is
+     * consistent for all of the buckets protected by the stripe we hold.
      */
-    unsigned int expand_bucket{0};
+    std::atomic<unsigned int> expand_bucket{0};
 
     /*
-     * serialise access to the hashtable
+     * serialise access to the buckets in the hashtable. Each mutex lives
+     * in its own cache line so that threads using different stripes don't
+     * contend on the same cache line.
      */
-    std::mutex mutex;
+    struct Stripe {
+        std::mutex mutex;
+        char padding[64 - (sizeof(std::mutex) % 64)];
+    };
+    std::array<Stripe, lock_stripes> stripes;
 };
 
 /* One hashtable for all */
 static struct Assoc* global_assoc = nullptr;
 static EXTENSION_LOGGER_DESCRIPTOR *logger = nullptr;
 
+/*
+ * Holds all of the stripes (acquired in order) for the lifetime of the
+ * object; used while changing the layout of the hashtable.
+ */
+class AllStripesGuard {
+public:
+    AllStripesGuard() {
+        for (auto& stripe : global_assoc->stripes) {
+            stripe.mutex.lock();
+        }
+    }
+
+    ~AllStripesGuard() {
+        for (auto it = global_assoc->stripes.rbegin();
+             it != global_assoc->stripes.rend(); ++it) {
+            it->mutex.unlock();
+        }
+    }
+};
+
 /* assoc factory. returns one new assoc or NULL if out-of-memory */
 static struct Assoc* assoc_consruct(int hashpower) {
     try {
@@ -85,7 +142,7 @@ ENGINE_ERROR_CODE assoc_init(struct default_engine *engine) {
 
 void assoc_destroy() {
     if (global_assoc != nullptr) {
-        while (global_assoc->expanding) {
+        while (global_assoc->resizing) {
             usleep(250);
         }
         delete global_assoc;
@@ -93,19 +150,27 @@ void assoc_destroy() {
     }
 }
 
-hash_item *assoc_find(uint32_t hash, const hash_key *key) {
-    hash_item *it;
+/*
+    returns the address of the bucket the given hash value belongs to.
+    the stripe for the hash value is assumed to be held by the caller.
+*/
+static hash_item** _hashbucket(uint32_t hash) {
     unsigned int oldbucket;
-    hash_item *ret = NULL;
-    int depth = 0;
-    std::lock_guard<std::mutex> guard(global_assoc->mutex);
+
     if (global_assoc->expanding &&
         (oldbucket = (hash & hashmask(global_assoc->hashpower - 1))) >= global_assoc->expand_bucket)
     {
-        it = global_assoc->old_hashtable[oldbucket];
-    } else {
-        it = global_assoc->primary_hashtable[hash & hashmask(global_assoc->hashpower)];
+        return &global_assoc->old_hashtable[oldbucket];
     }
+    return &global_assoc->primary_hashtable[hash & hashmask(global_assoc->hashpower)];
+}
+
+hash_item *assoc_find(uint32_t hash, const hash_key *key) {
+    hash_item *it;
+    hash_item *ret = NULL;
+    int depth = 0;
+    std::lock_guard<std::mutex> guard(global_assoc->getStripe(hash));
+    it = *_hashbucket(hash);
 
     while (it) {
         const hash_key* it_key = item_get_key(it);
@@ -126,19 +191,10 @@ hash_item *assoc_find(uint32_t hash, const hash_key *key) {
 /*
     returns the address of the item pointer before the key.  if *item == 0,
     the item wasn't found
-    assoc->lock is assumed to be held by the caller.
+    the stripe for the hash value is assumed to be held by the caller.
 */
 static hash_item** _hashitem_before(uint32_t hash, const hash_key* key) {
-    hash_item **pos;
-    unsigned int oldbucket;
-
-    if (global_assoc->expanding &&
-        (oldbucket = (hash & hashmask(global_assoc->hashpower - 1))) >= global_assoc->expand_bucket)
-    {
-        pos = &global_assoc->old_hashtable[oldbucket];
-    } else {
-        pos = &global_assoc->primary_hashtable[hash & hashmask(global_assoc->hashpower)];
-    }
+    hash_item **pos = _hashbucket(hash);
 
     while (*pos) {
         const hash_key* pos_key = item_get_key(*pos);
@@ -159,26 +215,39 @@ static void assoc_maintenance_thread(void *arg);
 
 /*
     grows the hashtable to the next power of 2.
-    assoc->lock is assumed to be held by the caller.
+    none of the stripes may be held by the caller. The new table is
+    allocated before we grab the stripes, and they're only held while
+    swapping in the new table; the items are moved over to it by the
+    maintenance thread.
 */
 static void assoc_expand() {
-    global_assoc->old_hashtable.swap(global_assoc->primary_hashtable);
+    bool expected = false;
+    if (!global_assoc->resizing.compare_exchange_strong(expected, true)) {
+        /* Someone else is already growing the table */
+        return;
+    }
 
+    std::vector<hash_item*> table;
     try {
-        global_assoc->primary_hashtable.resize(hashsize(global_assoc->hashpower + 1));
+        table.resize(hashsize(global_assoc->hashpower + 1));
     } catch (const std::bad_alloc&) {
-        global_assoc->primary_hashtable.swap(global_assoc->old_hashtable);
         /* Bad news, but we can keep running. */
+        global_assoc->resizing = false;
         return;
     }
 
+    {
+        AllStripesGuard guard;
+        global_assoc->old_hashtable.swap(global_assoc->primary_hashtable);
+        global_assoc->primary_hashtable.swap(table);
+        global_assoc->hashpower++;
+        global_assoc->expand_bucket = 0;
+        global_assoc->expanding = true;
+    }
+
     int ret = 0;
     cb_thread_t tid;
 
-    global_assoc->hashpower++;
-    global_assoc->expanding = true;
-    global_assoc->expand_bucket = 0;
-
     /* start a thread to do the expansion */
     if ((ret = cb_create_named_thread(&tid, assoc_maintenance_thread,
                                       nullptr, 1, "mc:assoc_maint")) != 0)
@@ -187,52 +256,55 @@ static void assoc_expand() {
             logger->log(EXTENSION_LOG_WARNING, NULL,
                         "Can't create thread: %s", cb_strerror().c_str());
         }
-        global_assoc->hashpower--;
-        global_assoc->expanding = false;
-        global_assoc->primary_hashtable.swap(global_assoc->old_hashtable);
-        global_assoc->old_hashtable.resize(0);
-        global_assoc->old_hashtable.shrink_to_fit();
+        {
+            /* No items have been moved yet; just drop the new table */
+            AllStripesGuard guard;
+            global_assoc->hashpower--;
+            global_assoc->expanding = false;
+            global_assoc->primary_hashtable.swap(global_assoc->old_hashtable);
+            global_assoc->old_hashtable.swap(table);
+        }
+        global_assoc->resizing = false;
     }
 }
 
 /* Note: this isn't an assoc_update.  The key must not already exist to call this */
 int assoc_insert(uint32_t hash, hash_item *it) {
-    unsigned int oldbucket;
+    bool grow;
 
     cb_assert(assoc_find(hash, item_get_key(it)) == 0);  /* shouldn't have duplicately named things defined */
 
-    std::lock_guard<std::mutex> guard(global_assoc->mutex);
-    if (global_assoc->expanding &&
-        (oldbucket = (hash & hashmask(global_assoc->hashpower - 1))) >= global_assoc->expand_bucket)
     {
-        it->h_next = global_assoc->old_hashtable[oldbucket];
-        global_assoc->old_hashtable[oldbucket] = it;
-    } else {
-        it->h_next = global_assoc->primary_hashtable[hash & hashmask(global_assoc->hashpower)];
-        global_assoc->primary_hashtable[hash & hashmask(global_assoc->hashpower)] = it;
+        std::lock_guard<std::mutex> guard(global_assoc->getStripe(hash));
+        hash_item **bucket = _hashbucket(hash);
+        it->h_next = *bucket;
+        *bucket = it;
+
+        unsigned int items = ++global_assoc->hash_items;
+        grow = !global_assoc->expanding &&
+               items > (hashsize(global_assoc->hashpower) * 3) / 2;
+        MEMCACHED_ASSOC_INSERT(hash_key_get_key(item_get_key(it)), hash_key_get_key_len(item_get_key(it)), items);
     }
 
-    global_assoc->hash_items++;
-    if (! global_assoc->expanding && global_assoc->hash_items > (hashsize(global_assoc->hashpower) * 3) / 2) {
+    if (grow) {
         assoc_expand();
     }
-    MEMCACHED_ASSOC_INSERT(hash_key_get_key(item_get_key(it)), hash_key_get_key_len(item_get_key(it)), global_assoc->hash_items);
     return 1;
 }
 
 void assoc_delete(uint32_t hash, const hash_key *key) {
-    std::lock_guard<std::mutex> guard(global_assoc->mutex);
+    std::lock_guard<std::mutex> guard(global_assoc->getStripe(hash));
     hash_item **before = _hashitem_before(hash, key);
 
     if (*before) {
         hash_item *nxt;
-        global_assoc->hash_items--;
+        unsigned int items = --global_assoc->hash_items;
         /* The DTrace probe cannot be triggered as the last instruction
          * due to possible tail-optimization by the compiler
          */
         MEMCACHED_ASSOC_DELETE(hash_key_get_key(key),
                                hash_key_get_key_len(key),
-                               global_assoc->hash_items);
+                               items);
         nxt = (*before)->h_next;
         (*before)->h_next = 0;   /* probably pointless, but whatever. */
         *before = nxt;
@@ -243,51 +315,46 @@ void assoc_delete(uint32_t hash, const hash_key *key) {
     cb_assert(*before != 0);
 }
 
+/*
+ * Move the items over to the new table one bucket at the time, only
+ * holding the stripe for the bucket being moved; so lookups and updates
+ * of the other buckets run in parallel with the expansion.
+ */
+static void assoc_maintenance_thread(void *arg) {
+    const unsigned int oldsize = hashsize(global_assoc->hashpower - 1);
+
+    for (unsigned int ii = 0; ii < oldsize; ++ii) {
+        std::lock_guard<std::mutex> guard(global_assoc->getStripe(ii));
+        hash_item *it, *next;
+        int bucket;
+
+        for (it = global_assoc->old_hashtable[ii]; NULL != it; it = next) {
+            next = it->h_next;
+            const hash_key* key = item_get_key(it);
+            bucket = crc32c(hash_key_get_key(key),
+                            hash_key_get_key_len(key),
+                            0) & hashmask(global_assoc->hashpower);
+            it->h_next = global_assoc->primary_hashtable[bucket];
+            global_assoc->primary_hashtable[bucket] = it;
+        }
 
+        global_assoc->old_hashtable[ii] = NULL;
+        global_assoc->expand_bucket = ii + 1;
+    }
 
-#define DEFAULT_HASH_BULK_MOVE 1
-int hash_bulk_move = DEFAULT_HASH_BULK_MOVE;
+    std::vector<hash_item*> table;
+    {
+        AllStripesGuard guard;
+        global_assoc->expanding = false;
+        global_assoc->old_hashtable.swap(table);
+    }
 
-static void assoc_maintenance_thread(void *arg) {
-    bool done = false;
-    do {
-        int ii;
-        std::lock_guard<std::mutex> guard(global_assoc->mutex);
-
-        for (ii = 0; ii < hash_bulk_move && global_assoc->expanding; ++ii) {
-            hash_item *it, *next;
-            int bucket;
-
-            for (it = global_assoc->old_hashtable[global_assoc->expand_bucket];
-                 NULL != it; it = next) {
-                next = it->h_next;
-                const hash_key* key = item_get_key(it);
-                bucket = crc32c(hash_key_get_key(key),
-                                hash_key_get_key_len(key),
-                                0) & hashmask(global_assoc->hashpower);
-                it->h_next = global_assoc->primary_hashtable[bucket];
-                global_assoc->primary_hashtable[bucket] = it;
-            }
-
-            global_assoc->old_hashtable[global_assoc->expand_bucket] = NULL;
-            global_assoc->expand_bucket++;
-            if (global_assoc->expand_bucket == hashsize(global_assoc->hashpower - 1)) {
-                global_assoc->expanding = false;
-                global_assoc->old_hashtable.resize(0);
-                global_assoc->old_hashtable.shrink_to_fit();
-                if (logger != nullptr) {
-                    logger->log(EXTENSION_LOG_INFO, NULL,
-                                "Hash table expansion done");
-                }
-            }
-        }
-        if (!global_assoc->expanding) {
-            done = true;
-        }
-    } while (!done);
+    if (logger != nullptr) {
+        logger->log(EXTENSION_LOG_INFO, NULL, "Hash table expansion done");
+    }
+    global_assoc->resizing = false;
 }
 
 bool assoc_expanding() {
-    std::lock_guard<std::mutex> guard(global_assoc->mutex);
-    return global_assoc->expanding;
+    return global_assoc->resizing;
 }
@@ -21,6 +21,7 @@
 #include <platform/crc32c.h>
 #include <benchmark/benchmark.h>
 #include <random>
+#include <vector>
 
 const uint32_t max_items = 100000;
 
@@ -87,6 +88,7 @@ void AccessSingleItem(benchmark::State& state) {
             throw std::logic_error("AccessSingleItem: Expected to find key");
         }
     }
+    state.SetItemsProcessed(state.iterations());
 }
 
 void AccessRandomItems(benchmark::State& state) {
@@ -104,10 +106,46 @@ void AccessRandomItems(benchmark::State& state) {
             throw std::logic_error("AccessRandomItems: Expected to find key");
         }
     }
+    state.SetItemsProcessed(state.iterations());
 }
 
-BENCHMARK(AccessSingleItem)->ThreadRange(1, 16);
-BENCHMARK(AccessRandomItems)->ThreadRange(1, 16);
+/*
+ * Each thread keeps inserting and deleting its own set of keys (which
+ * aren't part of the populated cache), so the threads only contend
+ * with each other when their keys share a lock stripe.
+ */
+void InsertAndDeleteItems(benchmark::State& state) {
+    const uint32_t num_keys = 1000;
+    const uint32_t first = max_items + state.thread_index * num_keys;
+    std::vector<hash_item*> items;
+    std::vector<uint32_t> hashes;
+
+    for (uint32_t ii = 0; ii < num_keys; ++ii) {
+        auto* it = item_alloc(first + ii);
+        const hash_key* key = item_get_key(it);
+        items.push_back(it);
+        hashes.push_back(crc32c(hash_key_get_key(key),
+                                hash_key_get_key_len(key), 0));
+    }
+
+    uint32_t ii = 0;
+    while (state.KeepRunning()) {
+        assoc_insert(hashes[ii], items[ii]);
+        assoc_delete(hashes[ii], item_get_key(items[ii]));
+        ii = (ii + 1) % num_keys;
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    for (auto* it : items) {
+        free(static_cast<void*>(it));
+    }
+}
+
+// Measure the throughput in wall clock time, to show how the hash table
+// scales with the number of threads
+BENCHMARK(AccessSingleItem)->ThreadRange(1, 32)->UseRealTime();
+BENCHMARK(AccessRandomItems)->ThreadRange(1, 32)->UseRealTime();
+BENCHMARK(InsertAndDeleteItems)->ThreadRange(1, 32)->UseRealTime();
 
 int main(int argc, char** argv) {
     ::benchmark::Initialize(&argc, argv);
@@ -65,6 +65,12 @@ static cb::EngineErrorItemPair default_get(gsl::not_null<ENGINE_HANDLE*> handle,
                                            uint16_t vbucket,
                                            DocStateFilter);
 
+static std::vector<cb::EngineErrorItemPair> default_get_multi(
+        gsl::not_null<ENGINE_HANDLE*> handle,
+        gsl::not_null<const void*> cookie,
+        const std::vector<cb::GetMultiKey>& keys,
+        DocStateFilter documentStateFilter);
+
 static cb::EngineErrorItemPair default_get_if(
         gsl::not_null<ENGINE_HANDLE*>,
         gsl::not_null<const void*>,
@@ -184,7 +190,12 @@ void default_engine_constructor(struct default_engine* engine, bucket_id_t id)
     memset(engine, 0, sizeof(*engine));
 
     cb_mutex_initialize(&engine->slabs.lock);
-    cb_mutex_initialize(&engine->items.lock);
+    for (auto& cache : engine->slabs.caches) {
+        cb_mutex_initialize(&cache.lock);
+    }
+    for (auto& part : engine->items.partitions) {
+        cb_mutex_initialize(&part.lock);
+    }
     cb_mutex_initialize(&engine->stats.lock);
     cb_mutex_initialize(&engine->scrubber.lock);
 
@@ -198,6 +209,7 @@ void default_engine_constructor(struct default_engine* engine, bucket_id_t id)
     engine->engine.remove = default_item_delete;
     engine->engine.release = default_item_release;
     engine->engine.get = default_get;
+    engine->engine.get_multi = default_get_multi;
     engine->engine.get_if = default_get_if;
     engine->engine.get_locked = default_get_locked;
     engine->engine.get_meta = default_get_meta;
@@ -306,8 +318,13 @@ void destroy_engine_instance(struct default_engine* engine) {
         cb_free(engine->config.uuid);
 
         /* Clean up the mutexes */
-        cb_mutex_destroy(&engine->items.lock);
+        for (auto& part : engine->items.partitions) {
+            cb_mutex_destroy(&part.lock);
+        }
         cb_mutex_destroy(&engine->stats.lock);
+        for (auto& cache : engine->slabs.caches) {
+            cb_mutex_destroy(&cache.lock);
+        }
         cb_mutex_destroy(&engine->slabs.lock);
         cb_mutex_destroy(&engine->scrubber.lock);
 
@@ -490,6 +507,22 @@ static cb::EngineErrorItemPair default_get(gsl::not_null<ENGINE_HANDLE*> handle,
     }
 }
 
+static std::vector<cb::EngineErrorItemPair> default_get_multi(
+        gsl::not_null<ENGINE_HANDLE*> handle,
+        gsl::not_null<const void*> cookie,
+        const std::vector<cb::GetMultiKey>& keys,
+        DocStateFilter documentStateFilter) {
+    // All of the items are in memory so there is nothing to batch; look
+    // them up one by one.
+    std::vector<cb::EngineErrorItemPair> ret;
+    ret.reserve(keys.size());
+    for (const auto& key : keys) {
+        ret.emplace_back(default_get(
+                handle, cookie, key.key, key.vbucket, documentStateFilter));
+    }
+    return ret;
+}
+
 static cb::EngineErrorItemPair default_get_if(
         gsl::not_null<ENGINE_HANDLE*> handle,
         gsl::not_null<const void*> cookie,
@@ -682,6 +715,11 @@ static ENGINE_ERROR_CODE default_get_stats(gsl::not_null<ENGINE_HANDLE*> handle,
             len = sprintf(val, "%" PRIu64, engine->scrubber.cleaned);
             add_stat("scrubber:cleaned", 16, val, len, cookie);
         }
+
+        len = sprintf(val, "%" PRIu64, engine->scrubber.crawler_visited);
+        add_stat("crawler:visited", 15, val, len, cookie);
+        len = sprintf(val, "%" PRIu64, engine->scrubber.crawler_reclaimed);
+        add_stat("crawler:reclaimed", 17, val, len, cookie);
         cb_mutex_exit(&engine->scrubber.lock);
     } else {
         ret = ENGINE_KEY_ENOENT;
@@ -47,6 +47,9 @@ struct default_engine;
 /** The item is deleted (may only be accessed if explicitly asked for) */
 #define ITEM_ZOMBIE (4)
 
+/** The item has been accessed since it was linked into its LRU segment */
+#define ITEM_ACTIVE (8)
+
 struct config {
    size_t verbose;
    rel_time_t oldest_live;
@@ -83,6 +86,10 @@ struct engine_scrubber {
    time_t stopped;
    bool running;
    bool force_delete;
+   /* the next partition for the crawler to visit */
+   unsigned int crawler_partition;
+   uint64_t crawler_visited;
+   uint64_t crawler_reclaimed;
 };
 
 struct vbucket_info {
@@ -29,6 +29,7 @@
 
 #include <chrono>
 #include <memory>
+#include <vector>
 
 static std::unique_ptr<EngineManager> engineManager;
 
@@ -158,6 +159,24 @@ void EngineManager::notifyScrubComplete(struct default_engine* engine,
     cond.notify_one();
 }
 
+void EngineManager::crawlEngines() {
+    std::vector<struct default_engine*> toCrawl;
+    {
+        std::lock_guard<std::mutex> lck(lock);
+        if (shuttingdown) {
+            return;
+        }
+        toCrawl.assign(engines.begin(), engines.end());
+    }
+
+    for (auto* engine : toCrawl) {
+        // Skip the engines which are still being created
+        if (engine->initialized) {
+            item_crawler_main(engine);
+        }
+    }
+}
+
 EngineManager& getEngineManager() {
     static std::mutex createLock;
     if (engineManager.get() == nullptr) {
@@ -69,6 +69,14 @@ public:
      */
     void notifyScrubComplete(struct default_engine* engine, bool destroy);
 
+    /**
+     * Run the crawler on all of the engines to reclaim the memory used
+     * by expired items. Called by the scrubber task when it is idle
+     * (and only the scrubber task deletes engines, so they can't go
+     * away while we crawl them).
+     */
+    void crawlEngines();
+
 protected:
     /**
      * Wait for the scrubber task to be idle. You <b>must</b> hold the
@@ -7,6 +7,7 @@
 #include <string.h>
 #include <time.h>
 #include <inttypes.h>
+#include <vector>
 
 #include <memcached/server_api.h>
 #include <platform/cb_malloc.h>
@@ -50,7 +51,7 @@ static void hash_key_destroy(hash_key* hkey);
 static void hash_key_copy_to_item(hash_item* dst, const hash_key* src);
 
 /*
- * We only reposition items in the LRU queue if they haven't been repositioned
+ * We only flag items in HOT and WARM as active if they haven't been moved
  * in this many seconds. That saves us from churning on frequently-accessed
  * items.
  */
@@ -60,11 +61,51 @@ static void hash_key_copy_to_item(hash_item* dst, const hash_key* src);
  * just give up and return an error after inspecting a fixed number of objects.
  */
 static const int search_items = 50;
+/*
+ * The crawler stops at the end of the first partition where it has visited
+ * at least this many items, and continues from the next one in its next run.
+ */
+static const int crawl_items = 10000;
+
+/* Get the index of the partition owning the items with the given key */
+static uint8_t item_partition_index(const hash_key* key) {
+    return uint8_t(crc32c(hash_key_get_key(key), hash_key_get_key_len(key), 0) %
+                   ITEM_PARTITIONS);
+}
+
+/* Get the partition owning the items with the given key */
+static item_partition_t* item_get_partition(struct default_engine* engine,
+                                            const hash_key* key) {
+    return &engine->items.partitions[item_partition_index(key)];
+}
+
+/* Get the partition the item belongs to */
+static item_partition_t* item_get_partition(struct default_engine* engine,
+                                            const hash_item* it) {
+    return &engine->items.partitions[it->partition];
+}
+
+/* Is the item one of the cursors used by the scrubber and the crawler? */
+static bool item_is_cursor(const hash_item* it) {
+    return item_get_key(it)->header.len == 0 && it->nbytes == 0;
+}
+
+/* Has the item expired, or been invalidated by a flush? */
+static bool do_item_is_dead(struct default_engine* engine,
+                            const hash_item* it,
+                            const rel_time_t current_time) {
+    const rel_time_t oldest_live = engine->config.oldest_live;
+    return (oldest_live != 0 && oldest_live <= current_time &&
+            it->time <= oldest_live) ||
+           (it->exptime != 0 && it->exptime <= current_time);
+}
 
 void item_stats_reset(struct default_engine *engine) {
-    cb_mutex_enter(&engine->items.lock);
-    memset(engine->items.itemstats, 0, sizeof(engine->items.itemstats));
-    cb_mutex_exit(&engine->items.lock);
+    for (auto& part : engine->items.partitions) {
+        cb_mutex_enter(&part.lock);
+        memset(part.itemstats, 0, sizeof(part.itemstats));
+        cb_mutex_exit(&part.lock);
+    }
 }
 
 
@@ -77,7 +118,7 @@ static size_t ITEM_ntotal(struct default_engine *engine,
 
 /* Get the next CAS id for a new item. */
 static uint64_t get_cas_id(void) {
-    static uint64_t cas_id = 0;
+    static std::atomic<uint64_t> cas_id{0};
     return ++cas_id;
 }
 
@@ -93,6 +134,158 @@ static uint64_t get_cas_id(void) {
 #endif
 
 
+/*
+ * Move the item to the head of the given LRU segment (the caller must hold
+ * the lock for the item's partition). The item's time is reset so that
+ * each segment stays sorted by time.
+ */
+static void do_item_lru_move(struct default_engine *engine,
+                             hash_item *it,
+                             const uint8_t lru,
+                             const rel_time_t current_time) {
+    item_unlink_q(engine, it);
+    it->lru = lru;
+    it->time = current_time;
+    it->iflag &= ~ITEM_ACTIVE;
+    item_link_q(engine, it);
+}
+
+/* Account for an expired (or flushed) item being unlinked */
+static void do_item_reclaimed(struct default_engine *engine,
+                              item_partition_t *part,
+                              const unsigned int id) {
+    part->itemstats[id].reclaimed++;
+    cb_mutex_enter(&engine->stats.lock);
+    engine->stats.reclaimed++;
+    cb_mutex_exit(&engine->stats.lock);
+}
+
+/*
+ * Move the items at the tails of HOT and WARM on to the next segment
+ * while the segments hold more than their share of the items of the slab
+ * class in the partition. This is called every time an item is linked, so
+ * we only need to move a couple of items at a time: active items go to
+ * WARM, the others go to COLD, and expired items are unlinked.
+ */
+static void do_item_lru_rebalance(struct default_engine *engine,
+                                  item_partition_t *part,
+                                  const unsigned int id,
+                                  const rel_time_t current_time) {
+    const unsigned int total = part->sizes[HOT_LRU][id] +
+                               part->sizes[WARM_LRU][id] +
+                               part->sizes[COLD_LRU][id];
+    const unsigned int limits[] = {total * HOT_LRU_PCT / 100,
+                                   total * WARM_LRU_PCT / 100};
+
+    for (int lru = HOT_LRU; lru <= WARM_LRU; ++lru) {
+        for (int moves = 0; moves < 2 && part->sizes[lru][id] > limits[lru];
+             ++moves) {
+            hash_item *it = part->tails[lru][id];
+            while (it != NULL && item_is_cursor(it)) {
+                it = it->prev;
+            }
+            if (it == NULL) {
+                break;
+            }
+
+            if (do_item_is_dead(engine, it, current_time)) {
+                do_item_reclaimed(engine, part, id);
+                do_item_unlink(engine, it);
+            } else if ((it->iflag & ITEM_ACTIVE) != 0) {
+                do_item_lru_move(engine, it, WARM_LRU, current_time);
+            } else {
+                do_item_lru_move(engine, it, COLD_LRU, current_time);
+            }
+        }
+    }
+}
+
+/*
+ * Try to evict one of the least recently used items of the given slab class
+ * in the partition (the caller must hold the lock for the partition).
+ *
+ * Returns true if an item was unlinked.
+ */
+static bool do_item_evict(struct default_engine *engine,
+                          item_partition_t *part,
+                          const unsigned int id,
+                          const void *cookie,
+                          const rel_time_t current_time) {
+    int tries = search_items;
+
+    /*
+     * try to get one off the right LRU, starting with COLD
+     * don't necessariuly unlink the tail because it may be locked: refcount>0
+     * search up from tail an item with refcount==0 and unlink it; give up after search_items
+     * tries
+     */
+    for (int lru = COLD_LRU; lru >= HOT_LRU; --lru) {
+        hash_item *search, *prev;
+        for (search = part->tails[lru][id]; tries > 0 && search != NULL;
+             tries--, search = prev) {
+            prev = search->prev;
+            if (search->refcount != 0 || search->locktime > current_time) {
+                continue;
+            }
+            if (lru == COLD_LRU && (search->iflag & ITEM_ACTIVE) != 0 &&
+                !do_item_is_dead(engine, search, current_time)) {
+                /* Accessed since it was moved to COLD; give it another go */
+                do_item_lru_move(engine, search, WARM_LRU, current_time);
+                continue;
+            }
+
+            if (search->exptime == 0 || search->exptime > current_time) {
+                part->itemstats[id].evicted++;
+                part->itemstats[id].evicted_time = current_time - search->time;
+                if (search->exptime != 0) {
+                    part->itemstats[id].evicted_nonzero++;
+                }
+                cb_mutex_enter(&engine->stats.lock);
+                engine->stats.evictions++;
+                cb_mutex_exit(&engine->stats.lock);
+                const hash_key* search_key = item_get_key(search);
+                engine->server.stat->evicting(cookie,
+                                              hash_key_get_client_key(search_key),
+                                              hash_key_get_client_key_len(search_key));
+            } else {
+                do_item_reclaimed(engine, part, id);
+            }
+            do_item_unlink(engine, search);
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Try to evict an item of the given slab class from one of the other
+ * partitions; a slab class with few items may not have any (unlocked)
+ * items in our partition even though its memory is full. The caller
+ * holds the lock for its own partition so we only try-lock the others
+ * (and skip those which are busy) to avoid deadlocks.
+ *
+ * Returns true if an item was unlinked.
+ */
+static bool do_item_evict_other(struct default_engine *engine,
+                                const unsigned int partition,
+                                const unsigned int id,
+                                const void *cookie,
+                                const rel_time_t current_time) {
+    for (unsigned int ii = 1; ii < ITEM_PARTITIONS; ++ii) {
+        item_partition_t *other =
+                &engine->items.partitions[(partition + ii) % ITEM_PARTITIONS];
+        if (cb_mutex_try_enter(&other->lock) != 0) {
+            continue;
+        }
+        bool evicted = do_item_evict(engine, other, id, cookie, current_time);
+        cb_mutex_exit(&other->lock);
+        if (evicted) {
+            return true;
+        }
+    }
+    return false;
+}
+
 /*@null@*/
 hash_item *do_item_alloc(struct default_engine *engine,
                          const hash_key *key,
@@ -107,6 +300,8 @@ hash_item *do_item_alloc(struct default_engine *engine,
     rel_time_t oldest_live;
     rel_time_t current_time;
     unsigned int id;
+    const uint8_t partition = item_partition_index(key);
+    item_partition_t *part = &engine->items.partitions[partition];
 
     size_t ntotal = sizeof(hash_item) + hash_key_get_alloc_size(key) + nbytes;
 
@@ -114,11 +309,11 @@ hash_item *do_item_alloc(struct default_engine *engine,
         return 0;
     }
 
-    /* do a quick check if we have any expired items in the tail.. */
+    /* do a quick check if we have any expired items in the tail of COLD.. */
     oldest_live = engine->config.oldest_live;
     current_time = engine->server.core->get_current_time();
 
-    for (search = engine->items.tails[id];
+    for (search = part->tails[COLD_LRU][id];
          tries > 0 && search != NULL;
          tries--, search=search->prev) {
         if (search->refcount == 0 &&
@@ -129,10 +324,7 @@ hash_item *do_item_alloc(struct default_engine *engine,
             /* I don't want to actually free the object, just steal
              * the item to avoid to grab the slab mutex twice ;-)
              */
-            cb_mutex_enter(&engine->stats.lock);
-            engine->stats.reclaimed++;
-            cb_mutex_exit(&engine->stats.lock);
-            engine->items.itemstats[id].reclaimed++;
+            do_item_reclaimed(engine, part, id);
             it->refcount = 1;
             slabs_adjust_mem_requested(engine, it->slabs_clsid, ITEM_ntotal(engine, it), ntotal);
             do_item_unlink(engine, it);
@@ -149,57 +341,22 @@ hash_item *do_item_alloc(struct default_engine *engine,
         ** Could not find an expired item at the tail, and memory allocation
         ** failed. Try to evict some items!
         */
-        tries = search_items;
 
         /* If requested to not push old items out of cache when memory runs out,
          * we're out of luck at this point...
          */
 
         if (engine->config.evict_to_free == 0) {
-            engine->items.itemstats[id].outofmemory++;
-            return NULL;
-        }
-
-        /*
-         * try to get one off the right LRU
-         * don't necessariuly unlink the tail because it may be locked: refcount>0
-         * search up from tail an item with refcount==0 and unlink it; give up after search_items
-         * tries
-         */
-
-        if (engine->items.tails[id] == 0) {
-            engine->items.itemstats[id].outofmemory++;
+            part->itemstats[id].outofmemory++;
             return NULL;
         }
 
-        for (search = engine->items.tails[id]; tries > 0 && search != NULL; tries--, search=search->prev) {
-            if (search->refcount == 0 && search->locktime <= current_time) {
-                if (search->exptime == 0 || search->exptime > current_time) {
-                    engine->items.itemstats[id].evicted++;
-                    engine->items.itemstats[id].evicted_time = current_time - search->time;
-                    if (search->exptime != 0) {
-                        engine->items.itemstats[id].evicted_nonzero++;
-                    }
-                    cb_mutex_enter(&engine->stats.lock);
-                    engine->stats.evictions++;
-                    cb_mutex_exit(&engine->stats.lock);
-                    const hash_key* search_key = item_get_key(search);
-                    engine->server.stat->evicting(cookie,
-                                                  hash_key_get_client_key(search_key),
-                                                  hash_key_get_client_key_len(search_key));
-                } else {
-                    engine->items.itemstats[id].reclaimed++;
-                    cb_mutex_enter(&engine->stats.lock);
-                    engine->stats.reclaimed++;
-                    cb_mutex_exit(&engine->stats.lock);
-                }
-                do_item_unlink(engine, search);
-                break;
-            }
+        if (!do_item_evict(engine, part, id, cookie, current_time)) {
+            do_item_evict_other(engine, partition, id, cookie, current_time);
         }
         it = static_cast<hash_item*>(slabs_alloc(engine, ntotal, id));
         if (it == 0) {
-            engine->items.itemstats[id].outofmemory++;
+            part->itemstats[id].outofmemory++;
             /* Last ditch effort. There is a very rare bug which causes
              * refcount leaks. We've fixed most of them, but it still happens,
              * and it may happen in the future.
@@ -208,9 +365,10 @@ hash_item *do_item_alloc(struct default_engine *engine,
              * free it anyway.
              */
             tries = search_items;
-            for (search = engine->items.tails[id]; tries > 0 && search != NULL; tries--, search=search->prev) {
-                if (search->refcount != 0 && search->time + TAIL_REPAIR_TIME < current_time) {
-                    engine->items.itemstats[id].tailrepairs++;
+            for (search = part->tails[COLD_LRU][id]; tries > 0 && search != NULL; tries--, search=search->prev) {
+                if (search->refcount != 0 && !item_is_cursor(search) &&
+                    search->time + TAIL_REPAIR_TIME < current_time) {
+                    part->itemstats[id].tailrepairs++;
                     search->refcount = 0;
                     do_item_unlink(engine, search);
                     break;
@@ -226,8 +384,10 @@ hash_item *do_item_alloc(struct default_engine *engine,
     cb_assert(it->slabs_clsid == 0);
 
     it->slabs_clsid = id;
+    it->partition = partition;
+    it->lru = HOT_LRU;
 
-    cb_assert(it != engine->items.heads[it->slabs_clsid]);
+    cb_assert(it != part->heads[HOT_LRU][it->slabs_clsid]);
 
     it->next = it->prev = it->h_next = 0;
     it->refcount = 1;     /* the caller will have a reference */
@@ -246,8 +406,8 @@ static void item_free(struct default_engine *engine, hash_item *it) {
     size_t ntotal = ITEM_ntotal(engine, it);
     unsigned int clsid;
     cb_assert((it->iflag & ITEM_LINKED) == 0);
-    cb_assert(it != engine->items.heads[it->slabs_clsid]);
-    cb_assert(it != engine->items.tails[it->slabs_clsid]);
+    cb_assert(it != item_get_partition(engine, it)->heads[it->lru][it->slabs_clsid]);
+    cb_assert(it != item_get_partition(engine, it)->tails[it->lru][it->slabs_clsid]);
     cb_assert(it->refcount == 0 || engine->scrubber.force_delete);
 
     /* so slab size changer can tell later if item is already free or not */
@@ -260,11 +420,12 @@ static void item_free(struct default_engine *engine, hash_item *it) {
 
 static void item_link_q(struct default_engine *engine, hash_item *it) { /* item is the new head */
     hash_item **head, **tail;
+    item_partition_t *part = item_get_partition(engine, it);
     cb_assert(it->slabs_clsid < POWER_LARGEST);
     cb_assert((it->iflag & ITEM_SLABBED) == 0);
 
-    head = &engine->items.heads[it->slabs_clsid];
-    tail = &engine->items.tails[it->slabs_clsid];
+    head = &part->heads[it->lru][it->slabs_clsid];
+    tail = &part->tails[it->lru][it->slabs_clsid];
     cb_assert(it != *head);
     cb_assert((*head && *tail) || (*head == 0 && *tail == 0));
     it->prev = 0;
@@ -272,15 +433,16 @@ static void item_link_q(struct default_engine *engine, hash_item *it) { /* item
     if (it->next) it->next->prev = it;
     *head = it;
     if (*tail == 0) *tail = it;
-    engine->items.sizes[it->slabs_clsid]++;
+    part->sizes[it->lru][it->slabs_clsid]++;
     return;
 }
 
 static void item_unlink_q(struct default_engine *engine, hash_item *it) {
     hash_item **head, **tail;
+    item_partition_t *part = item_get_partition(engine, it);
     cb_assert(it->slabs_clsid < POWER_LARGEST);
-    head = &engine->items.heads[it->slabs_clsid];
-    tail = &engine->items.tails[it->slabs_clsid];
+    head = &part->heads[it->lru][it->slabs_clsid];
+    tail = &part->tails[it->lru][it->slabs_clsid];
 
     if (*head == it) {
         cb_assert(it->prev == 0);
@@ -295,7 +457,7 @@ static void item_unlink_q(struct default_engine *engine, hash_item *it) {
 
     if (it->next) it->next->prev = it->prev;
     if (it->prev) it->prev->next = it->next;
-    engine->items.sizes[it->slabs_clsid]--;
+    part->sizes[it->lru][it->slabs_clsid]--;
     return;
 }
 
@@ -307,6 +469,7 @@ int do_item_link(struct default_engine *engine,
     cb_assert((it->iflag & (ITEM_LINKED|ITEM_SLABBED)) == 0);
     it->iflag |= ITEM_LINKED;
     it->time = engine->server.core->get_current_time();
+    it->lru = HOT_LRU;
 
     assoc_insert(crc32c(hash_key_get_key(key), hash_key_get_key_len(key), 0),
                  it);
@@ -338,6 +501,8 @@ int do_item_link(struct default_engine *engine,
     }
 
     item_link_q(engine, it);
+    do_item_lru_rebalance(engine, item_get_partition(engine, it),
+                          it->slabs_clsid, it->time);
 
     return 1;
 }
@@ -418,14 +583,16 @@ void do_item_update(struct default_engine *engine, hash_item *it) {
     MEMCACHED_ITEM_UPDATE(hash_key_get_client_key(item_get_key(it)),
                           hash_key_get_client_key_len(item_get_key(it)),
                           it->nbytes);
-    if (it->time < current_time - ITEM_UPDATE_INTERVAL) {
+    /*
+     * Don't move the item on access; just flag it as active and it'll be
+     * moved when it reaches the tail of its segment. Items in COLD are
+     * always flagged as they're the next in line to be evicted.
+     */
+    if ((it->iflag & ITEM_ACTIVE) == 0 &&
+        (it->lru == COLD_LRU ||
+         it->time < current_time - ITEM_UPDATE_INTERVAL)) {
         cb_assert((it->iflag & ITEM_SLABBED) == 0);
-
-        if ((it->iflag & ITEM_LINKED) != 0) {
-            item_unlink_q(engine, it);
-            it->time = current_time;
-            item_link_q(engine, it);
-        }
+        it->iflag |= ITEM_ACTIVE;
     }
 }
 
@@ -445,49 +612,58 @@ int do_item_replace(struct default_engine *engine,
     return do_item_link(engine, cookie, new_it);
 }
 
+/* The item statistics for a slab class, summed over all of the partitions */
+typedef struct {
+    unsigned int number;
+    unsigned int lru_number[NUM_LRU_SEGMENTS];
+    rel_time_t age;
+    itemstats_t itemstats;
+} item_class_stats_t;
+
 static void do_item_stats(struct default_engine *engine,
-                          ADD_STAT add_stats, const void *c) {
+                          item_partition_t *part,
+                          item_class_stats_t *stats) {
     int i;
     rel_time_t current_time = engine->server.core->get_current_time();
     for (i = 0; i < POWER_LARGEST; i++) {
-        if (engine->items.tails[i] != NULL) {
-            const char *prefix = "items";
+        stats[i].itemstats.evicted += part->itemstats[i].evicted;
+        stats[i].itemstats.evicted_nonzero +=
+                part->itemstats[i].evicted_nonzero;
+        if (part->itemstats[i].evicted_time > stats[i].itemstats.evicted_time) {
+            stats[i].itemstats.evicted_time = part->itemstats[i].evicted_time;
+        }
+        stats[i].itemstats.outofmemory += part->itemstats[i].outofmemory;
+        stats[i].itemstats.tailrepairs += part->itemstats[i].tailrepairs;
+        stats[i].itemstats.reclaimed += part->itemstats[i].reclaimed;
+
+        for (int lru = 0; lru < NUM_LRU_SEGMENTS; lru++) {
+            hash_item **tail = &part->tails[lru][i];
             int search = search_items;
-            while (search > 0 &&
-                   engine->items.tails[i] != NULL &&
-                   ((engine->config.oldest_live != 0 && /* Item flushd */
-                     engine->config.oldest_live <= current_time &&
-                     engine->items.tails[i]->time <= engine->config.oldest_live) ||
-                    (engine->items.tails[i]->exptime != 0 && /* and not expired */
-                     engine->items.tails[i]->exptime < current_time))) {
+            while (search > 0 && *tail != NULL &&
+                   do_item_is_dead(engine, *tail, current_time)) {
                 --search;
-                if (engine->items.tails[i]->refcount == 0) {
-                    do_item_unlink(engine, engine->items.tails[i]);
+                if ((*tail)->refcount == 0) {
+                    do_item_unlink(engine, *tail);
                 } else {
                     break;
                 }
             }
-            if (engine->items.tails[i] == NULL) {
-                /* We removed all of the items in this slab class */
+
+            hash_item *oldest = *tail;
+            while (oldest != NULL && item_is_cursor(oldest)) {
+                oldest = oldest->prev;
+            }
+            if (oldest == NULL) {
+                /* We removed all of the items in this segment */
                 continue;
             }
 
-            add_statistics(c, add_stats, prefix, i, "number", "%u",
-                           engine->items.sizes[i]);
-            add_statistics(c, add_stats, prefix, i, "age", "%u",
-                           engine->items.tails[i]->time);
-            add_statistics(c, add_stats, prefix, i, "evicted",
-                           "%u", engine->items.itemstats[i].evicted);
-            add_statistics(c, add_stats, prefix, i, "evicted_nonzero",
-                           "%u", engine->items.itemstats[i].evicted_nonzero);
-            add_statistics(c, add_stats, prefix, i, "evicted_time",
-                           "%u", engine->items.itemstats[i].evicted_time);
-            add_statistics(c, add_stats, prefix, i, "outofmemory",
-                           "%u", engine->items.itemstats[i].outofmemory);
-            add_statistics(c, add_stats, prefix, i, "tailrepairs",
-                           "%u", engine->items.itemstats[i].tailrepairs);;
-            add_statistics(c, add_stats, prefix, i, "reclaimed",
-                           "%u", engine->items.itemstats[i].reclaimed);;
+            /* The age of the class is the age of its oldest item */
+            if (stats[i].number == 0 || oldest->time < stats[i].age) {
+                stats[i].age = oldest->time;
+            }
+            stats[i].number += part->sizes[lru][i];
+            stats[i].lru_number[lru] += part->sizes[lru][i];
         }
     }
 }
@@ -495,46 +671,29 @@ static void do_item_stats(struct default_engine *engine,
 /** dumps out a list of objects of each size, with granularity of 32 bytes */
 /*@null@*/
 static void do_item_stats_sizes(struct default_engine *engine,
-                                ADD_STAT add_stats, const void *c) {
-
-    /* max 1MB object, divided into 32 bytes size buckets */
-    const int num_buckets = 32768;
-    unsigned int* histogram = static_cast<unsigned int*>
-        (cb_calloc(num_buckets, sizeof(unsigned int)));
-
-    if (histogram != NULL) {
-        int i;
+                                item_partition_t *part,
+                                unsigned int *histogram,
+                                const int num_buckets) {
+    int i;
 
-        /* build the histogram */
+    /* build the histogram */
+    for (int lru = 0; lru < NUM_LRU_SEGMENTS; lru++) {
         for (i = 0; i < POWER_LARGEST; i++) {
-            hash_item *iter = engine->items.heads[i];
-            while (iter) {
+            hash_item *iter;
+            for (iter = part->heads[lru][i]; iter != NULL; iter = iter->next) {
+                if (item_is_cursor(iter)) {
+                    continue;
+                }
                 size_t ntotal = ITEM_ntotal(engine, iter);
                 size_t bucket = ntotal / 32;
                 if ((ntotal % 32) != 0) {
                     bucket++;
                 }
-                if (bucket < num_buckets) {
+                if (bucket < size_t(num_buckets)) {
                     histogram[bucket]++;
                 }
-                iter = iter->next;
             }
         }
-
-        /* write the buffer */
-        for (i = 0; i < num_buckets; i++) {
-            if (histogram[i] != 0) {
-                char key[8], val[32];
-                int klen, vlen;
-                klen = snprintf(key, sizeof(key), "%d", i * 32);
-                vlen = snprintf(val, sizeof(val), "%u", histogram[i]);
-                if (klen > 0 && klen < int(sizeof(key)) && vlen > 0 &&
-                    vlen < int(sizeof(val))) {
-                    add_stats(key, klen, val, vlen, c);
-                }
-            }
-        }
-        cb_free(histogram);
     }
 }
 
@@ -569,7 +728,7 @@ hash_item* do_item_get(struct default_engine* engine,
     if (it != NULL && engine->config.oldest_live != 0 &&
         engine->config.oldest_live <= current_time &&
         it->time <= engine->config.oldest_live) {
-        do_item_unlink(engine, it);           /* MTSAFE - items.lock held */
+        do_item_unlink(engine, it);           /* MTSAFE - partition lock held */
         it = NULL;
     }
 
@@ -582,7 +741,7 @@ hash_item* do_item_get(struct default_engine* engine,
     }
 
     if (it != NULL && it->exptime != 0 && it->exptime <= current_time) {
-        do_item_unlink(engine, it);           /* MTSAFE - items.lock held */
+        do_item_unlink(engine, it);           /* MTSAFE - partition lock held */
         it = NULL;
     }
 
@@ -638,7 +797,7 @@ static ENGINE_ERROR_CODE do_store_item(struct default_engine *engine,
 
     if (old_it != NULL && operation == OPERATION_ADD &&
         (old_it->iflag & ITEM_ZOMBIE) == 0) {
-        /* add only adds a nonexistent item, but promote to head of LRU */
+        /* add only adds a nonexistent item, but flag it as accessed */
         do_item_update(engine, old_it);
     } else if ((!old_it || (old_it->iflag & ITEM_ZOMBIE)) && operation == OPERATION_REPLACE) {
         /* replace only replaces an existing value; don't store */
@@ -712,9 +871,10 @@ hash_item *item_alloc(struct default_engine *engine,
     if (!hash_key_create(&hkey, key, nkey, engine, cookie)) {
         return NULL;
     }
-    cb_mutex_enter(&engine->items.lock);
+    item_partition_t *part = item_get_partition(engine, &hkey);
+    cb_mutex_enter(&part->lock);
     it = do_item_alloc(engine, &hkey, flags, exptime, nbytes, cookie, datatype);
-    cb_mutex_exit(&engine->items.lock);
+    cb_mutex_exit(&part->lock);
     hash_key_destroy(&hkey);
     return it;
 }
@@ -746,9 +906,10 @@ hash_item* item_get(struct default_engine* engine,
                     const void* cookie,
                     const hash_key& key,
                     const DocStateFilter state) {
-    cb_mutex_enter(&engine->items.lock);
+    item_partition_t *part = item_get_partition(engine, &key);
+    cb_mutex_enter(&part->lock);
     auto* it = do_item_get(engine, &key, state);
-    cb_mutex_exit(&engine->items.lock);
+    cb_mutex_exit(&part->lock);
     return it;
 }
 
@@ -757,25 +918,28 @@ hash_item* item_get(struct default_engine* engine,
  * needed.
  */
 void item_release(struct default_engine *engine, hash_item *item) {
-    cb_mutex_enter(&engine->items.lock);
+    item_partition_t *part = item_get_partition(engine, item);
+    cb_mutex_enter(&part->lock);
     do_item_release(engine, item);
-    cb_mutex_exit(&engine->items.lock);
+    cb_mutex_exit(&part->lock);
 }
 
 /*
  * Unlinks an item from the LRU and hashtable.
  */
 void item_unlink(struct default_engine *engine, hash_item *item) {
-    cb_mutex_enter(&engine->items.lock);
+    item_partition_t *part = item_get_partition(engine, item);
+    cb_mutex_enter(&part->lock);
     do_item_unlink(engine, item);
-    cb_mutex_exit(&engine->items.lock);
+    cb_mutex_exit(&part->lock);
 }
 
 ENGINE_ERROR_CODE safe_item_unlink(struct default_engine *engine,
                                    hash_item *it) {
-    cb_mutex_enter(&engine->items.lock);
+    item_partition_t *part = item_get_partition(engine, it);
+    cb_mutex_enter(&part->lock);
     auto ret = do_safe_item_unlink(engine, it);
-    cb_mutex_exit(&engine->items.lock);
+    cb_mutex_exit(&part->lock);
     return ret;
 }
 
@@ -794,12 +958,13 @@ ENGINE_ERROR_CODE store_item(struct default_engine *engine,
         item->iflag |= ITEM_ZOMBIE;
     }
 
-    cb_mutex_enter(&engine->items.lock);
+    item_partition_t *part = item_get_partition(engine, item);
+    cb_mutex_enter(&part->lock);
     ret = do_store_item(engine, item, operation, cookie, &stored_item);
     if (ret == ENGINE_SUCCESS) {
         *cas = stored_item->cas;
     }
-    cb_mutex_exit(&engine->items.lock);
+    cb_mutex_exit(&part->lock);
     return ret;
 }
 
@@ -910,10 +1075,11 @@ ENGINE_ERROR_CODE item_get_locked(struct default_engine* engine,
         return ENGINE_TMPFAIL;
     }
 
-    cb_mutex_enter(&engine->items.lock);
+    item_partition_t *part = item_get_partition(engine, &hkey);
+    cb_mutex_enter(&part->lock);
     ENGINE_ERROR_CODE ret = do_item_get_locked(engine, cookie, it, &hkey,
                                                locktime);
-    cb_mutex_exit(&engine->items.lock);
+    cb_mutex_exit(&part->lock);
     hash_key_destroy(&hkey);
 
     return ret;
@@ -979,9 +1145,10 @@ ENGINE_ERROR_CODE item_unlock(struct default_engine* engine,
         return ENGINE_TMPFAIL;
     }
 
-    cb_mutex_enter(&engine->items.lock);
+    item_partition_t *part = item_get_partition(engine, &hkey);
+    cb_mutex_enter(&part->lock);
     ENGINE_ERROR_CODE ret = do_item_unlock(engine, cookie, &hkey, cas);
-    cb_mutex_exit(&engine->items.lock);
+    cb_mutex_exit(&part->lock);
     hash_key_destroy(&hkey);
 
     return ret;
@@ -1055,10 +1222,11 @@ ENGINE_ERROR_CODE item_get_and_touch(struct default_engine* engine,
         return ENGINE_TMPFAIL;
     }
 
-    cb_mutex_enter(&engine->items.lock);
+    item_partition_t *part = item_get_partition(engine, &hkey);
+    cb_mutex_enter(&part->lock);
     ENGINE_ERROR_CODE ret = do_item_get_and_touch(engine, cookie, it, &hkey,
                                                   exptime);
-    cb_mutex_exit(&engine->items.lock);
+    cb_mutex_exit(&part->lock);
     hash_key_destroy(&hkey);
 
     return ret;
@@ -1068,63 +1236,139 @@ ENGINE_ERROR_CODE item_get_and_touch(struct default_engine* engine,
  * Flushes expired items after a flush_all call
  */
 void item_flush_expired(struct default_engine *engine) {
-    cb_mutex_enter(&engine->items.lock);
+    /*
+     * Hold all of the partitions (locked in order) so that no one sees
+     * the new oldest_live time before the flush is complete
+     */
+    for (auto& part : engine->items.partitions) {
+        cb_mutex_enter(&part.lock);
+    }
 
     rel_time_t now = engine->server.core->get_current_time();
     if (now > engine->config.oldest_live) {
         engine->config.oldest_live = now - 1;
     }
 
-    for (int ii = 0; ii < POWER_LARGEST; ii++) {
-        hash_item *iter, *next;
-        /*
-         * The LRU is sorted in decreasing time order, and an item's
-         * timestamp is never newer than its last access time, so we
-         * only need to walk back until we hit an item older than the
-         * oldest_live time.
-         * The oldest_live checking will auto-expire the remaining items.
-         */
-        for (iter = engine->items.heads[ii]; iter != NULL; iter = next) {
-            if (iter->time >= engine->config.oldest_live) {
-                next = iter->next;
-                if ((iter->iflag & ITEM_SLABBED) == 0) {
-                    do_item_unlink(engine, iter);
+    for (auto& part : engine->items.partitions) {
+        for (int lru = 0; lru < NUM_LRU_SEGMENTS; lru++) {
+            for (int ii = 0; ii < POWER_LARGEST; ii++) {
+                hash_item *iter, *next;
+                /*
+                 * Each LRU segment is sorted in decreasing time order
+                 * (items get a new timestamp whenever they're moved to the
+                 * head of a segment), so we only need to walk back until
+                 * we hit an item older than the oldest_live time.
+                 * The oldest_live checking will auto-expire the remaining
+                 * items.
+                 */
+                for (iter = part.heads[lru][ii]; iter != NULL; iter = next) {
+                    next = iter->next;
+                    if (item_is_cursor(iter)) {
+                        continue;
+                    }
+                    if (iter->time >= engine->config.oldest_live) {
+                        if ((iter->iflag & ITEM_SLABBED) == 0) {
+                            do_item_unlink(engine, iter);
+                        }
+                    } else {
+                        /* We've hit the first old item. Continue to the next queue. */
+                        break;
+                    }
                 }
-            } else {
-                /* We've hit the first old item. Continue to the next queue. */
-                break;
             }
         }
     }
-    cb_mutex_exit(&engine->items.lock);
+
+    for (int ii = ITEM_PARTITIONS - 1; ii >= 0; --ii) {
+        cb_mutex_exit(&engine->items.partitions[ii].lock);
+    }
 }
 
 void item_stats(struct default_engine *engine,
                    ADD_STAT add_stat, const void *cookie)
 {
-    cb_mutex_enter(&engine->items.lock);
-    do_item_stats(engine, add_stat, cookie);
-    cb_mutex_exit(&engine->items.lock);
+    std::vector<item_class_stats_t> stats(POWER_LARGEST);
+    for (auto& part : engine->items.partitions) {
+        cb_mutex_enter(&part.lock);
+        do_item_stats(engine, &part, stats.data());
+        cb_mutex_exit(&part.lock);
+    }
+
+    for (int i = 0; i < POWER_LARGEST; i++) {
+        if (stats[i].number != 0) {
+            const char *prefix = "items";
+            add_statistics(cookie, add_stat, prefix, i, "number", "%u",
+                           stats[i].number);
+            add_statistics(cookie, add_stat, prefix, i, "number_hot", "%u",
+                           stats[i].lru_number[HOT_LRU]);
+            add_statistics(cookie, add_stat, prefix, i, "number_warm", "%u",
+                           stats[i].lru_number[WARM_LRU]);
+            add_statistics(cookie, add_stat, prefix, i, "number_cold", "%u",
+                           stats[i].lru_number[COLD_LRU]);
+            add_statistics(cookie, add_stat, prefix, i, "age", "%u",
+                           stats[i].age);
+            add_statistics(cookie, add_stat, prefix, i, "evicted",
+                           "%u", stats[i].itemstats.evicted);
+            add_statistics(cookie, add_stat, prefix, i, "evicted_nonzero",
+                           "%u", stats[i].itemstats.evicted_nonzero);
+            add_statistics(cookie, add_stat, prefix, i, "evicted_time",
+                           "%u", stats[i].itemstats.evicted_time);
+            add_statistics(cookie, add_stat, prefix, i, "outofmemory",
+                           "%u", stats[i].itemstats.outofmemory);
+            add_statistics(cookie, add_stat, prefix, i, "tailrepairs",
+                           "%u", stats[i].itemstats.tailrepairs);
+            add_statistics(cookie, add_stat, prefix, i, "reclaimed",
+                           "%u", stats[i].itemstats.reclaimed);
+        }
+    }
 }
 
 
 void item_stats_sizes(struct default_engine *engine,
                       ADD_STAT add_stat, const void *cookie)
 {
-    cb_mutex_enter(&engine->items.lock);
-    do_item_stats_sizes(engine, add_stat, cookie);
-    cb_mutex_exit(&engine->items.lock);
+    /* max 1MB object, divided into 32 bytes size buckets */
+    const int num_buckets = 32768;
+    unsigned int* histogram = static_cast<unsigned int*>
+        (cb_calloc(num_buckets, sizeof(unsigned int)));
+
+    if (histogram != NULL) {
+        for (auto& part : engine->items.partitions) {
+            cb_mutex_enter(&part.lock);
+            do_item_stats_sizes(engine, &part, histogram, num_buckets);
+            cb_mutex_exit(&part.lock);
+        }
+
+        /* write the buffer */
+        for (int i = 0; i < num_buckets; i++) {
+            if (histogram[i] != 0) {
+                char key[8], val[32];
+                int klen, vlen;
+                klen = snprintf(key, sizeof(key), "%d", i * 32);
+                vlen = snprintf(val, sizeof(val), "%u", histogram[i]);
+                if (klen > 0 && klen < int(sizeof(key)) && vlen > 0 &&
+                    vlen < int(sizeof(val))) {
+                    add_stat(key, klen, val, vlen, cookie);
+                }
+            }
+        }
+        cb_free(histogram);
+    }
 }
 
 static void do_item_link_cursor(struct default_engine *engine,
-                                hash_item *cursor, int ii)
+                                hash_item *cursor, int partition, int lru,
+                                int ii)
 {
+    item_partition_t *part = &engine->items.partitions[partition];
     cursor->slabs_clsid = (uint8_t)ii;
+    cursor->partition = (uint8_t)partition;
+    cursor->lru = (uint8_t)lru;
     cursor->next = NULL;
-    cursor->prev = engine->items.tails[ii];
-    engine->items.tails[ii]->next = cursor;
-    engine->items.tails[ii] = cursor;
-    engine->items.sizes[ii]++;
+    cursor->prev = part->tails[lru][ii];
+    part->tails[lru][ii]->next = cursor;
+    part->tails[lru][ii] = cursor;
+    part->sizes[lru][ii]++;
 }
 
 typedef ENGINE_ERROR_CODE (*ITERFUNC)(struct default_engine *engine,
@@ -1140,6 +1384,7 @@ static bool do_item_walk_cursor(struct default_engine *engine,
     int ii = 0;
     *error = ENGINE_SUCCESS;
 
+    item_partition_t *part = item_get_partition(engine, cursor);
     while (cursor->prev != NULL && ii < steplength) {
         /* Move cursor */
         hash_item *ptr = cursor->prev;
@@ -1148,7 +1393,7 @@ static bool do_item_walk_cursor(struct default_engine *engine,
         ++ii;
         item_unlink_q(engine, cursor);
 
-        if (ptr == engine->items.heads[cursor->slabs_clsid]) {
+        if (ptr == part->heads[cursor->lru][cursor->slabs_clsid]) {
             done = true;
             cursor->prev = NULL;
         } else {
@@ -1156,10 +1401,11 @@ static bool do_item_walk_cursor(struct default_engine *engine,
             cursor->prev = ptr->prev;
             cursor->prev->next = cursor;
             ptr->prev = cursor;
+            part->sizes[cursor->lru][cursor->slabs_clsid]++;
         }
 
         /* Ignore cursors */
-        if (item_get_key(ptr)->header.len == 0 && ptr->nbytes == 0) {
+        if (item_is_cursor(ptr)) {
             --ii;
         } else {
             *error = itemfunc(engine, ptr, itemdata);
@@ -1205,42 +1451,90 @@ static ENGINE_ERROR_CODE item_scrub(struct default_engine *engine,
     return ENGINE_SUCCESS;
 }
 
-static void item_scrub_class(struct default_engine *engine,
-                             hash_item *cursor) {
+typedef struct {
+    rel_time_t current_time;
+    int visited;
+    int reclaimed;
+} crawler_pass_t;
+
+static ENGINE_ERROR_CODE item_crawl(struct default_engine *engine,
+                                    hash_item *item,
+                                    void *cookie) {
+    crawler_pass_t *pass = static_cast<crawler_pass_t*>(cookie);
+    pass->visited++;
+    /*
+        the crawler unlinks the expired (and flushed) items which no one
+        holds a reference to, so that their memory can be reused before
+        we have to evict live items
+    */
+    if (item->refcount == 0 &&
+        do_item_is_dead(engine, item, pass->current_time)) {
+        do_item_reclaimed(engine, item_get_partition(engine, item),
+                          item->slabs_clsid);
+        do_item_unlink(engine, item);
+        pass->reclaimed++;
+    }
+    return ENGINE_SUCCESS;
+}
+
+/*
+ * Walk the items from the cursor to the head of its LRU segment, a few
+ * at a time so that we don't hold the partition lock for too long.
+ */
+static void item_walk_class(struct default_engine *engine,
+                            hash_item *cursor,
+                            ITERFUNC itemfunc,
+                            void *itemdata) {
 
     ENGINE_ERROR_CODE ret;
     bool more;
+    item_partition_t *part = item_get_partition(engine, cursor);
     do {
-        cb_mutex_enter(&engine->items.lock);
-        more = do_item_walk_cursor(engine, cursor, 200, item_scrub, NULL, &ret);
-        cb_mutex_exit(&engine->items.lock);
+        cb_mutex_enter(&part->lock);
+        more = do_item_walk_cursor(engine, cursor, 200, itemfunc, itemdata,
+                                   &ret);
+        cb_mutex_exit(&part->lock);
         if (ret != ENGINE_SUCCESS) {
             break;
         }
     } while (more);
 }
 
+/* Walk all of the LRU segments of all of the slab classes in the partition */
+static void item_walk_partition(struct default_engine *engine,
+                                hash_item *cursor,
+                                int partition,
+                                ITERFUNC itemfunc,
+                                void *itemdata) {
+    item_partition_t *part = &engine->items.partitions[partition];
+    for (int lru = 0; lru < NUM_LRU_SEGMENTS; ++lru) {
+        for (int ii = 0; ii < POWER_LARGEST; ++ii) {
+            bool skip = false;
+            cb_mutex_enter(&part->lock);
+            if (part->heads[lru][ii] == NULL) {
+                skip = true;
+            } else {
+                /* add the item at the tail */
+                do_item_link_cursor(engine, cursor, partition, lru, ii);
+            }
+            cb_mutex_exit(&part->lock);
+
+            if (!skip) {
+                item_walk_class(engine, cursor, itemfunc, itemdata);
+            }
+        }
+    }
+}
+
 void item_scrubber_main(struct default_engine *engine)
 {
-    hash_item cursor;
-    int ii;
+    item_cursor_t cursor;
+    int jj;
 
     memset(&cursor, 0, sizeof(cursor));
-    cursor.refcount = 1;
-    for (ii = 0; ii < POWER_LARGEST; ++ii) {
-        bool skip = false;
-        cb_mutex_enter(&engine->items.lock);
-        if (engine->items.heads[ii] == NULL) {
-            skip = true;
-        } else {
-            /* add the item at the tail */
-            do_item_link_cursor(engine, &cursor, ii);
-        }
-        cb_mutex_exit(&engine->items.lock);
-
-        if (!skip) {
-            item_scrub_class(engine, &cursor);
-        }
+    cursor.item.refcount = 1;
+    for (jj = 0; jj < ITEM_PARTITIONS; ++jj) {
+        item_walk_partition(engine, &cursor.item, jj, item_scrub, NULL);
     }
 
     cb_mutex_enter(&engine->scrubber.lock);
@@ -1249,6 +1543,36 @@ void item_scrubber_main(struct default_engine *engine)
     cb_mutex_exit(&engine->scrubber.lock);
 }
 
+void item_crawler_main(struct default_engine *engine)
+{
+    item_cursor_t cursor;
+    crawler_pass_t pass;
+    unsigned int partition;
+    int jj;
+
+    memset(&cursor, 0, sizeof(cursor));
+    cursor.item.refcount = 1;
+    pass.current_time = engine->server.core->get_current_time();
+    pass.visited = 0;
+    pass.reclaimed = 0;
+
+    cb_mutex_enter(&engine->scrubber.lock);
+    partition = engine->scrubber.crawler_partition;
+    cb_mutex_exit(&engine->scrubber.lock);
+
+    for (jj = 0; jj < ITEM_PARTITIONS && pass.visited < crawl_items; ++jj) {
+        item_walk_partition(engine, &cursor.item, partition, item_crawl,
+                            &pass);
+        partition = (partition + 1) % ITEM_PARTITIONS;
+    }
+
+    cb_mutex_enter(&engine->scrubber.lock);
+    engine->scrubber.crawler_partition = partition;
+    engine->scrubber.crawler_visited += pass.visited;
+    engine->scrubber.crawler_reclaimed += pass.reclaimed;
+    cb_mutex_exit(&engine->scrubber.lock);
+}
+
 bool item_start_scrub(struct default_engine *engine)
 {
     bool ret = false;
@@ -25,7 +25,7 @@ typedef struct _hash_item {
      */
     uint64_t cas;
 
-    /** least recent access */
+    /** when the item was linked into (or last moved to) its LRU segment */
     rel_time_t time;
 
     /** When the item will expire (relative to process startup) */
@@ -61,7 +61,13 @@ typedef struct _hash_item {
     /** to identify the type of the data */
     uint8_t datatype;
 
-    // There is 3 spare bytes due to alignment
+    /** which item partition (LRU and lock) the item belongs to */
+    uint8_t partition;
+
+    /** which LRU segment (HOT_LRU, WARM_LRU or COLD_LRU) the item is in */
+    uint8_t lru;
+
+    // There is 1 spare byte due to alignment
 } hash_item;
 
 /*
@@ -148,17 +154,54 @@ typedef struct {
     unsigned int reclaimed;
 } itemstats_t;
 
-struct items {
-   hash_item *heads[POWER_LARGEST];
-   hash_item *tails[POWER_LARGEST];
+/*
+ * The items are partitioned by the hash of their key. Each partition has
+ * its own LRU for each slab class, so that operations on keys in different
+ * partitions don't contend on the same lock.
+ */
+#define ITEM_PARTITIONS 32
+
+/*
+ * Each LRU is split into segments. New items are linked into HOT; items
+ * falling off the tail of HOT or WARM move to WARM if they were accessed
+ * while in the segment (ITEM_ACTIVE) and to COLD otherwise. Items are
+ * evicted from the tail of COLD, unless they were accessed while in COLD
+ * in which case they get a second chance in WARM.
+ */
+#define HOT_LRU 0
+#define WARM_LRU 1
+#define COLD_LRU 2
+#define NUM_LRU_SEGMENTS 3
+
+/* The share (in percent) of the items of a slab class kept in HOT and WARM */
+#define HOT_LRU_PCT 20
+#define WARM_LRU_PCT 40
+
+typedef struct {
+   hash_item *heads[NUM_LRU_SEGMENTS][POWER_LARGEST];
+   hash_item *tails[NUM_LRU_SEGMENTS][POWER_LARGEST];
    itemstats_t itemstats[POWER_LARGEST];
-   unsigned int sizes[POWER_LARGEST];
+   unsigned int sizes[NUM_LRU_SEGMENTS][POWER_LARGEST];
    /*
-    * serialise access to the items data
+    * serialise access to the items in the partition (and their LRUs)
    */
    cb_mutex_t lock;
+} item_partition_t;
+
+struct items {
+   item_partition_t partitions[ITEM_PARTITIONS];
 };
 
+/*
+ * The placeholder linked into an LRU to keep track of the position of
+ * the scrubber and the crawler. It carries an empty key (and no value)
+ * so that it can be told apart from a real item.
+ */
+typedef struct {
+    hash_item item;
+    hash_key_header key;
+} item_cursor_t;
+
 
 /**
  * Allocate and initialize a new item structure
@@ -352,4 +395,11 @@ void item_scrubber_main(struct default_engine *engine);
  */
 bool item_start_scrub(struct default_engine *engine);
 
+/**
+ * Run a single pass of the crawler for the engine, unlinking the expired
+ * (and flushed) items it finds in the next few partitions.
+ * @param engine handle to the storage engine
+ */
+void item_crawler_main(struct default_engine *engine);
+
 #endif
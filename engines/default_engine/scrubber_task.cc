@@ -72,7 +72,15 @@ void ScrubberTask::run() {
             lck.lock();
         } else {
             state = State::Idle;
-            cvar.wait(lck);
+            if (cvar.wait_for(lck, crawlInterval) == std::cv_status::timeout &&
+                !shuttingdown && workQueue.empty()) {
+                state = State::Crawling;
+                lck.unlock();
+                // Crawl without holding the lock (so that work can be
+                // queued meanwhile)
+                engineManager.crawlEngines();
+                lck.lock();
+            }
         }
     }
     state = State::Stopped;
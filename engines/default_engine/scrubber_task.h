@@ -16,6 +16,7 @@
  */
 #pragma once
 
+#include <chrono>
 #include <condition_variable>
 #include <deque>
 #include <mutex>
@@ -76,6 +77,8 @@ private:
         Idle,
         /// The scrubber is currently scrubbing a list
         Scrubbing,
+        /// The scrubber is currently crawling the engines for expired items
+        Crawling,
         /// The scrubber task is stopped (returning from main)
         Stopped
     };
@@ -104,6 +107,12 @@ private:
      */
     std::condition_variable cvar;
 
+    /**
+     * How long the task waits for work before it crawls all of the
+     * engines for expired items.
+     */
+    const std::chrono::seconds crawlInterval{1};
+
     /**
      * The identifier to the thread handle
      */
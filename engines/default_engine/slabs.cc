@@ -12,11 +12,15 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <platform/cb_malloc.h>
+#include <utilities/thread_slot.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <inttypes.h>
 #include <stdarg.h>
+#include <algorithm>
+#include <atomic>
+#include <vector>
 
 #ifdef VALGRIND
 // switch to malloc if VALGRIND so we can get some useful insight.
@@ -140,6 +144,14 @@ ENGINE_ERROR_CODE slabs_init(struct default_engine *engine,
                     engine->slabs.slabclass[i].perslab);
     }
 
+#ifndef USE_SYSTEM_MALLOC
+    for (i = POWER_SMALLEST; i <= int(engine->slabs.power_largest); i++) {
+        slabclass_t *p = &engine->slabs.slabclass[i];
+        p->cache_limit = std::min(unsigned(SLAB_CACHE_CHUNKS),
+                                  unsigned(SLAB_CACHE_BYTES / p->size));
+    }
+#endif
+
     /* for the test suite:  faking of how much we've already malloc'd */
     {
         char *t_initial_malloc = getenv("T_MEMD_INITIAL_MALLOC");
@@ -219,6 +231,37 @@ static int do_slabs_newslab(struct default_engine *engine, const unsigned int id
     return 1;
 }
 
+/*
+ * Take a free chunk from the slab class (without counting it as requested)
+ * 0 if we don't have more memory available
+ */
+static void *do_slabs_alloc_chunk(struct default_engine *engine, unsigned int id) {
+    slabclass_t *p = &engine->slabs.slabclass[id];
+    void *ret = NULL;
+
+    /* fail unless we have space at the end of a recently allocated page,
+       we have something on our freelist, or we could allocate a new page */
+    if (! (p->end_page_ptr != 0 || p->sl_curr != 0 ||
+           do_slabs_newslab(engine, id) != 0)) {
+        /* We don't have more memory available */
+        ret = NULL;
+    } else if (p->sl_curr != 0) {
+        /* return off our freelist */
+        ret = p->slots[--p->sl_curr];
+    } else {
+        /* if we recently allocated a whole page, return from that */
+        cb_assert(p->end_page_ptr != NULL);
+        ret = p->end_page_ptr;
+        if (--p->end_page_free != 0) {
+            p->end_page_ptr = ((unsigned char *)p->end_page_ptr) + p->size;
+        } else {
+            p->end_page_ptr = 0;
+        }
+    }
+
+    return ret;
+}
+
 /*@null@*/
 static void *do_slabs_alloc(struct default_engine *engine, const size_t size, unsigned int id) {
     slabclass_t *p;
@@ -242,25 +285,7 @@ static void *do_slabs_alloc(struct default_engine *engine, const size_t size, un
     return ret;
 #endif
 
-    /* fail unless we have space at the end of a recently allocated page,
-       we have something on our freelist, or we could allocate a new page */
-    if (! (p->end_page_ptr != 0 || p->sl_curr != 0 ||
-           do_slabs_newslab(engine, id) != 0)) {
-        /* We don't have more memory available */
-        ret = NULL;
-    } else if (p->sl_curr != 0) {
-        /* return off our freelist */
-        ret = p->slots[--p->sl_curr];
-    } else {
-        /* if we recently allocated a whole page, return from that */
-        cb_assert(p->end_page_ptr != NULL);
-        ret = p->end_page_ptr;
-        if (--p->end_page_free != 0) {
-            p->end_page_ptr = ((unsigned char *)p->end_page_ptr) + p->size;
-        } else {
-            p->end_page_ptr = 0;
-        }
-    }
+    ret = do_slabs_alloc_chunk(engine, id);
 
     if (ret) {
         p->requested += size;
@@ -272,6 +297,26 @@ static void *do_slabs_alloc(struct default_engine *engine, const size_t size, un
     return ret;
 }
 
+/*
+ * Put a chunk back on the freelist of the slab class (without changing
+ * the requested bytes). Returns false if the freelist couldn't grow.
+ */
+static bool do_slabs_free_chunk(struct default_engine *engine, void *ptr, unsigned int id) {
+    slabclass_t *p = &engine->slabs.slabclass[id];
+
+    if (p->sl_curr == p->sl_total) { /* need more space on the free list */
+        int new_size = (p->sl_total != 0) ? p->sl_total * 2 : 16;  /* 16 is arbitrary */
+        void **new_slots = static_cast<void**>(cb_realloc(p->slots,
+                                               new_size * sizeof(void *)));
+        if (new_slots == 0)
+            return false;
+        p->slots = new_slots;
+        p->sl_total = new_size;
+    }
+    p->slots[p->sl_curr++] = ptr;
+    return true;
+}
+
 static void do_slabs_free(struct default_engine *engine, void *ptr, const size_t size, unsigned int id) {
     slabclass_t *p;
 
@@ -287,20 +332,85 @@ static void do_slabs_free(struct default_engine *engine, void *ptr, const size_t
     return;
 #endif
 
-    if (p->sl_curr == p->sl_total) { /* need more space on the free list */
-        int new_size = (p->sl_total != 0) ? p->sl_total * 2 : 16;  /* 16 is arbitrary */
-        void **new_slots = static_cast<void**>(cb_realloc(p->slots,
-                                               new_size * sizeof(void *)));
-        if (new_slots == 0)
-            return;
-        p->slots = new_slots;
-        p->sl_total = new_size;
+    if (do_slabs_free_chunk(engine, ptr, id)) {
+        p->requested -= size;
     }
-    p->slots[p->sl_curr++] = ptr;
-    p->requested -= size;
     return;
 }
 
+/* Get the slab cache used by the calling thread */
+static slabcache_t *get_slab_cache(struct default_engine *engine) {
+    return &engine->slabs.caches[cb::getThreadSlot() % SLAB_CACHES];
+}
+
+/*
+ * Get the cache for the given slab class (allocating it on first use), or
+ * 0 if the class isn't cached. The cache lock is assumed to be held by the
+ * caller.
+ */
+static slabcache_class_t *do_slabs_cache_class(struct default_engine *engine,
+                                               slabcache_t *cache,
+                                               unsigned int id) {
+    if (id < POWER_SMALLEST || id > engine->slabs.power_largest ||
+        engine->slabs.slabclass[id].cache_limit == 0) {
+        return NULL;
+    }
+
+    if (cache->classes[id] == NULL) {
+        cache->classes[id] = static_cast<slabcache_class_t*>
+            (cb_calloc(1, sizeof(slabcache_class_t)));
+    }
+    return cache->classes[id];
+}
+
+/* The number of chunks moved between a cache and its slab class at a time */
+static unsigned int slabs_cache_batch(struct default_engine *engine, unsigned int id) {
+    return std::max(1u, engine->slabs.slabclass[id].cache_limit / 2);
+}
+
+/*
+ * Move a batch of free chunks from the slab class to the cache, and
+ * add the bytes requested from the cache to the slab class.
+ * The cache lock is assumed to be held by the caller.
+ */
+static void do_slabs_cache_refill(struct default_engine *engine,
+                                  slabcache_class_t *c,
+                                  unsigned int id) {
+    const unsigned int batch = slabs_cache_batch(engine, id);
+    cb_mutex_enter(&engine->slabs.lock);
+    while (c->count < batch) {
+        void *chunk = do_slabs_alloc_chunk(engine, id);
+        if (chunk == NULL) {
+            break;
+        }
+        c->chunks[c->count++] = chunk;
+    }
+    engine->slabs.slabclass[id].requested += c->requested;
+    c->requested = 0;
+    cb_mutex_exit(&engine->slabs.lock);
+}
+
+/*
+ * Move a batch of the chunks which have been in the cache the longest
+ * back to the slab class, and add the bytes requested from the cache to
+ * the slab class. The cache lock is assumed to be held by the caller.
+ */
+static void do_slabs_cache_flush(struct default_engine *engine,
+                                 slabcache_class_t *c,
+                                 unsigned int id) {
+    const unsigned int batch = std::min(c->count, slabs_cache_batch(engine, id));
+    cb_mutex_enter(&engine->slabs.lock);
+    for (unsigned int ii = 0; ii < batch; ++ii) {
+        do_slabs_free_chunk(engine, c->chunks[ii], id);
+    }
+    engine->slabs.slabclass[id].requested += c->requested;
+    c->requested = 0;
+    cb_mutex_exit(&engine->slabs.lock);
+
+    c->count -= batch;
+    memmove(c->chunks, c->chunks + batch, c->count * sizeof(void*));
+}
+
 void add_statistics(const void *cookie, ADD_STAT add_stats,
                     const char* prefix, int num, const char *key,
                     const char *fmt, ...) {
@@ -349,7 +459,8 @@ void add_statistics(const void *cookie, ADD_STAT add_stats,
 }
 
 /*@null@*/
-static void do_slabs_stats(struct default_engine *engine, ADD_STAT add_stats, const void *cookie) {
+static void do_slabs_stats(struct default_engine *engine, ADD_STAT add_stats, const void *cookie,
+                           const unsigned int *cached, const int64_t *cached_requested) {
     unsigned int i;
     unsigned int total = 0;
 
@@ -369,14 +480,16 @@ static void do_slabs_stats(struct default_engine *engine, ADD_STAT add_stats, co
             add_statistics(cookie, add_stats, NULL, i, "total_chunks", "%u",
                            slabs * perslab);
             add_statistics(cookie, add_stats, NULL, i, "used_chunks", "%u",
-                           slabs*perslab - p->sl_curr - p->end_page_free);
+                           slabs*perslab - p->sl_curr - p->end_page_free - cached[i]);
             add_statistics(cookie, add_stats, NULL, i, "free_chunks", "%u",
                            p->sl_curr);
             add_statistics(cookie, add_stats, NULL, i, "free_chunks_end", "%u",
                            p->end_page_free);
+            add_statistics(cookie, add_stats, NULL, i, "cached_chunks", "%u",
+                           cached[i]);
             add_statistics(cookie, add_stats, NULL, i, "mem_requested",
                            "%" PRIu64,
-                           (uint64_t)p->requested);
+                           (uint64_t)(p->requested + cached_requested[i]));
             total++;
         }
     }
@@ -419,6 +532,26 @@ static void *memory_allocate(struct default_engine *engine, size_t size) {
 
 void *slabs_alloc(struct default_engine *engine, size_t size, unsigned int id) {
     void *ret;
+    slabcache_t *cache = get_slab_cache(engine);
+    slabcache_class_t *c;
+
+    cb_mutex_enter(&cache->lock);
+    if ((c = do_slabs_cache_class(engine, cache, id)) != NULL) {
+        if (c->count == 0) {
+            do_slabs_cache_refill(engine, c, id);
+        }
+        if (c->count != 0) {
+            ret = c->chunks[--c->count];
+            c->requested += size;
+            MEMCACHED_SLABS_ALLOCATE(size, id, engine->slabs.slabclass[id].size, ret);
+        } else {
+            ret = NULL;
+            MEMCACHED_SLABS_ALLOCATE_FAILED(size, id);
+        }
+        cb_mutex_exit(&cache->lock);
+        return ret;
+    }
+    cb_mutex_exit(&cache->lock);
 
     cb_mutex_enter(&engine->slabs.lock);
     ret = do_slabs_alloc(engine, size, id);
@@ -427,14 +560,44 @@ void *slabs_alloc(struct default_engine *engine, size_t size, unsigned int id) {
 }
 
 void slabs_free(struct default_engine *engine, void *ptr, size_t size, unsigned int id) {
+    slabcache_t *cache = get_slab_cache(engine);
+    slabcache_class_t *c;
+
+    cb_mutex_enter(&cache->lock);
+    if ((c = do_slabs_cache_class(engine, cache, id)) != NULL) {
+        MEMCACHED_SLABS_DEALLOCATE(size, id, ptr);
+        if (c->count == engine->slabs.slabclass[id].cache_limit) {
+            do_slabs_cache_flush(engine, c, id);
+        }
+        c->chunks[c->count++] = ptr;
+        c->requested -= size;
+        cb_mutex_exit(&cache->lock);
+        return;
+    }
+    cb_mutex_exit(&cache->lock);
+
     cb_mutex_enter(&engine->slabs.lock);
     do_slabs_free(engine, ptr, size, id);
     cb_mutex_exit(&engine->slabs.lock);
 }
 
 void slabs_stats(struct default_engine *engine, ADD_STAT add_stats, const void *c) {
+    /* The chunks in the caches are free, but not on the freelists */
+    std::vector<unsigned int> cached(MAX_NUMBER_OF_SLAB_CLASSES);
+    std::vector<int64_t> cached_requested(MAX_NUMBER_OF_SLAB_CLASSES);
+    for (auto& cache : engine->slabs.caches) {
+        cb_mutex_enter(&cache.lock);
+        for (unsigned int ii = POWER_SMALLEST; ii <= engine->slabs.power_largest; ii++) {
+            if (cache.classes[ii] != NULL) {
+                cached[ii] += cache.classes[ii]->count;
+                cached_requested[ii] += cache.classes[ii]->requested;
+            }
+        }
+        cb_mutex_exit(&cache.lock);
+    }
+
     cb_mutex_enter(&engine->slabs.lock);
-    do_slabs_stats(engine, add_stats, c);
+    do_slabs_stats(engine, add_stats, c, cached.data(), cached_requested.data());
     cb_mutex_exit(&engine->slabs.lock);
 }
 
@@ -473,4 +636,11 @@ void slabs_destroy(struct default_engine *e)
         cb_free(p->slots);
         cb_free(p->slab_list);
     }
+
+    /* Release the thread caches */
+    for (auto& cache : e->slabs.caches) {
+        for (jj = POWER_SMALLEST; jj <= e->slabs.power_largest; jj++) {
+            cb_free(cache.classes[jj]);
+        }
+    }
 }
@@ -24,8 +24,39 @@ typedef struct {
 
     unsigned int killing;  /* index+1 of dying slab, or zero if none */
     size_t requested; /* The number of requested bytes */
+
+    unsigned int cache_limit; /* max chunks in each thread cache, 0 = uncached */
 } slabclass_t;
 
+/*
+ * Each thread allocates from (and frees to) its own cache of free chunks,
+ * and only grabs the slab lock to move a batch of chunks between its cache
+ * and the slab class. The threads are spread over a fixed number of caches,
+ * each with its own lock which is uncontended unless more threads than
+ * caches use the engine.
+ */
+#define SLAB_CACHES 16
+
+/*
+ * The most chunks (and bytes) a cache holds for a slab class; the large
+ * slab classes aren't cached at all, as that could hide most of their
+ * memory in the caches.
+ */
+#define SLAB_CACHE_CHUNKS 32
+#define SLAB_CACHE_BYTES (32 * 1024)
+
+typedef struct {
+    unsigned int count;   /* number of free chunks in the cache */
+    int64_t requested;    /* requested bytes not yet added to the class */
+    void *chunks[SLAB_CACHE_CHUNKS];
+} slabcache_class_t;
+
+typedef struct {
+    /* the cache for each slab class, allocated on first use */
+    slabcache_class_t *classes[MAX_NUMBER_OF_SLAB_CLASSES];
+    cb_mutex_t lock;
+} slabcache_t;
+
 struct slabs {
    slabclass_t slabclass[MAX_NUMBER_OF_SLAB_CLASSES];
    size_t mem_limit;
@@ -42,6 +73,8 @@ struct slabs {
       size_t size;
    } allocs;
 
+   slabcache_t caches[SLAB_CACHES];
+
    /**
     * Access to the slab allocator is protected by this lock
     */
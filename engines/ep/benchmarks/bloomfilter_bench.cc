@@ -0,0 +1,101 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2017 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+/*
+ * Benchmarks comparing the standard and blocked layouts of BloomFilter, for
+ * filters sized from the default bfilter_key_count up to 50M keys per
+ * vBucket.
+ */
+
+#include "bloomfilter.h"
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+/**
+ * BloomFilter sized for the given number of keys, with its bits set at
+ * random to the ~50% density of a fully loaded filter - adding 50M keys
+ * one at a time would dominate the benchmark run time.
+ */
+class LoadedBloomFilter : public BloomFilter {
+public:
+    LoadedBloomFilter(size_t keyCount, bool blocked)
+        : BloomFilter(keyCount, 0.01, BFILTER_ENABLED, blocked) {
+        std::mt19937_64 gen(0);
+        if (blocked) {
+            for (size_t w = 0; w < numBlocks * wordsPerBlock; w++) {
+                blocks[w] = gen();
+            }
+        } else {
+            uint64_t bits = 0;
+            for (size_t i = 0; i < bitArray.size(); i++) {
+                if (i % 64 == 0) {
+                    bits = gen();
+                }
+                bitArray[i] = (bits >> (i % 64)) & 1;
+            }
+        }
+    }
+};
+
+/// Keys which are (almost certainly) not in the filter - i.e. GET misses.
+static std::vector<StoredDocKey> makeKeys() {
+    std::vector<StoredDocKey> keys;
+    for (size_t i = 0; i < 64 * 1024; i++) {
+        keys.emplace_back("absent_key_" + std::to_string(i),
+                          DocNamespace::DefaultCollection);
+    }
+    return keys;
+}
+
+/// Check for keys which are not present (as a full-eviction GET miss does).
+template <bool Blocked>
+static void BM_BloomFilterMaybeKeyExists(benchmark::State& state) {
+    LoadedBloomFilter filter(state.range(0), Blocked);
+    const auto keys = makeKeys();
+    size_t i = 0;
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(filter.maybeKeyExists(keys[i]));
+        i = (i + 1) % keys.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/// Add keys to the filter (as every mutation does).
+template <bool Blocked>
+static void BM_BloomFilterAddKey(benchmark::State& state) {
+    LoadedBloomFilter filter(state.range(0), Blocked);
+    const auto keys = makeKeys();
+    size_t i = 0;
+    while (state.KeepRunning()) {
+        filter.addKey(keys[i]);
+        i = (i + 1) % keys.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/// 10k (the bfilter_key_count default), 1M and 50M keys per vBucket.
+static void KeyCounts(benchmark::internal::Benchmark* b) {
+    b->Arg(10000)->Arg(1000000)->Arg(50000000);
+}
+
+BENCHMARK_TEMPLATE(BM_BloomFilterMaybeKeyExists, false)->Apply(KeyCounts);
+BENCHMARK_TEMPLATE(BM_BloomFilterMaybeKeyExists, true)->Apply(KeyCounts);
+BENCHMARK_TEMPLATE(BM_BloomFilterAddKey, false)->Apply(KeyCounts);
+BENCHMARK_TEMPLATE(BM_BloomFilterAddKey, true)->Apply(KeyCounts);
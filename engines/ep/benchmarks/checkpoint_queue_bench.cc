@@ -0,0 +1,113 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2017 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+/*
+ * Benchmarks comparing the CheckpointQueue (ChunkedQueue) against the
+ * std::list it replaced, for the access patterns used by Checkpoint.
+ */
+
+#include "checkpoint.h"
+
+#include <benchmark/benchmark.h>
+
+#include <list>
+#include <vector>
+
+/// Create N items with distinct keys (shared by all queues under test).
+static std::vector<queued_item> makeItems(size_t n) {
+    std::vector<queued_item> items;
+    for (size_t i = 0; i < n; i++) {
+        auto key = std::string("key_") + std::to_string(i);
+        items.emplace_back(
+                new Item(DocKey(key, DocNamespace::DefaultCollection),
+                         {},
+                         {},
+                         "data",
+                         4,
+                         PROTOCOL_BINARY_RAW_BYTES,
+                         0,
+                         i + 1));
+    }
+    return items;
+}
+
+/// Append N items to an empty queue (as queueDirty does for new keys).
+template <typename Queue>
+static void BM_QueuePushBack(benchmark::State& state) {
+    const auto items = makeItems(state.range(0));
+    while (state.KeepRunning()) {
+        Queue queue;
+        for (const auto& qi : items) {
+            queue.push_back(qi);
+        }
+        benchmark::DoNotOptimize(queue.back());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/// Walk all items in the queue (as a cursor does in getItemsForCursor).
+template <typename Queue>
+static void BM_QueueIterate(benchmark::State& state) {
+    const auto items = makeItems(state.range(0));
+    Queue queue;
+    for (const auto& qi : items) {
+        queue.push_back(qi);
+    }
+    while (state.KeepRunning()) {
+        int64_t sum = 0;
+        for (const auto& qi : queue) {
+            sum += qi->getBySeqno();
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/// De-duplicate every item: erase the existing entry and append the new
+/// version (as queueDirty does for existing keys).
+template <typename Queue>
+static void BM_QueueDeduplicate(benchmark::State& state) {
+    const auto items = makeItems(state.range(0));
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        Queue queue;
+        std::vector<typename Queue::iterator> positions;
+        for (const auto& qi : items) {
+            queue.push_back(qi);
+            positions.push_back(std::prev(queue.end()));
+        }
+        state.ResumeTiming();
+
+        for (size_t i = 0; i < items.size(); ++i) {
+            queue.push_back(items[i]);
+            queue.erase(positions[i]);
+        }
+        benchmark::DoNotOptimize(queue.back());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(BM_QueuePushBack, std::list<queued_item>)
+        ->Range(64, 64 * 1024);
+BENCHMARK_TEMPLATE(BM_QueuePushBack, CheckpointQueue)->Range(64, 64 * 1024);
+BENCHMARK_TEMPLATE(BM_QueueIterate, std::list<queued_item>)
+        ->Range(64, 64 * 1024);
+BENCHMARK_TEMPLATE(BM_QueueIterate, CheckpointQueue)->Range(64, 64 * 1024);
+BENCHMARK_TEMPLATE(BM_QueueDeduplicate, std::list<queued_item>)
+        ->Range(64, 64 * 1024);
+BENCHMARK_TEMPLATE(BM_QueueDeduplicate, CheckpointQueue)
+        ->Range(64, 64 * 1024);
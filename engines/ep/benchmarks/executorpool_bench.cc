@@ -0,0 +1,176 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2017 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+/*
+ * Benchmarks for the ExecutorPool scheduler - how quickly a burst of short
+ * NonIO tasks (as the checkpoint processor and notifier tasks of many
+ * vBuckets generate) gets through the pool, with and without work
+ * stealing; and the cost of snoozing and waking tasks in the future queue.
+ */
+
+#include "executorpool.h"
+#include "executorthread.h"
+#include "futurequeue.h"
+#include "globaltask.h"
+#include "taskable.h"
+#include "timerwheel.h"
+#include "workload.h"
+
+#include "tests/module_tests/lambda_task.h"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <random>
+#include <vector>
+
+class BenchTaskable : public Taskable {
+public:
+    BenchTaskable()
+        : name("executorpool_bench"), policy(HIGH_BUCKET_PRIORITY, 1) {
+    }
+
+    const std::string& getName() const override {
+        return name;
+    }
+
+    task_gid_t getGID() const override {
+        return 0;
+    }
+
+    bucket_priority_t getWorkloadPriority() const override {
+        return HIGH_BUCKET_PRIORITY;
+    }
+
+    void setWorkloadPriority(bucket_priority_t prio) override {
+    }
+
+    WorkLoadPolicy& getWorkLoadPolicy() override {
+        return policy;
+    }
+
+    void logQTime(TaskId id, const ProcessClock::duration enqTime) override {
+    }
+
+    void logRunTime(TaskId id, const ProcessClock::duration runTime) override {
+    }
+
+private:
+    const std::string name;
+    WorkLoadPolicy policy;
+};
+
+/// ExecutorPool with one thread of each IO type, and the given number of
+/// NonIO threads.
+class BenchExecutorPool : public ExecutorPool {
+public:
+    BenchExecutorPool(size_t numNonIO, bool workStealing)
+        : ExecutorPool(numNonIO + 3,
+                       NUM_TASK_GROUPS,
+                       1, // MaxNumReaders
+                       1, // MaxNumWriters
+                       1, // MaxNumAuxio
+                       numNonIO,
+                       workStealing) {
+    }
+};
+
+/*
+ * Schedule one short NonIO task per vBucket and wait for all of them to
+ * run.
+ * Variables:
+ *  - range(0) : Scheduler (0: shared task queues, 1: work stealing)
+ *  - range(1) : The number of NonIO threads
+ */
+static void BM_ExecutorPoolNonIOBurst(benchmark::State& state) {
+    const size_t numTasks = 1024;
+    BenchExecutorPool pool(state.range(1), state.range(0) != 0);
+    BenchTaskable taskable;
+    pool.registerTaskable(taskable);
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::atomic<size_t> remaining;
+    auto func = [&mutex, &cv, &remaining]() {
+        if (--remaining == 0) {
+            std::lock_guard<std::mutex> lh(mutex);
+            cv.notify_one();
+        }
+        return false;
+    };
+
+    while (state.KeepRunning()) {
+        remaining = numTasks;
+        for (size_t i = 0; i < numTasks; ++i) {
+            pool.schedule(std::make_shared<LambdaTask>(
+                    taskable, TaskId::ItemPager, 0, true, func));
+        }
+        std::unique_lock<std::mutex> lh(mutex);
+        cv.wait(lh, [&remaining] { return remaining == 0; });
+    }
+    state.SetLabel(state.range(0) ? "WorkStealing" : "SharedQueues");
+    state.SetItemsProcessed(state.iterations() * numTasks);
+
+    pool.unregisterTaskable(taskable, false);
+}
+
+static void SchedulerArguments(benchmark::internal::Benchmark* b) {
+    for (int threads : {2, 4, 8}) {
+        b->ArgPair(0, threads);
+        b->ArgPair(1, threads);
+    }
+}
+
+BENCHMARK(BM_ExecutorPoolNonIOBurst)->Apply(SchedulerArguments)->UseRealTime();
+
+/*
+ * Snooze one task and wake another in a future queue of N periodically
+ * snoozing tasks (as DCP connection notifiers, backfill managers and item
+ * pagers do).
+ * Variables:
+ *  - range(0) : The number of tasks in the queue
+ */
+template <typename Queue>
+static void BM_FutureQueueSnoozeWake(benchmark::State& state) {
+    BenchTaskable taskable;
+    Queue queue;
+    std::vector<ExTask> tasks;
+    for (int i = 0; i < state.range(0); ++i) {
+        tasks.push_back(std::make_shared<LambdaTask>(
+                taskable, TaskId::ItemPager, 1 + (i % 60), false, []() {
+                    return false;
+                }));
+        queue.push(tasks.back());
+    }
+
+    std::mt19937 gen;
+    std::uniform_int_distribution<size_t> dist(0, tasks.size() - 1);
+    while (state.KeepRunning()) {
+        queue.snooze(tasks[dist(gen)], 60);
+        queue.updateWaketime(tasks[dist(gen)], ProcessClock::now());
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+
+BENCHMARK_TEMPLATE(BM_FutureQueueSnoozeWake, FutureQueue<>)
+        ->Arg(1000)
+        ->Arg(10000);
+BENCHMARK_TEMPLATE(BM_FutureQueueSnoozeWake, TimerWheel)
+        ->Arg(1000)
+        ->Arg(10000);
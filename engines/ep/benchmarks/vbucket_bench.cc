@@ -22,6 +22,9 @@
 #include "benchmark_memory_tracker.h"
 #include "checkpoint.h"
 #include "engine_fixture.h"
+#include "hash_table.h"
+#include "stats.h"
+#include "stored_value_factories.h"
 
 #include <mock/mock_synchronous_ep_engine.h>
 
@@ -77,3 +80,82 @@ BENCHMARK_DEFINE_F(VBucketBench, FlushVBucket)(benchmark::State& state) {
 BENCHMARK_REGISTER_F(VBucketBench, FlushVBucket)
         ->RangeMultiplier(10)
         ->Range(1, 1000000);
+
+/**
+ * Compares HashTable lookups using the chained (IndexType::Chained) and
+ * tagged (IndexType::Tagged) bucket index.
+ *
+ * Arguments are: {item count, index type, load factor (items per bucket)}.
+ */
+class HashTableBench : public benchmark::Fixture {
+protected:
+    void SetUp(const benchmark::State& state) override {
+        const auto itemCount = state.range(0);
+        const auto indexType = static_cast<HashTable::IndexType>(state.range(1));
+        const auto loadFactor = state.range(2);
+        ht = std::make_unique<HashTable>(
+                stats,
+                std::make_unique<StoredValueFactory>(stats),
+                std::max(int64_t(1), itemCount / loadFactor),
+                /*locks*/ 47,
+                indexType);
+        for (int i = 0; i < itemCount; ++i) {
+            keys.push_back(makeKey(i));
+            Item item(keys.back(), 0, 0, "value", 5);
+            ht->set(item);
+        }
+    }
+
+    void TearDown(const benchmark::State& state) override {
+        ht.reset();
+        keys.clear();
+    }
+
+    static StoredDocKey makeKey(int i) {
+        return StoredDocKey(std::string("key") + std::to_string(i),
+                            DocNamespace::DefaultCollection);
+    }
+
+    EPStats stats;
+    std::unique_ptr<HashTable> ht;
+    std::vector<StoredDocKey> keys;
+};
+
+BENCHMARK_DEFINE_F(HashTableBench, FindHit)(benchmark::State& state) {
+    size_t i = 0;
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(ht->find(keys[i++ % keys.size()],
+                                          TrackReference::No,
+                                          WantsDeleted::No));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_DEFINE_F(HashTableBench, FindMiss)(benchmark::State& state) {
+    // Keys beyond the populated range are never present.
+    std::vector<StoredDocKey> missing;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        missing.push_back(makeKey(keys.size() + i));
+    }
+    size_t i = 0;
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(ht->find(missing[i++ % missing.size()],
+                                          TrackReference::No,
+                                          WantsDeleted::No));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void HashTableBenchArgs(benchmark::internal::Benchmark* b) {
+    for (auto type : {HashTable::IndexType::Chained,
+                      HashTable::IndexType::Tagged}) {
+        for (int items : {10000, 1000000}) {
+            for (int loadFactor : {1, 4}) {
+                b->Args({items, static_cast<int>(type), loadFactor});
+            }
+        }
+    }
+}
+
+BENCHMARK_REGISTER_F(HashTableBench, FindHit)->Apply(HashTableBenchArgs);
+BENCHMARK_REGISTER_F(HashTableBench, FindMiss)->Apply(HashTableBenchArgs);
@@ -25,6 +25,7 @@
 #include "access_scanner.h"
 #include "ep_time.h"
 #include "hash_table.h"
+#include "indexed_access_log.h"
 #include "kv_bucket.h"
 #include "mutation_log.h"
 #include "stats.h"
@@ -51,7 +52,8 @@ public:
           stateFinalizer(sfin),
           as(aS),
           items_scanned(0),
-          items_to_scan(items_to_scan) {
+          items_to_scan(items_to_scan),
+          useHotKeys(conf.getAlogSketchSize() != 0) {
         name = conf.getAlogPath();
         std::stringstream s;
         s << shardID;
@@ -59,6 +61,19 @@ public:
         prev = name + ".old";
         next = name + ".next";
 
+        if (conf.isAlogIndexed()) {
+            indexedLog = std::make_unique<IndexedAccessLog::Writer>(next);
+            if (!indexedLog->open()) {
+                LOG(EXTENSION_LOG_WARNING, "Failed to open access log: '%s'",
+                    next.c_str());
+                indexedLog.reset();
+            } else {
+                LOG(EXTENSION_LOG_NOTICE, "Attempting to generate new indexed "
+                    "access file '%s'", next.c_str());
+            }
+            return;
+        }
+
         log = std::make_unique<MutationLog>(next, conf.getAlogBlockSize());
         log->open();
         if (!log->isOpen()) {
@@ -72,7 +87,7 @@ public:
     }
 
     bool visit(const HashTable::HashBucketLock& lh, StoredValue& v) override {
-        if (log && v.isResident()) {
+        if ((log || indexedLog) && v.isResident()) {
             if (v.isExpired(startTime) || v.isDeleted()) {
                 LOG(EXTENSION_LOG_INFO,
                     "INFO: Skipping expired/deleted item: %" PRIu64,
@@ -98,6 +113,16 @@ public:
         currentBucket = vb;
         update();
 
+        if (useHotKeys) {
+            visitBucketHotKeys(*vb);
+            return;
+        }
+
+        if (indexedLog) {
+            visitBucketIndexed(*vb);
+            return;
+        }
+
         if (log == nullptr) {
             return;
         }
@@ -115,13 +140,27 @@ public:
 
     void complete() override {
 
-        if (log == nullptr) {
+        if (log == nullptr && indexedLog == nullptr) {
             updateStateFinalizer(false);
         } else {
-            size_t num_items = log->itemsLogged[int(MutationLogType::New)];
-            log->commit1();
-            log->commit2();
-            log.reset();
+            size_t num_items;
+            if (indexedLog) {
+                num_items = indexedLog->getNumKeys();
+                const bool committed = indexedLog->commit();
+                indexedLog.reset();
+                if (!committed) {
+                    LOG(EXTENSION_LOG_WARNING, "Failed to write access log "
+                        "file '%s'", next.c_str());
+                    remove(next.c_str());
+                    updateStateFinalizer(false);
+                    return;
+                }
+            } else {
+                num_items = log->itemsLogged[int(MutationLogType::New)];
+                log->commit1();
+                log->commit2();
+                log.reset();
+            }
             stats.alogRuntime.store(ep_real_time() - startTime);
             stats.alogNumItems.store(num_items);
             stats.accessScannerHisto.add(
@@ -172,6 +211,43 @@ public:
     }
 
 private:
+    /**
+     * Visit all of the vBucket's resident items, then write them to the
+     * indexed access log as the vBucket's section (which is sorted, so needs
+     * all of the vBucket's keys).
+     */
+    void visitBucketIndexed(VBucket& vb) {
+        if (!vBucketFilter(vb.getId())) {
+            return;
+        }
+        HashTable::Position ht_start;
+        while (ht_start != vb.ht.endPosition()) {
+            ht_start = vb.ht.pauseResumeVisit(*this, ht_start);
+            items_scanned = 0;
+        }
+        indexedLog->addVBucket(vb.getId(), accessed);
+        accessed.clear();
+    }
+
+    /**
+     * Write the keys held by the vBucket's hot key sketch, rather than
+     * visiting its resident items.
+     */
+    void visitBucketHotKeys(VBucket& vb) {
+        if (!vBucketFilter(vb.getId()) || (!log && !indexedLog)) {
+            return;
+        }
+        vb.ht.getHotKeys(accessed);
+        if (indexedLog) {
+            indexedLog->addVBucket(vb.getId(), accessed);
+            accessed.clear();
+        } else {
+            update();
+            log->commit1();
+            log->commit2();
+        }
+    }
+
     /**
      * Finalizer method called at the end of completing a visit.
      * @param created_log: Did we successfully create a MutationLog object on
@@ -205,6 +281,7 @@ private:
     std::vector<StoredDocKey> accessed;
 
     std::unique_ptr<MutationLog> log;
+    std::unique_ptr<IndexedAccessLog::Writer> indexedLog;
     std::atomic<bool> &stateFinalizer;
     AccessScanner &as;
 
@@ -213,6 +290,9 @@ private:
     // The number of items to scan before we pause
     const uint64_t items_to_scan;
 
+    // Write the vBuckets' hot key sketches instead of visiting their items
+    const bool useHotKeys;
+
     VBucketPtr currentBucket;
 };
 
@@ -339,6 +419,28 @@ bool AccessScanner::run() {
     return true;
 }
 
+void AccessScanner::writeHotKeys() {
+    bool inverse = true;
+    if (!available.compare_exchange_strong(inverse, false)) {
+        LOG(EXTENSION_LOG_NOTICE, "Not writing hot keys as the access scanner "
+            "is already running");
+        return;
+    }
+    completedCount = 0;
+
+    for (size_t i = 0; i < store.getVBuckets().getNumShards(); i++) {
+        ItemAccessVisitor visitor(
+                store, conf, stats, i, available, *this, maxStoredItems);
+        for (auto vbid : store.getVBuckets().getShard(i)->getVBuckets()) {
+            VBucketPtr vb = store.getVBucket(vbid);
+            if (vb) {
+                visitor.visitBucket(vb);
+            }
+        }
+        visitor.complete();
+    }
+}
+
 void AccessScanner::updateAlogTime(double sleepSecs) {
     struct timeval _waketime;
     gettimeofday(&_waketime, NULL);
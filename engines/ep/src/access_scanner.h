@@ -41,6 +41,13 @@ public:
                   bool completeBeforeShutdown = false);
 
     bool run();
+
+    /**
+     * Synchronously write the access logs from the vBuckets' hot key
+     * sketches (see alog_sketch_size), e.g. at shutdown.
+     */
+    void writeHotKeys();
+
     cb::const_char_buffer getDescription();
     std::chrono::microseconds maxExpectedDuration();
 
@@ -61,50 +61,6 @@ void BgFetcher::wakeUpTaskIfSnoozed() {
     }
 }
 
-size_t BgFetcher::doFetch(VBucket::id_type vbId,
-                          vb_bgfetch_queue_t& itemsToFetch) {
-    TRACE_EVENT2("BgFetcher",
-                 "doFetch",
-                 "vbid",
-                 vbId,
-                 "#itemsToFetch",
-                 itemsToFetch.size());
-    ProcessClock::time_point startTime(ProcessClock::now());
-    LOG(EXTENSION_LOG_DEBUG,
-        "BgFetcher is fetching data, vb:%" PRIu16 " numDocs:%" PRIu64 " "
-        "startTime:%" PRIu64,
-        vbId,
-        uint64_t(itemsToFetch.size()),
-        std::chrono::duration_cast<std::chrono::milliseconds>(
-                startTime.time_since_epoch())
-                .count());
-
-    shard->getROUnderlying()->getMulti(vbId, itemsToFetch);
-
-    std::vector<bgfetched_item_t> fetchedItems;
-    for (const auto& fetch : itemsToFetch) {
-        auto& key = fetch.first;
-        const vb_bgfetch_item_ctx_t& bg_item_ctx = fetch.second;
-
-        for (const auto& itm : bg_item_ctx.bgfetched_list) {
-            // We don't want to transfer ownership of itm here as we clean it
-            // up at the end of this method in clearItems()
-            fetchedItems.push_back(std::make_pair(key, itm.get()));
-        }
-    }
-
-    if (fetchedItems.size() > 0) {
-        store->completeBGFetchMulti(vbId, fetchedItems, startTime);
-        stats.getMultiHisto.add(
-                std::chrono::duration_cast<std::chrono::microseconds>(
-                        ProcessClock::now() - startTime),
-                fetchedItems.size());
-        stats.getMultiBatchSizeHisto.add(fetchedItems.size());
-    }
-
-    return fetchedItems.size();
-}
-
 bool BgFetcher::run(GlobalTask *task) {
     // Setup to snooze forever, and *then* clear the pending flag.
     // The ordering of these two statements is important - if we were
@@ -131,7 +87,14 @@ bool BgFetcher::run(GlobalTask *task) {
         pendingVbs.clear();
     }
 
-    size_t num_fetched_items = 0;
+    // Coalesce: drain the outstanding fetches of every pending vBucket in
+    // the shard before issuing any reads, so the whole shard's batch is known
+    // up front. Fetches queued while reading are picked up by the next run
+    // (which they will have woken).
+    ProcessClock::time_point coalesceStart(ProcessClock::now());
+    vb_bgfetch_batch_t batch;
+    batch.reserve(bg_vbs.size());
+    size_t numKeys = 0;
     for (const uint16_t vbId : bg_vbs) {
         VBucketPtr vb = shard->getBucket(vbId);
         if (vb) {
@@ -147,10 +110,81 @@ bool BgFetcher::run(GlobalTask *task) {
 
             auto items = vb->getBGFetchItems();
             if (items.size() > 0) {
-                num_fetched_items += doFetch(vbId, items);
+                numKeys += items.size();
+                batch.emplace_back(vbId, std::move(items));
             }
         }
     }
+    if (batch.empty()) {
+        return true;
+    }
+    stats.bgFetchCoalesceHisto.add(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                    ProcessClock::now() - coalesceStart));
+
+    // Read the smallest vBuckets' batches first, so their waiting
+    // connections aren't held up behind larger vBuckets.
+    std::stable_sort(
+            batch.begin(),
+            batch.end(),
+            [](const vb_bgfetch_batch_t::value_type& a,
+               const vb_bgfetch_batch_t::value_type& b) {
+                return a.second.size() < b.second.size();
+            });
+
+    TRACE_EVENT2("BgFetcher",
+                 "getMultiBatch",
+                 "#vbuckets",
+                 batch.size(),
+                 "#itemsToFetch",
+                 numKeys);
+    ProcessClock::time_point startTime(ProcessClock::now());
+    LOG(EXTENSION_LOG_DEBUG,
+        "BgFetcher is fetching data, shard:%" PRIu16 " numVbs:%" PRIu64
+        " numDocs:%" PRIu64 " startTime:%" PRIu64,
+        shard->getId(),
+        uint64_t(batch.size()),
+        uint64_t(numKeys),
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+                startTime.time_since_epoch())
+                .count());
+
+    // Issue the whole shard's batch as a single read, completing each key's
+    // fetches (and notifying their cookies) as soon as it has been read.
+    size_t num_fetched_items = 0;
+    auto completeFetch = [this, startTime, &num_fetched_items](
+                                 uint16_t vbId,
+                                 const StoredDocKey& key,
+                                 vb_bgfetch_item_ctx_t& fetch) {
+        ProcessClock::time_point readTime(ProcessClock::now());
+        stats.bgFetchReadHisto.add(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                        readTime - startTime));
+
+        std::vector<bgfetched_item_t> fetchedItems;
+        for (const auto& itm : fetch.bgfetched_list) {
+            // We don't want to transfer ownership of itm here, it is freed
+            // along with the batch.
+            fetchedItems.push_back(std::make_pair(key, itm.get()));
+        }
+        if (fetchedItems.empty()) {
+            return;
+        }
+        store->completeBGFetchMulti(vbId, fetchedItems, startTime);
+        stats.bgFetchCompleteHisto.add(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                        ProcessClock::now() - readTime));
+        num_fetched_items += fetchedItems.size();
+    };
+    shard->getROUnderlying()->getMultiBatch(batch, completeFetch);
+
+    if (num_fetched_items > 0) {
+        stats.getMultiHisto.add(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                        ProcessClock::now() - startTime),
+                num_fetched_items);
+        stats.getMultiBatchSizeHisto.add(num_fetched_items);
+    }
 
     stats.numRemainingBgItems.fetch_sub(num_fetched_items);
 
@@ -82,8 +82,6 @@ public:
     }
 
 private:
-    size_t doFetch(VBucket::id_type vbId, vb_bgfetch_queue_t& items);
-
     /// If the BGFetch task is currently snoozed (not scheduled to
     /// run), wake it up. Has no effect the if the task has already
     /// been woken.
@@ -21,6 +21,7 @@
 
 #include "murmurhash3.h"
 
+#include <algorithm>
 #include <cmath>
 
 #if __x86_64__ || __ppc64__
@@ -29,19 +30,38 @@
 #define MURMURHASH_3 MurmurHash3_x86_128
 #endif
 
+const size_t BloomFilter::wordsPerBlock;
+const size_t BloomFilter::bitsPerBlock;
+
 BloomFilter::BloomFilter(size_t key_count, double false_positive_prob,
-                         bfilter_status_t new_status) {
+                         bfilter_status_t new_status, bool blocked)
+    : blocked(blocked), blocks(nullptr), numBlocks(0) {
 
     status = new_status;
     filterSize = estimateFilterSize(key_count, false_positive_prob);
     noOfHashes = estimateNoOfHashes(key_count);
     keyCounter = 0;
-    bitArray.assign(filterSize, false);
+    if (blocked) {
+        // Round up to a whole number of blocks (and at least one).
+        numBlocks = std::max(size_t(1),
+                             (filterSize + bitsPerBlock - 1) / bitsPerBlock);
+        filterSize = numBlocks * bitsPerBlock;
+        // Over-allocate by one block, so the blocks can start on a cache
+        // line boundary.
+        blockStorage.assign((numBlocks + 1) * wordsPerBlock, 0);
+        const uintptr_t blockBytes = wordsPerBlock * sizeof(uint64_t);
+        auto addr = reinterpret_cast<uintptr_t>(blockStorage.data());
+        blocks = reinterpret_cast<uint64_t*>((addr + blockBytes - 1) &
+                                             ~(blockBytes - 1));
+    } else {
+        bitArray.assign(filterSize, false);
+    }
 }
 
 BloomFilter::~BloomFilter() {
     status = BFILTER_DISABLED;
     bitArray.clear();
+    blockStorage.clear();
 }
 
 size_t BloomFilter::estimateFilterSize(size_t key_count,
@@ -55,10 +75,43 @@ size_t BloomFilter::estimateNoOfHashes(size_t key_count) {
 }
 
 uint64_t BloomFilter::hashDocKey(const DocKey& key, uint32_t iteration) {
-    uint64_t result = 0;
+    // MurmurHash3 produces a 128-bit hash; only the first half is used.
+    uint64_t result[2] = {0, 0};
     uint32_t seed = iteration + (uint32_t(key.getDocNamespace()) * noOfHashes);
-    MURMURHASH_3(key.data(), key.size(), seed, &result);
-    return result;
+    MURMURHASH_3(key.data(), key.size(), seed, result);
+    return result[0];
+}
+
+uint64_t* BloomFilter::getBlock(const DocKey& key, BlockMask& mask) {
+    // A single hash of the key selects both the block (first half) and the
+    // bits within it (second half); using the namespace as the seed keeps
+    // the same key in different namespaces distinct.
+    uint64_t result[2] = {0, 0};
+    MURMURHASH_3(key.data(), key.size(), uint32_t(key.getDocNamespace()),
+                 result);
+
+    // Derive the bit positions by double hashing; as the stride is odd (and
+    // the block size a power of two) the first bitsPerBlock positions are
+    // all distinct.
+    const uint32_t start = uint32_t(result[1]);
+    const uint32_t stride = uint32_t(result[1] >> 32) | 1;
+    mask.fill(0);
+    for (uint32_t i = 0; i < noOfHashes; i++) {
+        const uint32_t bit = (start + i * stride) % bitsPerBlock;
+        mask[bit / 64] |= uint64_t(1) << (bit % 64);
+    }
+    return blocks + (result[0] % numBlocks) * wordsPerBlock;
+}
+
+bool BloomFilter::blockContains(const uint64_t* block, const BlockMask& mask) {
+    // Deliberately branch-free, so the compiler checks the whole block with
+    // a handful of vector and-not / compare instructions instead of testing
+    // each bit in turn.
+    uint64_t missing = 0;
+    for (size_t w = 0; w < wordsPerBlock; w++) {
+        missing |= mask[w] & ~block[w];
+    }
+    return missing == 0;
 }
 
 void BloomFilter::setStatus(bfilter_status_t to) {
@@ -72,6 +125,8 @@ void BloomFilter::setStatus(bfilter_status_t to) {
             if (to == BFILTER_DISABLED) {
                 status = to;
                 bitArray.clear();
+                blockStorage.clear();
+                blocks = nullptr;
             } else if (to == BFILTER_COMPACTING) {
                 status = to;
             }
@@ -80,6 +135,8 @@ void BloomFilter::setStatus(bfilter_status_t to) {
             if (to == BFILTER_DISABLED) {
                 status = to;
                 bitArray.clear();
+                blockStorage.clear();
+                blocks = nullptr;
             } else if (to == BFILTER_ENABLED) {
                 status = to;
             }
@@ -88,6 +145,8 @@ void BloomFilter::setStatus(bfilter_status_t to) {
             if (to == BFILTER_DISABLED) {
                 status = to;
                 bitArray.clear();
+                blockStorage.clear();
+                blocks = nullptr;
             } else if (to == BFILTER_COMPACTING) {
                 status = to;
             }
@@ -115,6 +174,21 @@ std::string BloomFilter::getStatusString() {
 
 void BloomFilter::addKey(const DocKey& key) {
     if (status == BFILTER_COMPACTING || status == BFILTER_ENABLED) {
+        if (blocked) {
+            BlockMask mask;
+            uint64_t* block = getBlock(key, mask);
+            // As with the standard filter, only count the key if it wasn't
+            // already (possibly falsely) present.
+            const bool overlap = blockContains(block, mask);
+            for (size_t w = 0; w < wordsPerBlock; w++) {
+                block[w] |= mask[w];
+            }
+            if (!overlap) {
+                keyCounter++;
+            }
+            return;
+        }
+
         bool overlap = true;
         for (uint32_t i = 0; i < noOfHashes; i++) {
             uint64_t result = hashDocKey(key, i);
@@ -131,6 +205,12 @@ void BloomFilter::addKey(const DocKey& key) {
 
 bool BloomFilter::maybeKeyExists(const DocKey& key) {
     if (status == BFILTER_COMPACTING || status == BFILTER_ENABLED) {
+        if (blocked) {
+            BlockMask mask;
+            const uint64_t* block = getBlock(key, mask);
+            return blockContains(block, mask);
+        }
+
         for (uint32_t i = 0; i < noOfHashes; i++) {
             uint64_t result = hashDocKey(key, i);
             if (bitArray[result % filterSize] == 0) {
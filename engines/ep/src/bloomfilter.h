@@ -20,6 +20,7 @@
 
 #include "config.h"
 
+#include <array>
 #include <string>
 #include <vector>
 
@@ -37,11 +38,21 @@ enum bfilter_status_t {
  * We are to maintain the vbucket-number of these instances.
  *
  * Each vbucket will hold one such object.
+ *
+ * The filter can either be a standard bloom filter, where each of the
+ * noOfHashes bits for a key is at an independent position in the bit array
+ * (and computed by a separate hash of the key), or a blocked bloom filter.
+ * In the latter the bit array is split into cache-line sized blocks, and all
+ * the bits for a key are in the same block - derived from a single hash of
+ * the key. A lookup therefore costs one hash and one cache miss instead of
+ * noOfHashes of each, in exchange for a slightly higher false positive rate
+ * for the same filter size.
  */
 class BloomFilter {
 public:
     BloomFilter(size_t key_count, double false_positive_prob,
-                bfilter_status_t newStatus = BFILTER_DISABLED);
+                bfilter_status_t newStatus = BFILTER_DISABLED,
+                bool blocked = false);
     ~BloomFilter();
 
     void setStatus(bfilter_status_t to);
@@ -54,19 +65,54 @@ public:
     size_t getNumOfKeysInFilter();
     size_t getFilterSize();
 
+    bool isBlocked() const {
+        return blocked;
+    }
+
 protected:
+    /// Number of 64-bit words in one block of a blocked filter.
+    static const size_t wordsPerBlock = 8;
+    /// Number of bits in one block of a blocked filter (one cache line).
+    static const size_t bitsPerBlock = wordsPerBlock * 64;
+
+    /// Bits which are set for a key within its block.
+    using BlockMask = std::array<uint64_t, wordsPerBlock>;
+
     size_t estimateFilterSize(size_t key_count, double false_positive_prob);
     size_t estimateNoOfHashes(size_t key_count);
 
     uint64_t hashDocKey(const DocKey& key, uint32_t iteration);
 
+    /**
+     * Locate the bits for the given key in a blocked filter.
+     *
+     * @param key The key to locate
+     * @param[out] mask The bits of the key within its block
+     * @return The block the key maps to
+     */
+    uint64_t* getBlock(const DocKey& key, BlockMask& mask);
+
+    /// @return true if all the bits in mask are set in the given block.
+    static bool blockContains(const uint64_t* block, const BlockMask& mask);
+
     size_t filterSize;
     size_t noOfHashes;
 
     size_t keyCounter;
 
     bfilter_status_t status;
+    const bool blocked;
+
+    /// Bit array of a standard filter.
     std::vector<bool> bitArray;
+
+    /// Backing storage of a blocked filter, over-allocated so that the
+    /// blocks can be aligned to a cache line.
+    std::vector<uint64_t> blockStorage;
+    /// First block of a blocked filter (within blockStorage).
+    uint64_t* blocks;
+    /// Number of blocks in a blocked filter.
+    size_t numBlocks;
 };
 
 #endif // SRC_BLOOMFILTER_H_
@@ -90,6 +90,7 @@ Checkpoint::Checkpoint(EPStats& st,
       numItems(0),
       numMetaItems(0),
       memOverhead(0),
+      queueMemOverhead(0),
       effectiveMemUsage(0) {
     stats.memOverhead->fetch_add(memorySize());
     if (stats.memOverhead->load() >= GIGANTOR) {
@@ -127,6 +128,7 @@ void Checkpoint::popBackCheckpointEndItem() {
         toWrite.back()->getOperation() == queue_op::checkpoint_end) {
         metaKeyIndex.erase(toWrite.back()->getKey());
         toWrite.pop_back();
+        updateQueueMemOverhead();
     }
 }
 
@@ -153,6 +155,12 @@ queue_dirty_t Checkpoint::queueDirty(const queued_item &qi,
         }
         rv = NEW_ITEM;
         toWrite.push_back(qi);
+        if (qi->getOperation() == queue_op::checkpoint_start) {
+            // mergePrevCheckpoint() inserts items directly after the
+            // checkpoint_start; keep that at a chunk boundary so the insert
+            // never has to move items which cursors may point at.
+            toWrite.startNewChunk();
+        }
     } else {
         // Check if this checkpoint already had an item for the same key
         if (it != keyIndex.end()) {
@@ -238,8 +246,8 @@ queue_dirty_t Checkpoint::queueDirty(const queued_item &qi,
             keyIndex[qi->getKey()] = entry;
         }
         if (rv == NEW_ITEM) {
-            size_t newEntrySize = qi->getKey().size() +
-                                  sizeof(index_entry) + sizeof(queued_item);
+            // The queued_item itself is accounted for with toWrite's chunks
+            size_t newEntrySize = qi->getKey().size() + sizeof(index_entry);
             memOverhead += newEntrySize;
             stats.memOverhead->fetch_add(newEntrySize);
             if (stats.memOverhead->load() >= GIGANTOR) {
@@ -251,6 +259,10 @@ queue_dirty_t Checkpoint::queueDirty(const queued_item &qi,
         }
     }
 
+    updateQueueMemOverhead();
+
+    checkpointManager->markItemsPublished_UNLOCKED();
+
     // Notify flusher if in case queued item is a checkpoint meta item or
     // vbpersist state.
     if (qi->getOperation() == queue_op::checkpoint_start ||
@@ -286,6 +298,11 @@ size_t Checkpoint::mergePrevCheckpoint(Checkpoint *pPrevCheckpoint) {
     ++itr;
     (*itr)->setBySeqno(seqno);
 
+    // Items from the previous checkpoint to insert after the first two meta
+    // items (empty & checkpoint start); collected in reverse order and then
+    // inserted together.
+    std::vector<queued_item> newItems;
+
     // Iterate in reverse over the previous checkpoints' items, inserting them
     // into the current checkpoint as necessary.
     for (auto rit = pPrevCheckpoint->rbegin(); rit != pPrevCheckpoint->rend();
@@ -298,11 +315,10 @@ size_t Checkpoint::mergePrevCheckpoint(Checkpoint *pPrevCheckpoint) {
             // present then it must be an older revision and hence we can
             // safely discard it).
             if (keyIndex.find(key) == keyIndex.end()) {
-                // Skip the first two meta items (empty & checkpoint start).
-                auto pos = std::next(toWrite.begin(), 2);
-                toWrite.insert(pos, *rit);
+                newItems.push_back(*rit);
+                // Position is updated once the items have been inserted.
                 index_entry entry = {
-                        --pos,
+                        toWrite.end(),
                         static_cast<int64_t>(
                                 pPrevCheckpoint->getMutationIdForKey(key,
                                                                      false))};
@@ -340,12 +356,10 @@ size_t Checkpoint::mergePrevCheckpoint(Checkpoint *pPrevCheckpoint) {
         case queue_op::system_event:
             // Need to re-insert these into the correct place in the index.
             if (metaKeyIndex.find(key) == metaKeyIndex.end()) {
-                // Skip the first two meta items (empty & checkpoint start).
-                auto pos = std::next(toWrite.begin(), 2);
-                toWrite.insert(pos, *rit);
+                newItems.push_back(*rit);
                 auto mutationId = static_cast<int64_t>(
                         pPrevCheckpoint->getMutationIdForKey(key, true));
-                metaKeyIndex[key] = {--pos, mutationId};
+                metaKeyIndex[key] = {toWrite.end(), mutationId};
                 newEntryMemOverhead += key.size() + sizeof(index_entry);
                 ++numMetaItems;
                 ++numNewItems;
@@ -357,6 +371,19 @@ size_t Checkpoint::mergePrevCheckpoint(Checkpoint *pPrevCheckpoint) {
         }
     }
 
+    // Skip the first two meta items (empty & checkpoint start), which are
+    // alone in the first chunk (see queueDirty). The items already in
+    // toWrite aren't moved by the insert, so only the index entries of the
+    // new items need their positions set.
+    auto pos = toWrite.insert(std::next(toWrite.begin(), 2),
+                              newItems.rbegin(),
+                              newItems.rend());
+    for (auto rit = newItems.rbegin(); rit != newItems.rend(); ++rit, ++pos) {
+        auto& index = (*rit)->isCheckPointMetaItem() ? metaKeyIndex : keyIndex;
+        index[(*rit)->getKey()].position = pos;
+    }
+    updateQueueMemOverhead();
+
     /**
      * Update snapshot start of current checkpoint to the first
      * item's sequence number, after merge completed, as items
@@ -391,6 +418,20 @@ uint64_t Checkpoint::getMutationIdForKey(const DocKey& key, bool isMeta) {
     return mid;
 }
 
+void Checkpoint::updateQueueMemOverhead() {
+    const size_t usage = toWrite.getMemoryUsage();
+    if (usage >= queueMemOverhead) {
+        const size_t delta = usage - queueMemOverhead;
+        memOverhead += delta;
+        stats.memOverhead->fetch_add(delta);
+    } else {
+        const size_t delta = queueMemOverhead - usage;
+        memOverhead -= delta;
+        stats.memOverhead->fetch_sub(delta);
+    }
+    queueMemOverhead = usage;
+}
+
 bool Checkpoint::isEligibleToBeUnreferenced() {
     const std::set<std::string> &cursors = getCursorNameList();
     std::set<std::string>::const_iterator cit = cursors.begin();
@@ -428,6 +469,7 @@ CheckpointManager::CheckpointManager(EPStats& st,
       checkpointConfig(config),
       vbucketId(vbucket),
       numItems(0),
+      publishCount(0),
       lastBySeqno(lastSeqno),
       isCollapsedCheckpoint(false),
       pCursorPreCheckpointId(0),
@@ -704,6 +746,7 @@ CursorRegResult CheckpointManager::registerCursorBySeqno(
                 "CheckpointManager::registerCursorBySeqno the sequences number "
                 "is higher than anything currently assigned");
     }
+    markItemsPublished_UNLOCKED();
     return result;
 }
 
@@ -813,6 +856,7 @@ bool CheckpointManager::registerCursor_UNLOCKED(
         (*it)->registerCursorName(name);
     }
 
+    markItemsPublished_UNLOCKED();
     return found;
 }
 
@@ -1358,6 +1402,7 @@ void CheckpointManager::resetCursors(bool resetPersistenceCursor) {
         cit.second.setMetaItemOffset(0);
         checkpointList.front()->registerCursorName(cit.second.name);
     }
+    markItemsPublished_UNLOCKED();
 }
 
 void CheckpointManager::resetCursors(checkpointCursorInfoList &cursors) {
@@ -1475,6 +1520,7 @@ void CheckpointManager::decrCursorFromCheckpointEnd(const std::string &name) {
         (*(it->second.currentPos))->getOperation() ==
         queue_op::checkpoint_end) {
         it->second.decrPos();
+        markItemsPublished_UNLOCKED();
     }
 }
 
@@ -1704,6 +1750,7 @@ void CheckpointManager::collapseCheckpoints(uint64_t id) {
         checkpointList.back()->setState(CHECKPOINT_OPEN);
     }
     putCursorsInCollapsedChk(cursorMap, checkpointList.begin());
+    markItemsPublished_UNLOCKED();
 }
 
 void CheckpointManager::putCursorsInCollapsedChk(
@@ -21,6 +21,7 @@
 #include "config.h"
 
 #include "callbacks.h"
+#include "checkpoint_queue.h"
 #include "ep_types.h"
 #include "item.h"
 #include "monotonic.h"
@@ -59,9 +60,9 @@ enum checkpoint_state {
 
 const char* to_string(enum checkpoint_state);
 
-// List is used for queueing mutations as vector incurs shift operations for
-// deduplication.
-typedef std::list<queued_item> CheckpointQueue;
+// A chunked queue is used for queueing mutations - vector incurs shift
+// operations for deduplication, and list a heap allocation per item.
+typedef ChunkedQueue<queued_item> CheckpointQueue;
 
 /**
  * A checkpoint index entry.
@@ -572,8 +573,19 @@ private:
     checkpoint_index               keyIndex;
     /* Index for meta keys like "dummy_key" */
     checkpoint_index               metaKeyIndex;
+
+    /**
+     * Bring the memory accounted for toWrite's chunks (in memOverhead and
+     * stats.memOverhead) up to date. Called whenever items are added to or
+     * removed from toWrite, which may allocate or free chunks.
+     */
+    void updateQueueMemOverhead();
+
     size_t                         memOverhead;
 
+    /// The part of memOverhead which is accounted for toWrite's chunks.
+    size_t                         queueMemOverhead;
+
     // The following stat is to contain the memory consumption of all
     // the queued items in the given checkpoint.
     size_t                         effectiveMemUsage;
@@ -742,6 +754,27 @@ public:
      */
     size_t getNumItemsForCursor(const std::string &name) const;
 
+    /**
+     * Returns a count which is incremented (under queueLock, with release
+     * semantics) whenever items may have become available to cursors - an
+     * item or checkpoint is queued, or cursors are repositioned.
+     *
+     * Can be read without taking queueLock: a reader which recorded the count
+     * before it last drained its cursor (via getAllItemsForCursor) and sees it
+     * unchanged knows there is nothing new to read, so can avoid contending
+     * on queueLock with the front-end threads queueing items.
+     *
+     * This is the only lock-free read: registering a cursor and reading items
+     * for it (getAllItemsForCursor, nextItem - as used by DCP streams and the
+     * flusher) still take queueLock. Writers de-duplicate in place, erasing
+     * items from the open checkpoint and moving the cursors pointing at
+     * them, so a reader walking the queue without the lock could observe a
+     * half-moved cursor or an erased item.
+     */
+    uint64_t getPublishCount() const {
+        return publishCount.load(std::memory_order_acquire);
+    }
+
     void clear(vbucket_state_t vbState) {
         LockHolder lh(queueLock);
         clear_UNLOCKED(vbState, lastBySeqno);
@@ -960,6 +993,12 @@ private:
      */
     size_t getNumOfMetaItemsFromCursor(const CheckpointCursor &cursor) const;
 
+    /// Signal lock-free readers that items may be available (see
+    /// getPublishCount).
+    void markItemsPublished_UNLOCKED() {
+        publishCount.fetch_add(1, std::memory_order_release);
+    }
+
     EPStats                 &stats;
     CheckpointConfig        &checkpointConfig;
     mutable std::mutex       queueLock;
@@ -968,6 +1007,8 @@ private:
     // Total number of items (including meta items) in /all/ checkpoints managed
     // by this object.
     std::atomic<size_t>      numItems;
+    // See getPublishCount().
+    std::atomic<uint64_t>    publishCount;
     Monotonic<int64_t>       lastBySeqno;
     CheckpointList checkpointList;
     bool                     isCollapsedCheckpoint;
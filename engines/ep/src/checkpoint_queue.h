@@ -0,0 +1,355 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2017 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#pragma once
+
+#include "config.h"
+
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <list>
+#include <stdexcept>
+#include <type_traits>
+
+/**
+ * Sequence container used to hold the items of a Checkpoint.
+ *
+ * Elements are stored in fixed-size chunks of ChunkSize elements, which are
+ * linked together. Compared to std::list this means appending only allocates
+ * memory once every ChunkSize elements, and walking the queue (as the flusher
+ * and DCP cursors do) mostly touches contiguous memory.
+ *
+ * Unlike std::deque / std::vector, iterators remain valid when elements are
+ * appended, inserted or when other elements are erased - CheckpointCursor
+ * and the Checkpoint key index both hold iterators into the queue. To achieve this,
+ * erase() doesn't shift the following elements; it replaces the element with
+ * a default-constructed (null) value - a hole - which iteration skips over.
+ * Holes at the start or end of a chunk are reclaimed, and a chunk is freed
+ * once it has no elements left.
+ *
+ * T must be default-constructible, with a default-constructed T evaluating to
+ * false and any element stored in the queue evaluating to true (for example a
+ * non-null smart pointer such as queued_item).
+ *
+ * Invariant: every chunk holds at least one element, and the first and last
+ * used slot of every chunk hold an element (not a hole).
+ */
+template <typename T, size_t ChunkSize = 64>
+class ChunkedQueue {
+    struct Chunk {
+        std::array<T, ChunkSize> slots;
+        /// Slots [begin, end) are in use (holding an element or a hole).
+        size_t begin = 0;
+        size_t end = 0;
+        /// Number of elements (i.e. not holes) in [begin, end).
+        size_t count = 0;
+        /// If true no more elements are appended to this chunk.
+        bool sealed = false;
+    };
+    using ChunkList = std::list<Chunk>;
+
+public:
+    template <bool IsConst>
+    class Iterator {
+        using ChunkIt = typename std::conditional<IsConst,
+                typename ChunkList::const_iterator,
+                typename ChunkList::iterator>::type;
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = typename std::conditional<IsConst, const T*, T*>::type;
+        using reference =
+                typename std::conditional<IsConst, const T&, T&>::type;
+
+        Iterator() = default;
+
+        // Allow conversion from iterator to const_iterator.
+        template <bool OtherConst,
+                  typename = typename std::enable_if<IsConst &&
+                                                     !OtherConst>::type>
+        Iterator(const Iterator<OtherConst>& other)
+            : chunks(other.chunks), chunk(other.chunk), slot(other.slot) {
+        }
+
+        reference operator*() const {
+            return chunk->slots[slot];
+        }
+
+        pointer operator->() const {
+            return &chunk->slots[slot];
+        }
+
+        Iterator& operator++() {
+            ++slot;
+            skipHoles();
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator tmp(*this);
+            ++*this;
+            return tmp;
+        }
+
+        Iterator& operator--() {
+            do {
+                if (chunk == chunks->end() || slot == chunk->begin) {
+                    --chunk;
+                    slot = chunk->end;
+                }
+                --slot;
+            } while (!chunk->slots[slot]);
+            return *this;
+        }
+
+        Iterator operator--(int) {
+            Iterator tmp(*this);
+            --*this;
+            return tmp;
+        }
+
+        bool operator==(const Iterator& other) const {
+            return chunk == other.chunk && slot == other.slot;
+        }
+
+        bool operator!=(const Iterator& other) const {
+            return !(*this == other);
+        }
+
+    private:
+        Iterator(const ChunkList* chunks, ChunkIt chunk, size_t slot)
+            : chunks(chunks), chunk(chunk), slot(slot) {
+        }
+
+        /// Move forward until positioned on an element, or at end().
+        void skipHoles() {
+            while (chunk != chunks->end()) {
+                if (slot >= chunk->end) {
+                    ++chunk;
+                    slot = (chunk != chunks->end()) ? chunk->begin : 0;
+                } else if (!chunk->slots[slot]) {
+                    ++slot;
+                } else {
+                    return;
+                }
+            }
+        }
+
+        const ChunkList* chunks = nullptr;
+        ChunkIt chunk;
+        size_t slot = 0;
+
+        friend class ChunkedQueue;
+        template <bool>
+        friend class Iterator;
+    };
+
+    using value_type = T;
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    iterator begin() {
+        if (chunks.empty()) {
+            return end();
+        }
+        return iterator(&chunks, chunks.begin(), chunks.front().begin);
+    }
+
+    const_iterator begin() const {
+        if (chunks.empty()) {
+            return end();
+        }
+        return const_iterator(&chunks, chunks.begin(), chunks.front().begin);
+    }
+
+    iterator end() {
+        return iterator(&chunks, chunks.end(), 0);
+    }
+
+    const_iterator end() const {
+        return const_iterator(&chunks, chunks.end(), 0);
+    }
+
+    reverse_iterator rbegin() {
+        return reverse_iterator(end());
+    }
+
+    const_reverse_iterator rbegin() const {
+        return const_reverse_iterator(end());
+    }
+
+    reverse_iterator rend() {
+        return reverse_iterator(begin());
+    }
+
+    const_reverse_iterator rend() const {
+        return const_reverse_iterator(begin());
+    }
+
+    bool empty() const {
+        return numElements == 0;
+    }
+
+    size_t size() const {
+        return numElements;
+    }
+
+    T& front() {
+        return chunks.front().slots[chunks.front().begin];
+    }
+
+    const T& front() const {
+        return chunks.front().slots[chunks.front().begin];
+    }
+
+    T& back() {
+        return chunks.back().slots[chunks.back().end - 1];
+    }
+
+    const T& back() const {
+        return chunks.back().slots[chunks.back().end - 1];
+    }
+
+    /// Append an element. Doesn't invalidate any iterators.
+    void push_back(T value) {
+        if (chunks.empty() || chunks.back().end == ChunkSize ||
+            chunks.back().sealed) {
+            chunks.emplace_back();
+        }
+        auto& chunk = chunks.back();
+        chunk.slots[chunk.end++] = std::move(value);
+        ++chunk.count;
+        ++numElements;
+    }
+
+    /// Remove the last element.
+    void pop_back() {
+        erase(--end());
+    }
+
+    /**
+     * Remove the element at pos. Only invalidates iterators to the erased
+     * element.
+     * @return iterator following the removed element.
+     */
+    iterator erase(iterator pos) {
+        auto next = std::next(pos);
+        auto chunk = pos.chunk;
+        chunk->slots[pos.slot] = T();
+        --chunk->count;
+        --numElements;
+        if (chunk->count == 0) {
+            chunks.erase(chunk);
+        } else {
+            trim(*chunk);
+        }
+        return next;
+    }
+
+    /**
+     * Start a new chunk for the next element appended, so that elements can
+     * later be inserted before it (see insert()).
+     */
+    void startNewChunk() {
+        if (!chunks.empty()) {
+            chunks.back().sealed = true;
+        }
+    }
+
+    /**
+     * Insert the elements [first, last) before pos, which must be end() or
+     * the first element of its chunk (see startNewChunk()). The elements are
+     * placed in new chunks, so existing elements are never moved and no
+     * iterators are invalidated.
+     * @return iterator to the first inserted element, or pos if none were.
+     */
+    template <typename InputIt>
+    iterator insert(iterator pos, InputIt first, InputIt last) {
+        if (first == last) {
+            return pos;
+        }
+        if (pos == end()) {
+            push_back(*first);
+            iterator result(&chunks,
+                            std::prev(chunks.end()),
+                            chunks.back().end - 1);
+            for (++first; first != last; ++first) {
+                push_back(*first);
+            }
+            return result;
+        }
+        if (pos.slot != pos.chunk->begin) {
+            throw std::invalid_argument(
+                    "ChunkedQueue::insert: pos is not the first element of "
+                    "its chunk");
+        }
+
+        auto dest = chunks.end();
+        auto firstDest = chunks.end();
+        for (; first != last; ++first) {
+            if (dest == chunks.end() || dest->end == ChunkSize) {
+                dest = chunks.emplace(pos.chunk);
+                if (firstDest == chunks.end()) {
+                    firstDest = dest;
+                }
+            }
+            dest->slots[dest->end++] = *first;
+            ++dest->count;
+            ++numElements;
+        }
+        return iterator(&chunks, firstDest, 0);
+    }
+
+    void clear() {
+        chunks.clear();
+        numElements = 0;
+    }
+
+    /// Returns the number of chunks currently allocated.
+    size_t getNumChunks() const {
+        return chunks.size();
+    }
+
+    /**
+     * Returns the memory allocated for the chunks, including the slots of
+     * partly used chunks (e.g. those sealed by startNewChunk(), or left
+     * sparse by erase()).
+     */
+    size_t getMemoryUsage() const {
+        // Each chunk is a std::list node: the Chunk plus its prev/next links.
+        return chunks.size() * (sizeof(Chunk) + 2 * sizeof(void*));
+    }
+
+private:
+    /// Reclaim any holes at the start and end of the given (non-empty) chunk.
+    static void trim(Chunk& chunk) {
+        while (!chunk.slots[chunk.begin]) {
+            ++chunk.begin;
+        }
+        while (!chunk.slots[chunk.end - 1]) {
+            --chunk.end;
+        }
+    }
+
+    ChunkList chunks;
+    size_t numElements = 0;
+};
@@ -35,7 +35,9 @@ StatsOps::StatFile::StatFile(FileOpsInterface* _orig_ops,
       orig_handle(_orig_handle),
       last_offs(_last_offs),
       read_count_since_open(0),
-      write_count_since_open(0) {
+      write_count_since_open(0),
+      defer_sync(false),
+      sync_pending(false) {
 }
 
 size_t StatsOps::StatFile::getReadCount() {
@@ -77,7 +79,18 @@ couchstore_error_t StatsOps::close(couchstore_error_info_t* errinfo,
         stats.writeCountHisto.add(sf->write_count_since_open);
     }
 
-    return sf->orig_ops->close(errinfo, sf->orig_handle);
+    // Never close a file with a deferred sync outstanding; if the sync fails
+    // still close the file, but report the sync failure.
+    couchstore_error_t syncErrCode = COUCHSTORE_SUCCESS;
+    if (sf->sync_pending) {
+        BlockTimer bt(&stats.syncTimeHisto);
+        syncErrCode = syncPending(errinfo, sf);
+    }
+    sf->defer_sync = false;
+    sf->sync_pending = false;
+
+    couchstore_error_t errCode = sf->orig_ops->close(errinfo, sf->orig_handle);
+    return (syncErrCode != COUCHSTORE_SUCCESS) ? syncErrCode : errCode;
 }
 
 couchstore_error_t StatsOps::set_periodic_sync(couch_file_handle h,
@@ -113,6 +126,15 @@ ssize_t StatsOps::pwrite(couchstore_error_info_t*errinfo,
                          size_t sz,
                          cs_off_t off) {
     StatFile* sf = reinterpret_cast<StatFile*>(h);
+    if (sf->sync_pending) {
+        // Any deferred sync must complete before the file is written to
+        // again, so writes stay ordered with respect to it.
+        BlockTimer bt(&stats.syncTimeHisto);
+        couchstore_error_t errCode = syncPending(errinfo, sf);
+        if (errCode != COUCHSTORE_SUCCESS) {
+            return errCode;
+        }
+    }
     stats.writeSizeHisto.add(sz);
     BlockTimer bt(&stats.writeTimeHisto);
     ssize_t result = sf->orig_ops->pwrite(errinfo, sf->orig_handle, buf,
@@ -133,6 +155,10 @@ cs_off_t StatsOps::goto_eof(couchstore_error_info_t* errinfo,
 couchstore_error_t StatsOps::sync(couchstore_error_info_t* errinfo,
                                   couch_file_handle h) {
     StatFile* sf = reinterpret_cast<StatFile*>(h);
+    if (sf->defer_sync) {
+        sf->sync_pending = true;
+        return COUCHSTORE_SUCCESS;
+    }
     BlockTimer bt(&stats.syncTimeHisto);
     return sf->orig_ops->sync(errinfo, sf->orig_handle);
 }
@@ -146,6 +172,55 @@ couchstore_error_t StatsOps::advise(couchstore_error_info_t* errinfo,
     return sf->orig_ops->advise(errinfo, sf->orig_handle, offs, len, adv);
 }
 
+couchstore_error_t StatsOps::readahead(couchstore_error_info_t* errinfo,
+                                       FHStats* fhStats,
+                                       cs_off_t offset,
+                                       cs_off_t len) {
+    auto* sf = dynamic_cast<StatFile*>(fhStats);
+    if (sf == nullptr) {
+        return COUCHSTORE_ERROR_INVALID_ARGUMENTS;
+    }
+    return sf->orig_ops->advise(errinfo,
+                                sf->orig_handle,
+                                offset,
+                                len,
+                                COUCHSTORE_FILE_ADVICE_WILLNEED);
+}
+
+couchstore_error_t StatsOps::deferSync(FHStats* fhStats) {
+    auto* sf = dynamic_cast<StatFile*>(fhStats);
+    if (sf == nullptr) {
+        return COUCHSTORE_ERROR_INVALID_ARGUMENTS;
+    }
+    sf->defer_sync = true;
+    return COUCHSTORE_SUCCESS;
+}
+
+couchstore_error_t StatsOps::syncDeferred(couchstore_error_info_t* errinfo,
+                                          FHStats* fhStats) {
+    auto* sf = dynamic_cast<StatFile*>(fhStats);
+    if (sf == nullptr) {
+        return COUCHSTORE_ERROR_INVALID_ARGUMENTS;
+    }
+    couchstore_error_t errCode = syncPending(errinfo, sf);
+    if (errCode == COUCHSTORE_SUCCESS) {
+        sf->defer_sync = false;
+    }
+    return errCode;
+}
+
+couchstore_error_t StatsOps::syncPending(couchstore_error_info_t* errinfo,
+                                         StatFile* sf) {
+    if (!sf->sync_pending) {
+        return COUCHSTORE_SUCCESS;
+    }
+    couchstore_error_t errCode = sf->orig_ops->sync(errinfo, sf->orig_handle);
+    if (errCode == COUCHSTORE_SUCCESS) {
+        sf->sync_pending = false;
+    }
+    return errCode;
+}
+
 FileOpsInterface::FHStats* StatsOps::get_stats(couch_file_handle h) {
     // StatFile implements FHStats interface directly.
     StatFile* sf = reinterpret_cast<StatFile*>(h);
@@ -69,6 +69,47 @@ public:
     FHStats* get_stats(couch_file_handle handle) override;
     void destructor(couch_file_handle handle) override;
 
+    /**
+     * Ask the OS to read the given range of a file opened via StatsOps in
+     * the background (COUCHSTORE_FILE_ADVICE_WILLNEED), so that a later
+     * pread() of it doesn't have to wait for the device.
+     *
+     * @param fhStats The stats of the file (as returned by get_stats() /
+     *                couchstore_get_db_filestats()).
+     * @return COUCHSTORE_ERROR_INVALID_ARGUMENTS if fhStats doesn't belong to
+     *         a StatsOps file, otherwise the result of the underlying advise.
+     */
+    static couchstore_error_t readahead(couchstore_error_info_t* errinfo,
+                                        FHStats* fhStats,
+                                        cs_off_t offset,
+                                        cs_off_t len);
+
+    /**
+     * Defer syncs of a file opened via StatsOps: sync() only records that
+     * the file needs syncing, and the sync is performed before the next
+     * write to (or close of) the file, or by syncDeferred(). Writes therefore
+     * stay ordered with respect to syncs, but the final sync is left
+     * outstanding - allowing the caller to perform the final syncs of
+     * several files together.
+     *
+     * @param fhStats The stats of the file (as returned by get_stats() /
+     *                couchstore_get_db_filestats()).
+     * @return COUCHSTORE_ERROR_INVALID_ARGUMENTS if fhStats doesn't belong to
+     *         a StatsOps file, otherwise COUCHSTORE_SUCCESS.
+     */
+    static couchstore_error_t deferSync(FHStats* fhStats);
+
+    /**
+     * Perform the outstanding sync (if any) of a file which deferSync() was
+     * called for, and stop deferring syncs of it.
+     *
+     * @param fhStats The stats of the file.
+     * @return COUCHSTORE_ERROR_INVALID_ARGUMENTS if fhStats doesn't belong to
+     *         a StatsOps file, otherwise the result of the underlying sync.
+     */
+    static couchstore_error_t syncDeferred(couchstore_error_info_t* errinfo,
+                                           FHStats* fhStats);
+
 protected:
     FileStats& stats;
     FileOpsInterface& wrapped_ops;
@@ -89,5 +130,14 @@ protected:
         size_t read_count_since_open;
         /// Number of write() calls against this file since it was last opened.
         size_t write_count_since_open;
+
+        /// Are syncs of this file being deferred? (see deferSync())
+        bool defer_sync;
+        /// Has a sync of this file been deferred (and not yet performed)?
+        bool sync_pending;
     };
+
+    /// Perform the deferred sync of the given file, if there is one.
+    static couchstore_error_t syncPending(couchstore_error_info_t* errinfo,
+                                          StatFile* sf);
 };
@@ -38,6 +38,7 @@
 #include <platform/cb_malloc.h>
 #include <platform/checked_snprintf.h>
 #include <string>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 #include <cJSON.h>
@@ -171,13 +172,36 @@ static DocKey makeDocKey(const sized_buf buf, bool restoreNamespace) {
 }
 
 struct GetMultiCbCtx {
-    GetMultiCbCtx(CouchKVStore &c, uint16_t v, vb_bgfetch_queue_t &f) :
-        cks(c), vbId(v), fetches(f) {}
+    GetMultiCbCtx(CouchKVStore& c,
+                  uint16_t v,
+                  vb_bgfetch_queue_t& f,
+                  const BGFetchedCallback* cb = nullptr)
+        : cks(c), vbId(v), fetches(f), onFetched(cb) {
+    }
 
     CouchKVStore &cks;
     uint16_t vbId;
     vb_bgfetch_queue_t &fetches;
+    // If non-null, called as each key's document has been read.
+    const BGFetchedCallback* onFetched;
+};
+
+/// Deleter for DocInfos whose ownership has been taken from couchstore.
+struct DocInfoDeleter {
+    void operator()(DocInfo* docinfo) {
+        couchstore_free_docinfo(docinfo);
+    }
 };
+using UniqueDocInfoPtr = std::unique_ptr<DocInfo, DocInfoDeleter>;
+
+extern "C" {
+    static int collectDocInfoCbC(Db* db, DocInfo* docinfo, void* ctx) {
+        static_cast<std::vector<UniqueDocInfoPtr>*>(ctx)->emplace_back(
+                docinfo);
+        // Non-zero - we have taken ownership of docinfo.
+        return 1;
+    }
+}
 
 struct StatResponseCtx {
 public:
@@ -281,6 +305,7 @@ CouchKVStore::CouchKVStore(KVStoreConfig& config,
       dbFileRevMap(dbFileRevMap),
       fileRevMap(fileRevMapSize),
       intransaction(false),
+      inGroupCommit(false),
       scanCounter(0),
       logger(config.getLogger()),
       base_ops(ops) {
@@ -366,6 +391,10 @@ void CouchKVStore::initialize() {
 
 CouchKVStore::~CouchKVStore() {
     close();
+    // Closing the files performs any outstanding deferred sync.
+    for (auto* db : groupCommitDbs) {
+        closeDatabaseHandle(db);
+    }
 }
 
 void CouchKVStore::reset(uint16_t vbucketId) {
@@ -501,6 +530,59 @@ GetValue CouchKVStore::getWithHeader(void* dbHandle,
     return rv;
 }
 
+/// Returns the couchstore document ids of the keys to fetch.
+static std::vector<sized_buf> makeFetchIds(vb_bgfetch_queue_t& fetches,
+                                           bool persistNamespace) {
+    std::vector<sized_buf> ids;
+    ids.reserve(fetches.size());
+    for (auto& fetch : fetches) {
+        if (persistNamespace) {
+            ids.push_back({const_cast<char*>(reinterpret_cast<const char*>(
+                                   fetch.first.getDocNameSpacedData())),
+                           fetch.first.getDocNameSpacedSize()});
+        } else {
+            ids.push_back({const_cast<char*>(reinterpret_cast<const char*>(
+                                   fetch.first.data())),
+                           fetch.first.size()});
+        }
+    }
+    return ids;
+}
+
+/**
+ * Ask the OS to start reading the bodies of the given documents (other than
+ * those only needing metadata), so the device has them all in flight
+ * concurrently rather than us waiting for each pread() in turn.
+ */
+static void readaheadDocs(CouchKVStore& cks,
+                          Db* db,
+                          const std::vector<UniqueDocInfoPtr>& docinfos,
+                          const vb_bgfetch_queue_t& fetches) {
+    auto* fhStats = couchstore_get_db_filestats(db);
+    if (fhStats == nullptr) {
+        return;
+    }
+    for (const auto& docinfo : docinfos) {
+        if (docinfo->size == 0) {
+            continue;
+        }
+        auto fetch = fetches.find(makeDocKey(
+                docinfo->id, cks.getConfig().shouldPersistDocNamespace()));
+        if (fetch == fetches.end() ||
+            fetch->second.isMetaOnly == GetMetaOnly::Yes) {
+            continue;
+        }
+        // Allow for the chunk header and the per-block prefix bytes
+        // couchstore stores alongside the body.
+        const cs_off_t len = docinfo->size + (docinfo->size / 4096) + 8;
+        couchstore_error_info_t errinfo;
+        if (StatsOps::readahead(&errinfo, fhStats, docinfo->bp, len) ==
+            COUCHSTORE_SUCCESS) {
+            ++cks.getKVStoreStat().getMultiReadaheadCount;
+        }
+    }
+}
+
 void CouchKVStore::getMulti(uint16_t vb, vb_bgfetch_queue_t &itms) {
     if (itms.empty()) {
         return;
@@ -523,26 +605,16 @@ void CouchKVStore::getMulti(uint16_t vb, vb_bgfetch_queue_t &itms) {
         return;
     }
 
-    size_t idx = 0;
-    std::vector<sized_buf> ids(itms.size());
-    for (auto& item : itms) {
-        if (configuration.shouldPersistDocNamespace()) {
-            ids[idx] = {const_cast<char*>(reinterpret_cast<const char*>(
-                                item.first.getDocNameSpacedData())),
-                        item.first.getDocNameSpacedSize()};
-        } else {
-            ids[idx] = {const_cast<char*>(reinterpret_cast<const char*>(
-                                item.first.data())),
-                        item.first.size()};
-        }
-
-        ++idx;
-    }
+    auto ids = makeFetchIds(itms, configuration.shouldPersistDocNamespace());
 
     GetMultiCbCtx ctx(*this, vb, itms);
 
-    errCode = couchstore_docinfos_by_id(db, ids.data(), itms.size(),
-                                        0, getMultiCbC, &ctx);
+    if (configuration.isBgFetchReadahead() && itms.size() > 1) {
+        errCode = getMultiWithReadahead(db, ids, ctx);
+    } else {
+        errCode = couchstore_docinfos_by_id(db, ids.data(), itms.size(),
+                                            0, getMultiCbC, &ctx);
+    }
     if (errCode != COUCHSTORE_SUCCESS) {
         st.numGetFailure += numItems;
         logger.log(EXTENSION_LOG_WARNING, "CouchKVStore::getMulti: "
@@ -567,6 +639,149 @@ void CouchKVStore::getMulti(uint16_t vb, vb_bgfetch_queue_t &itms) {
     closeDatabaseHandle(db);
 }
 
+couchstore_error_t CouchKVStore::getMultiWithReadahead(
+        Db* db, std::vector<sized_buf>& ids, GetMultiCbCtx& ctx) {
+    // First pass - look up the DocInfos of all of the keys. The by-id B-tree
+    // nodes are shared between the keys (and are typically cached), unlike
+    // the document bodies which are usually in different blocks.
+    std::vector<UniqueDocInfoPtr> docinfos;
+    docinfos.reserve(ids.size());
+    couchstore_error_t errCode = couchstore_docinfos_by_id(
+            db, ids.data(), ids.size(), 0, collectDocInfoCbC, &docinfos);
+    if (errCode != COUCHSTORE_SUCCESS) {
+        return errCode;
+    }
+
+    // Read the bodies in file order.
+    std::sort(docinfos.begin(),
+              docinfos.end(),
+              [](const UniqueDocInfoPtr& a, const UniqueDocInfoPtr& b) {
+                  return a->bp < b->bp;
+              });
+
+    // Second pass - ask the OS to start reading all of the bodies we need.
+    readaheadDocs(*this, db, docinfos, ctx.fetches);
+
+    // Final pass - fetch each document, which should now mostly be served
+    // from the page cache.
+    for (const auto& docinfo : docinfos) {
+        getMultiCb(db, docinfo.get(), &ctx);
+    }
+    return COUCHSTORE_SUCCESS;
+}
+
+void CouchKVStore::getMultiBatch(vb_bgfetch_batch_t& batch,
+                                 const BGFetchedCallback& onFetched) {
+    struct VBLookup {
+        uint16_t vbId;
+        vb_bgfetch_queue_t* fetches;
+        Db* db;
+        std::vector<UniqueDocInfoPtr> docinfos;
+    };
+    std::vector<VBLookup> lookups;
+    lookups.reserve(batch.size());
+
+    // First pass - look up the DocInfos of every vBucket's keys. Keys which
+    // don't exist, or whose vBucket can't be read, are complete already.
+    for (auto& vbFetches : batch) {
+        const uint16_t vb = vbFetches.first;
+        auto& fetches = vbFetches.second;
+        if (fetches.empty()) {
+            continue;
+        }
+
+        Db* db = nullptr;
+        couchstore_error_t errCode = openDB(
+                vb, dbFileRevMap[vb], &db, COUCHSTORE_OPEN_FLAG_RDONLY);
+        if (errCode != COUCHSTORE_SUCCESS) {
+            logger.log(EXTENSION_LOG_WARNING,
+                       "CouchKVStore::getMultiBatch: openDB error:%s, "
+                       "vb:%" PRIu16 ", numDocs:%" PRIu64,
+                       couchstore_strerror(errCode),
+                       vb,
+                       uint64_t(fetches.size()));
+            st.numGetFailure += fetches.size();
+            for (auto& fetch : fetches) {
+                fetch.second.value.setStatus(ENGINE_NOT_MY_VBUCKET);
+                onFetched(vb, fetch.first, fetch.second);
+            }
+            continue;
+        }
+
+        auto ids = makeFetchIds(fetches,
+                                configuration.shouldPersistDocNamespace());
+        std::vector<UniqueDocInfoPtr> docinfos;
+        docinfos.reserve(ids.size());
+        errCode = couchstore_docinfos_by_id(
+                db, ids.data(), ids.size(), 0, collectDocInfoCbC, &docinfos);
+        if (errCode != COUCHSTORE_SUCCESS) {
+            st.numGetFailure += fetches.size();
+            logger.log(EXTENSION_LOG_WARNING,
+                       "CouchKVStore::getMultiBatch: "
+                       "couchstore_docinfos_by_id error %s [%s], "
+                       "vb:%" PRIu16,
+                       couchstore_strerror(errCode),
+                       couchkvstore_strerrno(db, errCode).c_str(),
+                       vb);
+            for (auto& fetch : fetches) {
+                fetch.second.value.setStatus(couchErr2EngineErr(errCode));
+                onFetched(vb, fetch.first, fetch.second);
+            }
+            closeDatabaseHandle(db);
+            continue;
+        }
+
+        std::unordered_set<const StoredDocKey*> found;
+        for (const auto& docinfo : docinfos) {
+            auto fetch = fetches.find(makeDocKey(
+                    docinfo->id, configuration.shouldPersistDocNamespace()));
+            if (fetch != fetches.end()) {
+                found.insert(&fetch->first);
+            }
+        }
+        for (auto& fetch : fetches) {
+            if (found.count(&fetch.first) == 0) {
+                // Left with its default status of ENGINE_KEY_ENOENT.
+                onFetched(vb, fetch.first, fetch.second);
+            }
+        }
+
+        // Read the bodies in file order.
+        std::sort(docinfos.begin(),
+                  docinfos.end(),
+                  [](const UniqueDocInfoPtr& a, const UniqueDocInfoPtr& b) {
+                      return a->bp < b->bp;
+                  });
+        lookups.push_back({vb, &fetches, db, std::move(docinfos)});
+    }
+
+    // Second pass - start reading the bodies of the whole batch, across all
+    // of the vBucket files, before waiting on any of them.
+    if (configuration.isBgFetchReadahead()) {
+        for (const auto& lookup : lookups) {
+            readaheadDocs(*this, lookup.db, lookup.docinfos, *lookup.fetches);
+        }
+    }
+
+    // Final pass - fetch each document, completing it as soon as it's read.
+    for (auto& lookup : lookups) {
+        GetMultiCbCtx ctx(*this, lookup.vbId, *lookup.fetches, &onFetched);
+        for (const auto& docinfo : lookup.docinfos) {
+            getMultiCb(lookup.db, docinfo.get(), &ctx);
+        }
+
+        auto* stats = couchstore_get_db_filestats(lookup.db);
+        if (stats != nullptr) {
+            const auto readCount = stats->getReadCount();
+            st.getMultiFsReadCount += readCount;
+            st.getMultiFsReadHisto.add(readCount);
+            st.getMultiFsReadPerDocHisto.add(readCount /
+                                             lookup.fetches->size());
+        }
+        closeDatabaseHandle(lookup.db);
+    }
+}
+
 void CouchKVStore::del(const Item& itm, Callback<TransactionContext, int>& cb) {
     if (isReadOnly()) {
         throw std::logic_error("CouchKVStore::del: Not valid on a read-only "
@@ -1165,6 +1380,50 @@ bool CouchKVStore::commit(const Item* collectionsManifest) {
     return !intransaction;
 }
 
+void CouchKVStore::beginGroupCommit() {
+    if (isReadOnly()) {
+        throw std::logic_error("CouchKVStore::beginGroupCommit: Not valid on "
+                               "a read-only object.");
+    }
+    inGroupCommit = true;
+}
+
+bool CouchKVStore::endGroupCommit() {
+    if (isReadOnly()) {
+        throw std::logic_error("CouchKVStore::endGroupCommit: Not valid on a "
+                               "read-only object.");
+    }
+
+    // Issue the outstanding syncs back-to-back; keep any which fail so they
+    // are re-attempted by the next call.
+    auto cs_begin = ProcessClock::now();
+    std::vector<Db*> failed;
+    for (auto* db : groupCommitDbs) {
+        couchstore_error_info_t errinfo;
+        couchstore_error_t errCode = StatsOps::syncDeferred(
+                &errinfo, couchstore_get_db_filestats(db));
+        if (errCode != COUCHSTORE_SUCCESS) {
+            logger.log(EXTENSION_LOG_WARNING,
+                       "CouchKVStore::endGroupCommit: sync error:%s [%s]",
+                       couchstore_strerror(errCode),
+                       couchkvstore_strerrno(db, errCode).c_str());
+            failed.push_back(db);
+            continue;
+        }
+        closeDatabaseHandle(db);
+    }
+    st.groupCommitSyncHisto.add(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                    ProcessClock::now() - cs_begin));
+
+    groupCommitDbs.swap(failed);
+    if (!groupCommitDbs.empty()) {
+        return false;
+    }
+    inGroupCommit = false;
+    return true;
+}
+
 bool CouchKVStore::getStat(const char* name, size_t& value)  {
     if (strcmp("failure_compaction", name) == 0) {
         value = st.numCompactionFailure.load();
@@ -1972,6 +2231,12 @@ couchstore_error_t CouchKVStore::saveDocs(uint16_t vbid,
             saveCollectionsManifest(*db.getDb(), *collectionsManifest);
         }
 
+        if (inGroupCommit) {
+            // Leave the final (header) sync of the commit outstanding; it is
+            // performed by endGroupCommit().
+            StatsOps::deferSync(couchstore_get_db_filestats(db.getDb()));
+        }
+
         auto cs_begin = ProcessClock::now();
         errCode = couchstore_commit(db.getDb());
         st.commitHisto.add(
@@ -2004,6 +2269,11 @@ couchstore_error_t CouchKVStore::saveDocs(uint16_t vbid,
                        info.last_sequence, maxDBSeqno, vbid);
         }
         state->highSeqno = info.last_sequence;
+
+        if (inGroupCommit) {
+            // Keep the file open until its deferred sync has been performed.
+            groupCommitDbs.push_back(db.releaseDb());
+        }
     }
 
     /* update stat */
@@ -2370,6 +2640,10 @@ int CouchKVStore::getMultiCb(Db *db, DocInfo *docinfo, void *ctx) {
                               cbCtx->vbId, docinfo->rev_seq);
     }
 
+    if (cbCtx->onFetched) {
+        (*cbCtx->onFetched)(cbCtx->vbId, qitr->first, bg_itm_ctx);
+    }
+
     return 0;
 }
 
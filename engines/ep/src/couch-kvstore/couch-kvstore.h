@@ -148,6 +148,7 @@ protected:
 };
 
 struct kvstats_ctx;
+struct GetMultiCbCtx;
 
 /**
  * KVStore with couchstore as the underlying storage system
@@ -215,6 +216,21 @@ public:
      */
     bool commit(const Item* collectionsManifest) override;
 
+    /**
+     * Begin a group commit. Until endGroupCommit(), the final sync of each
+     * vBucket file written by commit() (the one making the new file header
+     * durable) is deferred, and the file is kept open.
+     */
+    void beginGroupCommit() override;
+
+    /**
+     * End the current group commit, performing the deferred syncs of all
+     * vBucket files committed since beginGroupCommit() and closing them.
+     *
+     * @return false if any of the syncs failed.
+     */
+    bool endGroupCommit() override;
+
     /**
      * Rollback a transaction (unless not currently in one).
      */
@@ -278,6 +294,16 @@ public:
      */
     void getMulti(uint16_t vb, vb_bgfetch_queue_t &itms) override;
 
+    /**
+     * Retrieve the documents of several vbuckets as one batch. The DocInfos
+     * of every vbucket are looked up first (completing keys which don't
+     * exist), then readahead is issued for all of the batch's document
+     * bodies (if bg_fetch_readahead is enabled) before each document is
+     * read and completed in turn.
+     */
+    void getMultiBatch(vb_bgfetch_batch_t& batch,
+                       const BGFetchedCallback& onFetched) override;
+
     /**
      * Get the number of vbuckets in a single database file
      *
@@ -460,6 +486,16 @@ protected:
      */
     DbInfo getDbInfo(uint16_t vbid);
 
+    /**
+     * Variant of couchstore_docinfos_by_id() for getMulti() which looks up
+     * all of the DocInfos first, issues readahead for every document body
+     * required and then fetches the documents (in file order) via
+     * getMultiCb(). Used when bg_fetch_readahead is enabled.
+     */
+    couchstore_error_t getMultiWithReadahead(Db* db,
+                                             std::vector<sized_buf>& ids,
+                                             GetMultiCbCtx& ctx);
+
     bool setVBucketState(uint16_t vbucketId,
                          const vbucket_state& vbstate,
                          VBStatePersist options);
@@ -582,6 +618,12 @@ protected:
     bool intransaction;
     std::unique_ptr<TransactionContext> transactionCtx;
 
+    /// Is a group commit in progress? (see beginGroupCommit())
+    bool inGroupCommit;
+    /// vBucket files committed in the current group commit, whose final
+    /// sync is outstanding.
+    std::vector<Db*> groupCommitDbs;
+
     /**
      * FileOpsInterface implementation for couchstore which tracks
      * all bytes read/written by couchstore *except* compaction.
@@ -34,6 +34,7 @@
 
 #include <platform/checked_snprintf.h>
 
+#include <limits>
 #include <memory>
 
 
@@ -265,6 +266,7 @@ ActiveStream::ActiveStream(EventuallyPersistentEngine* e,
       producerPtr(p),
       lastSentSnapEndSeqno(0),
       chkptItemsExtractionInProgress(false),
+      lastDrainedPublishCount(std::numeric_limits<uint64_t>::max()),
       includeValue(includeVal),
       includeXattributes(includeXattrs),
       filter(filter, manifest) {
@@ -916,7 +918,12 @@ std::unique_ptr<DcpResponse> ActiveStream::nextQueuedItem() {
 
 bool ActiveStream::nextCheckpointItem() {
     VBucketPtr vbucket = engine->getVBucket(vb_);
-    if (vbucket &&
+    // Nothing has been published to the checkpoints since we last drained our
+    // cursor - no need to check (under queueLock) for outstanding items.
+    const bool maybeNewItems =
+            vbucket && vbucket->checkpointManager->getPublishCount() !=
+                               lastDrainedPublishCount;
+    if (maybeNewItems &&
         vbucket->checkpointManager->getNumItemsForCursor(name_) > 0) {
         // schedule this stream to build the next checkpoint
         auto producer = producerPtr.lock();
@@ -1009,7 +1016,11 @@ void ActiveStream::getOutstandingItems(VBucketPtr &vb,
     chkptItemsExtractionInProgress.store(true);
 
     auto _begin_ = ProcessClock::now();
+    // Read the publish count *before* draining the cursor; anything published
+    // after this is either included in items or changes the count.
+    const auto publishCount = vb->checkpointManager->getPublishCount();
     vb->checkpointManager->getAllItemsForCursor(name_, items);
+    lastDrainedPublishCount = publishCount;
     engine->getEpStats().dcpCursorsGetItemsHisto.add(
             std::chrono::duration_cast<std::chrono::microseconds>(
                     ProcessClock::now() - _begin_));
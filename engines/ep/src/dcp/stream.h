@@ -486,6 +486,11 @@ private:
        items are added to the readyQ */
     std::atomic<bool> chkptItemsExtractionInProgress;
 
+    /* The CheckpointManager publish count read before the cursor was last
+       drained; if unchanged there are no new items for the cursor and
+       nextCheckpointItem() can avoid taking the checkpoint queueLock. */
+    std::atomic<uint64_t> lastDrainedPublishCount;
+
     // Whether the responses sent using this stream should contain the value
     IncludeValue includeValue;
     // Whether the responses sent using the stream should contain the xattrs
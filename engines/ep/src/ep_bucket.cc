@@ -145,7 +145,9 @@ bool BloomFilterCallback::initTempFilter(uint16_t vbucketId) {
         estimated_count = initial_estimation;
     }
 
-    vb->initTempFilter(estimated_count, config.getBfilterFpProb());
+    vb->initTempFilter(estimated_count,
+                       config.getBfilterFpProb(),
+                       config.isBfilterBlocked());
 
     return true;
 }
@@ -211,6 +213,60 @@ void EPBucket::reset() {
 }
 
 int EPBucket::flushVBucket(uint16_t vbid) {
+    std::vector<FlushedVBucket> flushed;
+    const int items_flushed = writeVBucket(vbid, flushed);
+    for (auto& fvb : flushed) {
+        if (!completeVBucketFlush(fvb)) {
+            return RETRY_FLUSH_VBUCKET;
+        }
+    }
+    return items_flushed;
+}
+
+size_t EPBucket::flushVBuckets(const std::vector<uint16_t>& vbids,
+                               std::vector<uint16_t>& retry) {
+    if (vbids.empty()) {
+        return 0;
+    }
+
+    // All the vBuckets belong to the same shard, and hence share the same
+    // KVStore.
+    KVStore* rwUnderlying = getRWUnderlying(vbids.front());
+    rwUnderlying->beginGroupCommit();
+
+    // Write phase: each vBucket is written and committed in turn, but its
+    // commit isn't necessarily durable yet, so the vBuckets are kept locked
+    // and waiters for persistence aren't notified until after the group
+    // commit ends.
+    size_t total_flushed = 0;
+    std::vector<FlushedVBucket> flushed;
+    for (auto vbid : vbids) {
+        const int items_flushed = writeVBucket(vbid, flushed);
+        if (items_flushed == RETRY_FLUSH_VBUCKET) {
+            retry.push_back(vbid);
+        } else {
+            total_flushed += items_flushed;
+        }
+    }
+
+    while (!rwUnderlying->endGroupCommit()) {
+        ++stats.commitFailed;
+        LOG(EXTENSION_LOG_WARNING,
+            "EPBucket::flushVBuckets: endGroupCommit failed!!! Retry in 1 "
+            "sec...");
+        sleep(1);
+    }
+
+    for (auto& fvb : flushed) {
+        if (!completeVBucketFlush(fvb)) {
+            retry.push_back(fvb.vb->getId());
+        }
+    }
+    return total_flushed;
+}
+
+int EPBucket::writeVBucket(uint16_t vbid,
+                           std::vector<FlushedVBucket>& flushed) {
     KVShard *shard = vbMap.getShardByVbId(vbid);
     if (diskDeleteAll && !deleteAllTaskCtx.delay) {
         if (shard->getId() == EP_PRIMARY_SHARD) {
@@ -389,14 +445,6 @@ int EPBucket::flushVBucket(uint16_t vbid) {
                 }
             }
 
-            if (vb->rejectQueue.empty()) {
-                vb->setPersistedSnapshot(range.start, range.end);
-                uint64_t highSeqno = rwUnderlying->getLastPersistedSeqno(vbid);
-                if (highSeqno > 0 && highSeqno != vb->getPersistenceSeqno()) {
-                    vb->setPersistenceSeqno(highSeqno);
-                }
-            }
-
             auto flush_end = ProcessClock::now();
             uint64_t trans_time =
                     std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -409,32 +457,48 @@ int EPBucket::flushVBucket(uint16_t vbid) {
             stats.cumulativeFlushTime.fetch_add(trans_time);
             stats.flusher_todo.store(0);
             stats.totalPersistVBState++;
+
+            flushed.emplace_back(std::move(vb), *rwUnderlying, range);
+        } else {
+            flushed.emplace_back(std::move(vb), *rwUnderlying);
         }
+    }
 
-        rwUnderlying->pendingTasks();
+    return items_flushed;
+}
 
-        if (vb->checkpointManager->getNumCheckpoints() > 1) {
-            wakeUpCheckpointRemover();
-        }
+bool EPBucket::completeVBucketFlush(FlushedVBucket& flushed) {
+    auto& vb = flushed.vb;
+    auto& rwUnderlying = flushed.rwUnderlying;
 
-        if (vb->rejectQueue.empty()) {
-            vb->checkpointManager->itemsPersisted();
-            uint64_t seqno = vb->getPersistenceSeqno();
-            uint64_t chkid =
-                    vb->checkpointManager->getPersistenceCursorPreChkId();
-            vb->notifyHighPriorityRequests(
-                    engine, seqno, HighPriorityVBNotify::Seqno);
-            vb->notifyHighPriorityRequests(
-                    engine, chkid, HighPriorityVBNotify::ChkPersistence);
-            if (chkid > 0 && chkid != vb->getPersistenceCheckpointId()) {
-                vb->setPersistenceCheckpointId(chkid);
-            }
-        } else {
-            return RETRY_FLUSH_VBUCKET;
+    if (flushed.wroteItems && vb->rejectQueue.empty()) {
+        vb->setPersistedSnapshot(flushed.range.start, flushed.range.end);
+        uint64_t highSeqno = rwUnderlying.getLastPersistedSeqno(vb->getId());
+        if (highSeqno > 0 && highSeqno != vb->getPersistenceSeqno()) {
+            vb->setPersistenceSeqno(highSeqno);
         }
     }
 
-    return items_flushed;
+    rwUnderlying.pendingTasks();
+
+    if (vb->checkpointManager->getNumCheckpoints() > 1) {
+        wakeUpCheckpointRemover();
+    }
+
+    if (!vb->rejectQueue.empty()) {
+        return false;
+    }
+
+    vb->checkpointManager->itemsPersisted();
+    uint64_t seqno = vb->getPersistenceSeqno();
+    uint64_t chkid = vb->checkpointManager->getPersistenceCursorPreChkId();
+    vb->notifyHighPriorityRequests(engine, seqno, HighPriorityVBNotify::Seqno);
+    vb->notifyHighPriorityRequests(
+            engine, chkid, HighPriorityVBNotify::ChkPersistence);
+    if (chkid > 0 && chkid != vb->getPersistenceCheckpointId()) {
+        vb->setPersistenceCheckpointId(chkid);
+    }
+    return true;
 }
 
 void EPBucket::commit(KVStore& kvstore, const Item* collectionsManifest) {
@@ -45,6 +45,22 @@ public:
      */
     int flushVBucket(uint16_t vbid);
 
+    /**
+     * Flushes all items waiting for persistence in a group of vbuckets
+     * (which must all belong to the same shard), using a single group commit:
+     * the vbuckets are written one after another, then the syncs making
+     * their commits durable are issued together before anyone waiting for
+     * their persistence is notified.
+     *
+     * @param vbids The ids of the vbuckets to flush
+     * @param[out] retry The ids of any vbuckets which need to be flushed again
+     *             (i.e. flushVBucket() would have returned
+     *             RETRY_FLUSH_VBUCKET for them) are appended to this
+     * @return The total number of items flushed
+     */
+    size_t flushVBuckets(const std::vector<uint16_t>& vbids,
+                         std::vector<uint16_t>& retry);
+
     void commit(KVStore& kvstore, const Item* collectionsManifest);
 
     /// Start the Flusher for all shards in this bucket.
@@ -133,6 +149,52 @@ public:
     }
 
 protected:
+    /**
+     * A vbucket which has been written and committed by writeVBucket(), but
+     * whose flush is yet to be completed by completeVBucketFlush(). The
+     * vbucket remains locked until then.
+     */
+    struct FlushedVBucket {
+        FlushedVBucket(LockedVBucketPtr vb, KVStore& rwUnderlying)
+            : vb(std::move(vb)), rwUnderlying(rwUnderlying), wroteItems(false) {
+        }
+
+        FlushedVBucket(LockedVBucketPtr vb,
+                       KVStore& rwUnderlying,
+                       snapshot_range_t range)
+            : vb(std::move(vb)),
+              rwUnderlying(rwUnderlying),
+              wroteItems(true),
+              range(range) {
+        }
+
+        LockedVBucketPtr vb;
+        KVStore& rwUnderlying;
+        /// Were any items written for the vbucket?
+        bool wroteItems;
+        /// The snapshot range written (only valid if wroteItems).
+        snapshot_range_t range;
+    };
+
+    /**
+     * First stage of flushing a vbucket: writes all items waiting for
+     * persistence in it and commits them. On success the (still locked)
+     * vbucket is appended to `flushed`, and completeVBucketFlush() must be
+     * called for it once the commit is durable.
+     *
+     * @return The number of items flushed, or RETRY_FLUSH_VBUCKET
+     */
+    int writeVBucket(uint16_t vbid, std::vector<FlushedVBucket>& flushed);
+
+    /**
+     * Second stage of flushing a vbucket: updates its persisted seqno /
+     * snapshot and notifies anyone waiting for the persistence of it.
+     *
+     * @return false if the vbucket needs to be flushed again (it has rejected
+     *         items outstanding), otherwise true.
+     */
+    bool completeVBucketFlush(FlushedVBucket& flushed);
+
     void flushOneDeleteAll();
 
     std::unique_ptr<PersistenceCallback> flushOneDelOrSet(const queued_item& qi,
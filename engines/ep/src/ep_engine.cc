@@ -268,6 +268,39 @@ static cb::EngineErrorItemPair EvpGet(gsl::not_null<ENGINE_HANDLE*> handle,
     return cb::makeEngineErrorItemPair(cb::engine_errc(ret), itm, handle);
 }
 
+static std::vector<cb::EngineErrorItemPair> EvpGetMulti(
+        gsl::not_null<ENGINE_HANDLE*> handle,
+        gsl::not_null<const void*> cookie,
+        const std::vector<cb::GetMultiKey>& keys,
+        DocStateFilter documentStateFilter) {
+    get_options_t options = static_cast<get_options_t>(QUEUE_BG_FETCH |
+                                                       HONOR_STATES |
+                                                       TRACK_REFERENCE |
+                                                       DELETE_TEMP |
+                                                       HIDE_LOCKED_CAS |
+                                                       TRACK_STATISTICS);
+
+    switch (documentStateFilter) {
+    case DocStateFilter::Alive:
+        break;
+    case DocStateFilter::Deleted:
+        // Not supported; see EvpGet
+        {
+            std::vector<cb::EngineErrorItemPair> ret;
+            for (size_t ii = 0; ii < keys.size(); ++ii) {
+                ret.emplace_back(cb::makeEngineErrorItemPair(
+                        cb::engine_errc::not_supported));
+            }
+            return ret;
+        }
+    case DocStateFilter::AliveOrDeleted:
+        options = static_cast<get_options_t>(options | GET_DELETED_VALUE);
+        break;
+    }
+
+    return acquireEngine(handle)->get_multi(cookie, keys, options);
+}
+
 static cb::EngineErrorItemPair EvpGetIf(
         gsl::not_null<ENGINE_HANDLE*> handle,
         gsl::not_null<const void*> cookie,
@@ -463,6 +496,9 @@ protocol_binary_response_status EventuallyPersistentEngine::setFlushParam(
             getConfiguration().setBgFetchDelay(std::stoull(valz));
         } else if (strcmp(keyz, "flushall_enabled") == 0) {
             getConfiguration().setFlushallEnabled(cb_stob(valz));
+        } else if (strcmp(keyz, "flusher_group_commit_vbuckets") == 0) {
+            getConfiguration().setFlusherGroupCommitVbuckets(
+                    std::stoull(valz));
         } else if (strcmp(keyz, "max_size") == 0) {
             size_t vsize = std::stoull(valz);
 
@@ -543,6 +579,8 @@ protocol_binary_response_status EventuallyPersistentEngine::setFlushParam(
             size_t value = std::stoull(valz);
             getConfiguration().setNumNonioThreads(value);
             ExecutorPool::get()->setNumNonIO(value);
+        } else if (strcmp(keyz, "bfilter_blocked") == 0) {
+            getConfiguration().setBfilterBlocked(cb_stob(valz));
         } else if (strcmp(keyz, "bfilter_enabled") == 0) {
             getConfiguration().setBfilterEnabled(cb_stob(valz));
         } else if (strcmp(keyz, "bfilter_residency_threshold") == 0) {
@@ -1727,6 +1765,7 @@ EventuallyPersistentEngine::EventuallyPersistentEngine(
     ENGINE_HANDLE_V1::remove = EvpItemDelete;
     ENGINE_HANDLE_V1::release = EvpItemRelease;
     ENGINE_HANDLE_V1::get = EvpGet;
+    ENGINE_HANDLE_V1::get_multi = EvpGetMulti;
     ENGINE_HANDLE_V1::get_if = EvpGetIf;
     ENGINE_HANDLE_V1::get_and_touch = EvpGetAndTouch;
     ENGINE_HANDLE_V1::get_locked = EvpGetLocked;
@@ -2073,6 +2112,36 @@ ENGINE_ERROR_CODE EventuallyPersistentEngine::flush(const void *cookie){
     }
 }
 
+std::vector<cb::EngineErrorItemPair> EventuallyPersistentEngine::get_multi(
+        const void* cookie,
+        const std::vector<cb::GetMultiKey>& keys,
+        get_options_t options) {
+    auto* handle = reinterpret_cast<ENGINE_HANDLE*>(this);
+    auto values = kvBucket->getMulti(keys, cookie, options);
+
+    std::vector<cb::EngineErrorItemPair> ret;
+    ret.reserve(values.size());
+    for (auto& gv : values) {
+        ENGINE_ERROR_CODE rv = gv.getStatus();
+        if (rv == ENGINE_SUCCESS) {
+            if (options & TRACK_STATISTICS) {
+                ++stats.numOpsGet;
+            }
+            ret.emplace_back(cb::makeEngineErrorItemPair(
+                    cb::engine_errc::success, gv.item.release(), handle));
+            continue;
+        }
+
+        if ((rv == ENGINE_KEY_ENOENT || rv == ENGINE_NOT_MY_VBUCKET) &&
+            isDegradedMode()) {
+            rv = ENGINE_TMPFAIL;
+        }
+        ret.emplace_back(cb::makeEngineErrorItemPair(cb::engine_errc(rv)));
+    }
+
+    return ret;
+}
+
 cb::EngineErrorItemPair EventuallyPersistentEngine::get_and_touch(const void* cookie,
                                                            const DocKey& key,
                                                            uint16_t vbucket,
@@ -2838,6 +2907,10 @@ ENGINE_ERROR_CODE EventuallyPersistentEngine::doMemoryStats(const void *cookie,
     add_casted_stat("ep_storedval_overhead", "unknown", add_stat, cookie);
 #endif
     add_casted_stat("ep_storedval_num", stats.numStoredVal, add_stat, cookie);
+    add_casted_stat("ep_storedval_inline_num", stats.numInlineValue,
+                    add_stat, cookie);
+    add_casted_stat("ep_storedval_inline_size", stats.totalInlineValueSize,
+                    add_stat, cookie);
     add_casted_stat("ep_item_num", stats.numItem, add_stat, cookie);
 
     std::map<std::string, size_t> alloc_stats;
@@ -2971,11 +3044,25 @@ ENGINE_ERROR_CODE EventuallyPersistentEngine::doHashStats(const void *cookie,
                 add_casted_stat(buf, depthVisitor.size, add_stat, cookie);
                 checked_snprintf(buf, sizeof(buf), "vb_%d:resized", vbid);
                 add_casted_stat(buf, vb->ht.getNumResizes(), add_stat, cookie);
+                checked_snprintf(
+                        buf, sizeof(buf), "vb_%d:resize_old_size", vbid);
+                add_casted_stat(
+                        buf, vb->ht.getResizeOldSize(), add_stat, cookie);
+                checked_snprintf(
+                        buf, sizeof(buf), "vb_%d:resize_remaining", vbid);
+                add_casted_stat(buf,
+                                vb->ht.getNumBucketsToMigrate(),
+                                add_stat,
+                                cookie);
                 checked_snprintf(buf, sizeof(buf), "vb_%d:mem_size", vbid);
                 add_casted_stat(buf, vb->ht.getItemMemory(), add_stat, cookie);
                 checked_snprintf(buf, sizeof(buf), "vb_%d:mem_size_counted",
                                  vbid);
                 add_casted_stat(buf, depthVisitor.memUsed, add_stat, cookie);
+                checked_snprintf(
+                        buf, sizeof(buf), "vb_%d:optimistic_finds", vbid);
+                add_casted_stat(
+                        buf, vb->ht.getNumOptimisticFinds(), add_stat, cookie);
             } catch (std::exception& error) {
                 LOG(EXTENSION_LOG_WARNING,
                     "StatVBucketVisitor::visitBucket: Failed to build stat: %s",
@@ -3415,6 +3502,11 @@ ENGINE_ERROR_CODE EventuallyPersistentEngine::doTimingStats(const void *cookie,
     // Misc
     add_casted_stat("notify_io", stats.notifyIOHisto, add_stat, cookie);
     add_casted_stat("batch_read", stats.getMultiHisto, add_stat, cookie);
+    add_casted_stat("bg_fetch_coalesce", stats.bgFetchCoalesceHisto,
+                    add_stat, cookie);
+    add_casted_stat("bg_fetch_read", stats.bgFetchReadHisto, add_stat, cookie);
+    add_casted_stat("bg_fetch_complete", stats.bgFetchCompleteHisto,
+                    add_stat, cookie);
 
     // Disk stats
     add_casted_stat("disk_insert", stats.diskInsertHisto, add_stat, cookie);
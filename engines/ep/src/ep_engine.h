@@ -169,6 +169,15 @@ public:
         return ret;
     }
 
+    /**
+     * Fetch a batch of items; see ENGINE_HANDLE_V1::get_multi and
+     * KVBucket::getMulti.
+     */
+    std::vector<cb::EngineErrorItemPair> get_multi(
+            const void* cookie,
+            const std::vector<cb::GetMultiKey>& keys,
+            get_options_t options);
+
     /**
      * Fetch an item only if the specified filter predicate returns true.
      *
@@ -28,6 +28,19 @@
 #include "vbucket_bgfetch_item.h"
 #include "vbucketdeletiontask.h"
 
+/**
+ * Returns the StoredValue factory for a persistent VBucket; using inline
+ * values if configured.
+ */
+static std::unique_ptr<AbstractStoredValueFactory> makeStoredValueFactory(
+        EPStats& st, Configuration& config) {
+    const size_t maxInlineSize = config.getMaxInlineValueSize();
+    if (maxInlineSize > 0) {
+        return std::make_unique<CompactStoredValueFactory>(st, maxInlineSize);
+    }
+    return std::make_unique<StoredValueFactory>(st);
+}
+
 EPVBucket::EPVBucket(id_type i,
                      vbucket_state_t newState,
                      EPStats& st,
@@ -56,7 +69,7 @@ EPVBucket::EPVBucket(id_type i,
               lastSnapEnd,
               std::move(table),
               flusherCb,
-              std::make_unique<StoredValueFactory>(st),
+              makeStoredValueFactory(st, config),
               std::move(newSeqnoCb),
               config,
               evictionPolicy,
@@ -187,6 +200,30 @@ ENGINE_ERROR_CODE EPVBucket::completeBGFetchForSingleItem(
     return status;
 }
 
+ENGINE_ERROR_CODE EPVBucket::queueBGFetchForGroup(
+        const DocKey& key, const std::shared_ptr<BGFetchGroup>& group) {
+    { // hash bucket lock scope
+        auto hbl = ht.getLockedBucket(key);
+        StoredValue* v = ht.unlocked_find(
+                key, hbl.getBucketNum(), WantsDeleted::Yes, TrackReference::No);
+        if (v == nullptr) {
+            if (eviction == VALUE_ONLY) {
+                // Deleted since the HashTable lookup
+                return ENGINE_KEY_ENOENT;
+            }
+            if (addTempStoredValue(hbl, key) == TempAddStatus::NoMem) {
+                return ENGINE_ENOMEM;
+            }
+        }
+    }
+
+    auto fetch = std::make_unique<VBucketBGFetchItem>(group->cookie, false);
+    fetch->group = group;
+    group->add();
+    queueBGFetchItem(key, std::move(fetch), getShard()->getBgFetcher());
+    return ENGINE_EWOULDBLOCK;
+}
+
 vb_bgfetch_queue_t EPVBucket::getBGFetchItems() {
     vb_bgfetch_queue_t fetches;
     LockHolder lh(pendingBGFetchesLock);
@@ -238,8 +275,14 @@ void EPVBucket::notifyAllPendingConnsFailed(EventuallyPersistentEngine& e) {
         for (auto& bgf : pendingBGFetches) {
             vb_bgfetch_item_ctx_t& bg_itm_ctx = bgf.second;
             for (auto& bgitem : bg_itm_ctx.bgfetched_list) {
-                toNotify[bgitem->cookie] = ENGINE_NOT_MY_VBUCKET;
-                e.storeEngineSpecific(bgitem->cookie, nullptr);
+                if (!bgitem->group) {
+                    toNotify[bgitem->cookie] = ENGINE_NOT_MY_VBUCKET;
+                    e.storeEngineSpecific(bgitem->cookie, nullptr);
+                } else if (bgitem->group->complete()) {
+                    // The multi-get's other fetches have completed; its
+                    // retry finds the vbucket gone for this key
+                    toNotify[bgitem->cookie] = ENGINE_SUCCESS;
+                }
                 ++num_of_deleted_pending_fetches;
             }
         }
@@ -54,6 +54,10 @@ public:
             const VBucketBGFetchItem& fetched_item,
             const ProcessClock::time_point startTime) override;
 
+    ENGINE_ERROR_CODE queueBGFetchForGroup(
+            const DocKey& key,
+            const std::shared_ptr<BGFetchGroup>& group) override;
+
     vb_bgfetch_queue_t getBGFetchItems() override;
 
     bool hasPendingBGFetchItems() override;
@@ -189,6 +189,15 @@ ENGINE_ERROR_CODE EphemeralVBucket::completeBGFetchForSingleItem(
             std::string(reinterpret_cast<const char*>(key.data()), key.size()));
 }
 
+ENGINE_ERROR_CODE EphemeralVBucket::queueBGFetchForGroup(
+        const DocKey& key, const std::shared_ptr<BGFetchGroup>& group) {
+    throw std::logic_error(
+            "EphemeralVBucket::queueBGFetchForGroup() is not valid. Called "
+            "on vb " +
+            std::to_string(getId()) + "for key: " +
+            std::string(reinterpret_cast<const char*>(key.data()), key.size()));
+}
+
 void EphemeralVBucket::resetStats() {
     autoDeleteCount.reset();
 }
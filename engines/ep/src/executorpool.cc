@@ -138,7 +138,8 @@ ExecutorPool *ExecutorPool::get(void) {
                                    config.getNumReaderThreads(),
                                    config.getNumWriterThreads(),
                                    config.getNumAuxioThreads(),
-                                   config.getNumNonioThreads());
+                                   config.getNumNonioThreads(),
+                                   config.isExecutorWorkStealing());
             ObjectRegistry::onSwitchThread(epe);
             instance.store(tmp);
         }
@@ -157,11 +158,13 @@ void ExecutorPool::shutdown(void) {
 
 ExecutorPool::ExecutorPool(size_t maxThreads, size_t nTaskSets,
                            size_t maxReaders, size_t maxWriters,
-                           size_t maxAuxIO,   size_t maxNonIO) :
-                  numTaskSets(nTaskSets), totReadyTasks(0),
+                           size_t maxAuxIO,   size_t maxNonIO,
+                           bool workStealing) :
+                  numTaskSets(nTaskSets), workStealing(workStealing),
+                  totReadyTasks(0),
                   isHiPrioQset(false), isLowPrioQset(false), numBuckets(0),
                   numSleepers(0), curWorkers(nTaskSets), numWorkers(nTaskSets),
-                  numReadyTasks(nTaskSets) {
+                  numReadyTasks(nTaskSets), localDeques(nTaskSets) {
     size_t numCPU = Couchbase::get_available_cpu_count();
     size_t numThreads = (size_t)((numCPU * 3)/4);
     numThreads = (numThreads < EP_MIN_NUM_THREADS) ?
@@ -202,6 +205,20 @@ TaskQueue *ExecutorPool::_nextTask(ExecutorThread &t, uint8_t tick) {
     }
 
     task_type_t myq = t.taskType;
+    if (workStealing) {
+        // Run the tasks we took from the TaskQueue in our last fetch first,
+        // unless they came from the low priority queue and a high priority
+        // task has become ready since
+        TaskQueue* localQ = t.peekLocalTaskQueue();
+        if (localQ && isHiPrioQset && localQ != hpTaskQ[myq] &&
+            hpTaskQ[myq]->fetchNextTask(t, false)) {
+            return hpTaskQ[myq];
+        }
+        if (TaskQueue* q = t.popLocalTask()) {
+            return q;
+        }
+    }
+
     TaskQueue *checkQ; // which TaskQueue set should be polled first
     TaskQueue *checkNextQ; // which set of TaskQueue should be polled next
     TaskQueue *toggle = NULL;
@@ -220,6 +237,13 @@ TaskQueue *ExecutorPool::_nextTask(ExecutorThread &t, uint8_t tick) {
             return checkQ;
         }
         if (toggle || checkQ == checkNextQ) {
+            if (workStealing) {
+                // Nothing ready in the queues; help a busy thread out
+                // before going to sleep
+                if (TaskQueue* q = _stealTask(t)) {
+                    return q;
+                }
+            }
             TaskQueue *sleepQ = getSleepQ(myq);
             if (sleepQ->fetchNextTask(t, true)) {
                 return sleepQ;
@@ -234,6 +258,59 @@ TaskQueue *ExecutorPool::_nextTask(ExecutorThread &t, uint8_t tick) {
     return NULL;
 }
 
+TaskQueue* ExecutorPool::_stealTask(ExecutorThread& t) {
+    // The tasks in the local deques are counted as ready tasks of their
+    // type, so if there are none there is nothing to steal
+    if (numReadyTasks[t.taskType] == 0) {
+        return nullptr;
+    }
+
+    const auto victims = std::atomic_load(&localDeques[t.taskType]);
+    if (!victims) {
+        return nullptr;
+    }
+
+    const size_t start = nextVictim++;
+    for (size_t ii = 0; ii < victims->size(); ++ii) {
+        const auto& victim = (*victims)[(start + ii) % victims->size()];
+        if (victim != t.getLocalTaskDeque() && victim->size() != 0) {
+            auto stolen = victim->steal();
+            if (!stolen.empty()) {
+                for (auto& task : stolen) {
+                    t.pushLocalTask(std::move(task.first), task.second);
+                }
+                return t.popLocalTask();
+            }
+        }
+    }
+    return nullptr;
+}
+
+void ExecutorPool::_updateLocalDeques(task_type_t type) {
+    auto deques = std::make_shared<LocalDeques>();
+    for (auto* thread : threadQ) {
+        if (thread->taskType == type) {
+            deques->push_back(thread->getLocalTaskDeque());
+        }
+    }
+    std::atomic_store(&localDeques[type],
+                      std::shared_ptr<const LocalDeques>(std::move(deques)));
+}
+
+void ExecutorPool::_returnLocalTasks(ExecutorThread& t) {
+    auto tasks = t.takeLocalTasks();
+    if (tasks.empty()) {
+        return;
+    }
+
+    for (auto& task : tasks) {
+        lessWork(t.taskType);
+        task.second->reschedule(task.first);
+    }
+    size_t numToWake = tasks.size();
+    getSleepQ(t.taskType)->doWake(numToWake);
+}
+
 TaskQueue *ExecutorPool::nextTask(ExecutorThread &t, uint8_t tick) {
     EventuallyPersistentEngine *epe = ObjectRegistry::onSwitchThread(NULL, true);
     TaskQueue *tq = _nextTask(t, tick);
@@ -563,6 +640,7 @@ ssize_t ExecutorPool::_adjustWorkers(task_type_t type, size_t desiredNumItems) {
         }
 
         numWorkers[type] = desiredNumItems;
+        _updateLocalDeques(type);
     } // release mutex
 
     // MB-22938 wake all threads to avoid blocking if a thread is sleeping
@@ -581,6 +659,7 @@ ssize_t ExecutorPool::_adjustWorkers(task_type_t type, size_t desiredNumItems) {
     auto itr = removed.begin();
     while (itr != removed.end()) {
         (*itr)->stop(true);
+        _returnLocalTasks(**itr);
         delete (*itr);
         itr = removed.erase(itr);
     }
@@ -698,6 +777,9 @@ void ExecutorPool::_unregisterTaskable(Taskable& taskable, bool force) {
         }
 
         threadQ.clear();
+        for (size_t i = 0; i < numTaskSets; i++) {
+            _updateLocalDeques(static_cast<task_type_t>(i));
+        }
         if (isHiPrioQset) {
             for (size_t i = 0; i < numTaskSets; i++) {
                 delete hpTaskQ[i];
@@ -62,6 +62,18 @@
  * ExecutorPool::snooze(size_t taskId, double toSleep)
  *   The pool's snooze method will locate the task matching taskId and adjust
  *   its wakeTime to account for the toSleep value.
+ *
+ * === Work-stealing mode ===
+ *
+ * With executor_work_stealing set, a thread which fetches a task from a
+ * TaskQueue also takes up to ExecutorThread::MaxLocalTasks - 1 more ready
+ * tasks of the queue to its own local deque, and runs them from there
+ * without taking the TaskQueue's lock (checking the high priority queue
+ * before each task taken from a low priority one). A thread which finds no
+ * ready tasks in the TaskQueues steals half of the local deque of another
+ * thread of the same type before going to sleep.
+ * As threads only ever run (and steal) tasks of their own type the limits
+ * on the number of threads per type still apply.
  */
 #ifndef SRC_EXECUTORPOOL_H_
 #define SRC_EXECUTORPOOL_H_ 1
@@ -73,16 +85,20 @@
 #include "taskable.h"
 
 #include <map>
+#include <memory>
 #include <set>
+#include <vector>
 
 // Forward decl
 class TaskQueue;
 class ExecutorThread;
+class LocalTaskDeque;
 class TaskLogEntry;
 
 typedef std::vector<ExecutorThread *> ThreadQ;
 typedef std::pair<ExTask, TaskQueue *> TaskQpair;
 typedef std::vector<TaskQueue *> TaskQ;
+typedef std::vector<std::shared_ptr<LocalTaskDeque>> LocalDeques;
 
 class ExecutorPool {
 public:
@@ -199,14 +215,23 @@ public:
 
     size_t schedule(ExTask task);
 
+    bool isWorkStealing() const {
+        return workStealing;
+    }
+
     static ExecutorPool *get(void);
 
     static void shutdown(void);
 
 protected:
 
-    ExecutorPool(size_t t, size_t nTaskSets, size_t r, size_t w, size_t a,
-                 size_t n);
+    ExecutorPool(size_t t,
+                 size_t nTaskSets,
+                 size_t r,
+                 size_t w,
+                 size_t a,
+                 size_t n,
+                 bool workStealing = false);
     virtual ~ExecutorPool(void);
 
     TaskQueue* _nextTask(ExecutorThread &t, uint8_t tick);
@@ -231,8 +256,27 @@ protected:
     TaskQueue* _getTaskQueue(const Taskable& t, task_type_t qidx);
     void _stopAndJoinThreads();
 
+    /**
+     * Steal some of the ready tasks from the local deque of another thread
+     * of the same type, and make the first of them the current task.
+     *
+     * @return the queue the task was fetched from, or nullptr if there was
+     *         nothing to steal
+     */
+    TaskQueue* _stealTask(ExecutorThread& t);
+
+    /// Put the tasks left in a stopped thread's local deque back in the
+    /// queues they came from
+    void _returnLocalTasks(ExecutorThread& t);
+
+    /// Republish the local deques of the threads of the given type (in
+    /// threadQ) for stealing. Caller must hold tMutex.
+    void _updateLocalDeques(task_type_t type);
+
     size_t numTaskSets; // safe to read lock-less not altered after creation
     size_t maxGlobalThreads;
+    const bool workStealing;
+    std::atomic<size_t> nextVictim{0}; // spread the steals over the threads
 
     std::atomic<size_t> totReadyTasks;
     SyncObject mutex; // Thread management condition var + mutex
@@ -254,6 +298,11 @@ protected:
 
     SyncObject tMutex; // to serialize taskLocator, threadQ, numBuckets access
 
+    // Per task type, the local deques of its threads for idle threads to
+    // steal from. Replaced under tMutex and read with std::atomic_load, so
+    // stealing only takes the victim deque's own lock.
+    std::vector<std::shared_ptr<const LocalDeques>> localDeques;
+
     std::atomic<uint16_t> numSleepers; // total number of sleeping threads
     std::vector<std::atomic<uint16_t>> curWorkers; // track # of active workers per TaskSet
     std::vector<std::atomic<uint16_t>> numWorkers; // and limit it to the value set here
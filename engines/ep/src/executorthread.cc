@@ -212,6 +212,61 @@ void ExecutorThread::resetCurrentTask() {
     resetThisObject.reset();
 }
 
+void LocalTaskDeque::push(ExTask task, TaskQueue* q) {
+    LockHolder lh(mutex);
+    tasks.emplace_back(std::move(task), q);
+    ++count;
+}
+
+bool LocalTaskDeque::pop(LocalTask& task) {
+    LockHolder lh(mutex);
+    if (tasks.empty()) {
+        return false;
+    }
+    task = std::move(tasks.front());
+    tasks.pop_front();
+    --count;
+    return true;
+}
+
+TaskQueue* LocalTaskDeque::peekQueue() {
+    LockHolder lh(mutex);
+    return tasks.empty() ? nullptr : tasks.front().second;
+}
+
+std::vector<LocalTaskDeque::LocalTask> LocalTaskDeque::steal() {
+    LockHolder lh(mutex);
+    const size_t n = (tasks.size() + 1) / 2;
+    std::vector<LocalTask> stolen(std::make_move_iterator(tasks.end() - n),
+                                  std::make_move_iterator(tasks.end()));
+    tasks.erase(tasks.end() - n, tasks.end());
+    count -= n;
+    return stolen;
+}
+
+std::vector<LocalTaskDeque::LocalTask> LocalTaskDeque::takeAll() {
+    LockHolder lh(mutex);
+    std::vector<LocalTask> all(std::make_move_iterator(tasks.begin()),
+                               std::make_move_iterator(tasks.end()));
+    tasks.clear();
+    count = 0;
+    return all;
+}
+
+void ExecutorThread::pushLocalTask(ExTask task, TaskQueue* q) {
+    localTasks->push(std::move(task), q);
+}
+
+TaskQueue* ExecutorThread::popLocalTask() {
+    LocalTask task;
+    if (!localTasks->pop(task)) {
+        return nullptr;
+    }
+    manager->lessWork(taskType);
+    setCurrentTask(task.first);
+    return task.second;
+}
+
 cb::const_char_buffer ExecutorThread::getTaskName() {
     LockHolder lh(currentTaskMutex);
     if (currentTask) {
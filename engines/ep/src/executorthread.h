@@ -32,6 +32,7 @@
 #include <deque>
 #include <list>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <string>
@@ -55,11 +56,55 @@ enum executor_state_t {
     EXECUTOR_DEAD
 };
 
+/**
+ * The ready tasks a thread took from a TaskQueue in one fetch (in
+ * priority order). The thread runs them from the front without going
+ * back to the TaskQueue, and idle threads of the same type steal from
+ * the back. Stealers only take the deque's own mutex; they find it via
+ * a shared_ptr (see ExecutorPool::localDeques) so it outlives a thread
+ * which is removed while they are stealing from it.
+ */
+class LocalTaskDeque {
+public:
+    /// A ready task, and the queue it was fetched from
+    using LocalTask = std::pair<ExTask, TaskQueue*>;
+
+    void push(ExTask task, TaskQueue* q);
+
+    /**
+     * Remove the task at the front of the deque.
+     *
+     * @return false if the deque is empty
+     */
+    bool pop(LocalTask& task);
+
+    /// @return the queue of the task at the front, or nullptr if empty
+    TaskQueue* peekQueue();
+
+    /// Take half (rounded up) of the tasks at the back of the deque
+    std::vector<LocalTask> steal();
+
+    /// Take all of the tasks in the deque
+    std::vector<LocalTask> takeAll();
+
+    size_t size() const {
+        return count;
+    }
+
+private:
+    std::mutex mutex;
+    std::deque<LocalTask> tasks;
+    std::atomic<size_t> count{0};
+};
 
 class ExecutorThread {
     friend class ExecutorPool;
     friend class TaskQueue;
 public:
+    using LocalTask = LocalTaskDeque::LocalTask;
+
+    /// Most ready tasks a thread takes from a TaskQueue in one fetch
+    static const size_t MaxLocalTasks = 8;
 
     /* The AtomicProcessTime class provides an abstraction for ensuring that
      * changes to a ProcessClock::time_point are atomic.  This is achieved by
@@ -93,7 +138,8 @@ public:
           now(ProcessClock::now()),
           waketime(ProcessClock::time_point::max()),
           taskStart(),
-          currentTask(NULL) {
+          currentTask(NULL),
+          localTasks(std::make_shared<LocalTaskDeque>()) {
     }
 
     ~ExecutorThread() {
@@ -168,6 +214,46 @@ public:
         now.setTimePoint(ProcessClock::now());
     }
 
+    /**
+     * Add a ready task to the back of the thread's local deque (only used
+     * when the pool is in work-stealing mode).
+     *
+     * @param task the task to add
+     * @param q the queue the task was fetched from (and is rescheduled to)
+     */
+    void pushLocalTask(ExTask task, TaskQueue* q);
+
+    /**
+     * Make the task at the front of the local deque the current task.
+     *
+     * @return the queue the task was fetched from, or nullptr if the local
+     *         deque is empty
+     */
+    TaskQueue* popLocalTask();
+
+    /**
+     * @return the queue the task at the front of the local deque was
+     *         fetched from, or nullptr if the local deque is empty
+     */
+    TaskQueue* peekLocalTaskQueue() {
+        return localTasks->peekQueue();
+    }
+
+    /**
+     * Take all of the tasks in the local deque (once the thread is stopped)
+     */
+    std::vector<LocalTask> takeLocalTasks() {
+        return localTasks->takeAll();
+    }
+
+    size_t getNumLocalTasks() const {
+        return localTasks->size();
+    }
+
+    const std::shared_ptr<LocalTaskDeque>& getLocalTaskDeque() const {
+        return localTasks;
+    }
+
 protected:
 
     cb_thread_t thread;
@@ -185,6 +271,9 @@ protected:
     std::mutex currentTaskMutex; // Protects currentTask
     ExTask currentTask;
 
+    // Ready tasks taken from the TaskQueues in work-stealing mode
+    const std::shared_ptr<LocalTaskDeque> localTasks;
+
     std::mutex logMutex;
     cb::RingBuffer<TaskLogEntry, TASK_LOG_SIZE> tasklog;
     cb::RingBuffer<TaskLogEntry, TASK_LOG_SIZE> slowjobs;
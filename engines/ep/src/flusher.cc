@@ -19,12 +19,14 @@
 
 #include "common.h"
 #include "ep_bucket.h"
+#include "ep_engine.h"
 #include "tasks.h"
 
 #include <platform/timeutils.h>
 
 #include <stdlib.h>
 #include <sstream>
+#include <vector>
 
 Flusher::Flusher(EPBucket* st, KVShard* k)
     : store(st),
@@ -286,12 +288,36 @@ void Flusher::flushVB(void) {
             hpVbs.push(vbid);
         }
     } else {
-        if (doHighPriority && --numHighPriority == 0) {
-            doHighPriority = false;
+        const size_t groupSize = store->getEPEngine()
+                                         .getConfiguration()
+                                         .getFlusherGroupCommitVbuckets();
+        if (groupSize <= 1) {
+            if (doHighPriority && --numHighPriority == 0) {
+                doHighPriority = false;
+            }
+            uint16_t vbid = lpVbs.front();
+            lpVbs.pop();
+            if (store->flushVBucket(vbid) == RETRY_FLUSH_VBUCKET) {
+                lpVbs.push(vbid);
+            }
+            return;
         }
-        uint16_t vbid = lpVbs.front();
-        lpVbs.pop();
-        if (store->flushVBucket(vbid) == RETRY_FLUSH_VBUCKET) {
+
+        // Group commit: drain up to groupSize low priority vbuckets in this
+        // cycle, so their syncs can be issued together. (High priority
+        // vbuckets are always flushed individually above, so their waiters
+        // aren't delayed by the rest of a group.)
+        std::vector<uint16_t> vbids;
+        while (!lpVbs.empty() && vbids.size() < groupSize) {
+            if (doHighPriority && --numHighPriority == 0) {
+                doHighPriority = false;
+            }
+            vbids.push_back(lpVbs.front());
+            lpVbs.pop();
+        }
+        std::vector<uint16_t> retry;
+        store->flushVBuckets(vbids, retry);
+        for (auto vbid : retry) {
             lpVbs.push(vbid);
         }
     }
@@ -22,6 +22,7 @@
 #include "stored_value_factories.h"
 
 #include <phosphor/phosphor.h>
+#include <platform/make_unique.h>
 
 #include <cstring>
 
@@ -38,10 +39,30 @@ std::ostream& operator<<(std::ostream& os, const HashTable::Position& pos) {
     return os;
 }
 
+HashTable::TagIndex::TagIndex(size_t size)
+    : size(size),
+      storage(new char[(size * sizeof(TagBucket)) + cacheLineSize]) {
+    // Align the first TagBucket to a cache line; as sizeof(TagBucket) is a
+    // single cache line every subsequent TagBucket is aligned too.
+    auto addr = reinterpret_cast<uintptr_t>(storage.get());
+    addr = (addr + cacheLineSize - 1) & ~uintptr_t(cacheLineSize - 1);
+    buckets = reinterpret_cast<TagBucket*>(addr);
+    for (size_t i = 0; i < size; ++i) {
+        auto* tb = new (&buckets[i]) TagBucket;
+        tb->version.store(0);
+        tb->count.store(0);
+        for (auto& slot : tb->slots) {
+            slot.store(TaggedPtr<StoredValue>());
+        }
+    }
+}
+
 HashTable::HashTable(EPStats& st,
                      std::unique_ptr<AbstractStoredValueFactory> svFactory,
                      size_t initialSize,
-                     size_t locks)
+                     size_t locks,
+                     IndexType indexType,
+                     size_t hotKeySketchSize)
     : datatypeCounts(),
       cacheSize(0),
       metaDataMemory(0),
@@ -58,8 +79,20 @@ HashTable::HashTable(EPStats& st,
       numResizes(0),
       numTempItems(0),
       memSize(0),
-      maxDeletedRevSeqno(0) {
+      maxDeletedRevSeqno(0),
+      indexType(indexType),
+      tagIndex(nullptr),
+      numOptimisticFinds(0),
+      hotKeys(hotKeySketchSize
+                      ? std::make_unique<HotKeySketch>(hotKeySketchSize)
+                      : nullptr) {
+    static_assert(sizeof(TagBucket) == 64,
+                  "TagBucket should occupy exactly one cache line");
     values.resize(size);
+    if (indexType == IndexType::Tagged) {
+        ownedTagIndex = std::make_unique<TagIndex>(size);
+        tagIndex.store(ownedTagIndex.get());
+    }
     activeState = true;
 }
 
@@ -92,6 +125,9 @@ void HashTable::clear(bool deactivate) {
                     "non-active object");
         }
     }
+    // Serialise with any incremental resize, which clear_UNLOCKED() may
+    // complete.
+    std::lock_guard<std::mutex> rlh(resizeLock);
     MultiLockHolder mlh(mutexes);
     clear_UNLOCKED(deactivate);
 }
@@ -102,15 +138,26 @@ void HashTable::clear_UNLOCKED(bool deactivate) {
     }
     size_t clearedMemSize = 0;
     size_t clearedValSize = 0;
-    for (int i = 0; i < (int)size; i++) {
-        while (values[i]) {
+    const int numBuckets = static_cast<int>(getNumBucketsInUse());
+    for (int i = 0; i < numBuckets; i++) {
+        auto& chain = getChain(i);
+        while (chain) {
             // Take ownership of the StoredValue from the vector, update
             // statistics and release it.
-            auto v = std::move(values[i]);
+            auto v = std::move(chain);
             clearedMemSize += v->size();
             clearedValSize += v->valuelen();
-            values[i] = std::move(v->getNext());
+            chain = std::move(v->getNext());
         }
+        if (indexType == IndexType::Tagged) {
+            tagIndexRebuild(getTagBucket(i), chain);
+        }
+    }
+
+    // Nothing left to migrate; complete any in-progress resize. (When
+    // deactivating, the owner has already accounted for our memory.)
+    if (isResizing() && !deactivate) {
+        finishResize();
     }
 
     stats.currentSize.fetch_sub(clearedMemSize - clearedValSize);
@@ -137,6 +184,10 @@ static bool isCurrently(size_t size, ssize_t a, ssize_t b) {
 }
 
 void HashTable::resize() {
+    resize(getPreferredSize());
+}
+
+size_t HashTable::getPreferredSize() {
     size_t ni = getNumInMemoryItems();
     int i(0);
     size_t new_size(0);
@@ -164,7 +215,7 @@ void HashTable::resize() {
         new_size = nearest(ni, prime_size_table[i-1], prime_size_table[i]);
     }
 
-    resize(new_size);
+    return new_size;
 }
 
 void HashTable::resize(size_t newSize) {
@@ -173,57 +224,217 @@ void HashTable::resize(size_t newSize) {
                 "non-active object");
     }
 
+    // Avoid taking any locks when there's nothing to do.
+    if (newSize == size && !isResizing()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> rlh(resizeLock);
+
+    // Complete any incremental resize already in progress, then perform
+    // the requested one. Either stops early if a visitor is running (visitors
+    // rely on the bucket layout being stable); the next attempt will have to
+    // pick it up.
+    migrateBuckets(std::numeric_limits<size_t>::max());
+    if (!isResizing() && beginResize(newSize)) {
+        migrateBuckets(std::numeric_limits<size_t>::max());
+    }
+    reclaimTagIndexes();
+}
+
+size_t HashTable::resizeStep(size_t maxBuckets) {
+    if (!isActive()) {
+        throw std::logic_error("HashTable::resizeStep: Cannot call on a "
+                "non-active object");
+    }
+
+    std::lock_guard<std::mutex> rlh(resizeLock);
+    reclaimTagIndexes();
+    if (!isResizing() && !beginResize(getPreferredSize())) {
+        // Already the preferred size (or a visitor is running).
+        return 0;
+    }
+    migrateBuckets(maxBuckets);
+    return getNumBucketsToMigrate();
+}
+
+void HashTable::reclaimTagIndexes() {
+    if (retiredTagIndexes.empty()) {
+        return;
+    }
+    // The retired indexes were unpublished before now, so a reader which
+    // registers after we observe its count as zero loads a current index.
+    // Readers which registered earlier hold the count above zero.
+    for (const auto& readers : tagIndexReaders) {
+        if (readers.count.load() != 0) {
+            // Try again on the next resize step.
+            return;
+        }
+    }
+    retiredTagIndexes.clear();
+}
+
+bool HashTable::beginResize(size_t newSize) {
     // Due to the way hashing works, we can't fit anything larger than
     // an int.
     if (newSize > static_cast<size_t>(std::numeric_limits<int>::max())) {
-        return;
+        return false;
     }
 
     // Don't resize to the same size, either.
     if (newSize == size) {
-        return;
+        return false;
     }
 
-    TRACE_EVENT2(
-            "HashTable", "resize", "size", size.load(), "newSize", newSize);
+    if (isResizing()) {
+        throw std::logic_error(
+                "HashTable::beginResize: resize already in progress");
+    }
+
+    // Allocating the new buckets (and their index) is O(newSize), so do so
+    // before taking the locks; only the swap is done while holding them.
+    table_type newValues(newSize);
+    std::unique_ptr<TagIndex> newTagIndex;
+    if (indexType == IndexType::Tagged) {
+        newTagIndex = std::make_unique<TagIndex>(newSize);
+    }
 
     MultiLockHolder mlh(mutexes);
     if (visitors.load() > 0) {
         // Do not allow a resize while any visitors are actually
-        // processing.  The next attempt will have to pick it up.  New
-        // visitors cannot start doing meaningful work (we own all
-        // locks at this point).
-        return;
+        // processing. New visitors cannot start doing meaningful work (we
+        // own all locks at this point).
+        return false;
     }
 
-    // Get a place for the new items.
-    table_type newValues(newSize);
+    TRACE_EVENT2(
+            "HashTable", "resize", "size", size.load(), "newSize", newSize);
 
     stats.memOverhead->fetch_sub(memorySize());
     ++numResizes;
 
-    // Set the new size so all the hashy stuff works.
-    size_t oldSize = size;
+    // The current buckets become the old buckets, to be migrated into the
+    // new (empty) buckets by migrateBuckets().
+    oldValues = std::move(values);
+    values = std::move(newValues);
+    migratedBuckets.store(0);
+    oldSize.store(size);
     size.store(newSize);
 
-    // Move existing records into the new space.
-    for (size_t i = 0; i < oldSize; i++) {
-        while (values[i]) {
-            // unlink the front element from the hash chain at values[i].
-            auto v = std::move(values[i]);
-            values[i] = std::move(v->getNext());
+    if (indexType == IndexType::Tagged) {
+        // The current TagIndex continues to index the old buckets until they
+        // are migrated. Publishing the new index signals lock-free readers
+        // which probed the old one to retry with a locked lookup.
+        oldTagIndex = std::move(ownedTagIndex);
+        ownedTagIndex = std::move(newTagIndex);
+        tagIndex.store(ownedTagIndex.get());
+    }
 
-            // And re-link it into the correct place in newValues.
-            int newBucket = getBucketForHash(v->getKey().hash());
-            v->setNext(std::move(newValues[newBucket]));
-            newValues[newBucket] = std::move(v);
+    stats.memOverhead->fetch_add(memorySize());
+    return true;
+}
+
+void HashTable::migrateBuckets(size_t maxBuckets) {
+    for (size_t ii = 0; ii < maxBuckets && isResizing(); ++ii) {
+        if (!migrateBucket()) {
+            return;
         }
     }
+}
 
-    // Finally assign the new table to values.
-    values = std::move(newValues);
+bool HashTable::migrateBucket() {
+    const size_t oldBucket = migratedBuckets;
+    const bool last = (oldBucket + 1 == oldSize);
+    const int newSize = static_cast<int>(size);
+    const size_t oldLock = mutexForBucket(newSize + oldBucket);
+    auto& chain = oldValues[oldBucket];
+    auto newBucketFor = [newSize](const StoredValue& v) {
+        return abs(static_cast<int>(v.getKey().hash()) % newSize);
+    };
+
+    // Freed once the locks have been released.
+    table_type retiredValues;
+
+    while (true) {
+        // Lock the old bucket's stripe and the stripes of the new buckets its
+        // items move to - or every stripe to finish the resize. Stripe 0 is
+        // always locked, as visitors register under it (see visit()).
+        std::vector<bool> needed(mutexes.size(), last);
+        needed[0] = true;
+        needed[oldLock] = true;
+        {
+            LockHolder lh(mutexes[oldLock]);
+            for (auto* v = chain.get().get(); v; v = v->getNext().get().get()) {
+                needed[mutexForBucket(newBucketFor(*v))] = true;
+            }
+        }
+
+        // Acquired in ascending order, as MultiLockHolder does.
+        std::vector<std::unique_lock<std::mutex>> lhs;
+        for (size_t l = 0; l < needed.size(); ++l) {
+            if (needed[l]) {
+                lhs.emplace_back(mutexes[l]);
+            }
+        }
+
+        if (visitors.load() > 0) {
+            // As per beginResize(); visitors rely on the bucket layout being
+            // stable.
+            return false;
+        }
+
+        // Items may have been added to the chain while it was unlocked;
+        // retry if any of them move to a stripe we don't hold.
+        bool locked = true;
+        for (auto* v = chain.get().get(); v && locked;
+             v = v->getNext().get().get()) {
+            locked = needed[mutexForBucket(newBucketFor(*v))];
+        }
+        if (!locked) {
+            continue;
+        }
+
+        while (chain) {
+            // unlink the front element from the old hash chain.
+            auto v = std::move(chain);
+            chain = std::move(v->getNext());
+
+            // And re-link it into the correct place in the new buckets.
+            const int newBucket = newBucketFor(*v);
+            v->setNext(std::move(values[newBucket]));
+            values[newBucket] = std::move(v);
+            tagIndexInsert(newBucket, *values[newBucket]);
+        }
+        if (indexType == IndexType::Tagged) {
+            tagIndexRebuild((*oldTagIndex)[oldBucket], chain);
+        }
+
+        // The old bucket's keys are now located in the new buckets.
+        migratedBuckets.store(oldBucket + 1);
+
+        if (last) {
+            retiredValues = finishResize();
+        }
+        return true;
+    }
+}
+
+HashTable::table_type HashTable::finishResize() {
+    stats.memOverhead->fetch_sub(memorySize());
+
+    table_type retiredValues = std::move(oldValues);
+    oldValues = table_type();
+    oldSize.store(0);
+    migratedBuckets.store(0);
+
+    if (oldTagIndex) {
+        // Retire rather than free the old TagIndex, as lock-free readers
+        // may still be probing it; see reclaimTagIndexes().
+        retiredTagIndexes.push_back(std::move(oldTagIndex));
+    }
 
     stats.memOverhead->fetch_add(memorySize());
+    return retiredValues;
 }
 
 StoredValue* HashTable::find(const DocKey& key,
@@ -233,19 +444,24 @@ StoredValue* HashTable::find(const DocKey& key,
         throw std::logic_error("HashTable::find: Cannot call on a "
                 "non-active object");
     }
+    if (indexType == IndexType::Tagged && tagIndexDefinitelyAbsent(key)) {
+        ++numOptimisticFinds;
+        return nullptr;
+    }
     HashBucketLock hbl = getLockedBucket(key);
     return unlocked_find(key, hbl.getBucketNum(), wantsDeleted, trackReference);
 }
 
 std::unique_ptr<Item> HashTable::getRandomKey(long rnd) {
     /* Try to locate a partition */
-    size_t start = rnd % size;
+    const size_t numBuckets = getNumBucketsInUse();
+    size_t start = rnd % numBuckets;
     size_t curr = start;
     std::unique_ptr<Item> ret;
 
     do {
         ret = getRandomKeyFromSlot(curr++);
-        if (curr == size) {
+        if (curr == numBuckets) {
             curr = 0;
         }
     } while (ret == NULL && curr != start);
@@ -311,12 +527,14 @@ StoredValue* HashTable::unlocked_addNewStoredValue(const HashBucketLock& hbl,
     }
 
     // Create a new StoredValue and link it into the head of the bucket chain.
-    auto v = (*valFact)(itm, std::move(values[hbl.getBucketNum()]));
+    auto& chain = getChain(hbl.getBucketNum());
+    auto v = (*valFact)(itm, std::move(chain));
 
     statsEpilogue(*v.get());
 
-    values[hbl.getBucketNum()] = std::move(v);
-    return values[hbl.getBucketNum()].get().get();
+    chain = std::move(v);
+    tagIndexInsert(hbl.getBucketNum(), *chain);
+    return chain.get().get();
 }
 
 void HashTable::statsPrologue(const StoredValue& v) {
@@ -380,14 +598,15 @@ HashTable::unlocked_replaceByCopy(const HashBucketLock& hbl,
     auto releasedSv = unlocked_release(hbl, vToCopy.getKey());
 
     /* Copy the StoredValue and link it into the head of the bucket chain. */
-    auto newSv = valFact->copyStoredValue(
-            vToCopy, std::move(values[hbl.getBucketNum()]));
+    auto& chain = getChain(hbl.getBucketNum());
+    auto newSv = valFact->copyStoredValue(vToCopy, std::move(chain));
 
     // Adding a new item into the HashTable; update stats.
     statsEpilogue(*newSv.get());
 
-    values[hbl.getBucketNum()] = std::move(newSv);
-    return {values[hbl.getBucketNum()].get().get(), std::move(releasedSv)};
+    chain = std::move(newSv);
+    tagIndexInsert(hbl.getBucketNum(), *chain);
+    return {chain.get().get(), std::move(releasedSv)};
 }
 
 void HashTable::unlocked_softDelete(const std::unique_lock<std::mutex>& htLock,
@@ -408,18 +627,28 @@ StoredValue* HashTable::unlocked_find(const DocKey& key,
                                       int bucket_num,
                                       WantsDeleted wantsDeleted,
                                       TrackReference trackReference) {
-    for (StoredValue* v = values[bucket_num].get().get(); v;
-            v = v->getNext().get().get()) {
-        if (v->hasKey(key)) {
-            if (trackReference == TrackReference::Yes && !v->isDeleted()) {
-                v->referenced();
+    StoredValue* v = nullptr;
+    if (indexType == IndexType::Tagged) {
+        v = tagIndexFind(key, bucket_num);
+    } else {
+        for (v = getChain(bucket_num).get().get(); v;
+             v = v->getNext().get().get()) {
+            if (v->hasKey(key)) {
+                break;
             }
-            if (wantsDeleted == WantsDeleted::Yes || !v->isDeleted()) {
-                return v;
-            } else {
-                return NULL;
+        }
+    }
+
+    if (v) {
+        if (trackReference == TrackReference::Yes && !v->isDeleted()) {
+            v->referenced();
+            if (hotKeys && v->getNRUValue() == MIN_NRU_VALUE) {
+                hotKeys->sample(key);
             }
         }
+        if (wantsDeleted == WantsDeleted::Yes || !v->isDeleted()) {
+            return v;
+        }
     }
     return NULL;
 }
@@ -444,7 +673,7 @@ StoredValue::UniquePtr HashTable::unlocked_release(
 
     // Remove the first (should only be one) StoredValue with the given key.
     auto released = hashChainRemoveFirst(
-            values[hbl.getBucketNum()],
+            getChain(hbl.getBucketNum()),
             [key](const StoredValue* v) { return v->hasKey(key); });
 
     if (!released) {
@@ -454,6 +683,7 @@ StoredValue::UniquePtr HashTable::unlocked_release(
                 "HashTable::unlocked_release: StoredValue to be released "
                 "not found in HashTable; possibly HashTable leak");
     }
+    tagIndexRemove(hbl.getBucketNum(), released.get().get());
 
     // Update statistics for the item which is now gone.
     statsPrologue(*released.get());
@@ -528,14 +758,17 @@ void HashTable::visit(HashTableVisitor &visitor) {
     VisitorTracker vt(&visitors);
     lh.unlock();
 
+    // The bucket layout cannot change (including resize migration) while
+    // we are registered as a visitor.
+    const int numBuckets = static_cast<int>(getNumBucketsInUse());
     size_t visited = 0;
     for (int l = 0; isActive() && l < static_cast<int>(mutexes.size()); l++) {
-        for (int i = l; i < static_cast<int>(size); i+= mutexes.size()) {
+        for (int i = l; i < numBuckets; i+= mutexes.size()) {
             // (re)acquire mutex on each HashBucket, to minimise any impact
             // on front-end threads.
             HashBucketLock lh(i, mutexes[l]);
 
-            StoredValue* v = values[i].get().get();
+            StoredValue* v = getChain(i).get().get();
             if (v) {
                 // TODO: Perf: This check seems costly - do we think it's still
                 // worth keeping?
@@ -565,11 +798,12 @@ void HashTable::visitDepth(HashTableDepthVisitor &visitor) {
     size_t visited = 0;
     VisitorTracker vt(&visitors);
 
+    const int numBuckets = static_cast<int>(getNumBucketsInUse());
     for (int l = 0; l < static_cast<int>(mutexes.size()); l++) {
         LockHolder lh(mutexes[l]);
-        for (int i = l; i < static_cast<int>(size); i+= mutexes.size()) {
+        for (int i = l; i < numBuckets; i+= mutexes.size()) {
             size_t depth = 0;
-            StoredValue* p = values[i].get().get();
+            StoredValue* p = getChain(i).get().get();
             if (p) {
                 // TODO: Perf: This check seems costly - do we think it's still
                 // worth keeping?
@@ -621,6 +855,8 @@ HashTable::Position HashTable::pauseResumeVisit(HashTableVisitor& visitor,
     // Start from the requested lock number if in range.
     size_t lock = (start_pos.lock < mutexes.size()) ? start_pos.lock : 0;
     size_t hash_bucket = 0;
+    // Includes the old buckets of an in-progress resize.
+    const size_t numBuckets = getNumBucketsInUse();
 
     for (; isActive() && !paused && lock < mutexes.size(); lock++) {
 
@@ -628,18 +864,19 @@ HashTable::Position HashTable::pauseResumeVisit(HashTableVisitor& visitor,
         // recorded bucket (as long as we haven't resized).
         hash_bucket = lock;
         if (start_pos.lock == lock &&
-            start_pos.ht_size == size &&
-            start_pos.hash_bucket < size) {
+            start_pos.ht_size == numBuckets &&
+            start_pos.hash_bucket < numBuckets) {
             hash_bucket = start_pos.hash_bucket;
         }
 
         // Iterate across all values in the hash buckets owned by this lock.
         // Note: we don't record how far into the bucket linked-list we
         // pause at; so any restart will begin from the next bucket.
-        for (; !paused && hash_bucket < size; hash_bucket += mutexes.size()) {
+        for (; !paused && hash_bucket < numBuckets;
+             hash_bucket += mutexes.size()) {
             HashBucketLock lh(hash_bucket, mutexes[lock]);
 
-            StoredValue* v = values[hash_bucket].get().get();
+            StoredValue* v = getChain(hash_bucket).get().get();
             while (!paused && v) {
                 StoredValue* tmp = v->getNext().get().get();
                 paused = !visitor.visit(lh, *v);
@@ -650,21 +887,22 @@ HashTable::Position HashTable::pauseResumeVisit(HashTableVisitor& visitor,
         // If the visitor paused us before we visited all hash buckets owned
         // by this lock, we don't want to skip the remaining hash buckets, so
         // stop the outer for loop from advancing to the next lock.
-        if (paused && hash_bucket < size) {
+        if (paused && hash_bucket < numBuckets) {
             break;
         }
 
-        // Finished all buckets owned by this lock. Set hash_bucket to 'size'
-        // to give a consistent marker for "end of lock".
-        hash_bucket = size;
+        // Finished all buckets owned by this lock. Set hash_bucket to
+        // 'numBuckets' to give a consistent marker for "end of lock".
+        hash_bucket = numBuckets;
     }
 
     // Return the *next* location that should be visited.
-    return HashTable::Position(size, lock, hash_bucket);
+    return HashTable::Position(numBuckets, lock, hash_bucket);
 }
 
 HashTable::Position HashTable::endPosition() const  {
-    return HashTable::Position(size, mutexes.size(), size);
+    const size_t numBuckets = getNumBucketsInUse();
+    return HashTable::Position(numBuckets, mutexes.size(), numBuckets);
 }
 
 bool HashTable::unlocked_ejectItem(StoredValue*& vptr,
@@ -693,8 +931,9 @@ bool HashTable::unlocked_ejectItem(StoredValue*& vptr,
 
             // Remove the item from the hash table.
             auto removed = hashChainRemoveFirst(
-                    values[bucket_num],
+                    getChain(bucket_num),
                     [vptr](const StoredValue* v) { return v == vptr; });
+            tagIndexRemove(bucket_num, vptr);
 
             if (removed->isResident()) {
                 ++stats.numValueEjects;
@@ -718,7 +957,11 @@ bool HashTable::unlocked_ejectItem(StoredValue*& vptr,
 
 std::unique_ptr<Item> HashTable::getRandomKeyFromSlot(int slot) {
     auto lh = getLockedBucket(slot);
-    for (StoredValue* v = values[slot].get().get(); v;
+    if (static_cast<size_t>(slot) >= getNumBucketsInUse()) {
+        // A resize completed and this old bucket no longer exists.
+        return nullptr;
+    }
+    for (StoredValue* v = getChain(slot).get().get(); v;
             v = v->getNext().get().get()) {
         if (!v->isTempItem() && !v->isDeleted() && v->isResident()) {
             return v->toItem(false, 0);
@@ -747,13 +990,17 @@ bool HashTable::unlocked_restoreValue(
         decrNumNonResidentItems();
     }
 
+    // Restoring may store the value inline, which changes how much of the
+    // StoredValue is accounted as metadata.
+    reduceMetaDataSize(stats, v.metaDataSize());
     v.restoreValue(itm);
+    increaseMetaDataSize(stats, v.metaDataSize());
 
     if (v.isDeleted()) {
         ++numDeletedItems;
     }
 
-    increaseCacheSize(v.getValue()->valueSize());
+    increaseCacheSize(v.valuelen());
     return true;
 }
 
@@ -781,6 +1028,157 @@ void HashTable::unlocked_restoreMeta(const std::unique_lock<std::mutex>& htLock,
     }
 }
 
+void HashTable::tagIndexInsert(int bucket_num, const StoredValue& v) {
+    if (indexType != IndexType::Tagged) {
+        return;
+    }
+    auto& tb = getTagBucket(bucket_num);
+    const TaggedPtr<StoredValue> entry(const_cast<StoredValue*>(&v),
+                                       getTagForHash(v.getKey().hash()));
+
+    // Only the ht_lock holder modifies a TagBucket, so relaxed loads of our
+    // own previous writes are fine; the version bumps order the slot stores
+    // for lock-free readers.
+    const auto version = tb.version.load(std::memory_order_relaxed);
+    tb.version.store(version + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const auto count = tb.count.load(std::memory_order_relaxed);
+    if (count < TagBucket::numSlots) {
+        for (auto& slot : tb.slots) {
+            if (!slot.load(std::memory_order_relaxed)) {
+                slot.store(entry, std::memory_order_relaxed);
+                break;
+            }
+        }
+    }
+    // else: the chain has overflowed the slots; lookups walk the chain until
+    // enough elements are removed for tagIndexRemove to rebuild the slots.
+    tb.count.store(count + 1, std::memory_order_relaxed);
+
+    tb.version.store(version + 2, std::memory_order_release);
+}
+
+void HashTable::tagIndexRemove(int bucket_num, const StoredValue* v) {
+    if (indexType != IndexType::Tagged) {
+        return;
+    }
+    auto& tb = getTagBucket(bucket_num);
+    const auto count = tb.count.load(std::memory_order_relaxed);
+    if (count > TagBucket::numSlots) {
+        // Overflowed - the removed element may not have a slot. Re-derive
+        // the slots from the (already unlinked) chain.
+        tagIndexRebuild(tb, getChain(bucket_num));
+        return;
+    }
+
+    const auto version = tb.version.load(std::memory_order_relaxed);
+    tb.version.store(version + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (auto& slot : tb.slots) {
+        if (slot.load(std::memory_order_relaxed).get() == v) {
+            slot.store(TaggedPtr<StoredValue>(), std::memory_order_relaxed);
+            break;
+        }
+    }
+    tb.count.store(count - 1, std::memory_order_relaxed);
+
+    tb.version.store(version + 2, std::memory_order_release);
+}
+
+void HashTable::tagIndexRebuild(TagBucket& tb,
+                                const StoredValue::UniquePtr& chain) {
+    const auto version = tb.version.load(std::memory_order_relaxed);
+    tb.version.store(version + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    uint32_t count = 0;
+    for (StoredValue* v = chain.get().get(); v; v = v->getNext().get().get()) {
+        if (count < TagBucket::numSlots) {
+            tb.slots[count].store(
+                    TaggedPtr<StoredValue>(v, getTagForHash(v->getKey().hash())),
+                    std::memory_order_relaxed);
+        }
+        ++count;
+    }
+    for (size_t i = count; i < TagBucket::numSlots; ++i) {
+        tb.slots[i].store(TaggedPtr<StoredValue>(), std::memory_order_relaxed);
+    }
+    tb.count.store(count, std::memory_order_relaxed);
+
+    tb.version.store(version + 2, std::memory_order_release);
+}
+
+bool HashTable::tagIndexDefinitelyAbsent(const DocKey& key) {
+    const uint32_t hash = key.hash();
+    // Registered before loading the index, so reclaimTagIndexes() doesn't
+    // free it while we probe.
+    auto& readers = tagIndexReaders[hash % tagIndexReaders.size()].count;
+    readers.fetch_add(1);
+    const bool absent = tagIndexProbe(key, hash);
+    readers.fetch_sub(1);
+    return absent;
+}
+
+bool HashTable::tagIndexProbe(const DocKey& key, uint32_t hash) {
+    TagIndex* index = tagIndex.load();
+    if (isResizing()) {
+        // Keys may be in either the old or new buckets; the final check of
+        // tagIndex below catches a resize which starts after this point.
+        return false;
+    }
+    const int bucket_num =
+            abs(static_cast<int>(hash) % static_cast<int>(index->size));
+    const uint16_t tag = getTagForHash(hash);
+    auto& tb = (*index)[bucket_num];
+
+    const auto version = tb.version.load(std::memory_order_acquire);
+    if (version & 1) {
+        // Writer in progress.
+        return false;
+    }
+    if (tb.count.load(std::memory_order_relaxed) > TagBucket::numSlots) {
+        // Overflowed; slots do not describe the entire chain.
+        return false;
+    }
+    for (const auto& slot : tb.slots) {
+        auto entry = slot.load(std::memory_order_relaxed);
+        if (entry && entry.getTag() == tag) {
+            // Possible match - only a locked lookup can compare the key.
+            return false;
+        }
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (tb.version.load(std::memory_order_relaxed) != version) {
+        return false;
+    }
+    // Finally check the index wasn't replaced by a resize while probing.
+    return tagIndex.load(std::memory_order_acquire) == index;
+}
+
+StoredValue* HashTable::tagIndexFind(const DocKey& key, int bucket_num) {
+    auto& tb = getTagBucket(bucket_num);
+    if (tb.count.load(std::memory_order_relaxed) > TagBucket::numSlots) {
+        for (StoredValue* v = getChain(bucket_num).get().get(); v;
+             v = v->getNext().get().get()) {
+            if (v->hasKey(key)) {
+                return v;
+            }
+        }
+        return nullptr;
+    }
+
+    const uint16_t tag = getTagForHash(key.hash());
+    for (const auto& slot : tb.slots) {
+        auto entry = slot.load(std::memory_order_relaxed);
+        if (entry && entry.getTag() == tag && entry->hasKey(key)) {
+            return entry.get();
+        }
+    }
+    return nullptr;
+}
+
 void HashTable::increaseCacheSize(size_t by) {
     cacheSize.fetch_add(by);
     memSize.fetch_add(by);
@@ -809,11 +1207,13 @@ std::ostream& operator<<(std::ostream& os, const HashTable& ht) {
        << " numNonResident:" << ht.getNumInMemoryNonResItems()
        << " numTemp:" << ht.getNumTempItems()
        << " values: " << std::endl;
-    for (const auto& chain : ht.values) {
-        if (chain) {
-            for (StoredValue* sv = chain.get().get(); sv != nullptr;
-                 sv = sv->getNext().get().get()) {
-                os << "    " << *sv << std::endl;
+    for (const auto* table : {&ht.values, &ht.oldValues}) {
+        for (const auto& chain : *table) {
+            if (chain) {
+                for (StoredValue* sv = chain.get().get(); sv != nullptr;
+                     sv = sv->getNext().get().get()) {
+                    os << "    " << *sv << std::endl;
+                }
             }
         }
     }
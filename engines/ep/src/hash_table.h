@@ -18,12 +18,15 @@
 #pragma once
 
 #include "config.h"
+#include "hot_key_sketch.h"
 #include "storeddockey.h"
 #include "stored-value.h"
 
 #include <platform/histogram.h>
 #include <platform/non_negative_counter.h>
 
+#include <array>
+
 class AbstractStoredValueFactory;
 class HashTableStatVisitor;
 class HashTableVisitor;
@@ -95,6 +98,18 @@ enum class TempAddStatus : uint8_t {
 class HashTable {
 public:
 
+    /**
+     * How lookups locate a StoredValue within a hash bucket.
+     *
+     * - Chained: walk the bucket's chain of StoredValues, comparing keys.
+     * - Tagged: additionally maintain a cache-line sized TagBucket per hash
+     *   bucket holding (tag, pointer) slots for the chain; lookups compare
+     *   the 16-bit tags first and only dereference StoredValues whose tag
+     *   matches. Negative lookups via find() are performed optimistically,
+     *   without acquiring the ht_lock.
+     */
+    enum class IndexType : uint8_t { Chained, Tagged };
+
     /**
      * Represents a position within the hashtable.
      *
@@ -179,25 +194,83 @@ public:
      * @param svFactory Factory to use for constructing stored values
      * @param initialSize the number of hash table buckets to initially create.
      * @param locks the number of locks in the hash table
+     * @param indexType how StoredValues are located within a hash bucket
+     * @param hotKeySketchSize the number of keys to keep in a HotKeySketch of
+     *        the most referenced items (0 to not keep one)
      */
     HashTable(EPStats& st,
               std::unique_ptr<AbstractStoredValueFactory> svFactory,
               size_t initialSize,
-              size_t locks);
+              size_t locks,
+              IndexType indexType = IndexType::Chained,
+              size_t hotKeySketchSize = 0);
 
     ~HashTable();
 
     size_t memorySize() {
+        const size_t numBuckets = getNumBucketsInUse();
         return sizeof(HashTable)
-            + (size * sizeof(StoredValue*))
-            + (mutexes.size() * sizeof(std::mutex));
+            + (numBuckets * sizeof(StoredValue*))
+            + (mutexes.size() * sizeof(std::mutex))
+            + (indexType == IndexType::Tagged ? numBuckets * sizeof(TagBucket)
+                                              : 0);
+    }
+
+    /**
+     * Get the type of index used to locate items within a hash bucket.
+     */
+    IndexType getIndexType() const {
+        return indexType;
+    }
+
+    /**
+     * Get the number of find() calls which were answered from the tag index
+     * without acquiring an ht_lock (only non-zero for IndexType::Tagged).
+     */
+    size_t getNumOptimisticFinds() const {
+        return numOptimisticFinds;
+    }
+
+    /**
+     * Append the keys held by the hot key sketch to keys (does nothing if
+     * the hash table doesn't keep one).
+     */
+    void getHotKeys(std::vector<StoredDocKey>& keys) const {
+        if (hotKeys) {
+            hotKeys->getKeys(keys);
+        }
     }
 
     /**
-     * Get the number of hash table buckets this hash table has.
+     * Get the number of hash table buckets this hash table has. If a resize
+     * is in progress this is the size being resized to.
      */
     size_t getSize(void) { return size; }
 
+    /**
+     * Is an incremental resize in progress (i.e. are there still buckets to
+     * migrate from the old bucket array to the new one)?
+     */
+    bool isResizing() const {
+        return oldSize != 0;
+    }
+
+    /**
+     * Get the number of old buckets still to be migrated by the
+     * in-progress resize (zero if not resizing).
+     */
+    size_t getNumBucketsToMigrate() const {
+        return oldSize - migratedBuckets;
+    }
+
+    /**
+     * Get the number of buckets in the old bucket array of the in-progress
+     * resize (zero if not resizing).
+     */
+    size_t getResizeOldSize() const {
+        return oldSize;
+    }
+
     /**
      * Get the number of locks in this hash table.
      */
@@ -284,14 +357,34 @@ public:
 
     /**
      * Automatically resize to fit the current data.
+     * Returns once the resize is complete (see resize(size_t)).
      */
     void resize();
 
     /**
-     * Resize to the specified size.
+     * Resize to the specified size, completing any in-progress incremental
+     * resize first. Returns once all buckets have been migrated (unless a
+     * visitor is running, in which case the resize is left to a later
+     * attempt); buckets are migrated as per resizeStep().
      */
     void resize(size_t to);
 
+    /**
+     * Perform one step of an incremental resize.
+     *
+     * If no resize is in progress, begins one to fit the current data (if
+     * required). The old and new bucket arrays are then both live until all
+     * old buckets have been migrated; lookups and mutations locate a key in
+     * the old buckets until its bucket is migrated, and in the new buckets
+     * afterwards. Each step migrates at most maxBuckets old buckets, one at
+     * a time and each holding only the locks of the stripes it touches, so
+     * front-end operations on other stripes (or between buckets) proceed.
+     *
+     * @param maxBuckets maximum number of old buckets to migrate.
+     * @return the number of old buckets still to be migrated.
+     */
+    size_t resizeStep(size_t maxBuckets);
+
     /**
      * Find the item with the given key.
      *
@@ -655,6 +748,52 @@ private:
     // The container for actually holding the StoredValues.
     using table_type = std::vector<StoredValue::UniquePtr>;
 
+    /**
+     * A cache-line sized index over the chain of a single hash bucket
+     * (IndexType::Tagged only).
+     *
+     * Each slot holds a TaggedPtr to one StoredValue in the chain, where the
+     * top 16 bits of the pointer (the same bits StoredValue uses for its
+     * chain tag) carry a tag derived from the key's hash. A lookup scans the
+     * tags within the one cache line and only dereferences the StoredValues
+     * whose tag matches, instead of chasing every `next` pointer.
+     *
+     * The chain remains the owner of the StoredValues; slots are updated
+     * alongside the chain under the bucket's ht_lock. `version` is a
+     * sequence lock - writers make it odd while updating the slots - which
+     * allows readers to probe the slots without taking the ht_lock. If the
+     * chain is longer than numSlots then `count` exceeds numSlots and
+     * lookups fall back to walking the chain.
+     */
+    struct TagBucket {
+        static const size_t numSlots = 7;
+
+        std::atomic<uint32_t> version;
+        std::atomic<uint32_t> count;
+        std::array<std::atomic<TaggedPtr<StoredValue>>, numSlots> slots;
+    };
+
+    /**
+     * Array of TagBuckets, one per hash bucket, each aligned to a cache line.
+     */
+    class TagIndex {
+    public:
+        explicit TagIndex(size_t size);
+
+        TagBucket& operator[](size_t bucket) {
+            return buckets[bucket];
+        }
+
+        /// Number of TagBuckets (equal to the HashTable size it indexes).
+        const size_t size;
+
+    private:
+        static const size_t cacheLineSize = 64;
+
+        std::unique_ptr<char[]> storage;
+        TagBucket* buckets;
+    };
+
     friend class StoredValue;
     friend std::ostream& operator<<(std::ostream& os, const HashTable& ht);
 
@@ -668,7 +807,25 @@ private:
     // in `values`
     std::atomic<size_t> size;
     table_type values;
+
+    /*
+     * Incremental resize state. While resizing, `oldValues` holds the bucket
+     * array being resized from; buckets [0, migratedBuckets) of it have
+     * been moved into `values`. The arrays are swapped (and `size` /
+     * `oldSize` changed) holding all locks; `migratedBuckets` is advanced
+     * holding the locks of the bucket being migrated.
+     *
+     * Bucket numbers (as held by HashBucketLock) address both arrays:
+     * [0, size) are buckets of `values`, [size, size + oldSize) are buckets
+     * of `oldValues`.
+     */
+    table_type oldValues;
+    std::atomic<size_t> oldSize{0};
+    std::atomic<size_t> migratedBuckets{0};
     std::vector<std::mutex> mutexes;
+    /// Serialises resizing (and clear(), which may complete a resize).
+    /// Acquired before any of `mutexes`.
+    std::mutex resizeLock;
     EPStats&             stats;
     std::unique_ptr<AbstractStoredValueFactory> valFact;
     std::atomic<size_t>       visitors;
@@ -690,10 +847,161 @@ private:
     std::atomic<uint64_t> maxDeletedRevSeqno;
     bool                 activeState;
 
+    const IndexType indexType;
+
+    /**
+     * The current TagIndex (null for IndexType::Chained). Readers which
+     * probe without an ht_lock load this once and verify it is unchanged
+     * after probing; resize() publishes a new index while holding all locks.
+     */
+    std::atomic<TagIndex*> tagIndex;
+    std::unique_ptr<TagIndex> ownedTagIndex;
+    /// Indexes oldValues while an incremental resize is in progress.
+    std::unique_ptr<TagIndex> oldTagIndex;
+    /**
+     * TagIndexes replaced by a resize. Freed by reclaimTagIndexes() once no
+     * lock-free reader can still be probing them; modified holding
+     * resizeLock.
+     */
+    std::vector<std::unique_ptr<TagIndex>> retiredTagIndexes;
+
+    /**
+     * Number of lock-free readers probing a TagIndex, spread over several
+     * counters (by key hash) each on its own cache line to limit contention
+     * between readers.
+     */
+    struct TagIndexReaders {
+        std::atomic<size_t> count{0};
+        char pad[64 - sizeof(std::atomic<size_t>)];
+    };
+    std::array<TagIndexReaders, 16> tagIndexReaders;
+
+    std::atomic<size_t> numOptimisticFinds;
+
+    /// Sample of the hot keys, fed by unlocked_find (may be null).
+    const std::unique_ptr<HotKeySketch> hotKeys;
+
     int getBucketForHash(int h) {
+        const size_t old = oldSize;
+        if (old) {
+            const int oldBucket = abs(h % static_cast<int>(old));
+            if (static_cast<size_t>(oldBucket) >= migratedBuckets) {
+                // Not yet migrated; still located in the old buckets.
+                return static_cast<int>(size) + oldBucket;
+            }
+        }
         return abs(h % static_cast<int>(size));
     }
 
+    /// Number of buckets across both the new and old (if resizing) arrays.
+    size_t getNumBucketsInUse() const {
+        return size + oldSize;
+    }
+
+    /// @return the hash chain for the given bucket number.
+    StoredValue::UniquePtr& getChain(int bucket_num) {
+        if (static_cast<size_t>(bucket_num) < size) {
+            return values[bucket_num];
+        }
+        return oldValues[bucket_num - size];
+    }
+
+    /// @return the size the HashTable should be resized to for its contents.
+    size_t getPreferredSize();
+
+    /**
+     * Begin an incremental resize to the given size: the current buckets
+     * become the old buckets, to be migrated by migrateBuckets().
+     * Assumes resizeLock is held and no resize is in progress.
+     *
+     * @return false if no resize is necessary (or a visitor is running).
+     */
+    bool beginResize(size_t newSize);
+
+    /**
+     * Migrate up to maxBuckets of the old buckets into the new buckets,
+     * completing the resize once all are migrated. No-op if not resizing.
+     * Assumes resizeLock is held.
+     */
+    void migrateBuckets(size_t maxBuckets);
+
+    /**
+     * Migrate the next old bucket, holding the locks of the stripes it
+     * touches (all locks for the last bucket, which completes the resize).
+     * Assumes resizeLock is held and a resize is in progress.
+     *
+     * @return false if a visitor is running, so nothing was migrated.
+     */
+    bool migrateBucket();
+
+    /**
+     * Release the (now empty) old buckets. Assumes all locks are held.
+     *
+     * @return the old bucket array, for the caller to free once the locks
+     *         have been released.
+     */
+    table_type finishResize();
+
+    /**
+     * Tag stored alongside each StoredValue pointer in a TagBucket. The
+     * bucket number already consumes h % size, so fold the high half of the
+     * hash into the low half to keep tags within a bucket distinct.
+     */
+    static uint16_t getTagForHash(uint32_t h) {
+        return static_cast<uint16_t>((h >> 16) ^ h);
+    }
+
+    /**
+     * Record that a StoredValue has been linked into the given hash bucket.
+     * Assumes the bucket's ht_lock is held.
+     */
+    void tagIndexInsert(int bucket_num, const StoredValue& v);
+
+    /**
+     * Record that a StoredValue has been unlinked from the given hash
+     * bucket. Assumes the bucket's ht_lock is held.
+     */
+    void tagIndexRemove(int bucket_num, const StoredValue* v);
+
+    /**
+     * Rebuild the given TagBucket from a hash chain.
+     * Assumes the bucket's ht_lock is held.
+     */
+    void tagIndexRebuild(TagBucket& tb, const StoredValue::UniquePtr& chain);
+
+    /// @return the TagBucket for the given bucket number.
+    TagBucket& getTagBucket(int bucket_num) {
+        if (static_cast<size_t>(bucket_num) < size) {
+            return (*ownedTagIndex)[bucket_num];
+        }
+        return (*oldTagIndex)[bucket_num - size];
+    }
+
+    /**
+     * Probe the tag index for the given key without acquiring any ht_lock.
+     *
+     * @return true if the key is definitely not present in the HashTable
+     *         (at the time of the probe); false if it may be present (or a
+     *         concurrent update prevented a consistent probe), in which case
+     *         the caller must perform a locked lookup.
+     */
+    bool tagIndexDefinitelyAbsent(const DocKey& key);
+
+    /// Probe for tagIndexDefinitelyAbsent(); the caller registers as reader.
+    bool tagIndexProbe(const DocKey& key, uint32_t hash);
+
+    /**
+     * Free the retired TagIndexes if no lock-free reader is registered.
+     * Assumes resizeLock is held.
+     */
+    void reclaimTagIndexes();
+
+    /**
+     * Locate the StoredValue for the given key via the tag index.
+     * Assumes the bucket's ht_lock is held.
+     */
+    StoredValue* tagIndexFind(const DocKey& key, int bucket_num);
+
     inline size_t mutexForBucket(size_t bucket_num) {
         if (!isActive()) {
             throw std::logic_error("HashTable::mutexForBucket: Cannot call on a "
@@ -0,0 +1,76 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2018 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "config.h"
+
+#include "hot_key_sketch.h"
+
+#include <cstring>
+#include <stdexcept>
+
+HotKeySketch::HotKeySketch(size_t size) : slots(size) {
+    if (size == 0) {
+        throw std::invalid_argument(
+                "HotKeySketch: size must be greater than zero");
+    }
+}
+
+void HotKeySketch::sample(const DocKey& key) {
+    // A thread local counter rather than a shared one, so that unsampled
+    // accesses don't contend on a cache line.
+    static thread_local uint32_t accesses = 0;
+    if (++accesses % SampleInterval != 0) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lh(mutex, std::try_to_lock);
+    if (!lh) {
+        return;
+    }
+
+    const uint32_t hash = key.hash();
+    const auto ns = static_cast<char>(key.getDocNamespace());
+    Slot& slot = slots[hash % slots.size()];
+    if (slot.count != 0 && slot.hash == hash &&
+        slot.key.size() == key.size() + 1 && slot.key[0] == ns &&
+        std::memcmp(slot.key.data() + 1, key.data(), key.size()) == 0) {
+        if (slot.count < MaxCount) {
+            ++slot.count;
+        }
+        return;
+    }
+
+    if (slot.count > 1) {
+        --slot.count;
+        return;
+    }
+
+    slot.key.assign(1, ns);
+    slot.key.append(reinterpret_cast<const char*>(key.data()), key.size());
+    slot.hash = hash;
+    slot.count = 1;
+}
+
+void HotKeySketch::getKeys(std::vector<StoredDocKey>& keys) const {
+    std::lock_guard<std::mutex> lh(mutex);
+    for (const auto& slot : slots) {
+        if (slot.count != 0) {
+            keys.emplace_back(reinterpret_cast<const uint8_t*>(slot.key.data()),
+                              slot.key.size());
+        }
+    }
+}
@@ -0,0 +1,82 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2018 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#pragma once
+
+#include "config.h"
+
+#include "storeddockey.h"
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * A fixed size, sampled sketch of a vBucket's hot keys.
+ *
+ * The HashTable feeds it a sample of the accesses to items whose NRU value
+ * has reached MIN_NRU_VALUE. Each key maps to a single slot (by its hash);
+ * a slot counts the samples of its key, and a sample of a different key
+ * decrements the count, replacing the key once the count drops to zero. Keys
+ * which are accessed frequently therefore stay in the sketch, while keys
+ * only occasionally hot are displaced.
+ *
+ * The access scanner writes the sketched keys to the access log instead of
+ * visiting every resident item, so memory is bounded by the sketch size and
+ * dumping is cheap enough to do frequently (and at shutdown).
+ */
+class HotKeySketch {
+public:
+    /**
+     * @param size the number of keys the sketch can hold
+     */
+    explicit HotKeySketch(size_t size);
+
+    /**
+     * Record an access to the given (hot) key. Only one in SampleInterval
+     * calls (per thread) are recorded, and samples are dropped rather than
+     * waiting if the sketch is being sampled or read by another thread.
+     */
+    void sample(const DocKey& key);
+
+    /**
+     * Append the keys currently held by the sketch to keys.
+     */
+    void getKeys(std::vector<StoredDocKey>& keys) const;
+
+    /// @return the number of keys the sketch can hold
+    size_t getSize() const {
+        return slots.size();
+    }
+
+    /// Record one in this many hot accesses.
+    static const uint32_t SampleInterval = 8;
+
+private:
+    struct Slot {
+        // Namespaced key; assigned in place so its capacity is reused
+        std::string key;
+        uint32_t hash = 0;
+        // Zero if the slot is empty
+        uint8_t count = 0;
+    };
+
+    static const uint8_t MaxCount = 255;
+
+    mutable std::mutex mutex;
+    std::vector<Slot> slots;
+};
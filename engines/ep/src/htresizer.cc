@@ -18,6 +18,7 @@
 #include "config.h"
 
 #include "ep_engine.h"
+#include "executorpool.h"
 #include "htresizer.h"
 #include "kv_bucket_iface.h"
 
@@ -31,11 +32,36 @@
  */
 class ResizingVisitor : public VBucketVisitor {
 public:
-    ResizingVisitor() { }
+    ResizingVisitor(size_t stepSize, size_t resizerTaskId)
+        : stepSize(stepSize), resizerTaskId(resizerTaskId) {
+    }
 
     void visitBucket(VBucketPtr &vb) override {
-        vb->ht.resize();
+        if (stepSize == 0) {
+            vb->ht.resize();
+            return;
+        }
+
+        // Migrate a bounded number of buckets per run; the remainder is
+        // migrated by the following runs.
+        if (vb->ht.resizeStep(stepSize) > 0) {
+            migrating = true;
+        }
     }
+
+    void complete() override {
+        if (migrating) {
+            // Run again (rather than after ht_resize_interval) to continue
+            // the migrations.
+            ExecutorPool::get()->wake(resizerTaskId);
+        }
+    }
+
+private:
+    const size_t stepSize;
+    const size_t resizerTaskId;
+    // Does any HashTable still have buckets to migrate?
+    bool migrating = false;
 };
 
 HashtableResizerTask::HashtableResizerTask(KVBucketIface* s, double sleepTime)
@@ -48,13 +74,14 @@ HashtableResizerTask::HashtableResizerTask(KVBucketIface* s, double sleepTime)
 
 bool HashtableResizerTask::run(void) {
     TRACE_EVENT0("ep-engine/task", "HashtableResizerTask");
-    auto pv = std::make_unique<ResizingVisitor>();
+    auto pv = std::make_unique<ResizingVisitor>(
+            engine->getConfiguration().getHtResizeStepSize(), getId());
 
-    // [per-VBucket Task] While a Hashtable is resizing no user
-    // requests can be performed (the resizing process needs to
-    // acquire all HT locks). As such we are sensitive to the duration
-    // of this task - we want to log anything which has a
-    // non-negligible impact on frontend operations.
+    // [per-VBucket Task] While a Hashtable is migrating a bucket no user
+    // requests can be performed on the stripes it touches. Each run is
+    // bounded by ht_resize_step_size, but we remain sensitive to the duration
+    // of this task - we want to log anything which has a non-negligible
+    // impact on frontend operations.
     const auto maxExpectedDuration = std::chrono::milliseconds(100);
 
     store->visit(std::move(pv),
@@ -0,0 +1,342 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2018 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "config.h"
+
+#include "indexed_access_log.h"
+
+extern "C" {
+#include "crc32.h"
+}
+#include "ep_engine.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace IndexedAccessLog {
+
+// Sizes of the on-disk structures (see indexed_access_log.h)
+static const size_t HeaderLen = sizeof(uint32_t) + sizeof(uint32_t) +
+                                sizeof(uint64_t) + sizeof(uint32_t);
+static const size_t IndexEntryLen = sizeof(uint16_t) + sizeof(uint16_t) +
+                                    sizeof(uint32_t) + sizeof(uint64_t) +
+                                    sizeof(uint64_t) + sizeof(uint32_t) +
+                                    sizeof(uint32_t);
+static_assert(HeaderLen <= MIN_LOG_HEADER_SIZE,
+              "IndexedAccessLog header must fit in MIN_LOG_HEADER_SIZE");
+
+static uint32_t crc(const uint8_t* buf, size_t len) {
+    return crc32buf(const_cast<uint8_t*>(buf), len);
+}
+
+// Append / read an integer in network byte order
+static void put16(std::vector<uint8_t>& buf, uint16_t val) {
+    val = htons(val);
+    const auto* p = reinterpret_cast<const uint8_t*>(&val);
+    buf.insert(buf.end(), p, p + sizeof(val));
+}
+
+static void put32(std::vector<uint8_t>& buf, uint32_t val) {
+    val = htonl(val);
+    const auto* p = reinterpret_cast<const uint8_t*>(&val);
+    buf.insert(buf.end(), p, p + sizeof(val));
+}
+
+static void put64(std::vector<uint8_t>& buf, uint64_t val) {
+    val = htonll(val);
+    const auto* p = reinterpret_cast<const uint8_t*>(&val);
+    buf.insert(buf.end(), p, p + sizeof(val));
+}
+
+static uint16_t get16(const uint8_t*& p) {
+    uint16_t val;
+    std::memcpy(&val, p, sizeof(val));
+    p += sizeof(val);
+    return ntohs(val);
+}
+
+static uint32_t get32(const uint8_t*& p) {
+    uint32_t val;
+    std::memcpy(&val, p, sizeof(val));
+    p += sizeof(val);
+    return ntohl(val);
+}
+
+static uint64_t get64(const uint8_t*& p) {
+    uint64_t val;
+    std::memcpy(&val, p, sizeof(val));
+    p += sizeof(val);
+    return ntohll(val);
+}
+
+bool isIndexed(const std::string& path) {
+    FILE* fp = fopen(path.c_str(), "rb");
+    if (fp == nullptr) {
+        return false;
+    }
+    uint32_t version = 0;
+    const bool read = fread(&version, sizeof(version), 1, fp) == 1;
+    fclose(fp);
+    return read && ntohl(version) == Version;
+}
+
+Writer::Writer(const std::string& path) : path(path) {
+}
+
+Writer::~Writer() {
+    if (file != nullptr) {
+        fclose(file);
+    }
+}
+
+bool Writer::open() {
+    file = fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        LOG(EXTENSION_LOG_WARNING,
+            "IndexedAccessLog::Writer::open: Failed to create '%s': %s",
+            path.c_str(),
+            strerror(errno));
+        return false;
+    }
+
+    // Reserve the header; it's written by commit() once the index is known
+    std::array<uint8_t, MIN_LOG_HEADER_SIZE> header{};
+    return write(header.data(), header.size());
+}
+
+void Writer::addVBucket(uint16_t vbucket, std::vector<StoredDocKey>& keys) {
+    if (failed || keys.empty()) {
+        return;
+    }
+
+    // StoredDocKey orders by the namespaced key bytes, which is the order
+    // of the by-id B-tree.
+    std::sort(keys.begin(), keys.end());
+
+    buffer.clear();
+    for (const auto& key : keys) {
+        buffer.push_back(static_cast<uint8_t>(key.getDocNameSpacedSize()));
+        buffer.insert(buffer.end(),
+                      key.getDocNameSpacedData(),
+                      key.getDocNameSpacedData() + key.getDocNameSpacedSize());
+    }
+
+    index.push_back({vbucket,
+                     static_cast<uint32_t>(keys.size()),
+                     offset,
+                     buffer.size(),
+                     crc(buffer.data(), buffer.size())});
+    numKeys += keys.size();
+    write(buffer.data(), buffer.size());
+}
+
+bool Writer::commit() {
+    if (file == nullptr) {
+        return false;
+    }
+
+    buffer.clear();
+    for (const auto& entry : index) {
+        put16(buffer, entry.vbucket);
+        put16(buffer, 0);
+        put32(buffer, entry.numKeys);
+        put64(buffer, entry.offset);
+        put64(buffer, entry.length);
+        put32(buffer, entry.crc);
+        put32(buffer, 0);
+    }
+    const uint64_t indexOffset = offset;
+    const uint32_t indexCrc = crc(buffer.data(), buffer.size());
+    write(buffer.data(), buffer.size());
+
+    // The sections and index must be on disk before the header which
+    // refers to them, or a crash could leave a valid header over garbage
+    sync();
+
+    buffer.clear();
+    put32(buffer, Version);
+    put32(buffer, static_cast<uint32_t>(index.size()));
+    put64(buffer, indexOffset);
+    put32(buffer, indexCrc);
+    if (!failed && fseek(file, 0, SEEK_SET) != 0) {
+        LOG(EXTENSION_LOG_WARNING,
+            "IndexedAccessLog::Writer::commit: Failed to seek '%s': %s",
+            path.c_str(),
+            strerror(errno));
+        failed = true;
+    }
+    write(buffer.data(), buffer.size());
+    sync();
+
+    if (fclose(file) != 0) {
+        LOG(EXTENSION_LOG_WARNING,
+            "IndexedAccessLog::Writer::commit: Failed to close '%s': %s",
+            path.c_str(),
+            strerror(errno));
+        failed = true;
+    }
+    file = nullptr;
+    return !failed;
+}
+
+bool Writer::write(const void* data, size_t len) {
+    if (failed) {
+        return false;
+    }
+    if (len != 0 && fwrite(data, len, 1, file) != 1) {
+        LOG(EXTENSION_LOG_WARNING,
+            "IndexedAccessLog::Writer::write: Failed to write to '%s': %s",
+            path.c_str(),
+            strerror(errno));
+        failed = true;
+        return false;
+    }
+    offset += len;
+    return true;
+}
+
+bool Writer::sync() {
+    if (failed) {
+        return false;
+    }
+    int ret = fflush(file);
+    if (ret == 0) {
+#ifdef WIN32
+        ret = _commit(_fileno(file));
+#else
+        while ((ret = fsync(fileno(file))) == -1 && errno == EINTR) {
+            // Retry
+        }
+#endif
+    }
+    if (ret != 0) {
+        LOG(EXTENSION_LOG_WARNING,
+            "IndexedAccessLog::Writer::sync: Failed to sync '%s': %s",
+            path.c_str(),
+            strerror(errno));
+        failed = true;
+        return false;
+    }
+    return true;
+}
+
+Reader::iterator::iterator(const uint8_t* pos, const uint8_t* end)
+    : pos(pos), end(end) {
+    if (pos != end && pos + 1 + *pos > end) {
+        throw MutationLog::ShortReadException();
+    }
+}
+
+DocKey Reader::iterator::operator*() const {
+    // The first byte of the (namespaced) key is the DocNamespace
+    const size_t keylen = *pos;
+    if (keylen < 1) {
+        throw MutationLog::ReadException(
+                "IndexedAccessLog::Reader: Invalid key length 0");
+    }
+    return {pos + 2, keylen - 1, DocNamespace(pos[1])};
+}
+
+Reader::iterator& Reader::iterator::operator++() {
+    pos += 1 + *pos;
+    if (pos != end && pos + 1 + *pos > end) {
+        throw MutationLog::ShortReadException();
+    }
+    return *this;
+}
+
+Reader::Reader(const std::string& path)
+    : map(path.c_str(), cb::MemoryMappedFile::Mode::RDONLY) {
+    try {
+        map.open();
+    } catch (const std::system_error& e) {
+        throw MutationLog::ReadException(e.what());
+    }
+
+    const auto* root = static_cast<const uint8_t*>(map.getRoot());
+    const size_t size = map.getSize();
+    if (size < MIN_LOG_HEADER_SIZE) {
+        throw MutationLog::ShortReadException();
+    }
+
+    const uint8_t* p = root;
+    const uint32_t version = get32(p);
+    if (version != Version) {
+        throw MutationLog::ReadException(
+                "IndexedAccessLog::Reader: Unknown version " +
+                std::to_string(version));
+    }
+    const uint32_t numSections = get32(p);
+    const uint64_t indexOffset = get64(p);
+    const uint32_t indexCrc = get32(p);
+    const uint64_t indexLen = uint64_t(numSections) * IndexEntryLen;
+    if (indexOffset < MIN_LOG_HEADER_SIZE || indexOffset > size ||
+        indexLen > size - indexOffset) {
+        throw MutationLog::ShortReadException();
+    }
+    if (crc(root + indexOffset, indexLen) != indexCrc) {
+        throw MutationLog::CRCReadException();
+    }
+
+    p = root + indexOffset;
+    sections.reserve(numSections);
+    for (uint32_t ii = 0; ii < numSections; ++ii) {
+        Section section;
+        section.vbucket = get16(p);
+        get16(p);
+        section.numKeys = get32(p);
+        const uint64_t offset = get64(p);
+        const uint64_t length = get64(p);
+        section.crc = get32(p);
+        get32(p);
+        if (offset < MIN_LOG_HEADER_SIZE || offset > indexOffset ||
+            length > indexOffset - offset) {
+            throw MutationLog::ShortReadException();
+        }
+        section.begin = root + offset;
+        section.end = section.begin + length;
+        numKeys += section.numKeys;
+        sections.push_back(section);
+    }
+}
+
+const Reader::Section* Reader::getSection(uint16_t vbucket) const {
+    auto it = std::find_if(
+            sections.begin(), sections.end(), [vbucket](const Section& s) {
+                return s.vbucket == vbucket;
+            });
+    if (it == sections.end()) {
+        return nullptr;
+    }
+    // Check the section before handing out keys from it. This reads the
+    // section sequentially, which also pages it in ahead of the fetches.
+    if (crc(it->begin, it->end - it->begin) != it->crc) {
+        throw MutationLog::CRCReadException();
+    }
+    return &*it;
+}
+
+} // namespace IndexedAccessLog
@@ -0,0 +1,192 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2018 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#pragma once
+
+/**
+ * Indexed access log
+ *
+ * Version 3 of the access log (V1 and V2 being the block based MutationLog
+ * formats). Rather than a stream of CRC'd blocks of log entries, the file
+ * holds one section per vBucket, each containing the vBucket's keys sorted
+ * in on-disk (by-id B-tree) order, followed by an index of the sections.
+ * Warmup memory maps the file and feeds each section straight into getMulti
+ * batches, without having to parse and sort the entries first.
+ *
+ * All integers are in network byte order:
+ *
+ *   header    (MIN_LOG_HEADER_SIZE bytes, zero padded)
+ *     uint32_t version       (3; at the same offset as the MutationLog
+ *                             header's version, so older readers reject it)
+ *     uint32_t numSections
+ *     uint64_t indexOffset
+ *     uint32_t indexCrc      (crc32 of the index)
+ *   sections  (one per vBucket)
+ *     { uint8_t keylen; uint8_t key[keylen]; } * numKeys
+ *                            (key is the DocNamespace followed by the key)
+ *   index     (numSections entries)
+ *     uint16_t vbucket
+ *     uint16_t reserved
+ *     uint32_t numKeys
+ *     uint64_t offset
+ *     uint64_t length
+ *     uint32_t crc           (crc32 of the section)
+ *     uint32_t reserved
+ *
+ * The header is written last, so a partially written file is rejected.
+ */
+
+#include "config.h"
+
+#include "mutation_log.h"
+#include "storeddockey.h"
+
+#include <platform/memorymap.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace IndexedAccessLog {
+
+const uint32_t Version = 3;
+
+/**
+ * @return true if the file at the given path is an indexed access log (and
+ *         not a MutationLog).
+ */
+bool isIndexed(const std::string& path);
+
+/**
+ * Writes an indexed access log, one vBucket at a time.
+ */
+class Writer {
+public:
+    explicit Writer(const std::string& path);
+
+    ~Writer();
+
+    /**
+     * Create the file (replacing any existing one).
+     * @return false if the file could not be created
+     */
+    bool open();
+
+    /**
+     * Append the section of the given vBucket. The keys are sorted into
+     * on-disk order.
+     */
+    void addVBucket(uint16_t vbucket, std::vector<StoredDocKey>& keys);
+
+    /**
+     * Write the index and the header, and close the file. The sections and
+     * index are synced to disk before the header is written, and the header
+     * before the file is closed.
+     * @return false if any write (or sync) failed
+     */
+    bool commit();
+
+    size_t getNumKeys() const {
+        return numKeys;
+    }
+
+private:
+    struct IndexEntry {
+        uint16_t vbucket;
+        uint32_t numKeys;
+        uint64_t offset;
+        uint64_t length;
+        uint32_t crc;
+    };
+
+    bool write(const void* data, size_t len);
+
+    /// Flush the file's buffers and sync it to disk
+    bool sync();
+
+    const std::string path;
+    FILE* file = nullptr;
+    bool failed = false;
+    uint64_t offset = 0;
+    size_t numKeys = 0;
+    std::vector<IndexEntry> index;
+    std::vector<uint8_t> buffer;
+};
+
+/**
+ * Reads an indexed access log through a memory mapping of the file.
+ *
+ * Throws MutationLog::ReadException (or one of its subclasses) if the file
+ * cannot be mapped or is corrupt.
+ */
+class Reader {
+public:
+    /// A vBucket's section of the log.
+    struct Section {
+        uint16_t vbucket;
+        uint32_t numKeys;
+        const uint8_t* begin;
+        const uint8_t* end;
+        uint32_t crc;
+    };
+
+    /// Iterates over the keys of a Section; the keys point into the mapping.
+    class iterator : public std::iterator<std::input_iterator_tag, DocKey> {
+    public:
+        iterator(const uint8_t* pos, const uint8_t* end);
+
+        DocKey operator*() const;
+
+        iterator& operator++();
+
+        bool operator!=(const iterator& rhs) const {
+            return pos != rhs.pos;
+        }
+
+    private:
+        const uint8_t* pos;
+        const uint8_t* end;
+    };
+
+    explicit Reader(const std::string& path);
+
+    /**
+     * @return the section of the given vBucket, or nullptr if the log has
+     *         none. Throws CRCReadException if the section is corrupt.
+     */
+    const Section* getSection(uint16_t vbucket) const;
+
+    iterator begin(const Section& section) const {
+        return {section.begin, section.end};
+    }
+
+    iterator end(const Section& section) const {
+        return {section.end, section.end};
+    }
+
+    /// @return the total number of keys in the log
+    size_t getNumKeys() const {
+        return numKeys;
+    }
+
+private:
+    cb::MemoryMappedFile map;
+    std::vector<Section> sections;
+    size_t numKeys = 0;
+};
+
+} // namespace IndexedAccessLog
@@ -33,6 +33,7 @@
 #include <platform/make_unique.h>
 
 #include "access_scanner.h"
+#include "bgfetcher.h"
 #include "checkpoint.h"
 #include "checkpoint_remover.h"
 #include "collections/manager.h"
@@ -409,6 +410,16 @@ void KVBucket::deinitialize() {
 
     ExecutorPool::get()->unregisterTaskable(engine.getTaskable(),
                                             stats.forceShutdown);
+
+    // The hot key sketches are cheap to write (and are lost on shutdown), so
+    // save them for the next warmup. Done once all tasks have stopped, so
+    // this can't race with a scheduled access scanner run.
+    if (!stats.forceShutdown && isAccessScannerEnabled() &&
+        engine.getConfiguration().getAlogSketchSize() != 0) {
+        auto scanner = std::make_shared<AccessScanner>(
+                *this, engine.getConfiguration(), stats);
+        scanner->writeHotKeys();
+    }
 }
 
 KVBucket::~KVBucket() {
@@ -790,7 +801,8 @@ ENGINE_ERROR_CODE KVBucket::setVBucketState_UNLOCKED(
             // Initialize bloom filters upon vbucket creation during
             // bucket creation and rebalance
             newvb->createFilter(config.getBfilterKeyCount(),
-                                config.getBfilterFpProb());
+                                config.getBfilterFpProb(),
+                                config.isBfilterBlocked());
         }
 
         // The first checkpoint for active vbucket should start with id 2.
@@ -1218,7 +1230,7 @@ void KVBucket::completeBGFetchMulti(uint16_t vbId,
             auto* fetched_item = item.second;
             ENGINE_ERROR_CODE status = vb->completeBGFetchForSingleItem(
                     key, *fetched_item, startTime);
-            engine.notifyIOComplete(fetched_item->cookie, status);
+            notifyBGFetchComplete(*fetched_item, status);
         }
         LOG(EXTENSION_LOG_DEBUG,
             "EP Store completes %" PRIu64
@@ -1231,8 +1243,7 @@ void KVBucket::completeBGFetchMulti(uint16_t vbId,
                     .count());
     } else {
         for (const auto& item : fetchedItems) {
-            engine.notifyIOComplete(item.second->cookie,
-                                    ENGINE_NOT_MY_VBUCKET);
+            notifyBGFetchComplete(*item.second, ENGINE_NOT_MY_VBUCKET);
         }
         LOG(EXTENSION_LOG_WARNING,
             "EP Store completes %d of batched background fetch for "
@@ -1242,6 +1253,16 @@ void KVBucket::completeBGFetchMulti(uint16_t vbId,
     }
 }
 
+void KVBucket::notifyBGFetchComplete(const VBucketBGFetchItem& fetch,
+                                     ENGINE_ERROR_CODE status) {
+    if (!fetch.group) {
+        engine.notifyIOComplete(fetch.cookie, status);
+    } else if (fetch.group->complete()) {
+        // The frontend retries the group's keys to get their own status
+        engine.notifyIOComplete(fetch.cookie, ENGINE_SUCCESS);
+    }
+}
+
 GetValue KVBucket::getInternal(const DocKey& key,
                                uint16_t vbucket,
                                const void *cookie,
@@ -1290,6 +1311,100 @@ GetValue KVBucket::getInternal(const DocKey& key,
     }
 }
 
+std::vector<GetValue> KVBucket::getMulti(
+        const std::vector<cb::GetMultiKey>& keys,
+        const void* cookie,
+        get_options_t options) {
+    std::vector<GetValue> values;
+    values.reserve(keys.size());
+
+    // Look up all of the keys in the HashTable first, noting the ones which
+    // need a background fetch (without queueing the fetches yet).
+    const auto htOptions =
+            static_cast<get_options_t>(options & ~QUEUE_BG_FETCH);
+    std::vector<std::pair<size_t, VBucketPtr>> nonResident;
+    for (const auto& key : keys) {
+        VBucketPtr vb = getVBucket(key.vbucket);
+        if (!vb) {
+            ++stats.numNotMyVBuckets;
+            values.emplace_back(nullptr, ENGINE_NOT_MY_VBUCKET);
+            continue;
+        }
+
+        ReaderLockHolder rlh(vb->getStateLock());
+        if (options & HONOR_STATES) {
+            vbucket_state_t vbState = vb->getState();
+            if (vbState == vbucket_state_pending) {
+                // Unlike get we don't wait for the vbucket to become
+                // active (that would need a notification per key); the
+                // client should retry the key.
+                values.emplace_back(nullptr, ENGINE_TMPFAIL);
+                continue;
+            } else if (vbState != vbucket_state_active) {
+                ++stats.numNotMyVBuckets;
+                values.emplace_back(nullptr, ENGINE_NOT_MY_VBUCKET);
+                continue;
+            }
+        }
+
+        auto collectionsRHandle = vb->lockCollections(key.key);
+        if (!collectionsRHandle.valid()) {
+            values.emplace_back(nullptr, ENGINE_UNKNOWN_COLLECTION);
+            continue;
+        }
+
+        values.push_back(vb->getInternal(cookie,
+                                         engine,
+                                         bgFetchDelay,
+                                         htOptions,
+                                         diskDeleteAll,
+                                         VBucket::GetKeyOnly::No,
+                                         collectionsRHandle));
+        if (values.back().getStatus() == ENGINE_EWOULDBLOCK &&
+            (options & QUEUE_BG_FETCH)) {
+            nonResident.emplace_back(values.size() - 1, std::move(vb));
+        }
+    }
+
+    if (nonResident.empty()) {
+        return values;
+    }
+
+    // Queue the background fetches as a single group, so the cookie is only
+    // notified once the last of them has completed.
+    auto group = std::make_shared<BGFetchGroup>(cookie);
+    std::vector<BgFetcher*> bgFetchers;
+    for (auto& entry : nonResident) {
+        auto& vb = entry.second;
+        auto& value = values[entry.first];
+
+        ReaderLockHolder rlh(vb->getStateLock());
+        value.setStatus(
+                vb->queueBGFetchForGroup(keys[entry.first].key, group));
+        if (value.getStatus() == ENGINE_EWOULDBLOCK) {
+            bgFetchers.push_back(vb->getShard()->getBgFetcher());
+        }
+    }
+
+    if (bgFetchers.empty()) {
+        return values;
+    }
+
+    // Only wake the BgFetchers up now all of the fetches are queued, so each
+    // of them reads its share of the keys in one batch.
+    for (auto* bgFetcher : bgFetchers) {
+        bgFetcher->notifyBGEvent();
+    }
+
+    // Drop the hold the multi-get had on the group (see BGFetchGroup); if
+    // the fetches have already completed we have to notify the cookie.
+    if (group->complete()) {
+        engine.notifyIOComplete(cookie, ENGINE_SUCCESS);
+    }
+
+    return values;
+}
+
 GetValue KVBucket::getRandomKey() {
     VBucketMap::id_type max = vbMap.getSize();
 
@@ -1586,7 +1701,7 @@ std::string KVBucket::validateKey(const DocKey& key, uint16_t vbucket,
         if (diskItem.getFlags() != v->getFlags()) {
             return "flags_mismatch";
         } else if (v->isResident() && memcmp(diskItem.getData(),
-                                             v->getValue()->getData(),
+                                             v->getValueData(),
                                              diskItem.getNBytes())) {
             return "data_mismatch";
         } else {
@@ -186,6 +186,10 @@ public:
                            options);
     }
 
+    std::vector<GetValue> getMulti(const std::vector<cb::GetMultiKey>& keys,
+                                   const void* cookie,
+                                   get_options_t options);
+
     GetValue getRandomKey(void);
 
     /**
@@ -334,6 +338,15 @@ public:
                               std::vector<bgfetched_item_t>& fetchedItems,
                               ProcessClock::time_point start);
 
+    /**
+     * Notify the requestor of a background fetch that it has completed. For
+     * a fetch which is part of a multi-get the cookie is only notified when
+     * the last of the multi-get's fetches completes, and with ENGINE_SUCCESS
+     * whatever the fetches' status (see BGFetchGroup).
+     */
+    void notifyBGFetchComplete(const VBucketBGFetchItem& fetch,
+                               ENGINE_ERROR_CODE status);
+
     VBucketPtr getVBucket(uint16_t vbid) {
         return vbMap.getBucket(vbid);
     }
@@ -144,6 +144,26 @@ public:
     virtual GetValue get(const DocKey& key, uint16_t vbucket,
                          const void *cookie, get_options_t options) = 0;
 
+    /**
+     * Retrieve a batch of values.
+     *
+     * All of the keys are looked up in the HashTable first, and then the
+     * values of those which aren't resident are fetched from disk as a
+     * single background fetch batch. The cookie is notified once, when all
+     * of these fetches have completed.
+     *
+     * @param keys    the keys to fetch, and their vbuckets
+     * @param cookie  the connection cookie
+     * @param options options specified for retrieval
+     *
+     * @return a GetValue per key (ENGINE_EWOULDBLOCK for the keys being
+     *         fetched from disk)
+     */
+    virtual std::vector<GetValue> getMulti(
+            const std::vector<cb::GetMultiKey>& keys,
+            const void* cookie,
+            get_options_t options) = 0;
+
     virtual GetValue getRandomKey(void) = 0;
 
     /**
@@ -34,6 +34,7 @@
 #include "persistence_callback.h"
 #include "statwriter.h"
 #include "vbucket.h"
+#include "vbucket_bgfetch_item.h"
 
 #include <platform/dirutils.h>
 #include <sys/types.h>
@@ -271,6 +272,11 @@ void KVStore::addStats(ADD_STAT add_stat, const void *c) {
             add_stat,
             c);
     addStat(prefix, "io_write_bytes", st.io_write_bytes, add_stat, c);
+    addStat(prefix,
+            "io_bg_fetch_readahead",
+            st.getMultiReadaheadCount,
+            add_stat,
+            c);
 
     const size_t read = st.fsStats.totalBytesRead.load() +
                         st.fsStatsCompaction.totalBytesRead.load();
@@ -368,6 +374,11 @@ void KVStore::addTimingStats(ADD_STAT add_stat, const void *c) {
     const std::string& prefix = prefixStream.str();
 
     addStat(prefix, "commit",      st.commitHisto,      add_stat, c);
+    addStat(prefix,
+            "group_commit_sync",
+            st.groupCommitSyncHisto,
+            add_stat,
+            c);
     addStat(prefix, "compact",     st.compactHisto,     add_stat, c);
     addStat(prefix, "snapshot",    st.snapshotHisto,    add_stat, c);
     addStat(prefix, "delete",      st.delTimeHisto,     add_stat, c);
@@ -410,6 +421,16 @@ void KVStore::optimizeWrites(std::vector<queued_item>& items) {
     std::sort(items.begin(), items.end(), cq);
 }
 
+void KVStore::getMultiBatch(vb_bgfetch_batch_t& batch,
+                            const BGFetchedCallback& onFetched) {
+    for (auto& vbFetches : batch) {
+        getMulti(vbFetches.first, vbFetches.second);
+        for (auto& fetch : vbFetches.second) {
+            onFetched(vbFetches.first, fetch.first, fetch.second);
+        }
+    }
+}
+
 uint64_t KVStore::getLastPersistedSeqno(uint16_t vbid) {
     vbucket_state* state = getVBucketState(vbid);
     if (state) {
@@ -31,6 +31,7 @@
 #include <atomic>
 #include <cstring>
 #include <deque>
+#include <functional>
 #include <list>
 #include <map>
 #include <string>
@@ -51,6 +52,16 @@ struct vb_bgfetch_item_ctx_t;
 using vb_bgfetch_queue_t =
         std::unordered_map<StoredDocKey, vb_bgfetch_item_ctx_t>;
 
+/// The fetches of several vBuckets, read as a single batch.
+using vb_bgfetch_batch_t = std::vector<std::pair<uint16_t, vb_bgfetch_queue_t>>;
+
+/**
+ * Invoked by KVStore::getMultiBatch() for each fetched key, as soon as the
+ * read of that key has completed.
+ */
+using BGFetchedCallback = std::function<void(
+        uint16_t vb, const StoredDocKey& key, vb_bgfetch_item_ctx_t& fetch)>;
+
 enum class GetMetaOnly { Yes, No };
 
 typedef uint16_t DBFileId;
@@ -256,6 +267,7 @@ public:
       readSizeHisto(ExponentialGenerator<size_t>(1, 2), 25),
       writeSizeHisto(ExponentialGenerator<size_t>(1, 2), 25),
       getMultiFsReadCount(0),
+      getMultiReadaheadCount(0),
       getMultiFsReadHisto(ExponentialGenerator<uint32_t>(6, 1.2), 50),
       getMultiFsReadPerDocHisto(ExponentialGenerator<uint32_t>(6, 1.2),50) {
     }
@@ -282,9 +294,11 @@ public:
         compactHisto.reset();
         snapshotHisto.reset();
         commitHisto.reset();
+        groupCommitSyncHisto.reset();
         saveDocsHisto.reset();
         batchSize.reset();
         getMultiFsReadCount = 0;
+        getMultiReadaheadCount = 0;
         getMultiFsReadHisto.reset();
         getMultiFsReadPerDocHisto.reset();
         fsStats.reset();
@@ -334,6 +348,8 @@ public:
     MicrosecondHistogram delTimeHisto;
     // Time spent in commit
     MicrosecondHistogram commitHisto;
+    // Time spent performing the deferred syncs at the end of a group commit
+    MicrosecondHistogram groupCommitSyncHisto;
     // Time spent in compaction
     MicrosecondHistogram compactHisto;
     // Time spent in saving documents to disk
@@ -352,6 +368,10 @@ public:
     // per fetched document.
     Histogram<uint32_t> getMultiFsReadPerDocHisto;
 
+    // Number of document bodies read ahead by getMulti() requests (see
+    // bg_fetch_readahead).
+    Couchbase::RelaxedAtomic<size_t> getMultiReadaheadCount;
+
     // Stats from the underlying OS file operations
     FileStats fsStats;
 
@@ -521,6 +541,29 @@ public:
      */
     virtual bool commit(const Item* collectionsManifest) = 0;
 
+    /**
+     * Begin a group commit, spanning one or more subsequent transactions.
+     *
+     * Until endGroupCommit() is called, commit() may return before the data
+     * it wrote is durable, allowing the underlying storage to make the
+     * commits of several transactions (typically for different vBuckets)
+     * durable together. The default implementation does nothing - every
+     * commit() is durable when it returns.
+     */
+    virtual void beginGroupCommit() {
+    }
+
+    /**
+     * End the current group commit, making all transactions committed since
+     * beginGroupCommit() durable.
+     *
+     * @return false if the commits could not be made durable; in which case
+     *         endGroupCommit() should be retried.
+     */
+    virtual bool endGroupCommit() {
+        return true;
+    }
+
     /**
      * Rollback the current transaction.
      */
@@ -560,6 +603,19 @@ public:
         throw std::runtime_error("Backend does not support getMulti()");
     }
 
+    /**
+     * Get the items of several vBuckets as a single batch, calling onFetched
+     * for each key as soon as it has been read rather than once the whole
+     * batch has been.
+     *
+     * The default implementation reads each vBucket in turn via getMulti().
+     *
+     * @param batch the vBuckets and the keys to fetch for each
+     * @param onFetched called once for every key in the batch
+     */
+    virtual void getMultiBatch(vb_bgfetch_batch_t& batch,
+                               const BGFetchedCallback& onFetched);
+
     /**
      * Get the number of vbuckets in a single database file
      *
@@ -44,6 +44,7 @@ KVStoreConfig::KVStoreConfig(Configuration& config, uint16_t shardid)
                     config.getRocksdbCfOptions(),
                     config.getRocksdbBbtOptions()) {
     setPeriodicSyncBytes(config.getFsyncAfterEveryNBytesWritten());
+    setBgFetchReadahead(config.isBgFetchReadahead());
     config.addValueChangedListener("fsync_after_every_n_bytes_written",
                                    new ConfigChangeListener(*this));
     rocksDbLowPriBackgroundThreads = config.getRocksdbLowPriBackgroundThreads();
@@ -76,6 +77,7 @@ KVStoreConfig::KVStoreConfig(uint16_t _maxVBuckets,
       logger(&global_logger),
       buffered(true),
       persistDocNamespace(_persistDocNamespace),
+      bgFetchReadahead(false),
       rocksDBOptions(rocksDBOptions_),
       rocksDBCFOptions(rocksDBCFOptions_),
       rocksDbBBTOptions(rocksDbBBTOptions_) {
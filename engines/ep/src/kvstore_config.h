@@ -103,6 +103,20 @@ public:
         persistDocNamespace = value;
     }
 
+    /**
+     * Indicates whether the document bodies of a getMulti() batch should be
+     * read ahead (asynchronously) before they are fetched.
+     *
+     * Only recognised by CouchKVStore
+     */
+    bool isBgFetchReadahead() const {
+        return bgFetchReadahead;
+    }
+
+    void setBgFetchReadahead(bool value) {
+        bgFetchReadahead = value;
+    }
+
     uint64_t getPeriodicSyncBytes() const {
         return periodicSyncBytes;
     }
@@ -192,6 +206,7 @@ private:
     Logger* logger;
     bool buffered;
     bool persistDocNamespace;
+    bool bgFetchReadahead;
 
     /**
      * If non-zero, tell storage layer to issue a sync() operation after every
@@ -143,6 +143,26 @@ void ObjectRegistry::onDeleteStoredValue(const StoredValue *sv)
    }
 }
 
+void ObjectRegistry::onCreateInlineValue(const StoredValue *sv)
+{
+   EventuallyPersistentEngine *engine = th->get();
+   if (verifyEngine(engine)) {
+       EPStats &stats = engine->getEpStats();
+       stats.numInlineValue++;
+       stats.totalInlineValueSize.fetch_add(sv->valuelen());
+   }
+}
+
+void ObjectRegistry::onDeleteInlineValue(const StoredValue *sv)
+{
+   EventuallyPersistentEngine *engine = th->get();
+   if (verifyEngine(engine)) {
+       EPStats &stats = engine->getEpStats();
+       stats.totalInlineValueSize.fetch_sub(sv->valuelen());
+       stats.numInlineValue--;
+   }
+}
+
 
 void ObjectRegistry::onCreateItem(const Item *pItem)
 {
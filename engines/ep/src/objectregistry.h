@@ -51,6 +51,9 @@ public:
     static void onCreateStoredValue(const StoredValue *sv);
     static void onDeleteStoredValue(const StoredValue *sv);
 
+    static void onCreateInlineValue(const StoredValue *sv);
+    static void onDeleteInlineValue(const StoredValue *sv);
+
 
     static EventuallyPersistentEngine *getCurrentEngine();
 
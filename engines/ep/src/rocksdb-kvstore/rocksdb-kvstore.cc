@@ -209,6 +209,7 @@ public:
 
 RocksDBKVStore::RocksDBKVStore(KVStoreConfig& config)
     : KVStore(config),
+      engine(ObjectRegistry::getCurrentEngine()),
       vbHandles(configuration.getMaxVBuckets()),
       in_transaction(false),
       scanCounter(0),
@@ -246,8 +247,7 @@ RocksDBKVStore::RocksDBKVStore(KVStoreConfig& config)
     /* Use a listener to set the appropriate engine in the
      * flusher threads RocksDB creates. We need the flusher threads to
      * account for news/deletes against the appropriate bucket. */
-    auto fsl = std::make_shared<FlushStartListener>(
-            ObjectRegistry::getCurrentEngine());
+    auto fsl = std::make_shared<FlushStartListener>(engine);
     dbOptions.listeners.emplace_back(fsl);
 
     // Enable Statistics if 'Statistics::stat_level_' is provided by the
@@ -603,28 +603,44 @@ GetValue RocksDBKVStore::getWithHeader(void* dbHandle,
 }
 
 void RocksDBKVStore::getMulti(uint16_t vb, vb_bgfetch_queue_t& itms) {
-    // TODO RDB: RocksDB supports a multi get which we should use here.
+    if (itms.empty()) {
+        return;
+    }
+
+    // Look up all of the keys with a single MultiGet, which lets RocksDB
+    // share the work (e.g. memtable / version lookups, block reads) between
+    // the keys instead of repeating it for each one.
+    const auto vbh = getVBHandle(vb);
+    std::vector<rocksdb::ColumnFamilyHandle*> cfhs(itms.size(),
+                                                   vbh->defaultCFH.get());
+    std::vector<rocksdb::Slice> keys;
+    keys.reserve(itms.size());
+    for (const auto& it : itms) {
+        keys.push_back(getKeySlice(it.first));
+    }
+    std::vector<std::string> values;
+    const auto statuses =
+            rdb->MultiGet(rocksdb::ReadOptions(), cfhs, keys, &values);
+
+    // MultiGet returns the results in the order of 'keys', i.e. in the
+    // iteration order of 'itms'.
+    size_t idx = 0;
     for (auto& it : itms) {
-        auto& key = it.first;
-        rocksdb::Slice keySlice = getKeySlice(key);
-        std::string value;
-        const auto vbh = getVBHandle(vb);
-        rocksdb::Status s = rdb->Get(rocksdb::ReadOptions(),
-                                     vbh->defaultCFH.get(),
-                                     keySlice,
-                                     &value);
+        const auto& s = statuses[idx];
         if (s.ok()) {
-            it.second.value =
-                    makeGetValue(vb, key, value, it.second.isMetaOnly);
-            GetValue* rv = &it.second.value;
-            for (auto& fetch : it.second.bgfetched_list) {
-                fetch->value = rv;
-            }
+            it.second.value = makeGetValue(
+                    vb, it.first, values[idx], it.second.isMetaOnly);
+        } else if (s.IsNotFound()) {
+            it.second.value.setStatus(ENGINE_KEY_ENOENT);
         } else {
-            for (auto& fetch : it.second.bgfetched_list) {
-                fetch->value->setStatus(ENGINE_KEY_ENOENT);
-            }
+            ++st.numGetFailure;
+            it.second.value.setStatus(ENGINE_TMPFAIL);
         }
+        GetValue* rv = &it.second.value;
+        for (auto& fetch : it.second.bgfetched_list) {
+            fetch->value = rv;
+        }
+        ++idx;
     }
 }
 
@@ -723,6 +739,136 @@ bool RocksDBKVStore::snapshotVBucket(uint16_t vbucketId,
     return true;
 }
 
+/**
+ * Compaction filter applied to the 'default' Column Family of the vBucket
+ * being compacted by compactDB().
+ */
+class ExpiryCompactionFilter : public rocksdb::CompactionFilter {
+public:
+    ExpiryCompactionFilter(RocksDBKVStore& store, compaction_ctx& ctx)
+        : store(store), ctx(ctx) {
+    }
+
+    bool Filter(int level,
+                const rocksdb::Slice& key,
+                const rocksdb::Slice& existingValue,
+                std::string* newValue,
+                bool* valueChanged) const override {
+        return store.expireOnCompaction(ctx, key, existingValue);
+    }
+
+    const char* Name() const override {
+        return "ExpiryCompactionFilter";
+    }
+
+private:
+    RocksDBKVStore& store;
+    compaction_ctx& ctx;
+};
+
+std::unique_ptr<rocksdb::CompactionFilter>
+ExpiryCompactionFilterFactory::CreateCompactionFilter(
+        const rocksdb::CompactionFilter::Context& context) {
+    // Only the explicit compactDB() has an expiry callback to notify.
+    if (!context.is_manual_compaction) {
+        return nullptr;
+    }
+    auto* ctx = store.getCompactionCtx(context.column_family_id);
+    if (ctx == nullptr || !ctx->expiryCallback) {
+        return nullptr;
+    }
+    return std::make_unique<ExpiryCompactionFilter>(store, *ctx);
+}
+
+bool RocksDBKVStore::compactDB(compaction_ctx* ctx) {
+    const uint16_t vbid = ctx->db_file_id;
+    std::shared_ptr<VBHandle> vbh;
+    {
+        std::lock_guard<std::mutex> lg(vbhMutex);
+        vbh = vbHandles[vbid];
+    }
+    if (!vbh) {
+        // Nothing has been persisted for this vBucket; nothing to compact.
+        return true;
+    }
+
+    const auto cfId = vbh->defaultCFH->GetID();
+    {
+        std::lock_guard<std::mutex> lg(compactionCtxsMutex);
+        compactionCtxs[cfId] = ctx;
+    }
+
+    // Compact every level, so the filter sees the latest version of each key
+    // (RocksDB only invokes the filter for the newest version of a key in
+    // the compaction's input, and flushes the memtable first).
+    rocksdb::CompactRangeOptions options;
+    options.bottommost_level_compaction =
+            rocksdb::BottommostLevelCompaction::kForce;
+    auto status = rdb->CompactRange(
+            options, vbh->defaultCFH.get(), nullptr, nullptr);
+
+    {
+        std::lock_guard<std::mutex> lg(compactionCtxsMutex);
+        compactionCtxs.erase(cfId);
+    }
+
+    if (!status.ok()) {
+        logger.log(EXTENSION_LOG_WARNING,
+                   "RocksDBKVStore::compactDB: CompactRange failed "
+                   "vb:%" PRIu16 " :%s",
+                   vbid,
+                   status.getState());
+        ++st.numCompactionFailure;
+        return false;
+    }
+    return true;
+}
+
+compaction_ctx* RocksDBKVStore::getCompactionCtx(uint32_t columnFamilyId) {
+    std::lock_guard<std::mutex> lg(compactionCtxsMutex);
+    auto it = compactionCtxs.find(columnFamilyId);
+    return it == compactionCtxs.end() ? nullptr : it->second;
+}
+
+bool RocksDBKVStore::expireOnCompaction(compaction_ctx& ctx,
+                                        const rocksdb::Slice& key,
+                                        const rocksdb::Slice& value) {
+    if (value.size() < sizeof(rockskv::MetaData)) {
+        return false;
+    }
+    rockskv::MetaData meta;
+    std::memcpy(&meta, value.data(), sizeof(meta));
+    if (meta.deleted || meta.exptime == 0) {
+        return false;
+    }
+    time_t currtime = ep_real_time();
+    if (meta.exptime >= currtime) {
+        return false;
+    }
+
+    const uint16_t vbid = ctx.db_file_id;
+    // Only active vBuckets expire items (a replica is sent the deletion by
+    // its active), so keep the item if we cannot report it.
+    const auto* vbState = cachedVBStates[vbid].get();
+    if (!vbState || vbState->state != vbucket_state_active) {
+        return false;
+    }
+
+    // We are running in a RocksDB compaction thread; switch to our engine
+    // for the Item's memory accounting and the expiry itself.
+    auto* previousEngine = ObjectRegistry::onSwitchThread(engine, true);
+    {
+        // TODO RDB: Deal with collections
+        DocKey docKey(reinterpret_cast<const uint8_t*>(key.data()),
+                      key.size(),
+                      DocNamespace::DefaultCollection);
+        auto item = makeItem(vbid, docKey, value, GetMetaOnly::No);
+        ctx.expiryCallback->callback(*item, currtime);
+    }
+    ObjectRegistry::onSwitchThread(previousEngine);
+    return true;
+}
+
 bool RocksDBKVStore::snapshotStats(const std::map<std::string, std::string>&) {
     // TODO RDB:  Implement
     return true;
@@ -817,9 +963,6 @@ StorageProperties RocksDBKVStore::getStorageProperties(void) {
     StorageProperties rv(StorageProperties::EfficientVBDump::Yes,
                          StorageProperties::EfficientVBDeletion::Yes,
                          StorageProperties::PersistedDeletion::No,
-                         // TODO RDB: Not strictly true, multiGet
-                         // does not yet use the underlying multi get
-                         // of RocksDB
                          StorageProperties::EfficientGet::Yes,
                          StorageProperties::ConcurrentWriteCompact::Yes);
     return rv;
@@ -1086,6 +1229,10 @@ rocksdb::ColumnFamilyOptions RocksDBKVStore::getBaselineDefaultCFOptions() {
     // 'rocksdb_block_cache_size'
     cfOptions.OptimizeForPointLookup(1);
 
+    // Drop expired items when explicitly compacted (see compactDB()).
+    cfOptions.compaction_filter_factory =
+            std::make_shared<ExpiryCompactionFilterFactory>(*this);
+
     // Set the given Memory Budget as the write_buffer_size
     if (configuration.getRocksdbDefaultCfMemBudget() > 0) {
         cfOptions.write_buffer_size =
@@ -29,6 +29,7 @@
 
 #include <kvstore.h>
 
+#include <rocksdb/compaction_filter.h>
 #include <rocksdb/db.h>
 #include <rocksdb/listener.h>
 #include <rocksdb/utilities/memory_util.h>
@@ -87,10 +88,31 @@ public:
     }
 };
 
+class RocksDBKVStore;
 class RocksRequest;
 class VBHandle;
 struct KVStatsCtx;
 
+// Creates the compaction filters for the 'default' Column Families. Nothing
+// is filtered by the compactions RocksDB schedules itself; during an explicit
+// compactDB() expired items are dropped, and reported through the
+// compaction_ctx expiryCallback.
+class ExpiryCompactionFilterFactory : public rocksdb::CompactionFilterFactory {
+public:
+    ExpiryCompactionFilterFactory(RocksDBKVStore& store) : store(store) {
+    }
+
+    std::unique_ptr<rocksdb::CompactionFilter> CreateCompactionFilter(
+            const rocksdb::CompactionFilter::Context& context) override;
+
+    const char* Name() const override {
+        return "ExpiryCompactionFilterFactory";
+    }
+
+private:
+    RocksDBKVStore& store;
+};
+
 /**
  * A persistence store based on rocksdb.
  */
@@ -200,16 +222,18 @@ public:
         return 1024;
     }
 
-    bool compactDB(compaction_ctx*) override {
-        // Explicit compaction is not needed.
-        // Compaction is continuously occurring in separate threads
-        // under RocksDB's control
-        return true;
-    }
+    /**
+     * Compaction is continuously occurring in separate threads under
+     * RocksDB's control, so an explicit compaction is only needed to apply
+     * the compaction_ctx: it compacts the whole of the vBucket's 'default'
+     * Column Family, dropping the items whose TTL has elapsed and notifying
+     * the ctx->expiryCallback for each.
+     */
+    bool compactDB(compaction_ctx* ctx) override;
 
-    uint16_t getDBFileId(const protocol_binary_request_compact_db&) override {
-        // Not needed if there is no explicit compaction
-        return 0;
+    uint16_t getDBFileId(const protocol_binary_request_compact_db& req) override {
+        // compactDB() compacts the requested vBucket's Column Family.
+        return ntohs(req.message.header.request.vbucket);
     }
 
     vbucket_state* getVBucketState(uint16_t vbucketId) override {
@@ -287,6 +311,23 @@ public:
         return 0;
     }
 
+    /**
+     * Called by the compaction filter of an explicit compactDB() for every
+     * item in the compacted vBucket.
+     *
+     * @return true if the item should be dropped (it has expired and has been
+     *         reported to ctx.expiryCallback).
+     */
+    bool expireOnCompaction(compaction_ctx& ctx,
+                            const rocksdb::Slice& key,
+                            const rocksdb::Slice& value);
+
+    /**
+     * @return the compaction_ctx of the compactDB() in progress for the given
+     *         Column Family, or nullptr if there is none.
+     */
+    compaction_ctx* getCompactionCtx(uint32_t columnFamilyId);
+
     std::unique_ptr<RocksDBKVStore> makeReadOnlyStore() {
         // Not using make_unique due to the private constructor we're calling
         return std::unique_ptr<RocksDBKVStore>(
@@ -299,6 +340,16 @@ protected:
     rocksdb::Status writeAndTimeBatch(rocksdb::WriteBatch batch);
 
 private:
+    // The compaction_ctx of each compactDB() in progress, by the ID of the
+    // 'default' Column Family being compacted. Declared before 'rdb' as the
+    // compaction filters access it until the DB is closed.
+    std::mutex compactionCtxsMutex;
+    std::unordered_map<uint32_t, compaction_ctx*> compactionCtxs;
+
+    // The engine this store belongs to; used to account the Items created
+    // by the compaction filter (which runs in RocksDB's threads).
+    EventuallyPersistentEngine* engine;
+
     // Unique RocksDB instance, per-Shard.
     std::unique_ptr<rocksdb::DB> rdb;
 
@@ -103,6 +103,8 @@ public:
           numStoredVal(0),
           totalStoredValSize(0),
           storedValOverhead(0),
+          numInlineValue(0),
+          totalInlineValueSize(0),
           memOverhead(0),
           numItem(0),
           totalMemory(0),
@@ -327,6 +329,10 @@ public:
     Counter totalStoredValSize;
     //! Total size of StoredVal memory overhead
     Counter storedValOverhead;
+    //! The number of StoredVal objects holding their value inline
+    Counter numInlineValue;
+    //! Total size of values stored inline in StoredVal objects
+    Counter totalInlineValueSize;
     //! Amount of memory used to track items and what-not.
     cb::CachelinePadded<Counter> memOverhead;
     //! Total number of Item objects
@@ -537,6 +543,16 @@ public:
     //! Historgram of batch reads
     MicrosecondHistogram getMultiHisto;
 
+    //! Histogram of time the BgFetcher spends draining the pending fetch
+    //! queues of all vBuckets in a shard.
+    MicrosecondHistogram bgFetchCoalesceHisto;
+    //! Histogram of time from the start of a BgFetcher batch's KVStore read
+    //! until each key has been read.
+    MicrosecondHistogram bgFetchReadHisto;
+    //! Histogram of time taken to complete a fetched key and notify the
+    //! waiting cookies.
+    MicrosecondHistogram bgFetchCompleteHisto;
+
     // ! Histograms of various task wait times, one per Task.
     std::vector<MicrosecondHistogram> schedulingHisto;
 
@@ -611,6 +627,9 @@ public:
         dirtyAgeHisto.reset();
         mlogCompactorHisto.reset();
         getMultiHisto.reset();
+        bgFetchCoalesceHisto.reset();
+        bgFetchReadHisto.reset();
+        bgFetchCompleteHisto.reset();
         persistenceCursorGetItemsHisto.reset();
         dcpCursorsGetItemsHisto.reset();
     }
@@ -26,17 +26,21 @@
 
 #include <platform/cb_malloc.h>
 
+#include <algorithm>
+
 const int64_t StoredValue::state_pending_seqno = -2;
 const int64_t StoredValue::state_deleted_key = -3;
 const int64_t StoredValue::state_non_existent_key = -4;
 const int64_t StoredValue::state_temp_init = -5;
 const int64_t StoredValue::state_collection_open = -6;
+const size_t StoredValue::maxInlineValueCapacity;
 
 StoredValue::StoredValue(const Item& itm,
                          UniquePtr n,
                          EPStats& stats,
-                         bool isOrdered)
-    : value(itm.getValue()),
+                         bool isOrdered,
+                         uint8_t inlineCapacity)
+    : value(),
       chain_next_or_replacement(std::move(n)),
       cas(itm.getCas()),
       revSeqno(itm.getRevSeqno()),
@@ -44,7 +48,9 @@ StoredValue::StoredValue(const Item& itm,
       lock_expiry_or_delete_time(0),
       exptime(itm.getExptime()),
       flags(itm.getFlags()),
-      datatype(itm.getDataType()) {
+      datatype(itm.getDataType()),
+      inlineValueCapacity(inlineCapacity),
+      inlineValueSize(0) {
     // Initialise bit fields
     setDeletedPriv(itm.isDeleted());
     setNewCacheItem(true);
@@ -64,14 +70,19 @@ StoredValue::StoredValue(const Item& itm,
         markDirty();
     }
 
-    if (isTempItem()) {
-        resetValue();
+    if (!isTempItem()) {
+        // Value can only be assigned once the key is in place, as any inline
+        // value is stored after it.
+        replaceValue(itm.getValue());
     }
 
     ObjectRegistry::onCreateStoredValue(this);
 }
 
 StoredValue::~StoredValue() {
+    if (isValueInline()) {
+        ObjectRegistry::onDeleteInlineValue(this);
+    }
     ObjectRegistry::onDeleteStoredValue(this);
 }
 
@@ -84,7 +95,9 @@ StoredValue::StoredValue(const StoredValue& other, UniquePtr n, EPStats& stats)
       lock_expiry_or_delete_time(other.lock_expiry_or_delete_time),
       exptime(other.exptime),
       flags(other.flags),
-      datatype(other.datatype) {
+      datatype(other.datatype),
+      inlineValueCapacity(other.inlineValueCapacity),
+      inlineValueSize(0) {
     setDirty(other.isDirty());
     setDeletedPriv(other.isDeleted());
     setNewCacheItem(other.isNewCacheItem());
@@ -96,6 +109,9 @@ StoredValue::StoredValue(const StoredValue& other, UniquePtr n, EPStats& stats)
     // object.
     StoredDocKey sKey(other.getKey());
     new (key()) SerialisedDocKey(sKey);
+    if (other.isValueInline()) {
+        setInlineValue(other.getValueData(), other.valuelen());
+    }
 
     ObjectRegistry::onCreateStoredValue(this);
 }
@@ -150,7 +166,7 @@ void StoredValue::restoreValue(const Item& itm) {
     }
     datatype = itm.getDataType();
     setDeletedPriv(itm.isDeleted());
-    value = itm.getValue();
+    replaceValue(itm.getValue());
     setResident(true);
 }
 
@@ -191,7 +207,7 @@ std::unique_ptr<Item> StoredValue::toItem(bool lck, uint16_t vbucket) const {
             std::make_unique<Item>(getKey(),
                                    getFlags(),
                                    getExptime(),
-                                   value,
+                                   materialiseValue(),
                                    datatype,
                                    lck ? static_cast<uint64_t>(-1) : getCas(),
                                    bySeqno,
@@ -229,12 +245,53 @@ std::unique_ptr<Item> StoredValue::toItemKeyOnly(uint16_t vbucket) const {
 }
 
 void StoredValue::reallocate() {
+    if (isValueInline()) {
+        // Inline values live in our own allocation; nothing to do.
+        return;
+    }
     // Allocate a new Blob for this stored value; copy the existing Blob to
     // the new one and free the old.
     value_t new_val(Blob::Copy(*value));
     value.reset(new_val);
 }
 
+value_t StoredValue::materialiseValue() const {
+    if (isValueInline()) {
+        return value_t(Blob::New(getValueData(), valuelen()));
+    }
+    return value;
+}
+
+void StoredValue::resetValue() {
+    if (isValueInline()) {
+        ObjectRegistry::onDeleteInlineValue(this);
+        inlineValueSize = 0;
+    }
+    value.reset();
+}
+
+void StoredValue::replaceValue(const value_t& newValue) {
+    resetValue();
+    if (inlineValueCapacity != 0 && newValue &&
+        newValue->valueSize() <= inlineValueCapacity) {
+        setInlineValue(newValue->getData(), newValue->valueSize());
+    } else {
+        value = newValue;
+    }
+}
+
+void StoredValue::setInlineValue(const char* data, size_t len) {
+    if (len > inlineValueCapacity) {
+        throw std::logic_error(
+                "StoredValue::setInlineValue: len (which is " +
+                std::to_string(len) + ") exceeds inline capacity (which is " +
+                std::to_string(inlineValueCapacity) + ")");
+    }
+    std::copy_n(data, len, inlineValueData());
+    inlineValueSize = static_cast<uint8_t>(len + 1);
+    ObjectRegistry::onCreateInlineValue(this);
+}
+
 void StoredValue::Deleter::operator()(StoredValue* val) {
     if (val->isOrdered()) {
         delete static_cast<OrderedStoredValue*>(val);
@@ -269,7 +326,7 @@ bool StoredValue::operator==(const StoredValue& other) const {
 }
 
 bool StoredValue::deleteImpl() {
-    if (isDeleted() && !getValue()) {
+    if (isDeleted() && !hasValue()) {
         // SV is already marked as deleted and has no value - no further
         // deletion possible.
         return false;
@@ -313,7 +370,7 @@ void StoredValue::setValueImpl(const Item& itm) {
         setResident(false);
     } else {
         setResident(true);
-        value = itm.getValue();
+        replaceValue(itm.getValue());
     }
 }
 
@@ -337,9 +394,9 @@ boost::optional<item_info> StoredValue::getItemInfo(uint64_t vbuuid) const {
             isDeleted() ? DocumentState::Deleted : DocumentState::Alive;
     info.nkey = getKey().size();
     info.key = getKey().data();
-    if (getValue()) {
-        info.value[0].iov_base = const_cast<char*>(getValue()->getData());
-        info.value[0].iov_len = getValue()->valueSize();
+    if (hasValue()) {
+        info.value[0].iov_base = const_cast<char*>(getValueData());
+        info.value[0].iov_len = valuelen();
     }
     return info;
 }
@@ -384,15 +441,18 @@ std::ostream& operator<<(std::ostream& os, const StoredValue& sv) {
     }
 
     os << " vallen:" << sv.valuelen();
-    if (sv.getValue().get()) {
+    if (sv.isValueInline()) {
+        os << " inline";
+    }
+    if (sv.hasValue()) {
         os << " val:\"";
-        const char* data = sv.getValue()->getData();
+        const char* data = sv.getValueData();
         // print up to first 40 bytes of value.
-        const size_t limit = std::min(size_t(40), sv.getValue()->valueSize());
+        const size_t limit = std::min(size_t(40), sv.valuelen());
         for (size_t ii = 0; ii < limit; ii++) {
             os << data[ii];
         }
-        if (limit < sv.getValue()->valueSize()) {
+        if (limit < sv.valuelen()) {
             os << " <cut>";
         }
         os << "\"";
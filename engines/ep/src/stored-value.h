@@ -74,8 +74,17 @@ class OrderedStoredValue;
  *               + - - - - - - - - - +
  *  variable {   | key[]             |
  *   length  {   | ...               |
+ *               + - - - - - - - - - +
+ *  optional {   | inline value[]    |
  *               +-------------------+
  *
+ * Short values can optionally be stored inline, directly after the key (see
+ * CompactStoredValueFactory). The number of bytes reserved for the inline
+ * value is fixed when the StoredValue is allocated; a value which does not fit
+ * is stored in a Blob as usual. An inline value saves the separate Blob
+ * allocation (and its refcount / size header), at the cost of copying the
+ * value out whenever an Item is created from the StoredValue.
+ *
  * OrderedStoredValue is a "subclass" of StoredValue, which is used by
  * Ephemeral buckets as it supports maintaining a seqno ordering of items in
  * memory (for Persistent buckets this ordering is maintained on-disk).
@@ -174,7 +183,9 @@ public:
 
     bool eligibleForEviction(item_eviction_policy_t policy) {
         if (policy == VALUE_ONLY) {
-            return isResident() && !isDirty() && !isDeleted();
+            // Ejecting an inline value wouldn't free any memory.
+            return isResident() && !isDirty() && !isDeleted() &&
+                   !isValueInline();
         } else {
             return !isDirty() && !isDeleted();
         }
@@ -212,12 +223,44 @@ public:
     }
 
     /**
-     * Get this item's value.
+     * Get this item's value Blob. Note this is null if the value is stored
+     * inline - see hasValue() / getValueData().
      */
     const value_t &getValue() const {
         return value;
     }
 
+    /**
+     * True if the value is stored inline, in this object's allocation.
+     */
+    bool isValueInline() const {
+        return inlineValueSize != 0;
+    }
+
+    /**
+     * True if this item has a value (either inline or as a Blob).
+     */
+    bool hasValue() const {
+        return isValueInline() || value;
+    }
+
+    /**
+     * Get a pointer to this item's value bytes, or nullptr if it has no
+     * value.
+     */
+    const char* getValueData() const {
+        if (isValueInline()) {
+            return const_cast<StoredValue&>(*this).inlineValueData();
+        }
+        return value ? value->getData() : nullptr;
+    }
+
+    /**
+     * Get this item's value as a Blob; if the value is stored inline a new
+     * Blob is created holding a copy of it.
+     */
+    value_t materialiseValue() const;
+
     /**
      * Get the expiration time of this item.
      *
@@ -418,6 +461,9 @@ public:
      }
 
     size_t valuelen() const {
+        if (isValueInline()) {
+            return inlineValueSize - 1;
+        }
         if (!value) {
             return 0;
         }
@@ -430,10 +476,19 @@ public:
      * @return the amount of memory used by this item.
      */
     size_t size() const {
-        return getObjectSize() + valuelen();
+        return metaDataSize() + valuelen();
     }
 
+    /**
+     * Size of the key and metadata of this item; excludes the space reserved
+     * for an inline value while the value is stored there (it's accounted as
+     * value by size()). If the value has fallen back to a Blob the unused
+     * inline space is overhead, so is included.
+     */
     size_t metaDataSize() const {
+        if (isValueInline()) {
+            return getObjectSize() - inlineValueCapacity;
+        }
         return getObjectSize();
     }
 
@@ -469,9 +524,7 @@ public:
     }
 
     /// Discard the value from this document.
-    void resetValue() {
-        value.reset();
-    }
+    void resetValue();
 
     /**
      * True if this object is logically deleted.
@@ -594,8 +647,9 @@ public:
     static const int64_t state_collection_open;
 
     /**
-     * Return the size in byte of this object; both the fixed fields and the
-     * variable-length key. Doesn't include value size (allocated externally).
+     * Return the size in byte of this object; the fixed fields, the
+     * variable-length key and any space reserved for an inline value. Doesn't
+     * include the size of a Blob value (allocated externally).
      */
     inline size_t getObjectSize() const;
 
@@ -626,6 +680,9 @@ public:
     /// Return how many bytes are need to store Item as a StoredValue
     static size_t getRequiredStorage(const Item& item);
 
+    /// Largest inline value capacity a StoredValue can be created with.
+    static const size_t maxInlineValueCapacity = 254;
+
 protected:
     /**
      * Constructor - protected as allocation needs to be done via
@@ -638,11 +695,14 @@ protected:
      *           which the new item is being inserted).
      * @param stats EPStats to update for this new StoredValue
      * @param isOrdered Are we constructing an OrderedStoredValue?
+     * @param inlineCapacity Number of bytes allocated after the key for an
+     *        inline value (at most maxInlineValueCapacity).
      */
     StoredValue(const Item& itm,
                 UniquePtr n,
                 EPStats& stats,
-                bool isOrdered);
+                bool isOrdered,
+                uint8_t inlineCapacity = 0);
 
     // Destructor. protected, as needs to be carefully deleted (via
     // StoredValue::Destructor) depending on the value of isOrdered flag.
@@ -671,6 +731,23 @@ protected:
      */
     inline SerialisedDocKey* key();
 
+    /**
+     * Get the address of the space reserved for an inline value (directly
+     * after the key).
+     */
+    char* inlineValueData() {
+        return reinterpret_cast<char*>(key()) + key()->getObjectSize();
+    }
+
+    /**
+     * Replace the value of this SV with the given one; storing it inline if
+     * it fits in the inline capacity.
+     */
+    void replaceValue(const value_t& newValue);
+
+    /// Copy the given bytes into the inline value space.
+    void setInlineValue(const char* data, size_t len);
+
     /**
      * Logically mark this SV as deleted.
      * Implementation for StoredValue instances (dispatched to by del() based
@@ -723,6 +800,7 @@ protected:
     }
 
     friend class StoredValueFactory;
+    friend class CompactStoredValueFactory;
 
     value_t            value;          // 8 bytes
 
@@ -743,6 +821,10 @@ protected:
     uint32_t           exptime;        //!< Expiration time of this item.
     uint32_t           flags;          // 4 bytes
     protocol_binary_datatype_t datatype; // 1 byte
+    /// Bytes reserved after the key for an inline value. Fixed at creation.
+    uint8_t            inlineValueCapacity;
+    /// Length of the inline value plus one; zero if the value isn't inline.
+    uint8_t            inlineValueSize;
 
     /**
      * Compressed members live in the AtomicBitSet old comments for some members
@@ -907,7 +989,8 @@ size_t StoredValue::getObjectSize() const {
     // Size of fixed part of OrderedStoredValue or StoredValue, plus size of
     // (variable) key.
     if (isOrdered()) {
-        return sizeof(OrderedStoredValue) + getKey().getObjectSize();
+        return sizeof(OrderedStoredValue) + getKey().getObjectSize() +
+               inlineValueCapacity;
     }
-    return sizeof(*this) + getKey().getObjectSize();
+    return sizeof(*this) + getKey().getObjectSize() + inlineValueCapacity;
 }
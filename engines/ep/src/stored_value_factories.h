@@ -21,8 +21,10 @@
  * Factories for creating StoredValue and subclasses of StoredValue.
  */
 
+#include <algorithm>
 #include <memory>
 
+#include "item.h"
 #include "stored-value.h"
 
 /**
@@ -90,6 +92,54 @@ private:
     EPStats* stats;
 };
 
+/**
+ * Creator of StoredValue instances which store short values inline (directly
+ * after the key) instead of in a separately allocated Blob.
+ *
+ * The inline capacity of each StoredValue is sized to the value it is created
+ * with (if that is no larger than maxInlineSize); subsequent updates which
+ * don't fit fall back to a Blob.
+ */
+class CompactStoredValueFactory : public AbstractStoredValueFactory {
+public:
+    using value_type = StoredValue;
+
+    CompactStoredValueFactory(EPStats& s, size_t maxInlineSize)
+        : stats(&s),
+          maxInlineSize(std::min(maxInlineSize,
+                                 StoredValue::maxInlineValueCapacity)) {
+    }
+
+    /**
+     * Create a concrete StoredValue object, with space for the item's value
+     * if it is small enough to be stored inline.
+     */
+    StoredValue::UniquePtr operator()(const Item& itm,
+                                      StoredValue::UniquePtr next) override {
+        size_t inlineCapacity = 0;
+        if (itm.getValue() && itm.getNBytes() <= maxInlineSize) {
+            inlineCapacity = itm.getNBytes();
+        }
+        return StoredValue::UniquePtr(
+                new (::operator new(StoredValue::getRequiredStorage(itm) +
+                                    inlineCapacity))
+                        StoredValue(itm,
+                                    std::move(next),
+                                    *stats,
+                                    /*isOrdered*/ false,
+                                    static_cast<uint8_t>(inlineCapacity)));
+    }
+
+    StoredValue::UniquePtr copyStoredValue(const StoredValue& other,
+                                           StoredValue::UniquePtr next) override {
+        throw std::logic_error("Copy of StoredValue is not supported");
+    }
+
+private:
+    EPStats* stats;
+    const size_t maxInlineSize;
+};
+
 /**
  * Creator of OrderedStoredValue instances.
  */
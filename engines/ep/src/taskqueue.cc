@@ -139,6 +139,19 @@ bool TaskQueue::_fetchNextTask(ExecutorThread &t, bool toSleep) {
         _checkPendingQueue();
         ExTask tid = _popReadyTask(); // and pop out the top task
         t.setCurrentTask(tid);
+        if (manager->isWorkStealing() && t.getNumLocalTasks() == 0) {
+            // Take a batch of the next ready tasks to the thread's local
+            // deque (still in priority order) so it can run them without
+            // coming back here, and idle threads can steal them from it.
+            // The batch is bounded so the rest stay here for the threads
+            // woken below, and for higher priority tasks to overtake.
+            for (size_t ii = 1; ii < ExecutorThread::MaxLocalTasks &&
+                                !readyQueue.empty();
+                 ++ii) {
+                t.pushLocalTask(readyQueue.top(), this);
+                readyQueue.pop();
+            }
+        }
         ret = true;
     } else { // Let the task continue waiting in pendingQueue
         numToWake = numToWake ? numToWake - 1 : 0; // 1 fewer task ready
@@ -19,9 +19,9 @@
 
 #include "config.h"
 
-#include "futurequeue.h"
 #include "syncobject.h"
 #include "task_type.h"
+#include "timerwheel.h"
 
 #include <platform/processclock.h>
 
@@ -87,7 +87,7 @@ private:
                         CompareByPriority> readyQueue;
 
     // sorted by waketime.
-    FutureQueue<> futureQueue;
+    TimerWheel futureQueue;
 
     std::list<ExTask> pendingQueue;
 };
@@ -39,6 +39,7 @@ TASK(WarmupCheckforAccessLog, READER_TASK_IDX, 0)
 TASK(WarmupLoadAccessLog, READER_TASK_IDX, 0)
 TASK(WarmupLoadingKVPairs, READER_TASK_IDX, 0)
 TASK(WarmupLoadingData, READER_TASK_IDX, 0)
+TASK(WarmupVBucketScan, READER_TASK_IDX, 0)
 TASK(WarmupCompletion, READER_TASK_IDX, 0)
 TASK(SingleBGFetcherTask, READER_TASK_IDX, 1)
 TASK(VKeyStatBGFetchTask, READER_TASK_IDX, 3)
@@ -61,6 +62,7 @@ TASK(StatSnap, WRITER_TASK_IDX, 9)
 // Non-IO tasks
 TASK(PendingOpsNotification, NONIO_TASK_IDX, 0)
 TASK(NotifyHighPriorityReqTask, NONIO_TASK_IDX, 0)
+TASK(WarmupLoader, NONIO_TASK_IDX, 0)
 TASK(ItemPager, NONIO_TASK_IDX, 1)
 TASK(ExpiredItemPager, NONIO_TASK_IDX, 1)
 TASK(ItemPagerVisitor, NONIO_TASK_IDX, 1)
@@ -0,0 +1,264 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2016 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "timerwheel.h"
+
+#include <stdexcept>
+
+constexpr std::chrono::milliseconds TimerWheel::tickDuration;
+
+TimerWheel::TimerWheel()
+    : cursor(toTick(ProcessClock::now())), count(0), earliestId(0) {
+    levelSize.fill(0);
+}
+
+void TimerWheel::push(ExTask task) {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    const size_t id = task->getId();
+    auto& entry = entries[id];
+    if (entry.count == 0) {
+        entry.task = task;
+        entry.waketime = task->getWaketime();
+        entry.tick = toTick(entry.waketime);
+        place(id, entry);
+    } else {
+        // The same task pushed again; its wake time may have changed since
+        replace(id, entry);
+    }
+    ++entry.count;
+    ++count;
+}
+
+void TimerWheel::pop() {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    if (count == 0) {
+        return;
+    }
+    // Note: we don't advance the cursor here, so we remove the same task
+    // the preceding top() returned.
+    auto it = entries.find(nextId());
+    --count;
+    if (--it->second.count == 0) {
+        unplace(it->second);
+        entries.erase(it);
+    }
+}
+
+ExTask TimerWheel::top() {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    if (count == 0) {
+        throw std::logic_error("TimerWheel::top: queue is empty");
+    }
+    advance(toTick(ProcessClock::now()));
+    return entries.at(nextId()).task;
+}
+
+size_t TimerWheel::size() {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return count;
+}
+
+bool TimerWheel::empty() {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return count == 0;
+}
+
+bool TimerWheel::updateWaketime(const ExTask& task,
+                                ProcessClock::time_point newTime) {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    task->updateWaketime(newTime);
+    auto it = entries.find(task->getId());
+    if (it == entries.end()) {
+        return false;
+    }
+    replace(it->first, it->second);
+    return true;
+}
+
+bool TimerWheel::snooze(const ExTask& task, const double secs) {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    task->snooze(secs);
+    auto it = entries.find(task->getId());
+    if (it == entries.end()) {
+        return false;
+    }
+    replace(it->first, it->second);
+    return true;
+}
+
+TimerWheel::Tick TimerWheel::toTick(ProcessClock::time_point time) {
+    const auto ticks =
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                    time.time_since_epoch()) /
+            tickDuration;
+    // time_point::min() (used to run a task immediately) is before the
+    // epoch
+    return ticks < 0 ? 0 : Tick(ticks);
+}
+
+void TimerWheel::place(size_t id, Entry& entry) {
+    if (earliestId != 0 && entry.waketime < earliestWaketime) {
+        earliestId = id;
+        earliestWaketime = entry.waketime;
+    }
+
+    if (entry.tick <= cursor) {
+        entry.location = Location::Due;
+        entry.duePos = due.emplace(entry.waketime, id).first;
+        return;
+    }
+
+    // The entry belongs in the lowest level at which all of the higher
+    // digits of its tick match the cursor.
+    const Tick diff = entry.tick ^ cursor;
+    for (int level = 0; level < NumLevels; ++level) {
+        if ((diff >> ((level + 1) * SlotBits)) == 0) {
+            const size_t slot =
+                    (entry.tick >> (level * SlotBits)) & (NumSlots - 1);
+            entry.location = Location::Wheel;
+            entry.level = uint8_t(level);
+            entry.slot = uint8_t(slot);
+            entry.pos = wheel[level][slot].insert(wheel[level][slot].end(), id);
+            ++levelSize[level];
+            return;
+        }
+    }
+
+    entry.location = Location::Overflow;
+    entry.pos = overflow.insert(overflow.end(), id);
+}
+
+void TimerWheel::unplace(Entry& entry) {
+    switch (entry.location) {
+    case Location::Due:
+        due.erase(entry.duePos);
+        break;
+    case Location::Wheel:
+        wheel[entry.level][entry.slot].erase(entry.pos);
+        --levelSize[entry.level];
+        break;
+    case Location::Overflow:
+        overflow.erase(entry.pos);
+        break;
+    }
+
+    if (earliestId == entry.task->getId()) {
+        earliestId = 0;
+    }
+}
+
+void TimerWheel::replace(size_t id, Entry& entry) {
+    unplace(entry);
+    entry.waketime = entry.task->getWaketime();
+    entry.tick = toTick(entry.waketime);
+    place(id, entry);
+}
+
+void TimerWheel::setCursor(Tick newCursor) {
+    const int topShift = NumLevels * SlotBits;
+    const bool newRange = (newCursor >> topShift) != (cursor >> topShift);
+    cursor = newCursor;
+
+    Slot pending;
+    if (newRange) {
+        // Some of the overflow may now fit in the wheel (or be due)
+        pending.swap(overflow);
+        for (auto id : pending) {
+            place(id, entries.at(id));
+        }
+        pending.clear();
+    }
+
+    // Going from the top level down (so entries cascaded into a lower
+    // level's current slot get cascaded again), move the entries of the
+    // slots the cursor now points at down to where they belong.
+    for (int level = NumLevels - 1; level >= 0; --level) {
+        auto& slot = wheel[level][(cursor >> (level * SlotBits)) &
+                                  (NumSlots - 1)];
+        if (slot.empty()) {
+            continue;
+        }
+        pending.swap(slot);
+        levelSize[level] -= pending.size();
+        for (auto id : pending) {
+            place(id, entries.at(id));
+        }
+        pending.clear();
+    }
+}
+
+void TimerWheel::advance(Tick target) {
+    while (cursor < target) {
+        int level;
+        size_t slot;
+        if (findEarliestSlot(level, slot)) {
+            const auto start = slotStart(level, slot);
+            if (start <= target) {
+                setCursor(start);
+                continue;
+            }
+        }
+        setCursor(target);
+    }
+}
+
+bool TimerWheel::findEarliestSlot(int& level, size_t& slot) const {
+    // All of the entries in a level are after the entries of the levels
+    // below it, and are in the slots after the cursor's digit.
+    for (level = 0; level < NumLevels; ++level) {
+        if (levelSize[level] == 0) {
+            continue;
+        }
+        const size_t current =
+                (cursor >> (level * SlotBits)) & (NumSlots - 1);
+        for (slot = current + 1; slot < NumSlots; ++slot) {
+            if (!wheel[level][slot].empty()) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+TimerWheel::Tick TimerWheel::slotStart(int level, size_t slot) const {
+    const int shift = (level + 1) * SlotBits;
+    return ((cursor >> shift) << shift) | (Tick(slot) << (level * SlotBits));
+}
+
+size_t TimerWheel::nextId() {
+    if (!due.empty()) {
+        return due.begin()->second;
+    }
+    if (earliestId != 0) {
+        return earliestId;
+    }
+
+    // Nothing is due; search the earliest slot (or if the wheel is empty,
+    // the overflow) for the next task to run.
+    int level;
+    size_t slot;
+    const Slot& candidates =
+            findEarliestSlot(level, slot) ? wheel[level][slot] : overflow;
+    for (auto id : candidates) {
+        const auto& entry = entries.at(id);
+        if (earliestId == 0 || entry.waketime < earliestWaketime) {
+            earliestId = id;
+            earliestWaketime = entry.waketime;
+        }
+    }
+    return earliestId;
+}
@@ -0,0 +1,179 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2016 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+/*
+ * The TimerWheel is a FutureQueue with the same std::priority_queue style
+ * interface (push / pop / top / updateWaketime / snooze), backed by a
+ * hierarchical timer wheel instead of a binary heap.
+ *
+ * FutureQueue has to search the heap and rebuild it every time a task is
+ * snoozed or woken, which is O(n) under the queue's lock. With thousands
+ * of periodically snoozing tasks (DCP notifiers, backfill managers, item
+ * pagers of many buckets) that cost adds up. The TimerWheel indexes the
+ * tasks by id, so push, snooze and wake are O(1):
+ *
+ * - Wake times are bucketed into ticks of tickDuration. The wheel has
+ *   NumLevels levels of NumSlots slots; level L holds the tasks which are
+ *   due within NumSlots^(L+1) ticks of the cursor (the current tick), in
+ *   the slot given by the L'th digit of their tick. Tasks further away
+ *   than that are held in an overflow list (e.g. tasks snoozed "forever").
+ * - Tasks whose tick has been reached by the cursor are held in a small
+ *   ordered set, which gives top() the exact ordering FutureQueue has.
+ * - top() advances the cursor to the current time, cascading the tasks
+ *   of the slots it passes down a level (each task cascades at most
+ *   NumLevels times). If no task is due, the earliest non-empty slot is
+ *   searched for the next task to run.
+ *
+ * A task pushed more than once is only stored once, with a count of the
+ * number of times it was pushed (as it is the same task, all of the
+ * copies have the same wake time).
+ */
+
+#pragma once
+
+#include <platform/processclock.h>
+
+#include "globaltask.h"
+
+#include <array>
+#include <list>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+
+class TimerWheel {
+public:
+    /// The resolution of the wheel
+    static constexpr std::chrono::milliseconds tickDuration{1};
+
+    /// log2 of the number of slots in each level
+    static const int SlotBits = 8;
+    static const size_t NumSlots = 1 << SlotBits;
+    static const int NumLevels = 4;
+
+    TimerWheel();
+
+    void push(ExTask task);
+
+    void pop();
+
+    ExTask top();
+
+    size_t size();
+
+    bool empty();
+
+    /*
+     * Update the wakeTime of task and move it to its new slot.
+     * @returns true if 'task' is in the TimerWheel.
+     */
+    bool updateWaketime(const ExTask& task, ProcessClock::time_point newTime);
+
+    /*
+     * snooze the task (by altering its wakeTime) and move it to its new
+     * slot.
+     * @returns true if 'task' is in the TimerWheel.
+     */
+    bool snooze(const ExTask& task, const double secs);
+
+protected:
+    using Tick = uint64_t;
+    using Slot = std::list<size_t>;
+    /// The set of tasks which are due, ordered by (wake time, task id)
+    using DueSet = std::set<std::pair<ProcessClock::time_point, size_t>>;
+
+    /// Where an Entry is currently stored
+    enum class Location : uint8_t { Due, Wheel, Overflow };
+
+    struct Entry {
+        ExTask task;
+        /// The number of times the task has been pushed
+        size_t count = 0;
+        /// The wake time of the task when it was last placed
+        ProcessClock::time_point waketime;
+        Tick tick;
+        Location location;
+        uint8_t level;
+        uint8_t slot;
+        /// Position in the wheel slot or the overflow list
+        Slot::iterator pos;
+        /// Position in the due set
+        DueSet::iterator duePos;
+    };
+
+    static Tick toTick(ProcessClock::time_point time);
+
+    /// Store the entry in the due set, the wheel or the overflow list
+    /// depending on how far from the cursor its tick is.
+    void place(size_t id, Entry& entry);
+
+    /// Remove the entry from where it's currently stored.
+    void unplace(Entry& entry);
+
+    /// Re-place the entry after its task's wake time changed.
+    void replace(size_t id, Entry& entry);
+
+    /**
+     * Move the cursor forward to the given tick. There must be no entries
+     * in the wheel with a tick before the new cursor. Cascades the slots
+     * the new cursor points at (and the overflow list, if the cursor moved
+     * into a new range of the top level) down to where they now belong.
+     */
+    void setCursor(Tick newCursor);
+
+    /// Advance the cursor to the given tick, moving every entry due by then
+    /// into the due set.
+    void advance(Tick target);
+
+    /**
+     * Find the earliest non-empty slot of the wheel.
+     * @return true (with level and slot set) if there is one.
+     */
+    bool findEarliestSlot(int& level, size_t& slot) const;
+
+    /// @return the first tick the given slot of the given level covers
+    Tick slotStart(int level, size_t slot) const;
+
+    /// @return the id of the next task to run (the queue must not be empty)
+    size_t nextId();
+
+    /// All of the tasks in the queue, by task id
+    std::unordered_map<size_t, Entry> entries;
+
+    std::array<std::array<Slot, NumSlots>, NumLevels> wheel;
+    /// The number of entries in each level of the wheel
+    std::array<size_t, NumLevels> levelSize;
+
+    Slot overflow;
+
+    DueSet due;
+
+    /// Every entry with a tick at or before the cursor is in the due set
+    Tick cursor;
+
+    /// The number of tasks in the queue (counting repeated pushes)
+    size_t count;
+
+    /// The next task to run if no task is due (nextId() caches the result
+    /// of searching the wheel here until that task is removed, or an
+    /// earlier one is placed). Zero if not known.
+    size_t earliestId;
+    ProcessClock::time_point earliestWaketime;
+
+    // All access to the wheel must be done with the queueMutex
+    std::mutex queueMutex;
+};
@@ -151,7 +151,13 @@ VBucket::VBucket(id_type i,
                  int64_t hlcEpochSeqno,
                  bool mightContainXattrs,
                  const std::string& collectionsManifest)
-    : ht(st, std::move(valFact), config.getHtSize(), config.getHtLocks()),
+    : ht(st,
+         std::move(valFact),
+         config.getHtSize(),
+         config.getHtLocks(),
+         config.getHtIndexType() == "tagged" ? HashTable::IndexType::Tagged
+                                             : HashTable::IndexType::Chained,
+         config.getAlogSketchSize()),
       checkpointManager(std::make_unique<CheckpointManager>(st,
                                                             i,
                                                             chkConfig,
@@ -419,14 +425,13 @@ void VBucket::addStat(const char *nm, const T &val, ADD_STAT add_stat,
 
 void VBucket::handlePreExpiry(const std::unique_lock<std::mutex>& hbl,
                               StoredValue& v) {
-    value_t value = v.getValue();
-    if (value) {
+    if (v.hasValue()) {
         std::unique_ptr<Item> itm(v.toItem(false, id));
         item_info itm_info;
         EventuallyPersistentEngine* engine = ObjectRegistry::getCurrentEngine();
         itm_info =
                 itm->toItemInfo(failovers->getLatestUUID(), getHLCEpochSeqno());
-        value_t new_val(Blob::Copy(*value));
+        value_t new_val(Blob::New(v.getValueData(), v.valuelen()));
         itm->setValue(new_val);
         itm->setDataType(v.getDatatype());
 
@@ -506,28 +511,32 @@ bool VBucket::isResidentRatioUnderThreshold(float threshold) {
     }
 }
 
-void VBucket::createFilter(size_t key_count, double probability) {
+void VBucket::createFilter(size_t key_count,
+                           double probability,
+                           bool blocked) {
     // Create the actual bloom filter upon vbucket creation during
     // scenarios:
     //      - Bucket creation
     //      - Rebalance
     LockHolder lh(bfMutex);
     if (bFilter == nullptr && tempFilter == nullptr) {
-        bFilter = std::make_unique<BloomFilter>(key_count, probability,
-                                        BFILTER_ENABLED);
+        bFilter = std::make_unique<BloomFilter>(
+                key_count, probability, BFILTER_ENABLED, blocked);
     } else {
         LOG(EXTENSION_LOG_WARNING, "(vb %" PRIu16 ") Bloom filter / Temp filter"
             " already exist!", id);
     }
 }
 
-void VBucket::initTempFilter(size_t key_count, double probability) {
+void VBucket::initTempFilter(size_t key_count,
+                             double probability,
+                             bool blocked) {
     // Create a temp bloom filter with status as COMPACTING,
     // if the main filter is found to exist, set its state to
     // COMPACTING as well.
     LockHolder lh(bfMutex);
-    tempFilter = std::make_unique<BloomFilter>(key_count, probability,
-                                     BFILTER_COMPACTING);
+    tempFilter = std::make_unique<BloomFilter>(
+            key_count, probability, BFILTER_COMPACTING, blocked);
     if (bFilter) {
         bFilter->setStatus(BFILTER_COMPACTING);
     }
@@ -2415,8 +2424,8 @@ VBucket::processExpiredItem(const HashTable::HashBucketLock& hbl,
      * but functionally correct and for performance reasons
      * only the system xattrs need to be stored.
      */
-    value_t value = v.getValue();
-    bool onlyMarkDeleted = value && mcbp::datatype::is_xattr(v.getDatatype());
+    bool onlyMarkDeleted =
+            v.hasValue() && mcbp::datatype::is_xattr(v.getDatatype());
     v.setRevSeqno(v.getRevSeqno() + 1);
     VBNotifyCtx notifyCtx;
     StoredValue* newSv;
@@ -2653,10 +2662,8 @@ std::unique_ptr<Item> VBucket::pruneXattrDocument(
     // Need to take a copy of the value, prune it, and add it back
 
     // Create work-space document
-    std::vector<uint8_t> workspace(v.getValue()->valueSize());
-    std::copy_n(v.getValue()->getData(),
-                v.getValue()->valueSize(),
-                workspace.begin());
+    std::vector<uint8_t> workspace(v.valuelen());
+    std::copy_n(v.getValueData(), v.valuelen(), workspace.begin());
 
     // Now attach to the XATTRs in the document
     auto sz = cb::xattr::get_body_offset(
@@ -45,6 +45,7 @@ class PreLinkDocumentContext;
 class EventuallyPersistentEngine;
 class DCPBackfill;
 class RollbackResult;
+class BGFetchGroup;
 class VBucketBGFetchItem;
 
 /**
@@ -507,8 +508,8 @@ public:
     /**
      * BloomFilter operations for vbucket
      */
-    void createFilter(size_t key_count, double probability);
-    void initTempFilter(size_t key_count, double probability);
+    void createFilter(size_t key_count, double probability, bool blocked);
+    void initTempFilter(size_t key_count, double probability, bool blocked);
     void addToFilter(const DocKey& key);
     virtual bool maybeKeyExistsInFilter(const DocKey& key);
     bool isTempFilterAvailable();
@@ -710,6 +711,22 @@ public:
             const VBucketBGFetchItem& fetched_item,
             const ProcessClock::time_point startTime) = 0;
 
+    /**
+     * Queue a background fetch of a key on behalf of a multi-get, adding a
+     * temporary item for the key first if it isn't in the HashTable (full
+     * eviction). The BgFetcher isn't woken up; the caller does that once it
+     * has queued all of the multi-get's fetches, so they are read from disk
+     * as one batch.
+     *
+     * @param key the key to be bg fetched
+     * @param group the multi-get's group of fetches
+     *
+     * @return ENGINE_EWOULDBLOCK if the fetch was queued, otherwise the
+     *         status to return for the key
+     */
+    virtual ENGINE_ERROR_CODE queueBGFetchForGroup(
+            const DocKey& key, const std::shared_ptr<BGFetchGroup>& group) = 0;
+
     /**
      * Retrieve an item from the disk for vkey stats
      *
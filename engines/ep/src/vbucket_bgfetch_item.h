@@ -21,6 +21,52 @@
 
 #include "item.h"
 
+#include <atomic>
+#include <memory>
+
+/**
+ * The background fetches issued for the keys of a single multi-get.
+ *
+ * The frontend must be notified exactly once for each ENGINE_EWOULDBLOCK
+ * it was given, so instead of every fetch notifying the cookie as it
+ * completes, the last of the group's fetches to complete notifies it.
+ * The cookie is always notified with ENGINE_SUCCESS: the frontend then
+ * retries the keys which blocked, and gets each key's own status (e.g.
+ * ENGINE_KEY_ENOENT or ENGINE_NOT_MY_VBUCKET) rather than one key's error
+ * failing the whole multi-get.
+ */
+class BGFetchGroup {
+public:
+    explicit BGFetchGroup(const void* c) : cookie(c) {
+    }
+
+    /// Add a fetch which must complete before the cookie is notified.
+    void add() {
+        ++pending;
+    }
+
+    /**
+     * Record the completion of one of the group's fetches (whatever its
+     * status).
+     *
+     * @return true if this was the last outstanding fetch, in which case
+     *         the caller must notify the cookie with ENGINE_SUCCESS.
+     */
+    bool complete() {
+        return --pending == 0;
+    }
+
+    const void* const cookie;
+
+private:
+    /**
+     * Number of fetches still to complete. Starts at one - held by the
+     * multi-get itself until it has queued all of its fetches, so the
+     * cookie can't be notified while fetches are still being added.
+     */
+    std::atomic<size_t> pending{1};
+};
+
 class VBucketBGFetchItem {
 public:
     VBucketBGFetchItem(const void* c, bool meta_only)
@@ -43,6 +89,8 @@ public:
     const void* cookie;
     ProcessClock::time_point initTime;
     bool metaDataOnly;
+    /// The multi-get this fetch is part of (if any)
+    std::shared_ptr<BGFetchGroup> group;
 };
 
 struct vb_bgfetch_item_ctx_t {
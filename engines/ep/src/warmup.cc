@@ -24,6 +24,7 @@
 #include "ep_engine.h"
 #include "ep_vb.h"
 #include "failover-table.h"
+#include "indexed_access_log.h"
 #include "mutation_log.h"
 #include "statwriter.h"
 #include "vbucket_bgfetch_item.h"
@@ -31,6 +32,7 @@
 #include <platform/make_unique.h>
 #include <platform/timeutils.h>
 
+#include <climits>
 #include <limits>
 #include <string>
 #include <utility>
@@ -324,6 +326,111 @@ private:
     const std::string _description;
 };
 
+class WarmupVBucketScan : public GlobalTask {
+public:
+    WarmupVBucketScan(KVBucket& st, uint16_t sh, Warmup* w)
+        : GlobalTask(&st.getEPEngine(), TaskId::WarmupVBucketScan, 0, false),
+          _shardId(sh),
+          _warmup(w),
+          _description("Warmup - scanning vbuckets: shard " +
+                       std::to_string(_shardId)) {
+        _warmup->addToTaskSet(uid);
+    }
+
+    cb::const_char_buffer getDescription() {
+        return _description;
+    }
+
+    std::chrono::microseconds maxExpectedDuration() {
+        // Each run scans one vBucket until it has been read or the queue is
+        // full; runtime is a function of the number of documents in it (and
+        // how quickly the loader inserts them).
+        // Given this large variation; set max duration to a "way out" value
+        // which we don't expect to see.
+        return std::chrono::hours(1);
+    }
+
+    bool run() {
+        TRACE_EVENT1("ep-engine/task", "WarmupVBucketScan", "shard", _shardId);
+        if (_warmup->scanNextVBucket(_shardId, *this)) {
+            return true;
+        }
+        _warmup->removeFromTaskSet(uid);
+        return false;
+    }
+
+private:
+    uint16_t _shardId;
+    Warmup* _warmup;
+    const std::string _description;
+};
+
+class WarmupLoader : public GlobalTask {
+public:
+    WarmupLoader(KVBucket& st,
+                 uint16_t sh,
+                 Warmup* w,
+                 std::unique_ptr<StatusCallback<GetValue>> cb)
+        : GlobalTask(&st.getEPEngine(), TaskId::WarmupLoader, 0, false),
+          _shardId(sh),
+          _warmup(w),
+          _callback(std::move(cb)),
+          _description("Warmup - loading items: shard " +
+                       std::to_string(_shardId)) {
+        _warmup->addToTaskSet(uid);
+    }
+
+    cb::const_char_buffer getDescription() {
+        return _description;
+    }
+
+    std::chrono::microseconds maxExpectedDuration() {
+        // Each run inserts at most warmup_batch_size items.
+        return std::chrono::seconds(1);
+    }
+
+    bool run() {
+        TRACE_EVENT1("ep-engine/task", "WarmupLoader", "shard", _shardId);
+        if (_warmup->loadQueuedItems(_shardId, *this, *_callback)) {
+            return true;
+        }
+        _warmup->removeFromTaskSet(uid);
+        return false;
+    }
+
+private:
+    uint16_t _shardId;
+    Warmup* _warmup;
+    std::unique_ptr<StatusCallback<GetValue>> _callback;
+    const std::string _description;
+};
+
+/**
+ * Scan callback of the pipelined warmup; queues the items read from disk
+ * for the shard's WarmupLoader to insert.
+ */
+class WarmupQueueingCallback : public StatusCallback<GetValue> {
+public:
+    WarmupQueueingCallback(WarmupPipeline& pipeline,
+                           WarmupVBucketProgress& progress)
+        : pipeline(pipeline), progress(progress) {
+    }
+
+    void callback(GetValue& val) {
+        if (pipeline.push(val)) {
+            ++progress.scanned;
+            setStatus(ENGINE_SUCCESS);
+        } else {
+            // The queue is full (or loading has stopped); cut the scan short
+            setStatus(ENGINE_ENOMEM);
+        }
+    }
+
+private:
+    WarmupPipeline& pipeline;
+    WarmupVBucketProgress& progress;
+};
+
 class WarmupCompletion : public GlobalTask {
 public:
     WarmupCompletion(KVBucket& st, Warmup* w) :
@@ -353,23 +460,26 @@ private:
 };
 
 
-static bool batchWarmupCallback(uint16_t vbId,
-                                const std::set<StoredDocKey>& fetches,
-                                void *arg)
+static void addWarmupFetch(vb_bgfetch_queue_t& items2fetch, const DocKey& key)
 {
-    WarmupCookie *c = static_cast<WarmupCookie *>(arg);
+    // Deleted via a unique_ptr in warmupFetchBatch
+    vb_bgfetch_item_ctx_t& bg_itm_ctx = items2fetch[StoredDocKey(key)];
+    bg_itm_ctx.isMetaOnly = GetMetaOnly::No;
+    bg_itm_ctx.bgfetched_list.emplace_back(
+            std::make_unique<VBucketBGFetchItem>(nullptr, false));
+    bg_itm_ctx.bgfetched_list.back()->value = &bg_itm_ctx.value;
+}
 
+/**
+ * Fetch a batch of a vBucket's items (added via addWarmupFetch) from disk
+ * and load them into the HashTable.
+ * @return false if loading should stop (traffic has been enabled)
+ */
+static bool warmupFetchBatch(WarmupCookie* c,
+                             uint16_t vbId,
+                             vb_bgfetch_queue_t& items2fetch)
+{
     if (!c->epstore->maybeEnableTraffic()) {
-        vb_bgfetch_queue_t items2fetch;
-        for (auto& key : fetches) {
-            // Deleted below via a unique_ptr in the next loop
-            vb_bgfetch_item_ctx_t& bg_itm_ctx = items2fetch[key];
-            bg_itm_ctx.isMetaOnly = GetMetaOnly::No;
-            bg_itm_ctx.bgfetched_list.emplace_back(
-                    std::make_unique<VBucketBGFetchItem>(nullptr, false));
-            bg_itm_ctx.bgfetched_list.back()->value = &bg_itm_ctx.value;
-        }
-
         c->epstore->getROUnderlying(vbId)->getMulti(vbId, items2fetch);
 
         // applyItem controls the  mode this loop operates in.
@@ -413,6 +523,18 @@ static bool batchWarmupCallback(uint16_t vbId,
     }
 }
 
+static bool batchWarmupCallback(uint16_t vbId,
+                                const std::set<StoredDocKey>& fetches,
+                                void *arg)
+{
+    WarmupCookie *c = static_cast<WarmupCookie *>(arg);
+    vb_bgfetch_queue_t items2fetch;
+    for (auto& key : fetches) {
+        addWarmupFetch(items2fetch, key);
+    }
+    return warmupFetchBatch(c, vbId, items2fetch);
+}
+
 static bool warmupCallback(void *arg, uint16_t vb, const DocKey& key)
 {
     WarmupCookie *cookie = static_cast<WarmupCookie*>(arg);
@@ -527,6 +649,123 @@ std::ostream& operator <<(std::ostream &out, const WarmupState &state)
     return out;
 }
 
+const char* WarmupVBucketProgress::to_string(State state) {
+    switch (state) {
+    case State::None:
+        return "none";
+    case State::Pending:
+        return "pending";
+    case State::Scanning:
+        return "scanning";
+    case State::Scanned:
+        return "scanned";
+    }
+    return "<invalid>";
+}
+
+void WarmupPipeline::reset(size_t capacity_, size_t numScanners) {
+    std::lock_guard<std::mutex> lh(mutex);
+    nextVBucket = 0;
+    queue.clear();
+    capacity = capacity_;
+    activeScanners = numScanners;
+    sleepingLoader = 0;
+    sleepingScanners.clear();
+    paused.clear();
+    stopped = false;
+}
+
+bool WarmupPipeline::push(GetValue& val) {
+    std::unique_lock<std::mutex> lh(mutex);
+    if (stopped || queue.size() >= capacity) {
+        return false;
+    }
+    queue.push_back(std::move(val));
+    wakeLoader(lh);
+    return true;
+}
+
+bool WarmupPipeline::pause(GlobalTask& scanner, const Scan& scan) {
+    std::lock_guard<std::mutex> lh(mutex);
+    if (stopped) {
+        return false;
+    }
+    paused.push_back(scan);
+    if (queue.size() >= capacity) {
+        // Sleep until the loader takes the queued items
+        scanner.snooze(INT_MAX);
+        sleepingScanners.push_back(scanner.getId());
+    }
+    return true;
+}
+
+bool WarmupPipeline::resume(Scan& scan) {
+    std::lock_guard<std::mutex> lh(mutex);
+    if (paused.empty()) {
+        return false;
+    }
+    scan = paused.back();
+    paused.pop_back();
+    return true;
+}
+
+bool WarmupPipeline::pop(GlobalTask& loader, std::deque<GetValue>& items) {
+    std::vector<size_t> scanners;
+    {
+        std::lock_guard<std::mutex> lh(mutex);
+        if (queue.empty()) {
+            if (activeScanners == 0) {
+                return false;
+            }
+            // Sleep until a scanner queues an item (or finishes)
+            loader.snooze(INT_MAX);
+            sleepingLoader = loader.getId();
+            return true;
+        }
+        items.swap(queue);
+        scanners.swap(sleepingScanners);
+    }
+    wakeScanners(scanners);
+    return true;
+}
+
+void WarmupPipeline::scannerDone() {
+    std::unique_lock<std::mutex> lh(mutex);
+    if (--activeScanners == 0) {
+        wakeLoader(lh);
+    }
+}
+
+std::vector<WarmupPipeline::Scan> WarmupPipeline::stop() {
+    std::vector<size_t> scanners;
+    std::vector<Scan> scans;
+    {
+        std::lock_guard<std::mutex> lh(mutex);
+        stopped = true;
+        scanners.swap(sleepingScanners);
+        scans.swap(paused);
+    }
+    wakeScanners(scanners);
+    return scans;
+}
+
+void WarmupPipeline::wakeLoader(std::unique_lock<std::mutex>& lh) {
+    if (sleepingLoader == 0) {
+        return;
+    }
+    const size_t taskId = sleepingLoader;
+    sleepingLoader = 0;
+    // Drop the lock before calling into the ExecutorPool
+    lh.unlock();
+    ExecutorPool::get()->wake(taskId);
+}
+
+void WarmupPipeline::wakeScanners(const std::vector<size_t>& scanners) {
+    for (const auto taskId : scanners) {
+        ExecutorPool::get()->wake(taskId);
+    }
+}
+
 LoadStorageKVPairCallback::LoadStorageKVPairCallback(KVBucket& ep,
                                                      bool _maybeEnableTraffic,
                                                      int _warmupState)
@@ -737,6 +976,8 @@ Warmup::Warmup(KVBucket& st, Configuration& config_)
       threadtask_count(0),
       shardKeyDumpStatus(store.vbMap.getNumShards()),
       shardVbIds(store.vbMap.getNumShards()),
+      pipelines(store.vbMap.getNumShards()),
+      vbProgress(store.vbMap.getSize()),
       estimatedItemCount(std::numeric_limits<size_t>::max()),
       cleanShutdown(true),
       corruptAccessLog(false),
@@ -783,6 +1024,10 @@ void Warmup::stop(void)
         }
         taskSet.clear();
     }
+    // Discard the scans parked by the (now cancelled) scanners
+    for (size_t shardId = 0; shardId < pipelines.size(); shardId++) {
+        stopPipeline(shardId);
+    }
     transition(WarmupState::Done, true);
     done();
 }
@@ -961,8 +1206,12 @@ void Warmup::scheduleKeyDump()
 {
     threadtask_count = 0;
     for (size_t i = 0; i < store.vbMap.shards.size(); i++) {
-        ExTask task = std::make_shared<WarmupKeyDump>(store, i, this);
-        ExecutorPool::get()->schedule(task);
+        if (isPipelined()) {
+            schedulePipeline(i, false);
+        } else {
+            ExTask task = std::make_shared<WarmupKeyDump>(store, i, this);
+            ExecutorPool::get()->schedule(task);
+        }
     }
 
 }
@@ -989,6 +1238,10 @@ void Warmup::keyDumpforShard(uint16_t shardId)
         }
     }
 
+    keyDumpCompleteForShard(shardId);
+}
+
+void Warmup::keyDumpCompleteForShard(uint16_t shardId) {
     shardKeyDumpStatus[shardId] = true;
 
     if (++threadtask_count == store.vbMap.getNumShards()) {
@@ -1069,11 +1322,19 @@ void Warmup::loadingAccessLog(uint16_t shardId)
     auto stTime = ProcessClock::now();
     if (store.accessLog[shardId].exists()) {
         try {
-            store.accessLog[shardId].open();
-            if (doWarmup(store.accessLog[shardId],
-                         shardVbStates[shardId],
-                         load_cb) != (size_t)-1) {
-                success = true;
+            const auto& file = store.accessLog[shardId].getLogFile();
+            if (IndexedAccessLog::isIndexed(file)) {
+                if (doIndexedWarmup(file, shardVbStates[shardId], load_cb) !=
+                    (size_t)-1) {
+                    success = true;
+                }
+            } else {
+                store.accessLog[shardId].open();
+                if (doWarmup(store.accessLog[shardId],
+                             shardVbStates[shardId],
+                             load_cb) != (size_t)-1) {
+                    success = true;
+                }
             }
         } catch (MutationLog::ReadException &e) {
             corruptAccessLog = true;
@@ -1089,10 +1350,17 @@ void Warmup::loadingAccessLog(uint16_t shardId)
         MutationLog old(nm);
         if (old.exists()) {
             try {
-                old.open();
-                if (doWarmup(old, shardVbStates[shardId], load_cb) !=
-                    (size_t)-1) {
-                    success = true;
+                if (IndexedAccessLog::isIndexed(nm)) {
+                    if (doIndexedWarmup(nm, shardVbStates[shardId], load_cb) !=
+                        (size_t)-1) {
+                        success = true;
+                    }
+                } else {
+                    old.open();
+                    if (doWarmup(old, shardVbStates[shardId], load_cb) !=
+                        (size_t)-1) {
+                        success = true;
+                    }
                 }
             } catch (MutationLog::ReadException &e) {
                 corruptAccessLog = true;
@@ -1169,6 +1437,66 @@ size_t Warmup::doWarmup(MutationLog& lf,
     return cookie.loaded;
 }
 
+size_t Warmup::doIndexedWarmup(const std::string& path,
+                               const std::map<uint16_t, vbucket_state>& vbmap,
+                               StatusCallback<GetValue>& cb) {
+    IndexedAccessLog::Reader log(path);
+    setEstimatedWarmupCount(log.getNumKeys());
+
+    const size_t batchSize = config.getWarmupBatchSize();
+    const bool multiBGFetch = store.multiBGFetchEnabled();
+    WarmupCookie cookie(&store, cb);
+    const auto start = ProcessClock::now();
+
+    // Each vBucket's keys are in on-disk order, so consecutive keys (and
+    // hence each getMulti batch) share the same B-tree nodes.
+    bool loading = true;
+    for (auto it = vbmap.begin(); loading && it != vbmap.end(); ++it) {
+        const uint16_t vbid = it->first;
+        VBucketPtr vb = store.getVBucket(vbid);
+        const auto* section = log.getSection(vbid);
+        if (!vb || !section) {
+            continue;
+        }
+
+        vb_bgfetch_queue_t items2fetch;
+        for (auto key_it = log.begin(*section);
+             loading && key_it != log.end(*section);
+             ++key_it) {
+            const DocKey key = *key_it;
+            // Skip any items which are no longer valid in the VBucket.
+            if (vb->ht.find(key, TrackReference::No, WantsDeleted::No) ==
+                nullptr) {
+                continue;
+            }
+
+            if (!multiBGFetch) {
+                loading = warmupCallback(&cookie, vbid, key);
+                continue;
+            }
+
+            addWarmupFetch(items2fetch, key);
+            if (items2fetch.size() >= batchSize) {
+                loading = warmupFetchBatch(&cookie, vbid, items2fetch);
+                items2fetch.clear();
+            }
+        }
+        if (loading && !items2fetch.empty()) {
+            loading = warmupFetchBatch(&cookie, vbid, items2fetch);
+        }
+    }
+
+    LOG(EXTENSION_LOG_DEBUG,
+        "Populated indexed log '%s' in %s with(l: %ld, s: %ld, e: %ld)",
+        path.c_str(),
+        cb::time2text(ProcessClock::now() - start).c_str(),
+        cookie.loaded,
+        cookie.skipped,
+        cookie.error);
+
+    return cookie.loaded;
+}
+
 void Warmup::scheduleLoadingKVPairs()
 {
     // We reach here only if keyDump didn't return SUCCESS or if
@@ -1179,8 +1507,14 @@ void Warmup::scheduleLoadingKVPairs()
 
     threadtask_count = 0;
     for (size_t i = 0; i < store.vbMap.shards.size(); i++) {
-        ExTask task = std::make_shared<WarmupLoadingKVPairs>(store, i, this);
-        ExecutorPool::get()->schedule(task);
+        if (isPipelined()) {
+            schedulePipeline(i,
+                             store.getItemEvictionPolicy() == FULL_EVICTION);
+        } else {
+            ExTask task =
+                    std::make_shared<WarmupLoadingKVPairs>(store, i, this);
+            ExecutorPool::get()->schedule(task);
+        }
     }
 
 }
@@ -1225,8 +1559,12 @@ void Warmup::scheduleLoadingData()
 
     threadtask_count = 0;
     for (size_t i = 0; i < store.vbMap.shards.size(); i++) {
-        ExTask task = std::make_shared<WarmupLoadingData>(store, i, this);
-        ExecutorPool::get()->schedule(task);
+        if (isPipelined()) {
+            schedulePipeline(i, true);
+        } else {
+            ExTask task = std::make_shared<WarmupLoadingData>(store, i, this);
+            ExecutorPool::get()->schedule(task);
+        }
     }
 }
 
@@ -1259,6 +1597,144 @@ void Warmup::loadDataforShard(uint16_t shardId)
     }
 }
 
+bool Warmup::isPipelined() const {
+    return config.getWarmupVbucketConcurrency() > 1;
+}
+
+void Warmup::schedulePipeline(uint16_t shardId, bool maybeEnableTraffic) {
+    const auto& vbIds = shardVbIds[shardId];
+    for (const auto vbid : vbIds) {
+        auto& progress = vbProgress[vbid];
+        progress.state = WarmupVBucketProgress::State::Pending;
+        progress.scanned = 0;
+        progress.loaded = 0;
+    }
+
+    const size_t numScanners =
+            std::min(config.getWarmupVbucketConcurrency(), vbIds.size());
+    pipelines[shardId].reset(config.getWarmupBatchSize(), numScanners);
+
+    ExTask loader = std::make_shared<WarmupLoader>(
+            store,
+            shardId,
+            this,
+            std::make_unique<LoadStorageKVPairCallback>(
+                    store, maybeEnableTraffic, state.getState()));
+    ExecutorPool::get()->schedule(loader);
+
+    for (size_t i = 0; i < numScanners; i++) {
+        ExTask task = std::make_shared<WarmupVBucketScan>(store, shardId, this);
+        ExecutorPool::get()->schedule(task);
+    }
+}
+
+bool Warmup::scanNextVBucket(uint16_t shardId, GlobalTask& scanner) {
+    auto& pipeline = pipelines[shardId];
+    KVStore* kvstore = store.getROUnderlyingByShard(shardId);
+    if (pipeline.isStopped()) {
+        pipeline.scannerDone();
+        return false;
+    }
+
+    WarmupPipeline::Scan scan;
+    if (!pipeline.resume(scan)) {
+        const auto& vbIds = shardVbIds[shardId];
+        const size_t index = pipeline.nextVBucket++;
+        if (index >= vbIds.size()) {
+            pipeline.scannerDone();
+            return false;
+        }
+
+        const uint16_t vbid = vbIds[index];
+        auto& progress = vbProgress[vbid];
+        progress.state = WarmupVBucketProgress::State::Scanning;
+
+        // Each scan needs its own callbacks, as they record a status
+        std::shared_ptr<StatusCallback<CacheLookup>> cl;
+        ValueFilter valFilter;
+        if (state.getState() == WarmupState::KeyDump) {
+            cl = std::make_shared<Collections::VB::LogicallyDeletedCallback>(
+                    store);
+            valFilter = ValueFilter::KEYS_ONLY;
+        } else {
+            cl = std::make_shared<LoadValueCallback>(store.vbMap,
+                                                     state.getState());
+            valFilter = ValueFilter::VALUES_DECOMPRESSED;
+        }
+        auto cb = std::make_shared<WarmupQueueingCallback>(pipeline, progress);
+
+        scan.ctx = kvstore->initScanContext(
+                cb, cl, vbid, 0, DocumentFilter::NO_DELETES, valFilter);
+        scan.start = ProcessClock::now();
+        if (!scan.ctx) {
+            progress.state = WarmupVBucketProgress::State::Scanned;
+            return true;
+        }
+    }
+
+    if (kvstore->scan(scan.ctx) == scan_again && !pipeline.isStopped()) {
+        // The queue is full; pick the scan up from where it was cut short
+        // once the loader has taken the queued items
+        if (pipeline.pause(scanner, scan)) {
+            return true;
+        }
+    }
+    // Otherwise the scan is complete, or loading has stopped (which the
+    // next run picks up from the pipeline)
+    const uint16_t vbid = scan.ctx->vbid;
+    kvstore->destroyScanContext(scan.ctx);
+
+    auto& progress = vbProgress[vbid];
+    progress.state = WarmupVBucketProgress::State::Scanned;
+    LOG(EXTENSION_LOG_INFO,
+        "Warmup (%s): read %" PRIu64 " items of vb:%" PRIu16 " in %s",
+        state.toString(),
+        uint64_t(progress.scanned),
+        vbid,
+        cb::time2text(ProcessClock::now() - scan.start).c_str());
+    return true;
+}
+
+void Warmup::stopPipeline(uint16_t shardId) {
+    KVStore* kvstore = store.getROUnderlyingByShard(shardId);
+    for (auto& scan : pipelines[shardId].stop()) {
+        kvstore->destroyScanContext(scan.ctx);
+    }
+}
+
+bool Warmup::loadQueuedItems(uint16_t shardId,
+                             GlobalTask& loader,
+                             StatusCallback<GetValue>& cb) {
+    auto& pipeline = pipelines[shardId];
+    std::deque<GetValue> items;
+    if (!pipeline.pop(loader, items)) {
+        // All of the shard's vBuckets have been read and loaded
+        if (state.getState() == WarmupState::KeyDump) {
+            keyDumpCompleteForShard(shardId);
+        } else if (++threadtask_count == store.vbMap.getNumShards()) {
+            transition(WarmupState::Done);
+        }
+        return false;
+    }
+
+    for (auto& val : items) {
+        if (pipeline.isStopped()) {
+            // Drop the rest of the items
+            break;
+        }
+        const uint16_t vbid = val.item->getVBucketId();
+        cb.callback(val);
+        if (cb.getStatus() != ENGINE_SUCCESS) {
+            // Memory limit reached (or warmup is complete); skip loading the
+            // remaining vBuckets
+            stopPipeline(shardId);
+            break;
+        }
+        ++vbProgress[vbid].loaded;
+    }
+    return true;
+}
+
 void Warmup::scheduleCompletion() {
     ExTask task = std::make_shared<WarmupCompletion>(store, this);
     ExecutorPool::get()->schedule(task);
@@ -1394,6 +1870,29 @@ void Warmup::addStats(ADD_STAT add_stat, const void *c) const
     } else {
         addStat("estimated_value_count", warmupCount, add_stat, c);
     }
+
+    if (isPipelined()) {
+        for (size_t vbid = 0; vbid < vbProgress.size(); vbid++) {
+            const auto& progress = vbProgress[vbid];
+            const auto vbState = progress.state.load();
+            if (vbState == WarmupVBucketProgress::State::None) {
+                continue;
+            }
+            const std::string prefix = "vb_" + std::to_string(vbid) + ":";
+            addStat((prefix + "state").c_str(),
+                    WarmupVBucketProgress::to_string(vbState),
+                    add_stat,
+                    c);
+            addStat((prefix + "scanned").c_str(),
+                    progress.scanned.load(),
+                    add_stat,
+                    c);
+            addStat((prefix + "loaded").c_str(),
+                    progress.loaded.load(),
+                    add_stat,
+                    c);
+        }
+    }
 }
 
 /* In the case of CouchKVStore, all vbucket states of all the shards are stored
@@ -1444,6 +1943,17 @@ void Warmup::populateShardVbStates()
             }
         }
 
+        if (isPipelined()) {
+            // The pipelined warmup scans several vBuckets at once; scan all
+            // of the active vBuckets before any replicas, so the active
+            // data is loaded first.
+            shardVbIds[i] = activeVBs;
+            shardVbIds[i].insert(shardVbIds[i].end(),
+                                 replicaVBs.begin(),
+                                 replicaVBs.end());
+            continue;
+        }
+
         // Push one active VB to the front.
         // When the ratio of RAM to VBucket is poor (big vbuckets) this will
         // ensure we at least bring active data in before replicas eat RAM.
@@ -25,6 +25,7 @@
 #include <atomic>
 #include <deque>
 #include <map>
+#include <mutex>
 #include <ostream>
 #include <string>
 #include <unordered_set>
@@ -36,8 +37,10 @@
 
 class Configuration;
 class EPStats;
+class GlobalTask;
 class KVBucket;
 class MutationLog;
+class ScanContext;
 class VBucketMap;
 
 struct vbucket_state;
@@ -114,6 +117,117 @@ private:
     int         warmupState;
 };
 
+/**
+ * The progress of the warmup of one vBucket through the current scan phase
+ * (KeyDump, LoadingKVPairs or LoadingData) of a pipelined warmup.
+ */
+struct WarmupVBucketProgress {
+    enum class State : uint8_t {
+        /// Not being warmed up
+        None,
+        /// Waiting for a scanner
+        Pending,
+        /// Being read from disk
+        Scanning,
+        /// Read from disk (the loader may still be inserting its items)
+        Scanned
+    };
+
+    static const char* to_string(State state);
+
+    std::atomic<State> state{State::None};
+    /// Items read from disk
+    std::atomic<size_t> scanned{0};
+    /// Items inserted into the HashTable
+    std::atomic<size_t> loaded{0};
+};
+
+/**
+ * The pipelined warmup of one shard, used by the scan phases when
+ * warmup_vbucket_concurrency is greater than one.
+ *
+ * Up to warmup_vbucket_concurrency WarmupVBucketScan tasks (READER) each
+ * take the next of the shard's vBuckets and read it from disk into a
+ * bounded queue; a single WarmupLoader task (NONIO) drains the queue into
+ * the HashTables. When the queue is full a scanner parks its (part read)
+ * scan and snoozes until the loader takes the queued items, so the disk
+ * reads run at most warmup_batch_size items ahead of the inserts without
+ * tying up a reader thread.
+ */
+class WarmupPipeline {
+public:
+    /// A vBucket scan which was cut short by a full queue
+    struct Scan {
+        ScanContext* ctx;
+        ProcessClock::time_point start;
+    };
+
+    /// Prepare the pipeline for a new scan phase.
+    void reset(size_t capacity, size_t numScanners);
+
+    /**
+     * Queue an item read from disk.
+     * @return false if the queue is full or loading has stopped (the item
+     *         is not queued)
+     */
+    bool push(GetValue& val);
+
+    /**
+     * Park a scan which was cut short by a full queue, for the next scanner
+     * run to resume. The scanner is snoozed until the loader takes the
+     * queued items (unless it already has).
+     * @return false if loading has stopped (the scan is not parked)
+     */
+    bool pause(GlobalTask& scanner, const Scan& scan);
+
+    /**
+     * Take a parked scan to resume.
+     * @return false if there are none
+     */
+    bool resume(Scan& scan);
+
+    /**
+     * Take all of the queued items. If there are none (and some scanners
+     * are still running) the loader is snoozed until an item is pushed.
+     * @param loader the WarmupLoader task
+     * @param[out] items the queued items
+     * @return false if there are no more items (all scanners are done)
+     */
+    bool pop(GlobalTask& loader, std::deque<GetValue>& items);
+
+    /// Called by a scanner when there are no more vBuckets to scan
+    void scannerDone();
+
+    /**
+     * Stop loading; wakes any snoozed scanners.
+     * @return the parked scans, for the caller to destroy
+     */
+    std::vector<Scan> stop();
+
+    bool isStopped() const {
+        return stopped;
+    }
+
+    /// Index (into the shard's vBucket IDs) of the next vBucket to scan
+    std::atomic<size_t> nextVBucket{0};
+
+private:
+    void wakeLoader(std::unique_lock<std::mutex>& lh);
+
+    /// Wake the given (snoozed) scanners; called without the mutex held
+    static void wakeScanners(const std::vector<size_t>& scanners);
+
+    std::mutex mutex;
+    std::deque<GetValue> queue;
+    size_t capacity = 0;
+    size_t activeScanners = 0;
+    /// ID of the loader task if it's snoozed waiting for items (else 0)
+    size_t sleepingLoader = 0;
+    /// IDs of the scanner tasks snoozed waiting for space in the queue
+    std::vector<size_t> sleepingScanners;
+    std::vector<Scan> paused;
+    std::atomic<bool> stopped{false};
+};
 
 class Warmup {
 public:
@@ -148,6 +262,16 @@ public:
                     const std::map<uint16_t, vbucket_state>& vbmap,
                     StatusCallback<GetValue>& cb);
 
+    /**
+     * Load the items listed in the indexed access log at the given path (see
+     * IndexedAccessLog), streaming each vBucket's section into getMulti
+     * batches.
+     * @return the number of items loaded
+     */
+    size_t doIndexedWarmup(const std::string& path,
+                           const std::map<uint16_t, vbucket_state>& vbmap,
+                           StatusCallback<GetValue>& cb);
+
     bool isComplete() const {
         return warmupComplete.load();
     }
@@ -190,6 +314,23 @@ public:
     void loadDataforShard(uint16_t shardId);
     void done();
 
+    /**
+     * Scan the next vBucket of the given shard into the shard's warmup
+     * pipeline (or resume a scan which was cut short by a full queue).
+     * @param scanner the WarmupVBucketScan task
+     * @return false if there are no more vBuckets to scan
+     */
+    bool scanNextVBucket(uint16_t shardId, GlobalTask& scanner);
+
+    /**
+     * Insert the items queued in the given shard's warmup pipeline into the
+     * HashTables.
+     * @return false once all of the shard's vBuckets have been loaded
+     */
+    bool loadQueuedItems(uint16_t shardId,
+                         GlobalTask& loader,
+                         StatusCallback<GetValue>& cb);
+
 private:
     template <typename T>
     void addStat(const char *nm, const T &val, ADD_STAT add_stat, const void *c) const;
@@ -201,6 +342,18 @@ private:
 
     void populateShardVbStates();
 
+    /// @return true if the scan phases use the WarmupPipeline
+    bool isPipelined() const;
+
+    /// Schedule the scanners and loader of the given shard's pipeline for
+    /// the current scan phase.
+    void schedulePipeline(uint16_t shardId, bool maybeEnableTraffic);
+
+    /// Stop the given shard's pipeline, destroying any parked scans
+    void stopPipeline(uint16_t shardId);
+
+    void keyDumpCompleteForShard(uint16_t shardId);
+
     void scheduleInitialize();
     void scheduleCreateVBuckets();
     void scheduleEstimateDatabaseItemCount();
@@ -242,6 +395,13 @@ private:
     /// contains all vBucket IDs which are present for the given shard.
     std::vector<std::vector<uint16_t>> shardVbIds;
 
+    /// One WarmupPipeline per shard (only used if isPipelined())
+    std::vector<WarmupPipeline> pipelines;
+
+    /// Progress of each vBucket through the current pipelined scan phase,
+    /// indexed by vBucket ID
+    std::vector<WarmupVBucketProgress> vbProgress;
+
     cb::AtomicDuration estimateTime;
     std::atomic<size_t> estimatedItemCount;
     bool cleanShutdown;
@@ -6162,6 +6162,7 @@ static enum test_result test_mb19687_fixed(ENGINE_HANDLE* h,
                 "ro_0:io_bg_fetch_docs_read",
                 "ro_0:io_num_write",
                 "ro_0:io_bg_fetch_doc_bytes",
+                "ro_0:io_bg_fetch_readahead",
                 "ro_0:io_total_read_bytes",
                 "ro_0:io_total_write_bytes",
                 "ro_0:io_write_bytes",
@@ -6177,6 +6178,7 @@ static enum test_result test_mb19687_fixed(ENGINE_HANDLE* h,
                 "ro_1:io_bg_fetch_docs_read",
                 "ro_1:io_num_write",
                 "ro_1:io_bg_fetch_doc_bytes",
+                "ro_1:io_bg_fetch_readahead",
                 "ro_1:io_total_read_bytes",
                 "ro_1:io_total_write_bytes",
                 "ro_1:io_write_bytes",
@@ -6192,6 +6194,7 @@ static enum test_result test_mb19687_fixed(ENGINE_HANDLE* h,
                 "ro_2:io_bg_fetch_docs_read",
                 "ro_2:io_num_write",
                 "ro_2:io_bg_fetch_doc_bytes",
+                "ro_2:io_bg_fetch_readahead",
                 "ro_2:io_total_read_bytes",
                 "ro_2:io_total_write_bytes",
                 "ro_2:io_write_bytes",
@@ -6207,6 +6210,7 @@ static enum test_result test_mb19687_fixed(ENGINE_HANDLE* h,
                 "ro_3:io_bg_fetch_docs_read",
                 "ro_3:io_num_write",
                 "ro_3:io_bg_fetch_doc_bytes",
+                "ro_3:io_bg_fetch_readahead",
                 "ro_3:io_total_read_bytes",
                 "ro_3:io_total_write_bytes",
                 "ro_3:io_write_bytes",
@@ -6228,6 +6232,7 @@ static enum test_result test_mb19687_fixed(ENGINE_HANDLE* h,
                 "rw_0:io_bg_fetch_docs_read",
                 "rw_0:io_num_write",
                 "rw_0:io_bg_fetch_doc_bytes",
+                "rw_0:io_bg_fetch_readahead",
                 "rw_0:io_total_read_bytes",
                 "rw_0:io_total_write_bytes",
                 "rw_0:io_write_bytes",
@@ -6247,6 +6252,7 @@ static enum test_result test_mb19687_fixed(ENGINE_HANDLE* h,
                 "rw_1:io_bg_fetch_docs_read",
                 "rw_1:io_num_write",
                 "rw_1:io_bg_fetch_doc_bytes",
+                "rw_1:io_bg_fetch_readahead",
                 "rw_1:io_total_read_bytes",
                 "rw_1:io_total_write_bytes",
                 "rw_1:io_write_bytes",
@@ -6266,6 +6272,7 @@ static enum test_result test_mb19687_fixed(ENGINE_HANDLE* h,
                 "rw_2:io_bg_fetch_docs_read",
                 "rw_2:io_num_write",
                 "rw_2:io_bg_fetch_doc_bytes",
+                "rw_2:io_bg_fetch_readahead",
                 "rw_2:io_total_read_bytes",
                 "rw_2:io_total_write_bytes",
                 "rw_2:io_write_bytes",
@@ -6285,6 +6292,7 @@ static enum test_result test_mb19687_fixed(ENGINE_HANDLE* h,
                 "rw_3:io_bg_fetch_docs_read",
                 "rw_3:io_num_write",
                 "rw_3:io_bg_fetch_doc_bytes",
+                "rw_3:io_bg_fetch_readahead",
                 "rw_3:io_total_read_bytes",
                 "rw_3:io_total_write_bytes",
                 "rw_3:io_write_bytes",
@@ -6332,7 +6340,10 @@ static enum test_result test_mb19687_fixed(ENGINE_HANDLE* h,
               "vb_0:mem_size",
               "vb_0:mem_size_counted",
               "vb_0:min_depth",
+              "vb_0:optimistic_finds",
               "vb_0:reported",
+              "vb_0:resize_old_size",
+              "vb_0:resize_remaining",
               "vb_0:resized",
               "vb_0:size",
               "vb_0:state"}},
@@ -6419,11 +6430,13 @@ static enum test_result test_mb19687_fixed(ENGINE_HANDLE* h,
             {"allocator", {"detailed"}},
             {"config", {"ep_backend",
                         "ep_backfill_mem_threshold",
+                        "ep_bfilter_blocked",
                         "ep_bfilter_enabled",
                         "ep_bfilter_fp_prob",
                         "ep_bfilter_key_count",
                         "ep_bfilter_residency_threshold",
                         "ep_bg_fetch_delay",
+                        "ep_bg_fetch_readahead",
                         "ep_bucket_type",
                         "ep_cache_size",
                         "ep_chk_max_items",
@@ -6467,24 +6480,29 @@ static enum test_result test_mb19687_fixed(ENGINE_HANDLE* h,
                         "ep_defragmenter_interval",
                         "ep_enable_chk_merge",
                         "ep_enable_dcp_consumer_snappy_compression",
+                        "ep_executor_work_stealing",
                         "ep_exp_pager_enabled",
                         "ep_exp_pager_initial_run_time",
                         "ep_exp_pager_stime",
                         "ep_failpartialwarmup",
                         "ep_flushall_enabled",
+                        "ep_flusher_group_commit_vbuckets",
                         "ep_fsync_after_every_n_bytes_written",
                         "ep_getl_default_timeout",
                         "ep_getl_max_timeout",
                         "ep_hlc_drift_ahead_threshold_us",
                         "ep_hlc_drift_behind_threshold_us",
+                        "ep_ht_index_type",
                         "ep_ht_locks",
                         "ep_ht_resize_interval",
+                        "ep_ht_resize_step_size",
                         "ep_ht_size",
                         "ep_initfile",
                         "ep_item_num_based_new_chk",
                         "ep_keep_closed_chks",
                         "ep_max_checkpoints",
                         "ep_max_failover_entries",
+                        "ep_max_inline_value_size",
                         "ep_max_item_privileged_bytes",
                         "ep_max_item_size",
                         "ep_max_num_auxio",
@@ -6530,6 +6548,7 @@ static enum test_result test_mb19687_fixed(ENGINE_HANDLE* h,
                         "ep_warmup_batch_size",
                         "ep_warmup_min_items_threshold",
                         "ep_warmup_min_memory_threshold",
+                        "ep_warmup_vbucket_concurrency",
                         "ep_xattr_enabled"}},
             {"workload",
              {"ep_workload:num_readers",
@@ -6583,12 +6602,14 @@ static enum test_result test_mb19687_fixed(ENGINE_HANDLE* h,
               "ep_active_hlc_drift_count",
               "ep_backend",
               "ep_backfill_mem_threshold",
+              "ep_bfilter_blocked",
               "ep_bfilter_enabled",
               "ep_bfilter_fp_prob",
               "ep_bfilter_key_count",
               "ep_bfilter_residency_threshold",
               "ep_bg_fetch_avg_read_amplification",
               "ep_bg_fetch_delay",
+              "ep_bg_fetch_readahead",
               "ep_bg_fetched",
               "ep_bg_meta_fetched",
               "ep_bg_remaining_items",
@@ -6654,6 +6675,7 @@ static enum test_result test_mb19687_fixed(ENGINE_HANDLE* h,
               "ep_diskqueue_pending",
               "ep_enable_chk_merge",
               "ep_enable_dcp_consumer_snappy_compression",
+              "ep_executor_work_stealing",
               "ep_exp_pager_enabled",
               "ep_exp_pager_initial_run_time",
               "ep_exp_pager_stime",
@@ -6665,13 +6687,16 @@ static enum test_result test_mb19687_fixed(ENGINE_HANDLE* h,
               "ep_flush_all",
               "ep_flush_duration_total",
               "ep_flushall_enabled",
+              "ep_flusher_group_commit_vbuckets",
               "ep_fsync_after_every_n_bytes_written",
               "ep_getl_default_timeout",
               "ep_getl_max_timeout",
               "ep_hlc_drift_ahead_threshold_us",
               "ep_hlc_drift_behind_threshold_us",
+              "ep_ht_index_type",
               "ep_ht_locks",
               "ep_ht_resize_interval",
+              "ep_ht_resize_step_size",
               "ep_ht_size",
               "ep_initfile",
               "ep_io_bg_fetch_read_count",
@@ -6687,6 +6712,7 @@ static enum test_result test_mb19687_fixed(ENGINE_HANDLE* h,
               "ep_max_bg_remaining_jobs",
               "ep_max_checkpoints",
               "ep_max_failover_entries",
+              "ep_max_inline_value_size",
               "ep_max_item_privileged_bytes",
               "ep_max_item_size",
               "ep_max_num_auxio",
@@ -6772,6 +6798,8 @@ static enum test_result test_mb19687_fixed(ENGINE_HANDLE* h,
               "ep_startup_time",
               "ep_storage_age",
               "ep_storage_age_highwat",
+              "ep_storedval_inline_num",
+              "ep_storedval_inline_size",
               "ep_storedval_num",
               "ep_storedval_overhead",
               "ep_storedval_size",
@@ -6793,6 +6821,7 @@ static enum test_result test_mb19687_fixed(ENGINE_HANDLE* h,
               "ep_warmup_batch_size",
               "ep_warmup_min_items_threshold",
               "ep_warmup_min_memory_threshold",
+              "ep_warmup_vbucket_concurrency",
               "ep_workload_pattern",
               "ep_xattr_enabled",
               "mem_used",
@@ -6906,9 +6935,11 @@ static enum test_result test_mb19687_fixed(ENGINE_HANDLE* h,
         eng_stats.insert(eng_stats.end(),
                          {"ep_access_scanner_enabled",
                           "ep_alog_block_size",
+                          "ep_alog_indexed",
                           "ep_alog_max_stored_items",
                           "ep_alog_path",
                           "ep_alog_resident_ratio_threshold",
+                          "ep_alog_sketch_size",
                           "ep_alog_sleep_time",
                           "ep_alog_task_time",
                           "ep_item_eviction_policy"});
@@ -6938,9 +6969,11 @@ static enum test_result test_mb19687_fixed(ENGINE_HANDLE* h,
         config_stats.insert(config_stats.end(),
                             {"ep_access_scanner_enabled",
                              "ep_alog_block_size",
+                             "ep_alog_indexed",
                              "ep_alog_max_stored_items",
                              "ep_alog_path",
                              "ep_alog_resident_ratio_threshold",
+                             "ep_alog_sketch_size",
                              "ep_alog_sleep_time",
                              "ep_alog_task_time",
                              "ep_item_eviction_policy"});
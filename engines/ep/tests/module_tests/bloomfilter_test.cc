@@ -89,3 +89,51 @@ INSTANTIATE_TEST_CASE_P(
         BloomFilterDocKeyTest,
         ::testing::Combine(::testing::ValuesIn(allDocNamespaces),
                            ::testing::ValuesIn(allDocNamespaces)), );
+
+class BlockedBloomFilterTest : public BloomFilter, public ::testing::Test {
+public:
+    BlockedBloomFilterTest()
+        : BloomFilter(10000, 0.01, BFILTER_ENABLED, true /*blocked*/) {
+    }
+};
+
+TEST_F(BlockedBloomFilterTest, check_layout) {
+    EXPECT_TRUE(isBlocked());
+    // Whole number of blocks, at least as large as the estimated size, with
+    // each block on a cache line.
+    EXPECT_EQ(0, getFilterSize() % bitsPerBlock);
+    EXPECT_GE(getFilterSize(), estimateFilterSize(10000, 0.01));
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(blocks) % 64);
+}
+
+TEST_F(BlockedBloomFilterTest, check_addKey_maybeKeyExists) {
+    const size_t numKeys = 10000;
+    for (size_t i = 0; i < numKeys; i++) {
+        addKey(makeStoredDocKey("key" + std::to_string(i)));
+    }
+    // Keys which (falsely) appeared to exist already aren't counted.
+    EXPECT_LE(getNumOfKeysInFilter(), numKeys);
+    EXPECT_GT(getNumOfKeysInFilter(), numKeys * 0.98);
+
+    // No false negatives...
+    for (size_t i = 0; i < numKeys; i++) {
+        EXPECT_TRUE(maybeKeyExists(makeStoredDocKey("key" + std::to_string(i))));
+    }
+
+    // ... and a false positive rate close to the configured 1% (blocking
+    // increases it slightly).
+    size_t falsePositives = 0;
+    for (size_t i = 0; i < numKeys; i++) {
+        if (maybeKeyExists(makeStoredDocKey("absent" + std::to_string(i)))) {
+            falsePositives++;
+        }
+    }
+    EXPECT_LT(falsePositives, numKeys * 0.03);
+}
+
+TEST_F(BlockedBloomFilterTest, check_namespaces) {
+    addKey(StoredDocKey("key", DocNamespace::DefaultCollection));
+    EXPECT_TRUE(maybeKeyExists(
+            StoredDocKey("key", DocNamespace::DefaultCollection)));
+    EXPECT_FALSE(maybeKeyExists(StoredDocKey("key", DocNamespace::System)));
+}
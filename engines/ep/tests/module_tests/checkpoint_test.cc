@@ -779,6 +779,38 @@ TYPED_TEST(CheckpointTest, ItemsForCheckpointCursor) {
     EXPECT_EQ(2 * MIN_CHECKPOINT_ITEMS + 3, items.size());
 }
 
+// The publish count should change whenever items become available to a
+// cursor, and not when items are read.
+TYPED_TEST(CheckpointTest, PublishCount) {
+    std::vector<queued_item> items;
+    this->manager->getAllItemsForCursor(CheckpointManager::pCursorName, items);
+
+    const auto drained = this->manager->getPublishCount();
+    items.clear();
+    this->manager->getAllItemsForCursor(CheckpointManager::pCursorName, items);
+    EXPECT_TRUE(items.empty());
+    EXPECT_EQ(drained, this->manager->getPublishCount())
+            << "Reading items should not change the publish count";
+
+    // New item.
+    ASSERT_TRUE(this->queueNewItem("key"));
+    const auto afterNew = this->manager->getPublishCount();
+    EXPECT_NE(drained, afterNew);
+
+    // De-duplicated item.
+    items.clear();
+    this->manager->getAllItemsForCursor(CheckpointManager::pCursorName, items);
+    EXPECT_EQ(1, items.size());
+    this->queueNewItem("key");
+    EXPECT_NE(afterNew, this->manager->getPublishCount());
+
+    // Registering a cursor (which may have items to read).
+    const auto beforeRegister = this->manager->getPublishCount();
+    this->manager->registerCursorBySeqno(
+            DCP_CURSOR_PREFIX "publish", 0, MustSendCheckpointEnd::NO);
+    EXPECT_NE(beforeRegister, this->manager->getPublishCount());
+}
+
 // Test the checkpoint cursor movement
 TYPED_TEST(CheckpointTest, CursorMovement) {
     /* We want to have items across 2 checkpoints. Size down the default number
@@ -976,6 +1008,81 @@ TYPED_TEST(CheckpointTest, CursorMovementReplicaMerge) {
                                      HasOperation(queue_op::checkpoint_start)));
 }
 
+// Check that a cursor in the middle of the last closed checkpoint keeps its
+// position when the earlier closed checkpoints are merged into it (their
+// items are inserted before the cursor's item).
+TYPED_TEST(CheckpointTest, CursorInLastClosedCheckpointOnMerge) {
+    this->vbucket->setState(vbucket_state_replica);
+    this->checkpoint_config = CheckpointConfig(DEFAULT_CHECKPOINT_PERIOD,
+                                               MIN_CHECKPOINT_ITEMS,
+                                               /*numCheckpoints*/ 2,
+                                               /*itemBased*/ true,
+                                               /*keepClosed*/ false,
+                                               /*enableMerge*/ true,
+                                               /*persistenceEnabled*/ true);
+
+    for (int ii = 0; ii < 10; ++ii) {
+        EXPECT_TRUE(this->queueNewItem("key" + std::to_string(ii)));
+    }
+
+    // DCP cursor left in the middle of the first checkpoint, so that it
+    // stays referenced and is merged rather than removed.
+    std::string dcp_cursor{DCP_CURSOR_PREFIX + std::to_string(1)};
+    this->manager->registerCursorBySeqno(
+            dcp_cursor.c_str(), 0, MustSendCheckpointEnd::NO);
+    std::vector<queued_item> items;
+    this->manager->getAllItemsForCursor(dcp_cursor.c_str(), items);
+    EXPECT_EQ(11, items.size());
+    for (int ii = 10; ii < 15; ++ii) {
+        EXPECT_TRUE(this->queueNewItem("key" + std::to_string(ii)));
+    }
+
+    EXPECT_EQ(2, this->manager->createNewCheckpoint());
+    for (int ii = 0; ii < 10; ++ii) {
+        EXPECT_TRUE(this->queueNewItem("keyB_" + std::to_string(ii)));
+    }
+
+    // Move the persistence cursor into the middle of the second checkpoint.
+    bool isLastMutationItem;
+    queued_item qi;
+    do {
+        qi = this->manager->nextItem(CheckpointManager::pCursorName,
+                                     isLastMutationItem);
+        ASSERT_NE(queue_op::empty, qi->getOperation());
+    } while (qi->getKey() != makeStoredDocKey("keyB_4"));
+
+    EXPECT_EQ(3, this->manager->createNewCheckpoint());
+
+    // Merge the first checkpoint into the second.
+    bool newCheckpointCreated;
+    this->manager->removeClosedUnrefCheckpoints(*this->vbucket,
+                                                newCheckpointCreated);
+    EXPECT_EQ(2, this->manager->getNumCheckpoints());
+
+    // The persistence cursor carries on from where it was.
+    EXPECT_EQ(5,
+              this->manager->getNumItemsForCursor(
+                      CheckpointManager::pCursorName));
+    items.clear();
+    this->manager->getAllItemsForCursor(CheckpointManager::pCursorName, items);
+    ASSERT_EQ(7, items.size());
+    for (int ii = 0; ii < 5; ++ii) {
+        EXPECT_EQ(makeStoredDocKey("keyB_" + std::to_string(ii + 5)),
+                  items[ii]->getKey());
+    }
+    EXPECT_EQ(queue_op::checkpoint_end, items[5]->getOperation());
+    EXPECT_EQ(queue_op::checkpoint_start, items[6]->getOperation());
+
+    // The DCP cursor was moved into the merged checkpoint, and gets the rest
+    // of the first checkpoint followed by the second.
+    items.clear();
+    this->manager->getAllItemsForCursor(dcp_cursor.c_str(), items);
+    ASSERT_EQ(17, items.size());
+    EXPECT_EQ(makeStoredDocKey("key10"), items[0]->getKey());
+    EXPECT_EQ(makeStoredDocKey("keyB_0"), items[5]->getKey());
+    EXPECT_EQ(makeStoredDocKey("keyB_9"), items[14]->getKey());
+}
+
 // MB-25056 - Regression test replicating situation where the seqno returned by
 // registerCursorBySeqno minus one is greater than the input parameter
 // startBySeqno but a backfill is not required.
@@ -1206,3 +1313,166 @@ TYPED_TEST(CheckpointTest,
     // Test - second item (duplicate key) should return false.
     EXPECT_FALSE(this->queueNewItem("key"));
 }
+
+/**
+ * Tests for the CheckpointQueue container (ChunkedQueue). A small chunk size
+ * is used so the tests cross chunk boundaries.
+ */
+class ChunkedQueueTest : public ::testing::Test {
+protected:
+    using Queue = ChunkedQueue<queued_item, 4>;
+
+    static queued_item makeItem(int64_t seqno) {
+        queued_item qi(new Item(makeStoredDocKey("key" + std::to_string(seqno)),
+                                0,
+                                0,
+                                "value",
+                                5,
+                                PROTOCOL_BINARY_RAW_BYTES,
+                                0,
+                                seqno));
+        return qi;
+    }
+
+    /// Fill the queue with items with seqnos [1, n].
+    void fill(int64_t n) {
+        for (int64_t i = 1; i <= n; ++i) {
+            queue.push_back(makeItem(i));
+        }
+    }
+
+    /// Returns the seqnos of the items in the queue, in order.
+    std::vector<int64_t> seqnos() const {
+        std::vector<int64_t> result;
+        for (const auto& qi : queue) {
+            result.push_back(qi->getBySeqno());
+        }
+        return result;
+    }
+
+    Queue queue;
+};
+
+TEST_F(ChunkedQueueTest, PushBackAndIterate) {
+    EXPECT_TRUE(queue.empty());
+    EXPECT_EQ(queue.begin(), queue.end());
+
+    fill(10);
+    EXPECT_EQ(10, queue.size());
+    EXPECT_EQ(3, queue.getNumChunks());
+    EXPECT_EQ(1, queue.front()->getBySeqno());
+    EXPECT_EQ(10, queue.back()->getBySeqno());
+    EXPECT_EQ(std::vector<int64_t>({1, 2, 3, 4, 5, 6, 7, 8, 9, 10}),
+              seqnos());
+
+    // Reverse iteration.
+    std::vector<int64_t> reversed;
+    for (auto rit = queue.rbegin(); rit != queue.rend(); ++rit) {
+        reversed.push_back((*rit)->getBySeqno());
+    }
+    EXPECT_EQ(std::vector<int64_t>({10, 9, 8, 7, 6, 5, 4, 3, 2, 1}),
+              reversed);
+}
+
+// Iterators must remain valid as other elements are erased and new elements
+// are appended, as CheckpointCursor and the key index rely on this.
+TEST_F(ChunkedQueueTest, IteratorsStableOverEraseAndPushBack) {
+    fill(6);
+    auto third = std::next(queue.begin(), 2);
+    auto fifth = std::next(queue.begin(), 4);
+
+    queue.erase(std::next(queue.begin(), 3));
+    queue.erase(std::next(queue.begin(), 1));
+    fill(8);
+
+    EXPECT_EQ(3, (*third)->getBySeqno());
+    EXPECT_EQ(5, (*fifth)->getBySeqno());
+    EXPECT_EQ(12, queue.size());
+
+    // Stepping over the erased elements (holes) in either direction.
+    EXPECT_EQ(5, (*std::next(third))->getBySeqno());
+    EXPECT_EQ(1, (*std::prev(third))->getBySeqno());
+    EXPECT_EQ(3, (*std::prev(fifth))->getBySeqno());
+}
+
+// Erasing every element of a chunk frees it.
+TEST_F(ChunkedQueueTest, EmptyChunkFreed) {
+    fill(12);
+    ASSERT_EQ(3, queue.getNumChunks());
+
+    for (int i = 0; i < 4; ++i) {
+        queue.erase(std::next(queue.begin(), 4));
+    }
+    EXPECT_EQ(2, queue.getNumChunks());
+    EXPECT_EQ(std::vector<int64_t>({1, 2, 3, 4, 9, 10, 11, 12}), seqnos());
+
+    while (!queue.empty()) {
+        queue.pop_back();
+    }
+    EXPECT_EQ(0, queue.getNumChunks());
+    EXPECT_EQ(queue.begin(), queue.end());
+}
+
+TEST_F(ChunkedQueueTest, InsertRange) {
+    fill(2);
+    queue.startNewChunk();
+    for (int64_t i = 3; i <= 6; ++i) {
+        queue.push_back(makeItem(i));
+    }
+    queue.erase(std::next(queue.begin(), 3));
+    ASSERT_EQ(2, queue.getNumChunks());
+
+    // Iterators to the existing elements must survive the insert.
+    auto third = std::next(queue.begin(), 2);
+    auto last = std::prev(queue.end());
+
+    std::vector<queued_item> extra;
+    for (int64_t i = 100; i < 106; ++i) {
+        extra.push_back(makeItem(i));
+    }
+    auto inserted = queue.insert(third, extra.begin(), extra.end());
+
+    EXPECT_EQ(100, (*inserted)->getBySeqno());
+    EXPECT_EQ(11, queue.size());
+    EXPECT_EQ(std::vector<int64_t>(
+                      {1, 2, 100, 101, 102, 103, 104, 105, 3, 5, 6}),
+              seqnos());
+    EXPECT_EQ(3, (*third)->getBySeqno());
+    EXPECT_EQ(6, (*last)->getBySeqno());
+    EXPECT_EQ(105, (*std::prev(third))->getBySeqno());
+
+    // Inserting at the end is equivalent to push_back.
+    inserted = queue.insert(queue.end(), extra.begin(), extra.begin() + 1);
+    EXPECT_EQ(100, queue.back()->getBySeqno());
+    EXPECT_EQ(std::prev(queue.end()), inserted);
+    EXPECT_EQ(12, queue.size());
+}
+
+// The memory usage accounts for whole chunks, however sparsely used.
+TEST_F(ChunkedQueueTest, MemoryUsage) {
+    EXPECT_EQ(0, queue.getMemoryUsage());
+
+    fill(1);
+    const size_t chunkSize = queue.getMemoryUsage();
+    EXPECT_LT(4 * sizeof(queued_item), chunkSize);
+
+    queue.startNewChunk();
+    fill(5);
+    ASSERT_EQ(3, queue.getNumChunks());
+    EXPECT_EQ(3 * chunkSize, queue.getMemoryUsage());
+
+    queue.clear();
+    EXPECT_EQ(0, queue.getMemoryUsage());
+}
+
+// Inserting before an element in the middle of a chunk would have to move
+// existing elements, so is refused.
+TEST_F(ChunkedQueueTest, InsertMidChunk) {
+    fill(3);
+    std::vector<queued_item> extra{makeItem(100)};
+    EXPECT_THROW(queue.insert(std::next(queue.begin()),
+                              extra.begin(),
+                              extra.end()),
+                 std::invalid_argument);
+    EXPECT_EQ(std::vector<int64_t>({1, 2, 3}), seqnos());
+}
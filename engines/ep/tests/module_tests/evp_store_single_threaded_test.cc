@@ -27,10 +27,13 @@
 #include "ep_time.h"
 #include "evp_store_test.h"
 #include "fakes/fake_executorpool.h"
+#include "hot_key_sketch.h"
+#include "indexed_access_log.h"
 #include "programs/engine_testapp/mock_server.h"
 #include "taskqueue.h"
 #include "tests/module_tests/test_helpers.h"
 #include "tests/module_tests/test_task.h"
+#include "warmup.h"
 
 #include <libcouchstore/couch_db.h>
 #include <string_utilities.h>
@@ -1716,6 +1719,227 @@ TEST_F(WarmupTest, MB_25197) {
     }
 }
 
+// Check that a pipelined warmup (several vBuckets of a shard scanned at once)
+// loads every vBucket, and reports the progress of each of them.
+TEST_F(WarmupTest, PipelinedWarmup) {
+    // Two scanners per shard, and a queue smaller than a vBucket so the
+    // scanners have to wait for the loader
+    config_string += ";warmup_vbucket_concurrency=2;warmup_batch_size=4";
+
+    // With 4 shards, each shard has two active and two replica vBuckets
+    const uint16_t numVBuckets = 16;
+    const size_t itemsPerVBucket = 10;
+    for (uint16_t vb = 0; vb < numVBuckets; vb++) {
+        setVBucketStateAndRunPersistTask(vb, vbucket_state_active);
+        for (size_t ii = 0; ii < itemsPerVBucket; ii++) {
+            store_item(
+                    vb, makeStoredDocKey("key" + std::to_string(ii)), "value");
+        }
+        flush_vbucket_to_disk(vb, itemsPerVBucket);
+    }
+    // Make half of the vBuckets replicas, which are scanned after the actives
+    auto isReplica = [numVBuckets](uint16_t vb) {
+        return vb >= numVBuckets / 2;
+    };
+    for (uint16_t vb = 0; vb < numVBuckets; vb++) {
+        if (isReplica(vb)) {
+            setVBucketStateAndRunPersistTask(vb, vbucket_state_replica);
+        }
+    }
+
+    resetEngineAndEnableWarmup();
+
+    std::map<std::string, std::string> stats;
+    auto getStats = [this, &stats]() {
+        auto addStat = [](const char* key,
+                          const uint16_t klen,
+                          const char* val,
+                          const uint32_t vlen,
+                          gsl::not_null<const void*> cookie) {
+            auto& stats =
+                    *reinterpret_cast<std::map<std::string, std::string>*>(
+                            const_cast<void*>(cookie.get()));
+            stats[std::string(key, klen)] = std::string(val, vlen);
+        };
+        stats.clear();
+        engine->getKVBucket()->getWarmup()->addStats(addStat, &stats);
+    };
+    auto getVBState = [&stats](uint16_t vb) {
+        return stats["ep_warmup_vb_" + std::to_string(vb) + ":state"];
+    };
+
+    // Check that (in each scan phase) no replica is scanned before all of
+    // the active vBuckets of its shard
+    std::vector<bool> started(numVBuckets);
+    auto checkOrder = [&]() {
+        getStats();
+        for (uint16_t vb = 0; vb < numVBuckets; vb++) {
+            const auto state = getVBState(vb);
+            if (state != "scanning" && state != "scanned") {
+                // Not started yet (or a new phase)
+                started[vb] = false;
+                continue;
+            }
+            if (!started[vb] && isReplica(vb)) {
+                const auto& vbMap = store->getVBuckets();
+                const auto shard = vbMap.getShardByVbId(vb)->getId();
+                for (uint16_t active = 0; active < numVBuckets; active++) {
+                    if (!isReplica(active) &&
+                        vbMap.getShardByVbId(active)->getId() == shard) {
+                        EXPECT_TRUE(started[active])
+                                << "vb:" << vb << " scanned before vb:"
+                                << active;
+                    }
+                }
+            }
+            started[vb] = true;
+        }
+    };
+
+    // Is one of the reader tasks (not a snoozed scanner) due to run?
+    auto readerTaskReady = [this]() {
+        for (const auto& task : task_executor->getTaskLocator()) {
+            if (task.second.second->getQueueType() == READER_TASK_IDX &&
+                task.second.first->getWaketime() <= ProcessClock::now()) {
+                return true;
+            }
+        }
+        return false;
+    };
+    // Is a scanner snoozed, waiting for the loader to drain the queue?
+    auto scannerWaiting = [this]() {
+        const std::string scanner = "Warmup - scanning vbuckets";
+        for (const auto& task : task_executor->getTaskLocator()) {
+            const auto desc = to_string(task.second.first->getDescription());
+            if (desc.compare(0, scanner.size(), scanner) == 0 &&
+                task.second.first->getWaketime() > ProcessClock::now()) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // The scanners run on the reader queue, the loaders on the NonIO queue;
+    // only run a loader once all of the (current) scanners have finished,
+    // or are waiting for space in the queue.
+    auto& readerQueue = *task_executor->getLpTaskQ()[READER_TASK_IDX];
+    auto& nonIOQueue = *task_executor->getLpTaskQ()[NONIO_TASK_IDX];
+    size_t scannerWaits = 0;
+    while (engine->getKVBucket()->isWarmingUp()) {
+        if (readerTaskReady()) {
+            runNextTask(readerQueue);
+        } else {
+            if (scannerWaiting()) {
+                ++scannerWaits;
+            }
+            runNextTask(nonIOQueue);
+        }
+        checkOrder();
+    }
+    EXPECT_NE(0, scannerWaits) << "Scanners never waited for the loader";
+
+    getStats();
+    for (uint16_t vb = 0; vb < numVBuckets; vb++) {
+        EXPECT_EQ(itemsPerVBucket, store->getVBucket(vb)->getNumItems())
+                << "vb:" << vb;
+        const std::string prefix = "ep_warmup_vb_" + std::to_string(vb) + ":";
+        EXPECT_EQ("scanned", stats[prefix + "state"]) << "vb:" << vb;
+        EXPECT_EQ(std::to_string(itemsPerVBucket), stats[prefix + "scanned"])
+                << "vb:" << vb;
+        EXPECT_EQ(std::to_string(itemsPerVBucket), stats[prefix + "loaded"])
+                << "vb:" << vb;
+    }
+}
+
+class WarmupHotKeysTest : public WarmupTest {
+protected:
+    void SetUp() override {
+        // A single shard so the access scanner schedules a single visitor,
+        // and an access log generated whatever the resident ratio. Traffic is
+        // enabled once 10% of the values are loaded, so warmup only loads the
+        // values of the keys in the access log.
+        config_string += "alog_sketch_size=16;alog_indexed=true;"
+                         "alog_resident_ratio_threshold=100;max_num_shards=1;"
+                         "warmup_min_items_threshold=10;alog_path=" +
+                         std::string(test_dbname) + "/access.log";
+        WarmupTest::SetUp();
+    }
+
+    /// @return the keys of vbid in the (single shard's) access log
+    std::vector<StoredDocKey> readAccessLog() {
+        IndexedAccessLog::Reader reader(std::string(test_dbname) +
+                                        "/access.log.0");
+        std::vector<StoredDocKey> keys;
+        auto* section = reader.getSection(vbid);
+        if (section) {
+            for (auto it = reader.begin(*section); it != reader.end(*section);
+                 ++it) {
+                keys.emplace_back(*it);
+            }
+        }
+        return keys;
+    }
+
+    /// Reference the key often enough for it to be sampled into the sketch.
+    void makeHot(const StoredDocKey& key) {
+        for (uint32_t ii = 0; ii < 4 * HotKeySketch::SampleInterval; ++ii) {
+            store->getVBucket(vbid)->ht.find(
+                    key, TrackReference::Yes, WantsDeleted::No);
+        }
+    }
+};
+
+// Check that the access scanner writes the hot key sketch to the access log,
+// that the sketch is written again on shutdown, and that warmup loads the
+// values of (only) the sketched keys.
+TEST_F(WarmupHotKeysTest, AccessLogRoundTrip) {
+    setVBucketStateAndRunPersistTask(vbid, vbucket_state_active);
+    const auto hot = makeStoredDocKey("hot");
+    const auto warm = makeStoredDocKey("warm");
+    std::vector<StoredDocKey> cold;
+    for (int ii = 0; ii < 8; ii++) {
+        cold.push_back(makeStoredDocKey("key" + std::to_string(ii)));
+    }
+    store_item(vbid, hot, "value");
+    store_item(vbid, warm, "value");
+    for (const auto& key : cold) {
+        store_item(vbid, key, "value");
+    }
+    flush_vbucket_to_disk(vbid, 2 + cold.size());
+
+    makeHot(hot);
+
+    // Run the access scanner, which writes the sketch rather than visiting
+    // the (all resident) items.
+    store->enableAccessScannerTask();
+    ASSERT_TRUE(store->runAccessScannerTask());
+    auto& auxQueue = *task_executor->getLpTaskQ()[AUXIO_TASK_IDX];
+    runNextTask(auxQueue, "Generating access log");
+    runNextTask(auxQueue, "Item Access Scanner on vb " + std::to_string(vbid));
+    EXPECT_EQ(1, engine->getEpStats().alogRuns.load());
+    EXPECT_EQ(std::vector<StoredDocKey>{hot}, readAccessLog());
+
+    // Keys which become hot after the scanner ran are written on shutdown.
+    makeHot(warm);
+    resetEngineAndEnableWarmup();
+    EXPECT_EQ((std::vector<StoredDocKey>{hot, warm}), readAccessLog());
+
+    runReadersUntilWarmedUp();
+    EXPECT_EQ(2 + cold.size(), engine->getEpStats().warmedUpKeys.load());
+    EXPECT_EQ(2, engine->getEpStats().warmedUpValues.load());
+    auto vb = store->getVBucket(vbid);
+    for (const auto& key : {hot, warm}) {
+        auto* v = vb->ht.find(key, TrackReference::No, WantsDeleted::No);
+        ASSERT_NE(nullptr, v);
+        EXPECT_TRUE(v->isResident()) << key.c_str();
+    }
+    for (const auto& key : cold) {
+        auto* v = vb->ht.find(key, TrackReference::No, WantsDeleted::No);
+        ASSERT_NE(nullptr, v);
+        EXPECT_FALSE(v->isResident()) << key.c_str();
+    }
+}
+
 // Test that we can push a DCP_DELETION which pretends to be from a delete
 // with xattrs, i.e. the delete has a value containing only system xattrs
 // The MB was created because this code would actually trigger an exception
@@ -1818,3 +2042,26 @@ TEST_F(SingleThreadedEPBucketTest, mb25273) {
     EXPECT_EQ(3, gv.item->getCas());
     EXPECT_EQ(value.size(), gv.item->getValue()->valueSize());
 }
+
+// Check that flushVBuckets() persists a group of vBuckets (from the same
+// shard) with a group commit, and only then updates their persistence seqnos.
+TEST_F(SingleThreadedEPBucketTest, FlushVBucketsGroupCommit) {
+    const uint16_t vbid2 = vbid + store->getVBuckets().getNumShards();
+    setVBucketStateAndRunPersistTask(vbid, vbucket_state_active);
+    setVBucketStateAndRunPersistTask(vbid2, vbucket_state_active);
+
+    store_item(vbid, makeStoredDocKey("key1"), "value");
+    store_item(vbid2, makeStoredDocKey("key1"), "value");
+    store_item(vbid2, makeStoredDocKey("key2"), "value");
+
+    std::vector<uint16_t> retry;
+    EXPECT_EQ(3, getEPBucket().flushVBuckets({vbid, vbid2}, retry));
+    EXPECT_TRUE(retry.empty());
+
+    EXPECT_EQ(1, store->getVBucket(vbid)->getPersistenceSeqno());
+    EXPECT_EQ(2, store->getVBucket(vbid2)->getPersistenceSeqno());
+
+    // Nothing outstanding - a second group flushes nothing.
+    EXPECT_EQ(0, getEPBucket().flushVBuckets({vbid, vbid2}, retry));
+    EXPECT_TRUE(retry.empty());
+}
@@ -31,6 +31,7 @@
 #include "checkpoint_remover.h"
 #include "dcp/dcpconnmap.h"
 #include "flusher.h"
+#include "programs/engine_testapp/mock_server.h"
 #include "tests/mock/mock_global_task.h"
 #include "tests/module_tests/test_helpers.h"
 #include "vbucketdeletiontask.h"
@@ -438,6 +439,183 @@ TEST_P(EPStoreEvictionTest, TouchCmdDuringBgFetch) {
               store->getVBucket(vbid)->getHighSeqno());
 }
 
+// Check that a BgFetcher run records each of its stages (coalescing the
+// shard's pending fetches, reading them and completing them).
+TEST_P(EPStoreEvictionTest, BgFetchStageHistograms) {
+    const DocKey dockey("key", DocNamespace::DefaultCollection);
+    store_item(vbid, dockey, "value");
+    flush_vbucket_to_disk(vbid);
+    evict_key(vbid, dockey);
+
+    auto options = static_cast<get_options_t>(QUEUE_BG_FETCH | HONOR_STATES |
+                                              TRACK_REFERENCE | DELETE_TEMP |
+                                              HIDE_LOCKED_CAS);
+    EXPECT_EQ(ENGINE_EWOULDBLOCK,
+              store->get(dockey, vbid, cookie, options).getStatus());
+
+    auto& stats = engine->getEpStats();
+    EXPECT_EQ(0, stats.bgFetchCoalesceHisto.total());
+    EXPECT_EQ(0, stats.bgFetchReadHisto.total());
+    EXPECT_EQ(0, stats.bgFetchCompleteHisto.total());
+
+    runBGFetcherTask();
+
+    EXPECT_EQ(1, stats.bgFetchCoalesceHisto.total());
+    EXPECT_EQ(1, stats.bgFetchReadHisto.total());
+    EXPECT_EQ(1, stats.bgFetchCompleteHisto.total());
+    EXPECT_EQ(ENGINE_SUCCESS,
+              store->get(dockey, vbid, cookie, options).getStatus());
+
+    // A run with nothing outstanding shouldn't record anything.
+    runBGFetcherTask();
+    EXPECT_EQ(1, stats.bgFetchCoalesceHisto.total());
+    EXPECT_EQ(1, stats.bgFetchReadHisto.total());
+}
+
+// Check that a multi-get returns the resident values straight away, and
+// fetches the others as a single batch - notifying the cookie just once.
+TEST_P(EPStoreEvictionTest, GetMultiBatchesBgFetches) {
+    std::vector<StoredDocKey> storedKeys;
+    for (int ii = 0; ii < 4; ++ii) {
+        storedKeys.push_back(makeStoredDocKey("key" + std::to_string(ii)));
+        store_item(vbid, storedKeys.back(), "value");
+    }
+    flush_vbucket_to_disk(vbid);
+    for (size_t ii = 1; ii < storedKeys.size(); ++ii) {
+        evict_key(vbid, storedKeys[ii]);
+    }
+
+    std::vector<cb::GetMultiKey> keys;
+    for (const auto& key : storedKeys) {
+        keys.push_back({key, vbid});
+    }
+    keys.push_back({makeStoredDocKey("key1"), uint16_t(vbid + 1)});
+
+    auto options = static_cast<get_options_t>(QUEUE_BG_FETCH | HONOR_STATES |
+                                              TRACK_REFERENCE | DELETE_TEMP |
+                                              HIDE_LOCKED_CAS);
+    auto notifications = get_number_of_mock_cookie_io_notifications(cookie);
+    auto values = store->getMulti(keys, cookie, options);
+    ASSERT_EQ(keys.size(), values.size());
+    EXPECT_EQ(ENGINE_SUCCESS, values[0].getStatus());
+    for (size_t ii = 1; ii < storedKeys.size(); ++ii) {
+        EXPECT_EQ(ENGINE_EWOULDBLOCK, values[ii].getStatus());
+    }
+    EXPECT_EQ(ENGINE_NOT_MY_VBUCKET, values.back().getStatus());
+
+    // All three fetches are read in one batch, and only the last of them to
+    // complete notifies the cookie.
+    auto& stats = engine->getEpStats();
+    runBGFetcherTask();
+    EXPECT_EQ(1, stats.getMultiBatchSizeHisto.total());
+    EXPECT_EQ(notifications + 1,
+              get_number_of_mock_cookie_io_notifications(cookie));
+
+    values = store->getMulti(keys, cookie, options);
+    for (size_t ii = 0; ii < storedKeys.size(); ++ii) {
+        EXPECT_EQ(ENGINE_SUCCESS, values[ii].getStatus());
+        EXPECT_EQ(storedKeys[ii], values[ii].item->getKey());
+    }
+}
+
+// Check that a failed fetch doesn't fail the whole multi-get: the cookie is
+// notified with success, and the retry reports each key's own status.
+TEST_P(EPStoreEvictionTest, GetMultiVBucketDeletedDuringBgFetch) {
+    std::vector<cb::GetMultiKey> keys;
+    for (int ii = 0; ii < 2; ++ii) {
+        auto key = makeStoredDocKey("key" + std::to_string(ii));
+        store_item(vbid, key, "value");
+        keys.push_back({key, vbid});
+    }
+    flush_vbucket_to_disk(vbid);
+    for (const auto& key : keys) {
+        evict_key(vbid, key.key);
+    }
+
+    auto options = static_cast<get_options_t>(QUEUE_BG_FETCH | HONOR_STATES |
+                                              TRACK_REFERENCE | DELETE_TEMP |
+                                              HIDE_LOCKED_CAS);
+    auto values = store->getMulti(keys, cookie, options);
+    ASSERT_EQ(keys.size(), values.size());
+    for (const auto& value : values) {
+        EXPECT_EQ(ENGINE_EWOULDBLOCK, value.getStatus());
+    }
+
+    // Mark the status of the cookie so that we can see what it's notified
+    // with
+    lock_mock_cookie(cookie);
+    struct mock_connstruct* c = (struct mock_connstruct*)cookie;
+    c->status = ENGINE_E2BIG;
+    unlock_mock_cookie(cookie);
+
+    const void* deleteCookie = create_mock_cookie();
+    lock_mock_cookie(deleteCookie);
+    store->deleteVBucket(vbid, deleteCookie);
+    waitfor_mock_cookie(deleteCookie);
+    unlock_mock_cookie(deleteCookie);
+
+    EXPECT_EQ(ENGINE_SUCCESS, c->status);
+
+    values = store->getMulti(keys, cookie, options);
+    ASSERT_EQ(keys.size(), values.size());
+    for (const auto& value : values) {
+        EXPECT_EQ(ENGINE_NOT_MY_VBUCKET, value.getStatus());
+    }
+
+    destroy_mock_cookie(deleteCookie);
+}
+
+// Check that the fetches of all of a shard's vBuckets are read as a single
+// batch, with each key completed (and its cookie notified) individually.
+TEST_P(EPStoreEvictionTest, BgFetchBatchesAcrossShardVBuckets) {
+    // Another vBucket in the same shard as vbid.
+    const uint16_t otherVb = vbid + store->getVBuckets().getNumShards();
+    ASSERT_EQ(store->getVBuckets().getShardByVbId(vbid),
+              store->getVBuckets().getShardByVbId(otherVb));
+    store->setVBucketState(otherVb, vbucket_state_active, false);
+
+    const auto key = makeStoredDocKey("key");
+    for (const auto vb : {vbid, otherVb}) {
+        store_item(vb, key, "value");
+        flush_vbucket_to_disk(vb);
+        evict_key(vb, key);
+    }
+
+    auto options = static_cast<get_options_t>(QUEUE_BG_FETCH | HONOR_STATES |
+                                              TRACK_REFERENCE | DELETE_TEMP |
+                                              HIDE_LOCKED_CAS);
+    const void* cookie2 = create_mock_cookie();
+    EXPECT_EQ(ENGINE_EWOULDBLOCK,
+              store->get(key, vbid, cookie, options).getStatus());
+    EXPECT_EQ(ENGINE_EWOULDBLOCK,
+              store->get(key, otherVb, cookie2, options).getStatus());
+    const auto notifications = get_number_of_mock_cookie_io_notifications(
+            cookie);
+    const auto notifications2 = get_number_of_mock_cookie_io_notifications(
+            cookie2);
+
+    auto& stats = engine->getEpStats();
+    runBGFetcherTask();
+
+    // One batch for the whole shard, but every key read and completed
+    // individually.
+    EXPECT_EQ(1, stats.bgFetchCoalesceHisto.total());
+    EXPECT_EQ(1, stats.getMultiBatchSizeHisto.total());
+    EXPECT_EQ(2, stats.bgFetchReadHisto.total());
+    EXPECT_EQ(2, stats.bgFetchCompleteHisto.total());
+    EXPECT_EQ(notifications + 1,
+              get_number_of_mock_cookie_io_notifications(cookie));
+    EXPECT_EQ(notifications2 + 1,
+              get_number_of_mock_cookie_io_notifications(cookie2));
+
+    EXPECT_EQ(ENGINE_SUCCESS,
+              store->get(key, vbid, cookie, options).getStatus());
+    EXPECT_EQ(ENGINE_SUCCESS,
+              store->get(key, otherVb, cookie2, options).getStatus());
+
+    destroy_mock_cookie(cookie2);
+}
+
 TEST_P(EPStoreEvictionTest, checkIfResidentAfterBgFetch) {
     const DocKey dockey("key", DocNamespace::DefaultCollection);
 
@@ -22,6 +22,8 @@
 #include "executorpool_test.h"
 #include "lambda_task.h"
 
+#include <future>
+
 MockTaskable::MockTaskable() : policy(HIGH_BUCKET_PRIORITY, 1) {
 }
 
@@ -241,6 +243,117 @@ TEST_F(ExecutorPoolDynamicWorkerTest, reschedule_dead_task) {
     EXPECT_EQ(2, runCount);
 }
 
+/* In work-stealing mode a thread takes a batch of the ready tasks of the
+ * queue when it fetches one; check that the tasks left in its local deque
+ * still run while it is blocked running the first of them.
+ */
+TEST_F(ExecutorPoolTest, work_stealing_blocked_thread) {
+    TestExecutorPool pool(10, // MaxThreads
+                          NUM_TASK_GROUPS,
+                          2, // MaxNumReaders
+                          2, // MaxNumWriters
+                          2, // MaxNumAuxio
+                          2, // MaxNumNonio
+                          true // workStealing
+                          );
+
+    MockTaskable taskable;
+    pool.registerTaskable(taskable);
+
+    // Both tasks must be running at the same time to get through the gate
+    ThreadGate tg{2};
+    std::vector<ExTask> tasks;
+    for (size_t i = 0; i < 2; ++i) {
+        ExTask task = makeTask(taskable, tg, i);
+        pool.schedule(task);
+        tasks.push_back(task);
+    }
+
+    tg.waitFor(std::chrono::seconds(10));
+    EXPECT_TRUE(tg.isComplete()) << "Timeout waiting for threads to run";
+
+    pool.unregisterTaskable(taskable, false);
+}
+
+TEST_F(ExecutorPoolTest, work_stealing_runs_all_tasks) {
+    TestExecutorPool pool(10, // MaxThreads
+                          NUM_TASK_GROUPS,
+                          2, // MaxNumReaders
+                          2, // MaxNumWriters
+                          2, // MaxNumAuxio
+                          4, // MaxNumNonio
+                          true // workStealing
+                          );
+
+    MockTaskable taskable;
+    pool.registerTaskable(taskable);
+
+    const size_t numTasks = 1000;
+    std::atomic<size_t> runCount{0};
+    for (size_t i = 0; i < numTasks; ++i) {
+        pool.schedule(std::make_shared<LambdaTask>(
+                taskable, TaskId::ItemPager, 0, true, [&runCount] {
+                    ++runCount;
+                    return false;
+                }));
+    }
+
+    // Shrinking the pool hands the tasks of the stopped threads back
+    pool.setNumNonIO(2);
+
+    pool.waitForEmptyTaskLocator();
+    EXPECT_EQ(numTasks, runCount);
+    EXPECT_EQ(0, pool.getNumReadyTasks());
+
+    pool.unregisterTaskable(taskable, false);
+}
+
+// A thread only takes a bounded batch of the ready tasks into its local deque
+TEST_F(ExecutorPoolTest, work_stealing_bounded_batch) {
+    TestExecutorPool pool(10, // MaxThreads
+                          NUM_TASK_GROUPS,
+                          2, // MaxNumReaders
+                          2, // MaxNumWriters
+                          2, // MaxNumAuxio
+                          1, // MaxNumNonio
+                          true // workStealing
+                          );
+
+    MockTaskable taskable;
+    pool.registerTaskable(taskable);
+
+    // Keep the only NonIO thread busy while the other tasks become ready
+    std::promise<void> blocked;
+    std::promise<void> unblock;
+    auto unblocked = unblock.get_future().share();
+    pool.schedule(std::make_shared<LambdaTask>(
+            taskable, TaskId::ItemPager, 0, true, [&blocked, unblocked] {
+                blocked.set_value();
+                unblocked.wait();
+                return false;
+            }));
+    blocked.get_future().wait();
+
+    const size_t numTasks = 4 * ExecutorThread::MaxLocalTasks;
+    std::vector<size_t> numLocalTasks;
+    for (size_t i = 0; i < numTasks; ++i) {
+        pool.schedule(std::make_shared<LambdaTask>(
+                taskable, TaskId::ItemPager, 0, true, [&pool, &numLocalTasks] {
+                    numLocalTasks.push_back(pool.getNumLocalTasks());
+                    return false;
+                }));
+    }
+    unblock.set_value();
+
+    pool.waitForEmptyTaskLocator();
+    ASSERT_EQ(numTasks, numLocalTasks.size());
+    for (const auto count : numLocalTasks) {
+        EXPECT_GT(ExecutorThread::MaxLocalTasks, count);
+    }
+
+    pool.unregisterTaskable(taskable, false);
+}
+
 /* Testing to ensure that repeatedly scheduling a task does not result in
  * multiple entries in the taskQueue - this could cause a deadlock in
  * _unregisterTaskable when the taskLocator is empty but duplicate tasks remain
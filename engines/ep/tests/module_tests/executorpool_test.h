@@ -59,13 +59,15 @@ public:
                      size_t maxReaders,
                      size_t maxWriters,
                      size_t maxAuxIO,
-                     size_t maxNonIO)
+                     size_t maxNonIO,
+                     bool workStealing = false)
         : ExecutorPool(maxThreads,
                        nTaskSets,
                        maxReaders,
                        maxWriters,
                        maxAuxIO,
-                       maxNonIO) {
+                       maxNonIO,
+                       workStealing) {
     }
 
     size_t getNumBuckets() {
@@ -86,6 +88,16 @@ public:
         return output;
     }
 
+    /// @return the number of tasks in the threads' local deques
+    size_t getNumLocalTasks() {
+        LockHolder lh(tMutex);
+        size_t count = 0;
+        for (const auto* thread : threadQ) {
+            count += thread->getNumLocalTasks();
+        }
+        return count;
+    }
+
     bool threadExists(std::string name) {
         auto names = getThreadNames();
         return std::find(names.begin(), names.end(), name) != names.end();
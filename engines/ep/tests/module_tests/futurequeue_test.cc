@@ -19,46 +19,56 @@
 
 #include "futurequeue.h"
 #include "tests/module_tests/test_task.h"
+#include "timerwheel.h"
 
-class FutureQueueTest : public ::testing::TestWithParam<std::string> {
+#include <random>
+
+template <typename Queue>
+class FutureQueueTest : public ::testing::Test {
 public:
-    FutureQueue<> queue;
+    Queue queue;
 };
 
-TEST_F(FutureQueueTest, initAssumptions) {
-    EXPECT_EQ(0u, queue.size());
-    EXPECT_TRUE(queue.empty());
+using FutureQueueTypes = ::testing::Types<FutureQueue<>, TimerWheel>;
+
+TYPED_TEST_CASE(FutureQueueTest, FutureQueueTypes);
+
+TYPED_TEST(FutureQueueTest, initAssumptions) {
+    EXPECT_EQ(0u, this->queue.size());
+    EXPECT_TRUE(this->queue.empty());
 }
 
-TEST_F(FutureQueueTest, push1) {
+TYPED_TEST(FutureQueueTest, push1) {
     ExTask hpTask =
             std::make_shared<TestTask>(nullptr, TaskId::PendingOpsNotification);
 
-    queue.push(hpTask);
-    EXPECT_EQ(1u, queue.size());
-    EXPECT_FALSE(queue.empty());
+    this->queue.push(hpTask);
+    EXPECT_EQ(1u, this->queue.size());
+    EXPECT_FALSE(this->queue.empty());
 
-    EXPECT_EQ(TaskId::PendingOpsNotification, queue.top()->getTypeId());
+    EXPECT_EQ(TaskId::PendingOpsNotification,
+              this->queue.top()->getTypeId());
 }
 
-TEST_F(FutureQueueTest, pushn) {
+TYPED_TEST(FutureQueueTest, pushn) {
     ExTask hpTask =
             std::make_shared<TestTask>(nullptr, TaskId::PendingOpsNotification);
 
     const size_t n = 10;
     for (size_t i = 0; i < n; i++) {
-        queue.push(hpTask);
+        this->queue.push(hpTask);
     }
-    EXPECT_EQ(n, queue.size());
-    EXPECT_FALSE(queue.empty());
-    EXPECT_EQ(TaskId::PendingOpsNotification, queue.top()->getTypeId());
+    EXPECT_EQ(n, this->queue.size());
+    EXPECT_FALSE(this->queue.empty());
+    EXPECT_EQ(TaskId::PendingOpsNotification,
+              this->queue.top()->getTypeId());
 }
 
 /*
  * Push n TestTask objects, each with an id of their push order but with
  * a decreasing waketime, i.e. last element pushed has the smallest wakeTime.
  */
-TEST_F(FutureQueueTest, pushOrder) {
+TYPED_TEST(FutureQueueTest, pushOrder) {
     const int n = 10;
     for (int i = 0; i <= n; i++) {
         ExTask hpTask;
@@ -66,11 +76,11 @@ TEST_F(FutureQueueTest, pushOrder) {
                 nullptr, TaskId::PendingOpsNotification, i);
         const auto newtime = std::chrono::nanoseconds(n - i);
         hpTask->updateWaketime(ProcessClock::time_point(newtime));
-        queue.push(hpTask);
+        this->queue.push(hpTask);
     }
 
     // last task pushed must be the first one in the queue
-    EXPECT_EQ(n, static_cast<TestTask*>(queue.top().get())->order);
+    EXPECT_EQ(n, static_cast<TestTask*>(this->queue.top().get())->order);
 }
 
 /*
@@ -80,7 +90,7 @@ TEST_F(FutureQueueTest, pushOrder) {
  * Then use the queue updateWake time to move a task to the front
  *
  */
-TEST_F(FutureQueueTest, updateWaketime) {
+TYPED_TEST(FutureQueueTest, updateWaketime) {
     const int n = 10;
     ExTask middleTask;
     for (int i = 0; i <= n; i++) {
@@ -89,7 +99,7 @@ TEST_F(FutureQueueTest, updateWaketime) {
                 nullptr, TaskId::PendingOpsNotification, i);
         const auto newtime = std::chrono::nanoseconds((n * 2) - i);
         hpTask->updateWaketime(ProcessClock::time_point(newtime));
-        queue.push(hpTask);
+        this->queue.push(hpTask);
 
         if (i == n/2) {
             middleTask = hpTask;
@@ -99,17 +109,17 @@ TEST_F(FutureQueueTest, updateWaketime) {
     ASSERT_NE(nullptr, middleTask.get());
 
     // last task pushed must be the first one in the queue
-    EXPECT_EQ(n, static_cast<TestTask*>(queue.top().get())->order);
+    EXPECT_EQ(n, static_cast<TestTask*>(this->queue.top().get())->order);
     EXPECT_NE(static_cast<TestTask*>(middleTask.get())->order,
-              static_cast<TestTask*>(queue.top().get())->order);
+              static_cast<TestTask*>(this->queue.top().get())->order);
 
     // Now update the n/2 task's time and expect it to become the front task
-    EXPECT_TRUE(queue.updateWaketime(middleTask,
+    EXPECT_TRUE(this->queue.updateWaketime(middleTask,
                                      ProcessClock::time_point::min()));
 
     // Now the middleTask is queue.top
     EXPECT_EQ(static_cast<TestTask*>(middleTask.get())->order,
-              static_cast<TestTask*>(queue.top().get())->order);
+              static_cast<TestTask*>(this->queue.top().get())->order);
 }
 
 /*
@@ -119,7 +129,7 @@ TEST_F(FutureQueueTest, updateWaketime) {
  * Then use the snooze method to move a task from the front
  *
  */
-TEST_F(FutureQueueTest, snooze) {
+TYPED_TEST(FutureQueueTest, snooze) {
     const int n = 10;
 
     for (int i = 0; i <= n; i++) {
@@ -128,26 +138,26 @@ TEST_F(FutureQueueTest, snooze) {
                 nullptr, TaskId::PendingOpsNotification, i);
         const auto newtime = std::chrono::nanoseconds((n * 2) - i);
         hpTask->updateWaketime(ProcessClock::time_point(newtime));
-        queue.push(hpTask);
+        this->queue.push(hpTask);
     }
 
     // Now update the top task's time and expect it to become the last task
     // we can't see the back, so will pop/top all..
-    int top = static_cast<TestTask*>(queue.top().get())->order;
-    EXPECT_TRUE(queue.snooze(queue.top(), n*3));
+    int top = static_cast<TestTask*>(this->queue.top().get())->order;
+    EXPECT_TRUE(this->queue.snooze(this->queue.top(), n*3));
 
     // The top task is not the old top
     EXPECT_NE(top,
-              static_cast<TestTask*>(queue.top().get())->order);
+              static_cast<TestTask*>(this->queue.top().get())->order);
 
     ExTask lastTask;
-    while (!queue.empty()) {
+    while (!this->queue.empty()) {
         if (lastTask) {
             EXPECT_LT(lastTask->getWaketime(),
-                      queue.top()->getWaketime());
+                      this->queue.top()->getWaketime());
         }
-        lastTask = queue.top();
-        queue.pop();
+        lastTask = this->queue.top();
+        this->queue.pop();
     }
 
     EXPECT_EQ(top, static_cast<TestTask*>(lastTask.get())->order);
@@ -156,65 +166,108 @@ TEST_F(FutureQueueTest, snooze) {
 /*
  * snooze/wake a task not in the queue, the queue is also empty.
  */
-TEST_F(FutureQueueTest, taskNotInEmptyQueue) {
+TYPED_TEST(FutureQueueTest, taskNotInEmptyQueue) {
     ExTask task =
             std::make_shared<TestTask>(nullptr, TaskId::PendingOpsNotification);
 
     const auto wake = task->getWaketime();
-    queue.snooze(task, 5.0);
+    this->queue.snooze(task, 5.0);
     // snooze uses gethrtime so we'll only check that the tasks time changed.
     EXPECT_NE(wake, task->getWaketime());
 
-    EXPECT_EQ(0u, queue.size());
-    EXPECT_TRUE(queue.empty());
+    EXPECT_EQ(0u, this->queue.size());
+    EXPECT_TRUE(this->queue.empty());
 
     const auto newtime = std::chrono::nanoseconds(5);
-    EXPECT_FALSE(queue.updateWaketime(task, ProcessClock::time_point(newtime)));
+    EXPECT_FALSE(this->queue.updateWaketime(
+            task, ProcessClock::time_point(newtime)));
     EXPECT_EQ(ProcessClock::time_point(std::chrono::nanoseconds(5)),
               task->getWaketime());
 
-    EXPECT_EQ(0u, queue.size());
-    EXPECT_TRUE(queue.empty());
+    EXPECT_EQ(0u, this->queue.size());
+    EXPECT_TRUE(this->queue.empty());
 }
 
 /*
  * snooze/wake a task not in the queue
  */
-TEST_F(FutureQueueTest, taskNotInQueue) {
+TYPED_TEST(FutureQueueTest, taskNotInQueue) {
     const size_t nTasks = 5;
     for (size_t ii = 1; ii < nTasks; ii++) {
         ExTask t = std::make_shared<TestTask>(nullptr,
                                               TaskId::PendingOpsNotification);
         const auto newtime = std::chrono::nanoseconds(1+ii);
         t->updateWaketime(ProcessClock::time_point(newtime));
-        queue.push(t);
+        this->queue.push(t);
     }
     // Finally push a task with an obvious ID value of -1
     ExTask task = std::make_shared<TestTask>(
             nullptr, TaskId::PendingOpsNotification, -1);
     task->updateWaketime(ProcessClock::time_point::min());
-    queue.push(task);
+    this->queue.push(task);
 
     // Now operate with a new task not in the queue
     task = std::make_shared<TestTask>(nullptr, TaskId::PendingOpsNotification);
     const auto wake = task->getWaketime();
-    EXPECT_FALSE(queue.snooze(task, 5.0));
+    EXPECT_FALSE(this->queue.snooze(task, 5.0));
 
     // snooze uses gethrtime so we'll only check that the tasks time changed.
     EXPECT_NE(wake, task->getWaketime());
 
-    EXPECT_EQ(nTasks, queue.size());
-    EXPECT_FALSE(queue.empty());
+    EXPECT_EQ(nTasks, this->queue.size());
+    EXPECT_FALSE(this->queue.empty());
     EXPECT_EQ(-1,
-              static_cast<TestTask*>(queue.top().get())->order);
+              static_cast<TestTask*>(this->queue.top().get())->order);
 
     const auto newtime = std::chrono::nanoseconds(5);
-    EXPECT_FALSE(queue.updateWaketime(task, ProcessClock::time_point(newtime)));
+    EXPECT_FALSE(this->queue.updateWaketime(
+            task, ProcessClock::time_point(newtime)));
     EXPECT_EQ(ProcessClock::time_point(std::chrono::nanoseconds(5)),
               task->getWaketime());
 
-    EXPECT_EQ(nTasks, queue.size());
-    EXPECT_FALSE(queue.empty());
+    EXPECT_EQ(nTasks, this->queue.size());
+    EXPECT_FALSE(this->queue.empty());
     EXPECT_EQ(-1,
-              static_cast<TestTask*>(queue.top().get())->order);
+              static_cast<TestTask*>(this->queue.top().get())->order);
+}
+
+/*
+ * Push tasks with wake times from the past to far in the future (covering
+ * all levels of a TimerWheel, and its overflow), snooze and wake some of
+ * them, and check they are popped in wake time order.
+ */
+TYPED_TEST(FutureQueueTest, popOrder) {
+    std::mt19937 gen(42);
+    // Up to ~2 years in the future
+    std::uniform_int_distribution<int64_t> dist(-1000, int64_t(1) << 36);
+    const auto now = ProcessClock::now();
+    std::vector<ExTask> tasks;
+    for (int i = 0; i < 1000; i++) {
+        ExTask task = std::make_shared<TestTask>(
+                nullptr, TaskId::PendingOpsNotification, i);
+        // Spread the offsets over all orders of magnitude
+        const auto offset = dist(gen) >> (i % 40);
+        task->updateWaketime(now + std::chrono::milliseconds(offset));
+        this->queue.push(task);
+        tasks.push_back(task);
+    }
+    this->queue.push(tasks[0]);
+
+    for (size_t i = 0; i < tasks.size(); i += 7) {
+        this->queue.snooze(tasks[i], 3600);
+        this->queue.updateWaketime(tasks[i + 3], now);
+    }
+    this->queue.updateWaketime(tasks[1], ProcessClock::time_point::max());
+
+    EXPECT_EQ(tasks.size() + 1, this->queue.size());
+    ExTask lastTask;
+    while (!this->queue.empty()) {
+        if (lastTask) {
+            EXPECT_LE(lastTask->getWaketime(),
+                      this->queue.top()->getWaketime());
+        }
+        lastTask = this->queue.top();
+        this->queue.pop();
+    }
+    EXPECT_EQ(1, static_cast<TestTask*>(lastTask.get())->order);
 }
@@ -32,6 +32,7 @@
 #include <algorithm>
 #include <limits>
 #include <signal.h>
+#include <thread>
 
 EPStats global_stats;
 
@@ -310,6 +311,102 @@ TEST_F(HashTableTest, AutoResize) {
     verifyFound(h, keys);
 }
 
+// Check items remain accessible (and can be mutated) while an incremental
+// resize is in progress.
+TEST_F(HashTableTest, IncrementalResize) {
+    HashTable h(global_stats, makeFactory(), 5, 3);
+
+    auto keys = generateKeys(1000);
+    storeMany(h, keys);
+    ASSERT_FALSE(h.isResizing());
+
+    // First step begins the resize to the preferred size (769).
+    size_t remaining = h.resizeStep(1);
+    EXPECT_TRUE(h.isResizing());
+    EXPECT_EQ(769, h.getSize());
+    EXPECT_EQ(5, h.getResizeOldSize());
+    EXPECT_EQ(4, remaining);
+    EXPECT_EQ(remaining, h.getNumBucketsToMigrate());
+    verifyFound(h, keys);
+    EXPECT_EQ(keys.size(), count(h));
+
+    // Mutate while migration is in progress - add new keys and delete some
+    // existing ones.
+    auto newKeys = generateKeys(1100, 1000);
+    storeMany(h, newKeys);
+    for (size_t i = 0; i < 100; ++i) {
+        EXPECT_TRUE(del(h, keys[i]));
+    }
+
+    while (remaining > 0) {
+        const auto next = h.resizeStep(1);
+        ASSERT_LT(next, remaining);
+        remaining = next;
+        EXPECT_EQ(keys.size() + newKeys.size() - 100, count(h));
+    }
+
+    EXPECT_FALSE(h.isResizing());
+    EXPECT_EQ(0, h.getResizeOldSize());
+    EXPECT_EQ(1, h.getNumResizes());
+    verifyFound(h, newKeys);
+    for (size_t i = 0; i < keys.size(); ++i) {
+        EXPECT_EQ(i >= 100,
+                  h.find(keys[i], TrackReference::No, WantsDeleted::No) !=
+                          nullptr);
+    }
+
+    // Already the preferred size - no further resize.
+    EXPECT_EQ(0, h.resizeStep(1));
+    EXPECT_FALSE(h.isResizing());
+}
+
+// A blocking resize completes any in-progress incremental resize first.
+TEST_F(HashTableTest, ResizeDuringIncrementalResize) {
+    HashTable h(global_stats,
+                makeFactory(),
+                5,
+                3,
+                HashTable::IndexType::Tagged);
+
+    auto keys = generateKeys(1000);
+    storeMany(h, keys);
+    ASSERT_GT(h.resizeStep(2), 0);
+    ASSERT_TRUE(h.isResizing());
+    verifyFound(h, keys);
+
+    h.resize(6143);
+    EXPECT_FALSE(h.isResizing());
+    EXPECT_EQ(6143, h.getSize());
+    verifyFound(h, keys);
+}
+
+// Check items can be added (and found) while another thread migrates
+// buckets, as each bucket is migrated holding only the locks it needs.
+TEST_F(HashTableTest, ConcurrentAccessIncrementalResize) {
+    HashTable h(global_stats,
+                makeFactory(),
+                5,
+                3,
+                HashTable::IndexType::Tagged);
+
+    auto keys = generateKeys(2000);
+    storeMany(h, keys);
+
+    std::thread resizer([&h]() {
+        while (h.resizeStep(1) > 0) {
+        }
+    });
+    auto newKeys = generateKeys(3000, 2000);
+    storeMany(h, newKeys);
+    verifyFound(h, keys);
+    resizer.join();
+
+    EXPECT_FALSE(h.isResizing());
+    verifyFound(h, keys);
+    verifyFound(h, newKeys);
+    EXPECT_EQ(keys.size() + newKeys.size(), count(h));
+}
+
 TEST_F(HashTableTest, DepthCounting) {
     HashTable h(global_stats, makeFactory(), 5, 1);
     const int nkeys = 5000;
@@ -330,6 +427,132 @@ TEST_F(HashTableTest, PoisonKey) {
     EXPECT_EQ(1, count(h));
 }
 
+// Check the tagged index finds items in both short and overflowing chains.
+TEST_F(HashTableTest, TaggedFind) {
+    HashTable h(global_stats,
+                makeFactory(),
+                5,
+                1,
+                HashTable::IndexType::Tagged);
+    ASSERT_EQ(HashTable::IndexType::Tagged, h.getIndexType());
+    testFind(h);
+    // A missing key should have been rejected by the tag index, or in the
+    // unlikely event of a tag collision, by a locked lookup.
+    EXPECT_LE(h.getNumOptimisticFinds(), 1);
+}
+
+TEST_F(HashTableTest, TaggedResize) {
+    HashTable h(global_stats,
+                makeFactory(),
+                5,
+                3,
+                HashTable::IndexType::Tagged);
+
+    auto keys = generateKeys(1000);
+    storeMany(h, keys);
+    verifyFound(h, keys);
+
+    // 1000 items over 6143 buckets - chains fit within a TagBucket so
+    // missing keys should mostly be answered without locking.
+    h.resize(6143);
+    EXPECT_EQ(6143, h.getSize());
+    verifyFound(h, keys);
+
+    const auto before = h.getNumOptimisticFinds();
+    for (const auto& key : generateKeys(2000, 1000)) {
+        EXPECT_FALSE(h.find(key, TrackReference::No, WantsDeleted::Yes));
+    }
+    EXPECT_GT(h.getNumOptimisticFinds(), before);
+
+    h.resize(769);
+    EXPECT_EQ(769, h.getSize());
+    verifyFound(h, keys);
+}
+
+TEST_F(HashTableTest, TaggedDeletions) {
+    size_t initialSize = global_stats.currentSize.load();
+    HashTable h(global_stats,
+                makeFactory(),
+                5,
+                1,
+                HashTable::IndexType::Tagged);
+    const int nkeys = 1000;
+
+    auto keys = generateKeys(nkeys);
+    storeMany(h, keys);
+    EXPECT_EQ(nkeys, count(h));
+
+    // Delete every other key, then check the survivors are still found and
+    // the deleted ones are not.
+    for (size_t i = 0; i < keys.size(); i += 2) {
+        EXPECT_TRUE(del(h, keys[i]));
+    }
+    for (size_t i = 0; i < keys.size(); ++i) {
+        EXPECT_EQ(i % 2 != 0,
+                  h.find(keys[i], TrackReference::No, WantsDeleted::Yes) !=
+                          nullptr);
+    }
+
+    for (size_t i = 1; i < keys.size(); i += 2) {
+        EXPECT_TRUE(del(h, keys[i]));
+    }
+    EXPECT_EQ(0, count(h));
+    EXPECT_EQ(initialSize, global_stats.currentSize.load());
+}
+
+TEST_F(HashTableTest, TaggedConcurrentAccessResize) {
+    HashTable h(global_stats,
+                makeFactory(),
+                5,
+                3,
+                HashTable::IndexType::Tagged);
+
+    auto keys = generateKeys(2000);
+    h.resize(keys.size());
+    storeMany(h, keys);
+
+    verifyFound(h, keys);
+
+    srand(918475);
+    AccessGenerator gen(keys, h);
+    getCompletedThreads(4, &gen);
+}
+
+// Check lock-free probes of the tag index are safe while resizes replace
+// (and free) it; misses take the lock-free path.
+TEST_F(HashTableTest, TaggedConcurrentFindResize) {
+    HashTable h(global_stats,
+                makeFactory(),
+                5,
+                3,
+                HashTable::IndexType::Tagged);
+
+    auto keys = generateKeys(1000);
+    storeMany(h, keys);
+    auto missingKeys = generateKeys(2000, 1000);
+
+    std::atomic<bool> done{false};
+    std::vector<std::thread> readers;
+    for (int ii = 0; ii < 2; ++ii) {
+        readers.emplace_back([&h, &missingKeys, &done]() {
+            while (!done) {
+                for (const auto& key : missingKeys) {
+                    EXPECT_FALSE(h.find(
+                            key, TrackReference::No, WantsDeleted::No));
+                }
+            }
+        });
+    }
+    for (int ii = 0; ii < 50; ++ii) {
+        h.resize(ii % 2 ? 97 : 1531);
+    }
+    done = true;
+    for (auto& t : readers) {
+        t.join();
+    }
+    verifyFound(h, keys);
+}
+
 // Test fixture for HashTable statistics tests.
 class HashTableStatsTest
         : public HashTableTest,
@@ -636,6 +859,59 @@ TEST_F(HashTableTest, NRUMinimumExistingItem) {
     EXPECT_EQ(MIN_NRU_VALUE, v->getNRUValue());
 }
 
+// Check that referenced items are sampled into the hot key sketch once their
+// NRU reaches the minimum, and that unreferenced ones aren't.
+TEST_F(HashTableTest, HotKeySketch) {
+    HashTable ht(global_stats,
+                 makeFactory(),
+                 5,
+                 1,
+                 HashTable::IndexType::Chained,
+                 /*hotKeySketchSize*/ 4);
+    StoredDocKey hot = makeStoredDocKey("hot");
+    StoredDocKey cold = makeStoredDocKey("cold");
+    store(ht, hot);
+    store(ht, cold);
+
+    std::vector<StoredDocKey> keys;
+    ht.getHotKeys(keys);
+    EXPECT_TRUE(keys.empty());
+
+    for (uint32_t ii = 0; ii < 4 * HotKeySketch::SampleInterval; ++ii) {
+        ht.find(hot, TrackReference::Yes, WantsDeleted::No);
+        ht.find(cold, TrackReference::No, WantsDeleted::No);
+    }
+    ht.getHotKeys(keys);
+    EXPECT_EQ(std::vector<StoredDocKey>{hot}, keys);
+}
+
+// Check the hot key sketch never holds more keys than its size.
+TEST_F(HashTableTest, HotKeySketchBounded) {
+    const size_t sketchSize = 8;
+    HashTable ht(global_stats,
+                 makeFactory(),
+                 5,
+                 1,
+                 HashTable::IndexType::Chained,
+                 sketchSize);
+    auto keys = generateKeys(100);
+    storeMany(ht, keys);
+
+    for (uint32_t ii = 0; ii < 2 * HotKeySketch::SampleInterval; ++ii) {
+        for (const auto& key : keys) {
+            ht.find(key, TrackReference::Yes, WantsDeleted::No);
+        }
+    }
+
+    std::vector<StoredDocKey> hotKeys;
+    ht.getHotKeys(hotKeys);
+    EXPECT_FALSE(hotKeys.empty());
+    EXPECT_LE(hotKeys.size(), sketchSize);
+    for (const auto& key : hotKeys) {
+        EXPECT_NE(keys.end(), std::find(keys.begin(), keys.end(), key));
+    }
+}
+
 /* Test release from HT (but not deletion) of an (HT) element */
 TEST_F(HashTableTest, ReleaseItem) {
     /* Setup with 2 hash buckets and 1 lock */
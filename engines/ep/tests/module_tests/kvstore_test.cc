@@ -286,6 +286,45 @@ TEST_F(CouchKVStoreTest, StatsTest) {
     EXPECT_GE(io_total_write_bytes, io_write_bytes);
 }
 
+// Verify that getMulti() with bg_fetch_readahead enabled returns the same
+// documents, and only reads ahead the bodies of non meta-only fetches.
+TEST_F(CouchKVStoreTest, GetMultiReadahead) {
+    KVStoreConfig config(
+            1024, 4, data_dir, "couchdb", 0, false /*persistnamespace*/);
+    config.setBgFetchReadahead(true);
+    auto kvstore = setup_kv_store(config);
+
+    kvstore->begin({});
+    WriteCallback wc;
+    for (int i = 0; i < 3; i++) {
+        std::string key("key" + std::to_string(i));
+        std::string value("value" + std::to_string(i));
+        Item item(makeStoredDocKey(key), 0, 0, value.c_str(), value.size());
+        kvstore->set(item, wc);
+    }
+    ASSERT_TRUE(kvstore->commit(nullptr /*no collections manifest*/));
+
+    vb_bgfetch_queue_t itms;
+    for (int i = 0; i < 3; i++) {
+        vb_bgfetch_item_ctx_t ctx;
+        ctx.isMetaOnly = (i == 2) ? GetMetaOnly::Yes : GetMetaOnly::No;
+        itms[makeStoredDocKey("key" + std::to_string(i))] = std::move(ctx);
+    }
+    kvstore->getMulti(0, itms);
+
+    for (int i = 0; i < 2; i++) {
+        auto& gv = itms[makeStoredDocKey("key" + std::to_string(i))].value;
+        ASSERT_EQ(ENGINE_SUCCESS, gv.getStatus());
+        EXPECT_EQ("value" + std::to_string(i), gv.item->getValue()->to_s());
+    }
+    EXPECT_EQ(ENGINE_SUCCESS,
+              itms[makeStoredDocKey("key2")].value.getStatus());
+
+    std::map<std::string, std::string> stats;
+    kvstore->addStats(add_stat_callback, &stats);
+    EXPECT_EQ("2", stats["rw_0:io_bg_fetch_readahead"]);
+}
+
 // Verify the compaction stats returned from operations are accurate.
 TEST_F(CouchKVStoreTest, CompactStatsTest) {
     KVStoreConfig config(
@@ -1104,6 +1143,44 @@ TEST_F(CouchKVStoreErrorInjectionTest, CompactFailedStatsTest) {
 }
 
 
+/**
+ * Verify that during a group commit the final (header) sync of each commit is
+ * deferred until endGroupCommit(), and that a failed deferred sync is
+ * reported and retried by the next endGroupCommit().
+ */
+TEST_F(CouchKVStoreErrorInjectionTest, groupCommit_deferred_sync) {
+    generate_items(1);
+    CustomCallback<TransactionContext, mutation_result> set_callback;
+
+    kvstore->beginGroupCommit();
+    {
+        /* Only the sync ordering the documents before the new header should
+         * be performed by commit() */
+        EXPECT_CALL(ops, sync(_, _)).Times(1);
+
+        kvstore->begin({});
+        kvstore->set(items.front(), set_callback);
+        EXPECT_TRUE(kvstore->commit(nullptr /*no collections manifest*/));
+        ::testing::Mock::VerifyAndClearExpectations(&ops);
+    }
+    {
+        /* Establish Logger expectation */
+        EXPECT_CALL(logger, mlog(_, _)).Times(AnyNumber());
+        EXPECT_CALL(logger, mlog(Ge(EXTENSION_LOG_WARNING),
+                                 VCE(COUCHSTORE_ERROR_WRITE))
+                   ).Times(1).RetiresOnSaturation();
+
+        /* Establish FileOps expectation */
+        EXPECT_CALL(ops, sync(_, _))
+                .WillOnce(Return(COUCHSTORE_ERROR_WRITE))
+                .WillOnce(DoDefault());
+
+        EXPECT_FALSE(kvstore->endGroupCommit());
+        EXPECT_TRUE(kvstore->endGroupCommit());
+    }
+}
+
+
 class MockCouchRequest : public CouchRequest {
 public:
     class MetaData {
@@ -1973,6 +2050,36 @@ TEST_P(KVStoreParamTest, TestDataStoredInTheRightVBucket) {
     checkGetValue(gv, ENGINE_KEY_ENOENT);
 }
 
+// Test that getMulti fetches all of the requested documents (and reports the
+// missing ones).
+TEST_P(KVStoreParamTest, GetMulti) {
+    kvstore->begin({});
+    WriteCallback wc;
+    for (int i = 0; i < 3; i++) {
+        Item item(makeStoredDocKey("key" + std::to_string(i)),
+                  0,
+                  0,
+                  "value",
+                  5);
+        kvstore->set(item, wc);
+    }
+    ASSERT_TRUE(kvstore->commit(nullptr /*no collections manifest*/));
+
+    vb_bgfetch_queue_t itms;
+    for (int i = 0; i < 4; i++) {
+        vb_bgfetch_item_ctx_t ctx;
+        ctx.isMetaOnly = GetMetaOnly::No;
+        itms[makeStoredDocKey("key" + std::to_string(i))] = std::move(ctx);
+    }
+    kvstore->getMulti(0, itms);
+
+    for (int i = 0; i < 3; i++) {
+        checkGetValue(itms[makeStoredDocKey("key" + std::to_string(i))].value);
+    }
+    EXPECT_EQ(ENGINE_KEY_ENOENT,
+              itms[makeStoredDocKey("key3")].value.getStatus());
+}
+
 // Verify thread-safeness for 'delVBucket' concurrent operations.
 // Expect ThreadSanitizer to pick this.
 TEST_P(KVStoreParamTest, DelVBucketConcurrentOperationsTest) {
@@ -2090,6 +2197,99 @@ TEST_F(RocksDBKVStoreTest, StatsTest) {
     EXPECT_TRUE(kvstore->getStat("local_kTotalSstFilesSize", value));
 }
 
+// Verify that compactDB drops the expired items, and reports them to the
+// expiry callback.
+TEST_F(RocksDBKVStoreTest, CompactDBExpiresItems) {
+    kvstore->begin({});
+    WriteCallback wc;
+    Item expired(makeStoredDocKey("expired"), 0, 1 /*exptime*/, "value", 5);
+    kvstore->set(expired, wc);
+    Item live(makeStoredDocKey("live"), 0, 0, "value", 5);
+    kvstore->set(live, wc);
+    ASSERT_TRUE(kvstore->commit(nullptr /*no collections manifest*/));
+
+    std::vector<std::string> expiredKeys;
+    class RecordExpiry : public Callback<Item&, time_t&> {
+    public:
+        RecordExpiry(std::vector<std::string>& keys) : keys(keys) {
+        }
+        void callback(Item& it, time_t&) override {
+            keys.emplace_back(it.getKey().c_str());
+        }
+        std::vector<std::string>& keys;
+    };
+
+    compaction_ctx cctx;
+    cctx.purge_before_seq = 0;
+    cctx.purge_before_ts = 0;
+    cctx.curr_time = 0;
+    cctx.drop_deletes = 0;
+    cctx.db_file_id = 0;
+    cctx.expiryCallback = std::make_shared<RecordExpiry>(expiredKeys);
+    EXPECT_TRUE(kvstore->compactDB(&cctx));
+
+    EXPECT_EQ(std::vector<std::string>{"expired"}, expiredKeys);
+    GetValue gv = kvstore->get(makeStoredDocKey("expired"), 0);
+    checkGetValue(gv, ENGINE_KEY_ENOENT);
+    gv = kvstore->get(makeStoredDocKey("live"), 0);
+    checkGetValue(gv);
+}
+
+// Verify that compacting a vBucket other than 0 (as identified by the
+// compact_db request) only expires that vBucket's items.
+TEST_F(RocksDBKVStoreTest, CompactDBNonZeroVBucket) {
+    std::vector<uint16_t> vbids = {0, 1};
+    kvstore.reset();
+    kvstore = setup_kv_store(*kvstoreConfig, vbids);
+
+    WriteCallback wc;
+    for (auto vbid : vbids) {
+        kvstore->begin({});
+        Item expired(makeStoredDocKey("expired-" + std::to_string(vbid)),
+                     0 /*flags*/,
+                     1 /*exptime*/,
+                     "value",
+                     5,
+                     PROTOCOL_BINARY_RAW_BYTES,
+                     0 /*cas*/,
+                     -1 /*bySeqno*/,
+                     vbid);
+        kvstore->set(expired, wc);
+        ASSERT_TRUE(kvstore->commit(nullptr /*no collections manifest*/));
+    }
+
+    std::vector<std::string> expiredKeys;
+    class RecordExpiry : public Callback<Item&, time_t&> {
+    public:
+        RecordExpiry(std::vector<std::string>& keys) : keys(keys) {
+        }
+        void callback(Item& it, time_t&) override {
+            keys.emplace_back(it.getKey().c_str());
+        }
+        std::vector<std::string>& keys;
+    };
+
+    protocol_binary_request_compact_db req;
+    memset(&req, 0, sizeof(req));
+    req.message.header.request.vbucket = htons(1);
+
+    compaction_ctx cctx;
+    cctx.purge_before_seq = 0;
+    cctx.purge_before_ts = 0;
+    cctx.curr_time = 0;
+    cctx.drop_deletes = 0;
+    cctx.db_file_id = kvstore->getDBFileId(req);
+    cctx.expiryCallback = std::make_shared<RecordExpiry>(expiredKeys);
+    EXPECT_EQ(1, cctx.db_file_id);
+    EXPECT_TRUE(kvstore->compactDB(&cctx));
+
+    EXPECT_EQ(std::vector<std::string>{"expired-1"}, expiredKeys);
+    GetValue gv = kvstore->get(makeStoredDocKey("expired-1"), 1);
+    checkGetValue(gv, ENGINE_KEY_ENOENT);
+    gv = kvstore->get(makeStoredDocKey("expired-0"), 0);
+    checkGetValue(gv);
+}
+
 // Verify that a wrong value of 'rocksdb_statistics_option' is caught
 TEST_F(RocksDBKVStoreTest, StatisticsOptionWrongValueTest) {
     Configuration config;
@@ -32,6 +32,7 @@ extern "C" {
 #include "crc32.h"
 }
 
+#include "indexed_access_log.h"
 #include "mutation_log.h"
 #include "tests/module_tests/test_helpers.h"
 
@@ -646,3 +647,96 @@ TEST_F(MutationLogTest, upgrade) {
         }
     }
 }
+
+TEST_F(MutationLogTest, IndexedAccessLog) {
+    {
+        IndexedAccessLog::Writer writer(tmp_log_filename);
+        ASSERT_TRUE(writer.open());
+        std::vector<StoredDocKey> keys = {makeStoredDocKey("key3"),
+                                          makeStoredDocKey("key1"),
+                                          makeStoredDocKey("key2")};
+        writer.addVBucket(2, keys);
+        keys = {makeStoredDocKey("key4")};
+        writer.addVBucket(3, keys);
+        EXPECT_EQ(4, writer.getNumKeys());
+        EXPECT_TRUE(writer.commit());
+    }
+
+    EXPECT_TRUE(IndexedAccessLog::isIndexed(tmp_log_filename));
+
+    IndexedAccessLog::Reader reader(tmp_log_filename);
+    EXPECT_EQ(4, reader.getNumKeys());
+    EXPECT_EQ(nullptr, reader.getSection(1));
+
+    // Keys are returned in (sorted) on-disk order.
+    auto* section = reader.getSection(2);
+    ASSERT_NE(nullptr, section);
+    EXPECT_EQ(3, section->numKeys);
+    std::vector<StoredDocKey> keys;
+    for (auto it = reader.begin(*section); it != reader.end(*section); ++it) {
+        keys.emplace_back(*it);
+    }
+    EXPECT_EQ((std::vector<StoredDocKey>{makeStoredDocKey("key1"),
+                                         makeStoredDocKey("key2"),
+                                         makeStoredDocKey("key3")}),
+              keys);
+
+    section = reader.getSection(3);
+    ASSERT_NE(nullptr, section);
+    auto it = reader.begin(*section);
+    EXPECT_EQ(makeStoredDocKey("key4"), StoredDocKey(*it));
+    ++it;
+    EXPECT_FALSE(it != reader.end(*section));
+}
+
+TEST_F(MutationLogTest, IndexedAccessLogNotMutationLog) {
+    {
+        MutationLog ml(tmp_log_filename.c_str());
+        ml.open();
+        ml.newItem(2, makeStoredDocKey("key1"));
+        ml.commit1();
+        ml.commit2();
+    }
+    EXPECT_FALSE(IndexedAccessLog::isIndexed(tmp_log_filename));
+    EXPECT_THROW(IndexedAccessLog::Reader reader(tmp_log_filename),
+                 MutationLog::ReadException);
+
+    {
+        IndexedAccessLog::Writer writer(tmp_log_filename);
+        ASSERT_TRUE(writer.open());
+        std::vector<StoredDocKey> keys = {makeStoredDocKey("key1")};
+        writer.addVBucket(2, keys);
+        ASSERT_TRUE(writer.commit());
+    }
+
+    // Older (MutationLog) readers must reject the new format.
+    MutationLog ml(tmp_log_filename.c_str());
+    EXPECT_THROW(ml.open(true), MutationLog::ReadException);
+}
+
+TEST_F(MutationLogTest, IndexedAccessLogBadCRC) {
+    {
+        IndexedAccessLog::Writer writer(tmp_log_filename);
+        ASSERT_TRUE(writer.open());
+        std::vector<StoredDocKey> keys = {makeStoredDocKey("key1"),
+                                          makeStoredDocKey("key2")};
+        writer.addVBucket(2, keys);
+        ASSERT_TRUE(writer.commit());
+    }
+
+    // Break the first key of the section
+    int file = open(tmp_log_filename.c_str(),
+                    O_RDWR,
+                    FilePerms::Read | FilePerms::Write);
+    const off_t pos = MIN_LOG_HEADER_SIZE + 2;
+    EXPECT_EQ(pos, lseek(file, pos, SEEK_SET));
+    uint8_t b;
+    EXPECT_EQ(1, read(file, &b, sizeof(b)));
+    EXPECT_EQ(pos, lseek(file, pos, SEEK_SET));
+    b = ~b;
+    EXPECT_EQ(1, write(file, &b, sizeof(b)));
+    close(file);
+
+    IndexedAccessLog::Reader reader(tmp_log_filename);
+    EXPECT_THROW(reader.getSection(2), MutationLog::CRCReadException);
+}
@@ -255,3 +255,85 @@ TEST(OrderedStoredValueTest, expectedSize) {
             << "Unexpected change in OrderedStoredValue storage size for item: "
             << item;
 }
+
+/**
+ * Test fixture for StoredValues created by the CompactStoredValueFactory
+ * (values of up to 16 bytes stored inline).
+ */
+class CompactStoredValueTest : public ::testing::Test {
+public:
+    CompactStoredValueTest() : factory(stats, 16) {
+    }
+
+protected:
+    EPStats stats;
+    CompactStoredValueFactory factory;
+};
+
+/// Check a short value is stored inline, directly after the key.
+TEST_F(CompactStoredValueTest, shortValueIsInline) {
+    auto item = make_item(0, makeStoredDocKey("key"), "value");
+    auto sv = factory(item, {});
+
+    EXPECT_TRUE(sv->isValueInline());
+    EXPECT_TRUE(sv->hasValue());
+    EXPECT_FALSE(sv->getValue());
+    EXPECT_EQ(5, sv->valuelen());
+    EXPECT_EQ("value", std::string(sv->getValueData(), sv->valuelen()));
+
+    // Inline space is part of the object, but accounted as value.
+    EXPECT_EQ(StoredValue::getRequiredStorage(item) + 5, sv->getObjectSize());
+    EXPECT_EQ(StoredValue::getRequiredStorage(item), sv->metaDataSize());
+    EXPECT_EQ(sv->getObjectSize(), sv->size());
+
+    // Items created from the StoredValue get their own copy of the value.
+    auto copy = sv->toItem(false, 0);
+    ASSERT_TRUE(copy->getValue());
+    EXPECT_EQ("value", std::string(copy->getData(), copy->getNBytes()));
+}
+
+/// Check a value larger than the inline limit is stored in a Blob.
+TEST_F(CompactStoredValueTest, longValueIsBlob) {
+    auto item = make_item(0, makeStoredDocKey("key"), std::string(17, 'x'));
+    auto sv = factory(item, {});
+
+    EXPECT_FALSE(sv->isValueInline());
+    EXPECT_TRUE(sv->getValue());
+    EXPECT_EQ(17, sv->valuelen());
+    EXPECT_EQ(StoredValue::getRequiredStorage(item), sv->getObjectSize());
+}
+
+/// Check updates fall back to a Blob once the value outgrows the inline
+/// capacity, and return inline when it fits again.
+TEST_F(CompactStoredValueTest, updateInlineValue) {
+    auto sv = factory(make_item(0, makeStoredDocKey("key"), "value"), {});
+    const auto objectSize = sv->getObjectSize();
+
+    sv->setValue(make_item(0, makeStoredDocKey("key"), "longer value"));
+    EXPECT_FALSE(sv->isValueInline());
+    EXPECT_EQ(12, sv->valuelen());
+    // The now unused inline space is accounted as metadata.
+    EXPECT_EQ(objectSize, sv->metaDataSize());
+    EXPECT_EQ(objectSize + 12, sv->size());
+
+    sv->setValue(make_item(0, makeStoredDocKey("key"), "val"));
+    EXPECT_TRUE(sv->isValueInline());
+    EXPECT_EQ("val", std::string(sv->getValueData(), sv->valuelen()));
+    EXPECT_EQ(objectSize, sv->getObjectSize());
+    EXPECT_EQ(objectSize - 5, sv->metaDataSize());
+
+    // Deleting discards the inline value.
+    sv->del();
+    EXPECT_FALSE(sv->hasValue());
+    EXPECT_EQ(0, sv->valuelen());
+    EXPECT_EQ(objectSize, sv->metaDataSize());
+}
+
+/// Inline values aren't eligible for value eviction - it wouldn't free
+/// any memory.
+TEST_F(CompactStoredValueTest, inlineValueNotEvictable) {
+    auto sv = factory(make_item(0, makeStoredDocKey("key"), "value"), {});
+    sv->markClean();
+    EXPECT_FALSE(sv->eligibleForEviction(VALUE_ONLY));
+    EXPECT_TRUE(sv->eligibleForEviction(FULL_EVICTION));
+}
@@ -259,7 +259,7 @@ TEST_P(EPVBucketTest, GetBGFetchItemsPerformance) {
 // Check the existence of bloom filter after performing a
 // swap of existing filter with a temporary filter.
 TEST_P(VBucketTest, SwapFilter) {
-    this->vbucket->createFilter(1, 1.0);
+    this->vbucket->createFilter(1, 1.0, false /*blocked*/);
     ASSERT_FALSE(this->vbucket->isTempFilterAvailable());
     ASSERT_NE("DOESN'T EXIST", this->vbucket->getFilterStatusString());
     this->vbucket->swapFilter();
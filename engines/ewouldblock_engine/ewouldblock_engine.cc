@@ -425,6 +425,27 @@ public:
         }
     }
 
+    static std::vector<cb::EngineErrorItemPair> get_multi(
+            gsl::not_null<ENGINE_HANDLE*> handle,
+            gsl::not_null<const void*> cookie,
+            const std::vector<cb::GetMultiKey>& keys,
+            DocStateFilter documentStateFilter) {
+        EWB_Engine* ewb = to_engine(handle);
+        ENGINE_ERROR_CODE err = ENGINE_SUCCESS;
+        if (ewb->should_inject_error(Cmd::GET, cookie, err)) {
+            // Fail (or block) the entire batch
+            std::vector<cb::EngineErrorItemPair> ret;
+            for (size_t ii = 0; ii < keys.size(); ++ii) {
+                ret.emplace_back(
+                        cb::makeEngineErrorItemPair(cb::engine_errc(err)));
+            }
+            return ret;
+        } else {
+            return ewb->real_engine->get_multi(
+                    ewb->real_handle, cookie, keys, documentStateFilter);
+        }
+    }
+
     static cb::EngineErrorItemPair get_if(
             gsl::not_null<ENGINE_HANDLE*> handle,
             gsl::not_null<const void*> cookie,
@@ -1309,6 +1330,7 @@ EWB_Engine::EWB_Engine(GET_SERVER_API gsa_)
     ENGINE_HANDLE_V1::remove = remove;
     ENGINE_HANDLE_V1::release = release;
     ENGINE_HANDLE_V1::get = get;
+    ENGINE_HANDLE_V1::get_multi = get_multi;
     ENGINE_HANDLE_V1::get_if = get_if;
     ENGINE_HANDLE_V1::get_locked = get_locked;
     ENGINE_HANDLE_V1::get_meta = get_meta;
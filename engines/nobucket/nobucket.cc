@@ -43,6 +43,7 @@ public:
         ENGINE_HANDLE_V1::remove = item_delete;
         ENGINE_HANDLE_V1::release = item_release;
         ENGINE_HANDLE_V1::get = get;
+        ENGINE_HANDLE_V1::get_multi = get_multi;
         ENGINE_HANDLE_V1::get_meta = get_meta;
         ENGINE_HANDLE_V1::get_if = get_if;
         ENGINE_HANDLE_V1::get_and_touch = get_and_touch;
@@ -150,6 +151,19 @@ private:
         return cb::makeEngineErrorItemPair(cb::engine_errc::no_bucket);
     }
 
+    static std::vector<cb::EngineErrorItemPair> get_multi(
+            gsl::not_null<ENGINE_HANDLE*>,
+            gsl::not_null<const void*>,
+            const std::vector<cb::GetMultiKey>& keys,
+            DocStateFilter) {
+        std::vector<cb::EngineErrorItemPair> ret;
+        for (size_t ii = 0; ii < keys.size(); ++ii) {
+            ret.emplace_back(
+                    cb::makeEngineErrorItemPair(cb::engine_errc::no_bucket));
+        }
+        return ret;
+    }
+
     static cb::EngineErrorMetadataPair get_meta(
             gsl::not_null<ENGINE_HANDLE*> handle,
             gsl::not_null<const void*> cookie,
@@ -59,6 +59,11 @@ enum class Feature : uint16_t {
      * Tell the server to enable tracing of function calls
      */
     Tracing = 0x0f,
+    /**
+     * Tell the server that the client may use the GetMulti command to
+     * fetch a batch of keys in a single request.
+     */
+    GetMulti = 0x10,
 };
 
 } // namespace mcbp
@@ -244,6 +244,11 @@ enum class ClientOpcode : uint8_t {
      */
     CollectionsGetManifest = 0xba,
 
+    /**
+     * Command to fetch a batch of keys in a single request
+     */
+    GetMulti = 0xbb,
+
     /**
      * Commands for GO-XDCR
      */
@@ -9,6 +9,7 @@
 #include <memory>
 #include <sys/types.h>
 #include <utility>
+#include <vector>
 
 #include <boost/optional/optional.hpp>
 #include <gsl/gsl>
@@ -172,6 +173,14 @@ struct EngineErrorCasPair {
     engine_errc status;
     uint64_t cas;
 };
+
+/**
+ * A key to look up with get_multi, and the vbucket it belongs to.
+ */
+struct GetMultiKey {
+    DocKey key;
+    uint16_t vbucket;
+};
 }
 
 /**
@@ -335,6 +344,32 @@ typedef struct engine_interface_v1 {
                                    uint16_t vbucket,
                                    DocStateFilter documentStateFilter);
 
+    /**
+     * Retrieve a batch of items.
+     *
+     * The result for each key is the same as get would have returned for
+     * it, except that a key which can't be returned without blocking (for
+     * instance as it has to be read from disk) gets would_block. The
+     * engine notifies the cookie once (with ENGINE_SUCCESS), when all of
+     * the keys which blocked may be retried, and the frontend then calls
+     * get_multi again with just those keys; any errors are reported per
+     * key by that call.
+     *
+     * @param handle the engine handle
+     * @param cookie The cookie provided by the frontend
+     * @param keys the keys (and their vbuckets) to look up
+     * @param documentStateFilter The documents to return must be in any of
+     *                            these states (see get)
+     *
+     * @return one pair of error code and (optionally) item per key, in the
+     *         same order as keys
+     */
+    std::vector<cb::EngineErrorItemPair> (*get_multi)(
+            gsl::not_null<ENGINE_HANDLE*> handle,
+            gsl::not_null<const void*> cookie,
+            const std::vector<cb::GetMultiKey>& keys,
+            DocStateFilter documentStateFilter);
+
     /**
      * Retrieve metadata for a given item.
      *
@@ -395,6 +395,8 @@ const uint8_t PROTOCOL_BINARY_CMD_COLLECTIONS_SET_MANIFEST =
         uint8_t(cb::mcbp::ClientOpcode::CollectionsSetManifest);
 const uint8_t PROTOCOL_BINARY_CMD_COLLECTIONS_GET_MANIFEST =
         uint8_t(cb::mcbp::ClientOpcode::CollectionsGetManifest);
+const uint8_t PROTOCOL_BINARY_CMD_GET_MULTI =
+        uint8_t(cb::mcbp::ClientOpcode::GetMulti);
 const uint8_t PROTOCOL_BINARY_CMD_SET_DRIFT_COUNTER_STATE =
         uint8_t(cb::mcbp::ClientOpcode::SetDriftCounterState);
 const uint8_t PROTOCOL_BINARY_CMD_GET_ADJUSTED_TIME =
@@ -1789,11 +1791,16 @@ typedef protocol_binary_response_no_extras protocol_binary_response_ssl_refresh;
  * special name <code>/all/</code>.
  *
  * The returned payload is a json document of the following format:
- *    { "us" : [ x, x, x, x, ... ],
- *      "ms" : [ y, y, y, ...],
- *      "500ms" : [ z, z, z, ...],
- *      "wayout" : nnn
+ *    { "total" : nnn,
+ *      "percentiles" : { "50" : x, "90" : x, "99" : x, "99.9" : x,
+ *                        "99.99" : x, "100" : x },
+ *      "buckets" : [ [ low, high, count ], ... ]
  *    }
+ *
+ * All times are in microseconds. Each (non-empty) bucket is
+ * [lowest, highest, count] (highest is 0 for the last, unbounded bucket),
+ * and each percentile is the upper bound of the bucket containing it.
+ * "percentiles" is empty if there are no samples.
  */
 typedef union {
     struct {
@@ -259,6 +259,60 @@ static cb::EngineErrorItemPair mock_get(gsl::not_null<ENGINE_HANDLE*> handle,
             handle, construct, engine_fn);
 }
 
+static std::vector<cb::EngineErrorItemPair> mock_get_multi(
+        gsl::not_null<ENGINE_HANDLE*> handle,
+        gsl::not_null<const void*> cookie,
+        const std::vector<cb::GetMultiKey>& keys,
+        DocStateFilter documentStateFilter) {
+    auto* engine = get_engine_v1_from_handle(handle);
+    auto* construct =
+            reinterpret_cast<mock_connstruct*>(const_cast<void*>(cookie.get()));
+    construct->nblocks = 0;
+    cb_mutex_enter(&construct->mutex);
+
+    auto ret = engine->get_multi(get_engine_from_handle(handle),
+                                 cookie,
+                                 keys,
+                                 documentStateFilter);
+
+    // Retry the keys which blocked until all of them completed
+    std::vector<size_t> blocked;
+    std::vector<cb::GetMultiKey> retry;
+    do {
+        blocked.clear();
+        retry.clear();
+        for (size_t ii = 0; ii < ret.size(); ++ii) {
+            if (ret[ii].first == cb::engine_errc::would_block) {
+                blocked.push_back(ii);
+                retry.push_back(keys[ii]);
+            }
+        }
+        if (blocked.empty() || !construct->handle_ewouldblock) {
+            break;
+        }
+
+        ++construct->nblocks;
+        cb_cond_wait(&construct->cond, &construct->mutex);
+        if (construct->status == ENGINE_SUCCESS) {
+            auto next = engine->get_multi(get_engine_from_handle(handle),
+                                          cookie,
+                                          retry,
+                                          documentStateFilter);
+            for (size_t ii = 0; ii < blocked.size(); ++ii) {
+                ret[blocked[ii]] = std::move(next[ii]);
+            }
+        } else {
+            for (auto index : blocked) {
+                ret[index] = cb::makeEngineErrorItemPair(
+                        cb::engine_errc(construct->status));
+            }
+        }
+    } while (true);
+    cb_mutex_exit(&construct->mutex);
+
+    return ret;
+}
+
 static cb::EngineErrorItemPair mock_get_if(
         gsl::not_null<ENGINE_HANDLE*> handle,
         gsl::not_null<const void*> cookie,
@@ -874,6 +928,7 @@ static ENGINE_HANDLE_V1* create_bucket(bool initialize, const char* cfg) {
         mock_engine->me.remove = mock_remove;
         mock_engine->me.release = mock_release;
         mock_engine->me.get = mock_get;
+        mock_engine->me.get_multi = mock_get_multi;
         mock_engine->me.get_if = mock_get_if;
         mock_engine->me.get_and_touch = mock_get_and_touch;
         mock_engine->me.get_locked = mock_get_locked;
@@ -28,6 +28,7 @@
 #include <cstdlib>
 #include <iostream>
 #include <stdexcept>
+#include <vector>
 
 static uint32_t getValue(cJSON *root, const char *key) {
     cJSON *obj = cJSON_GetObjectItem(root, key);
@@ -64,13 +65,17 @@ struct Bin {
     uint64_t cumulative_count;
 };
 
+// A row of the printed histogram; the bin with its range of values.
+struct Row {
+    const char* timeunit;
+    uint32_t low;
+    uint32_t high;
+    Bin bin;
+};
+
 class Timings {
 public:
-    Timings(cJSON* json) : max(0), ns(Bin()), oldwayout(false) {
-        us.fill(Bin());
-        ms.fill(Bin());
-        halfsec.fill(Bin());
-        wayout.fill(Bin());
+    Timings(cJSON* json) : max(0), total(0) {
         initialize(json);
     }
 
@@ -83,43 +88,36 @@ public:
         std::cout << "The following data is collected for \""
                   << opcode << "\"" << std::endl;
 
-        int ii;
-
-        dump("ns", 0, 999, ns);
-        for (ii = 0; ii < 100; ++ii) {
-            dump("us", ii * 10, ((ii + 1) * 10 - 1), us[ii]);
+        for (const auto& row : rows) {
+            dump(row.timeunit, row.low, row.high, row.bin);
         }
-
-        for (ii = 1; ii < 50; ++ii) {
-            dump("ms", ii, ii, ms[ii]);
-        }
-
-        dump("ms", 50, 499, halfsec[0]);
-        for (ii = 1; ii < 10; ++ii) {
-            dump("ms", ii * 500, ((ii + 1) * 500) - 1, halfsec[ii]);
+        if (!percentiles.empty()) {
+            std::cout << "Percentiles: " << getPercentiles() << std::endl;
         }
+        std::cout << "Total: " << total << " operations" << std::endl;
+    }
 
-        if (oldwayout) {
-            dump("ms", (10 * 500), 0, wayout[0]);
-        } else {
-            dump("s ", 5, 9, wayout[0]);
-            dump("s ", 10, 19, wayout[1]);
-            dump("s ", 20, 39, wayout[2]);
-            dump("s ", 40, 79, wayout[3]);
-            dump("s ", 80, 0, wayout[4]);
+    /**
+     * Get the percentiles reported by the server as a string like
+     * "50th: 12us, 90th: 40us, ...", or an empty string if the server
+     * didn't report any (it uses the older fixed bucket histogram).
+     */
+    std::string getPercentiles() const {
+        std::string ret;
+        for (const auto& percentile : percentiles) {
+            if (!ret.empty()) {
+                ret += ", ";
+            }
+            ret += percentile.first + "th: " +
+                   std::to_string(percentile.second) + "us";
         }
-        std::cout << "Total: " << total << " operations" << std::endl;
+        return ret;
     }
 
 private:
-
-    // Helper function for initialize
-    static void update_max_and_total(uint32_t& max, uint64_t& total, Bin& bin) {
-        total += bin.count;
-        bin.cumulative_count = total;
-        if (bin.count > max) {
-            max = bin.count;
-        }
+    void addRow(const char* timeunit, uint32_t low, uint32_t high,
+                uint32_t count) {
+        rows.push_back({timeunit, low, high, {count, 0}});
     }
 
     void initialize(cJSON *root) {
@@ -130,12 +128,55 @@ private:
             throw std::runtime_error(message);
         }
 
-        ns.count = getValue(root, "ns");
+        if (cJSON_GetObjectItem(root, "buckets") != nullptr) {
+            initializeLogLinear(root);
+        } else {
+            initializeFixed(root);
+        }
+
+        // Calculate total and cumulative counts, and find the highest value.
+        max = total = 0;
+        for (auto& row : rows) {
+            total += row.bin.count;
+            row.bin.cumulative_count = total;
+            if (row.bin.count > max) {
+                max = row.bin.count;
+            }
+        }
+    }
+
+    // The log-linear histogram; a list of the non-empty buckets as
+    // [low, high, count] (in usec) and a set of percentiles.
+    void initializeLogLinear(cJSON* root) {
+        auto arr = getArray(root, "buckets");
+        for (cJSON* i = arr->child; i != nullptr; i = i->next) {
+            if (i->type != cJSON_Array || cJSON_GetArraySize(i) != 3) {
+                throw std::runtime_error(
+                        "Internal error.. invalid \"buckets\" entry");
+            }
+            addRow("us",
+                   uint32_t(cJSON_GetArrayItem(i, 0)->valuedouble),
+                   uint32_t(cJSON_GetArrayItem(i, 1)->valuedouble),
+                   uint32_t(cJSON_GetArrayItem(i, 2)->valuedouble));
+        }
+
+        auto* obj = cJSON_GetObjectItem(root, "percentiles");
+        if (obj != nullptr) {
+            for (cJSON* i = obj->child; i != nullptr; i = i->next) {
+                percentiles.emplace_back(i->string, uint64_t(i->valuedouble));
+            }
+        }
+    }
+
+    // The fixed bucket histogram sent by older servers
+    void initializeFixed(cJSON* root) {
+        addRow("ns", 0, 999, getValue(root, "ns"));
+
         auto arr = getArray(root, "us");
         int ii = 0;
         cJSON* i = arr->child;
         while (i) {
-            us[ii].count = i->valueint;
+            addRow("us", ii * 10, ((ii + 1) * 10 - 1), i->valueint);
             ++ii;
             i = i->next;
             if (ii == 100 && i != NULL) {
@@ -148,7 +189,7 @@ private:
         ii = 1;
         i = arr->child;
         while (i) {
-            ms[ii].count = i->valueint;
+            addRow("ms", ii, ii, i->valueint);
             ++ii;
             i = i->next;
             if (ii == 50 && i != NULL) {
@@ -161,7 +202,11 @@ private:
         ii = 0;
         i = arr->child;
         while (i) {
-            halfsec[ii].count = i->valueint;
+            if (ii == 0) {
+                addRow("ms", 50, 499, i->valueint);
+            } else {
+                addRow("ms", ii * 500, ((ii + 1) * 500) - 1, i->valueint);
+            }
             ++ii;
             i = i->next;
             if (ii == 10 && i != NULL) {
@@ -171,31 +216,19 @@ private:
         }
 
         try {
-            wayout[0].count = getValue(root, "5s-9s");
-            wayout[1].count = getValue(root, "10s-19s");
-            wayout[2].count = getValue(root, "20s-39s");
-            wayout[3].count = getValue(root, "40s-79s");
-            wayout[4].count = getValue(root, "80s-inf");
+            // Look up all of them before adding any
+            const auto s5 = getValue(root, "5s-9s");
+            const auto s10 = getValue(root, "10s-19s");
+            const auto s20 = getValue(root, "20s-39s");
+            const auto s40 = getValue(root, "40s-79s");
+            const auto s80 = getValue(root, "80s-inf");
+            addRow("s ", 5, 9, s5);
+            addRow("s ", 10, 19, s10);
+            addRow("s ", 20, 39, s20);
+            addRow("s ", 40, 79, s40);
+            addRow("s ", 80, 0, s80);
         } catch (...) {
-            wayout[0].count = getValue(root, "wayout");
-            oldwayout = true;
-        }
-
-        // Calculate total and cumulative counts, and find the highest value.
-        max = total = 0;
-
-        update_max_and_total(max, total, ns);
-        for (auto &val : us) {
-            update_max_and_total(max, total, val);
-        }
-        for (auto &val : ms) {
-            update_max_and_total(max, total, val);
-        }
-        for (auto &val : halfsec) {
-            update_max_and_total(max, total, val);
-        }
-        for (auto &val : wayout) {
-            update_max_and_total(max, total, val);
+            addRow("ms", (10 * 500), 0, getValue(root, "wayout"));
         }
     }
 
@@ -234,21 +267,11 @@ private:
      */
     uint32_t max;
 
-    /* We collect timings for <=1 us */
-    Bin ns;
-
-    /* We collect timings per 10usec */
-    std::array<Bin, 100> us;
-
-    /* we collect timings from 0-49 ms (entry 0 is never used!) */
-    std::array<Bin, 50> ms;
+    /// The bins of the histogram, in the order to print them
+    std::vector<Row> rows;
 
-    std::array<Bin, 10> halfsec;
-
-    // [5-9], [10-19], [20-39], [40-79], [80-inf].
-    std::array<Bin, 5> wayout;
-
-    bool oldwayout;
+    /// The percentiles (and their value in usec) reported by the server
+    std::vector<std::pair<std::string, uint64_t>> percentiles;
 
     uint64_t total;
 };
@@ -317,8 +340,12 @@ static void request_cmd_timings(MemcachedConnection& connection,
             if (verbose) {
                 timings.dumpHistogram(cmd);
             } else {
-                std::cout << cmd << " " << timings.getTotal() << " operations"
-                          << std::endl;
+                std::cout << cmd << " " << timings.getTotal() << " operations";
+                const auto percentiles = timings.getPercentiles();
+                if (!percentiles.empty()) {
+                    std::cout << " (" << percentiles << ")";
+                }
+                std::cout << std::endl;
             }
         }
     } catch (const std::exception& e) {
@@ -369,8 +396,12 @@ static void request_stat_timings(MemcachedConnection& connection,
         if (verbose) {
             timings.dumpHistogram(key);
         } else {
-            std::cout << key << " " << timings.getTotal() << " operations"
-                      << std::endl;
+            std::cout << key << " " << timings.getTotal() << " operations";
+            const auto percentiles = timings.getPercentiles();
+            if (!percentiles.empty()) {
+                std::cout << " (" << percentiles << ")";
+            }
+            std::cout << std::endl;
         }
     } catch (const std::exception& e) {
         std::cerr << "Fatal error: " << e.what() << std::endl;
@@ -121,6 +121,7 @@ bool cb::mcbp::Request::isQuiet() const {
         case ClientOpcode::GetKeys:
         case ClientOpcode::CollectionsSetManifest:
         case ClientOpcode::CollectionsGetManifest:
+        case ClientOpcode::GetMulti:
         case ClientOpcode::SetDriftCounterState:
         case ClientOpcode::GetAdjustedTime:
         case ClientOpcode::SubdocGet:
@@ -508,6 +508,68 @@ TEST_F(SettingsTest, TopkeysEnabled) {
     }
 }
 
+TEST_F(SettingsTest, LoadAwareConnectionPlacement) {
+    nonBooleanValuesShouldFail("load_aware_connection_placement");
+
+    unique_cJSON_ptr obj(cJSON_CreateObject());
+    cJSON_AddTrueToObject(obj.get(), "load_aware_connection_placement");
+    try {
+        Settings settings(obj);
+        EXPECT_TRUE(settings.isLoadAwareConnectionPlacement());
+        EXPECT_TRUE(settings.has.load_aware_connection_placement);
+    } catch (std::exception& exception) {
+        FAIL() << exception.what();
+    }
+
+    obj.reset(cJSON_CreateObject());
+    cJSON_AddFalseToObject(obj.get(), "load_aware_connection_placement");
+    try {
+        Settings settings(obj);
+        EXPECT_FALSE(settings.isLoadAwareConnectionPlacement());
+        EXPECT_TRUE(settings.has.load_aware_connection_placement);
+    } catch (std::exception& exception) {
+        FAIL() << exception.what();
+    }
+}
+
+TEST_F(SettingsTest, PerWorkerListen) {
+    nonBooleanValuesShouldFail("per_worker_listen");
+
+    unique_cJSON_ptr obj(cJSON_CreateObject());
+    cJSON_AddTrueToObject(obj.get(), "per_worker_listen");
+    try {
+        Settings settings(obj);
+        EXPECT_TRUE(settings.isPerWorkerListen());
+        EXPECT_TRUE(settings.has.per_worker_listen);
+    } catch (std::exception& exception) {
+        FAIL() << exception.what();
+    }
+
+    obj.reset(cJSON_CreateObject());
+    cJSON_AddFalseToObject(obj.get(), "per_worker_listen");
+    try {
+        Settings settings(obj);
+        EXPECT_FALSE(settings.isPerWorkerListen());
+        EXPECT_TRUE(settings.has.per_worker_listen);
+    } catch (std::exception& exception) {
+        FAIL() << exception.what();
+    }
+}
+
+TEST_F(SettingsTest, SendZerocopyThreshold) {
+    nonNumericValuesShouldFail("send_zerocopy_threshold");
+
+    unique_cJSON_ptr obj(cJSON_CreateObject());
+    cJSON_AddNumberToObject(obj.get(), "send_zerocopy_threshold", 65536);
+    try {
+        Settings settings(obj);
+        EXPECT_EQ(65536, settings.getSendZerocopyThreshold());
+        EXPECT_TRUE(settings.has.send_zerocopy_threshold);
+    } catch (std::exception& exception) {
+        FAIL() << exception.what();
+    }
+}
+
 TEST_F(SettingsTest, DefaultReqsPerEvent) {
     nonNumericValuesShouldFail("default_reqs_per_event");
 
@@ -236,6 +236,95 @@ INSTANTIATE_TEST_CASE_P(GetOpcodes,
                                           GetOpcodes::GetQMeta),
                         ::testing::PrintToStringParamName());
 
+// Test GET_MULTI
+class GetMultiValidatorTest : public ValidatorTest {
+    void SetUp() override {
+        ValidatorTest::SetUp();
+        connection.setGetMultiSupported(true);
+        addKey(0, "key1");
+        addKey(1, "key2");
+    }
+
+protected:
+    /// Append an entry (vbucket, keylen, key) to the request body
+    void addKey(uint16_t vbucket, const std::string& key) {
+        auto* ptr = blob + sizeof(request.bytes) + bodylen;
+        vbucket = htons(vbucket);
+        uint16_t keylen = htons(uint16_t(key.size()));
+        memcpy(ptr, &vbucket, sizeof(vbucket));
+        memcpy(ptr + sizeof(vbucket), &keylen, sizeof(keylen));
+        memcpy(ptr + sizeof(vbucket) + sizeof(keylen), key.data(), key.size());
+        bodylen += sizeof(vbucket) + sizeof(keylen) + key.size();
+        request.message.header.request.bodylen = htonl(bodylen);
+    }
+
+    int validate() {
+        return ValidatorTest::validate(PROTOCOL_BINARY_CMD_GET_MULTI,
+                                       static_cast<void*>(&request));
+    }
+
+    uint32_t bodylen = 0;
+};
+
+TEST_F(GetMultiValidatorTest, CorrectMessage) {
+    EXPECT_EQ(PROTOCOL_BINARY_RESPONSE_SUCCESS, validate());
+}
+
+TEST_F(GetMultiValidatorTest, NotNegotiated) {
+    connection.setGetMultiSupported(false);
+    EXPECT_EQ(PROTOCOL_BINARY_RESPONSE_NOT_SUPPORTED, validate());
+}
+
+TEST_F(GetMultiValidatorTest, InvalidMagic) {
+    request.message.header.request.magic = 0;
+    EXPECT_EQ(PROTOCOL_BINARY_RESPONSE_EINVAL, validate());
+}
+
+TEST_F(GetMultiValidatorTest, InvalidExtlen) {
+    request.message.header.request.extlen = 2;
+    EXPECT_EQ(PROTOCOL_BINARY_RESPONSE_EINVAL, validate());
+}
+
+TEST_F(GetMultiValidatorTest, InvalidKey) {
+    request.message.header.request.keylen = htons(2);
+    EXPECT_EQ(PROTOCOL_BINARY_RESPONSE_EINVAL, validate());
+}
+
+TEST_F(GetMultiValidatorTest, InvalidVbucket) {
+    request.message.header.request.vbucket = htons(1);
+    EXPECT_EQ(PROTOCOL_BINARY_RESPONSE_EINVAL, validate());
+}
+
+TEST_F(GetMultiValidatorTest, InvalidCas) {
+    request.message.header.request.cas = 1;
+    EXPECT_EQ(PROTOCOL_BINARY_RESPONSE_EINVAL, validate());
+}
+
+TEST_F(GetMultiValidatorTest, InvalidDatatype) {
+    request.message.header.request.datatype = PROTOCOL_BINARY_DATATYPE_JSON;
+    EXPECT_EQ(PROTOCOL_BINARY_RESPONSE_EINVAL, validate());
+}
+
+TEST_F(GetMultiValidatorTest, NoKeys) {
+    request.message.header.request.bodylen = 0;
+    EXPECT_EQ(PROTOCOL_BINARY_RESPONSE_EINVAL, validate());
+}
+
+TEST_F(GetMultiValidatorTest, EmptyKey) {
+    addKey(0, "");
+    EXPECT_EQ(PROTOCOL_BINARY_RESPONSE_EINVAL, validate());
+}
+
+TEST_F(GetMultiValidatorTest, TruncatedEntry) {
+    // Lose the last byte of the last key
+    request.message.header.request.bodylen = htonl(bodylen - 1);
+    EXPECT_EQ(PROTOCOL_BINARY_RESPONSE_EINVAL, validate());
+
+    // Only part of the entry header
+    request.message.header.request.bodylen = htonl(bodylen + 2);
+    EXPECT_EQ(PROTOCOL_BINARY_RESPONSE_EINVAL, validate());
+}
+
 // Test ADD & ADDQ
 class AddValidatorTest : public ValidatorTest {
     void SetUp() override {
@@ -0,0 +1,271 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2018 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+/*
+ * Tests for sending item values with MSG_ZEROCOPY, and for holding on to
+ * the items until the kernel is done with them.
+ */
+
+#include "config.h"
+
+#include <daemon/connection_mcbp.h>
+#include <daemon/memcached.h>
+#include <daemon/settings.h>
+#include <daemon/zerocopy.h>
+#include <gtest/gtest.h>
+#include <memcached/engine.h>
+
+#ifndef WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <thread>
+
+namespace mcbp {
+namespace test {
+
+/**
+ * A connection (not bound to libevent) over a loopback TCP socket, exposing
+ * the MSG_ZEROCOPY internals.
+ */
+class ZerocopyConnection : public McbpConnection {
+public:
+    ZerocopyConnection() : McbpConnection() {
+    }
+
+    using McbpConnection::msglist;
+    using McbpConnection::reapZerocopyCompletions;
+    using McbpConnection::sendmsgZerocopy;
+    using McbpConnection::shouldSendZerocopy;
+    using McbpConnection::zerocopySends;
+};
+
+class ZerocopyTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        previousThreshold = settings.getSendZerocopyThreshold();
+        released = 0;
+        engine.release = [](gsl::not_null<ENGINE_HANDLE*>,
+                            gsl::not_null<item*>) { ++released; };
+        connection.setBucketEngine(&engine);
+
+        // Create a connected pair of loopback TCP sockets (MSG_ZEROCOPY
+        // isn't supported on AF_UNIX sockets)
+        const int listener = socket(AF_INET, SOCK_STREAM, 0);
+        ASSERT_NE(-1, listener);
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = sizeof(addr);
+        ASSERT_EQ(0, bind(listener, (struct sockaddr*)&addr, sizeof(addr)));
+        ASSERT_EQ(0, listen(listener, 1));
+        ASSERT_EQ(0, getsockname(listener, (struct sockaddr*)&addr, &len));
+
+        const int client = socket(AF_INET, SOCK_STREAM, 0);
+        ASSERT_NE(-1, client);
+        ASSERT_EQ(0, connect(client, (struct sockaddr*)&addr, sizeof(addr)));
+        peer = accept(listener, nullptr, nullptr);
+        ASSERT_NE(-1, peer);
+        close(listener);
+        connection.setSocketDescriptor(client);
+        // Accounted for as the dispatcher does for accepted connections
+        // (closing the socket decrements it)
+        stats.curr_conns++;
+    }
+
+    void TearDown() override {
+        connection.closeSocket();
+        connection.releaseReservedItems();
+        close(peer);
+        settings.setSendZerocopyThreshold(previousThreshold);
+    }
+
+    /**
+     * Queue the value (held by the given item) as a response and send it,
+     * as McbpConnection::transmit would.
+     */
+    void send(void* it, const std::vector<char>& value) {
+        connection.addMsgHdr(true);
+        ASSERT_TRUE(connection.reserveItem(it));
+        connection.addZerocopyIov(value.data(), value.size());
+        auto* m = &connection.msglist[0];
+        size_t sent = 0;
+        while (sent < value.size()) {
+            const int res = connection.sendmsgZerocopy(m);
+            ASSERT_GT(res, 0);
+            sent += res;
+            m->msg_iov[0].iov_base =
+                    static_cast<char*>(m->msg_iov[0].iov_base) + res;
+            m->msg_iov[0].iov_len -= res;
+        }
+        connection.releaseTransmittedItems();
+    }
+
+    /// Read n bytes from the other end of the connection.
+    std::vector<char> receive(size_t n) {
+        std::vector<char> data(n);
+        size_t offset = 0;
+        while (offset < n) {
+            const auto res = recv(peer, data.data() + offset, n - offset, 0);
+            if (res <= 0) {
+                break;
+            }
+            offset += res;
+        }
+        data.resize(offset);
+        return data;
+    }
+
+    static int released;
+    ENGINE_HANDLE_V1 engine{};
+    ZerocopyConnection connection;
+    int peer = -1;
+    size_t previousThreshold = 0;
+};
+
+int ZerocopyTest::released;
+
+TEST_F(ZerocopyTest, ShouldSendZerocopyThreshold) {
+    // Disabled by default
+    settings.setSendZerocopyThreshold(0);
+    EXPECT_FALSE(connection.shouldSendZerocopy(1));
+    EXPECT_FALSE(connection.shouldSendZerocopy(1024 * 1024));
+
+    settings.setSendZerocopyThreshold(4096);
+    EXPECT_FALSE(connection.shouldSendZerocopy(0));
+    EXPECT_FALSE(connection.shouldSendZerocopy(4095));
+    const bool supported = connection.shouldSendZerocopy(4096);
+    EXPECT_EQ(supported, connection.shouldSendZerocopy(1024 * 1024));
+    // Still below the threshold once SO_ZEROCOPY has been enabled
+    EXPECT_FALSE(connection.shouldSendZerocopy(4095));
+
+    // Changing the threshold takes effect immediately
+    settings.setSendZerocopyThreshold(0);
+    EXPECT_FALSE(connection.shouldSendZerocopy(1024 * 1024));
+}
+
+// Without MSG_ZEROCOPY the items of a response are released as soon as the
+// response has been sent.
+TEST_F(ZerocopyTest, ItemsReleasedOnTransmitWhenDisabled) {
+    settings.setSendZerocopyThreshold(0);
+    std::vector<char> value(8192, 'a');
+    send(&value, value);
+
+    EXPECT_EQ(0, connection.zerocopySends.getSends());
+    EXPECT_TRUE(connection.zerocopySends.empty());
+    EXPECT_EQ(1, released);
+    EXPECT_EQ(value, receive(value.size()));
+}
+
+// Items referenced by MSG_ZEROCOPY sends are kept until the kernel reports
+// the sends as complete.
+TEST_F(ZerocopyTest, ItemsReleasedOnCompletion) {
+    settings.setSendZerocopyThreshold(4096);
+    if (!connection.shouldSendZerocopy(4096)) {
+        // MSG_ZEROCOPY isn't supported here
+        return;
+    }
+
+    std::vector<char> value1(8192, 'a');
+    std::vector<char> value2(8192, 'b');
+    send(&value1, value1);
+    const auto sends = connection.zerocopySends.getSends();
+    EXPECT_LE(1, sends);
+    send(&value2, value2);
+    EXPECT_LT(sends, connection.zerocopySends.getSends());
+
+    // Each response's items are held until its own sends complete
+    ASSERT_EQ(0, released);
+    ASSERT_EQ(2, connection.zerocopySends.size());
+    EXPECT_EQ(sends, connection.zerocopySends.frontSends());
+    EXPECT_EQ(connection.zerocopySends.getSends(),
+              connection.zerocopySends.backSends());
+
+    EXPECT_EQ(value1, receive(value1.size()));
+    EXPECT_EQ(value2, receive(value2.size()));
+    const auto deadline =
+            std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!connection.zerocopySends.empty() &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        connection.reapZerocopyCompletions();
+    }
+    EXPECT_TRUE(connection.zerocopySends.allComplete());
+    EXPECT_TRUE(connection.zerocopySends.empty());
+    EXPECT_EQ(2, released);
+}
+
+// Closing the connection doesn't wait for the sends to complete; the
+// reaper keeps the socket (and the items) until they are.
+TEST_F(ZerocopyTest, ReaperClosesOnceComplete) {
+    settings.setSendZerocopyThreshold(4096);
+    if (!connection.shouldSendZerocopy(4096)) {
+        return;
+    }
+
+    std::vector<char> value(8192, 'c');
+    send(&value, value);
+    ASSERT_EQ(0, released);
+
+    ZerocopyReaper reaper(nullptr);
+    reaper.add(connection.getSocketDescriptor(),
+               std::move(connection.zerocopySends));
+    connection.setSocketDescriptor(INVALID_SOCKET);
+    EXPECT_TRUE(connection.zerocopySends.empty());
+    ASSERT_EQ(1, reaper.size());
+    EXPECT_EQ(0, released);
+
+    EXPECT_EQ(value, receive(value.size()));
+    const auto deadline =
+            std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (reaper.size() != 0 &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        reaper.poll();
+    }
+    EXPECT_EQ(0, reaper.size());
+    EXPECT_EQ(1, released);
+
+    // The socket was closed normally once the sends completed
+    char c;
+    EXPECT_EQ(0, recv(peer, &c, 1, 0));
+}
+
+// Closing the connection without a reaper resets the connection, so the
+// items may be released at once.
+TEST_F(ZerocopyTest, CloseWithoutReaperResets) {
+    settings.setSendZerocopyThreshold(4096);
+    if (!connection.shouldSendZerocopy(4096)) {
+        return;
+    }
+
+    std::vector<char> value(8192, 'd');
+    send(&value, value);
+    ASSERT_EQ(0, released);
+
+    connection.closeSocket();
+    EXPECT_EQ(INVALID_SOCKET, connection.getSocketDescriptor());
+    EXPECT_TRUE(connection.zerocopySends.empty());
+    EXPECT_EQ(1, released);
+}
+
+} // namespace test
+} // namespace mcbp
+
+#endif // WIN32
@@ -0,0 +1,115 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2017 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#include "daemon/timing_histogram.h"
+
+#include <cJSON_utils.h>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using std::chrono::microseconds;
+using std::chrono::nanoseconds;
+
+static nanoseconds usec(uint64_t value) {
+    return std::chrono::duration_cast<nanoseconds>(microseconds(value));
+}
+
+// Every value must land in a bucket whose range covers it, and the buckets
+// must cover the whole range without gaps.
+TEST(TimingHistogramTest, BucketBoundaries) {
+    for (size_t ii = 0; ii < TimingHistogram::NumBuckets - 1; ++ii) {
+        const auto low = TimingHistogram::getBucketLow(ii);
+        const auto high = TimingHistogram::getBucketHigh(ii);
+        EXPECT_LE(low, high) << "bucket " << ii;
+        EXPECT_EQ(ii, TimingHistogram::getBucketIndex(low));
+        EXPECT_EQ(ii, TimingHistogram::getBucketIndex(high));
+        EXPECT_EQ(ii + 1, TimingHistogram::getBucketIndex(high + 1));
+    }
+
+    // Anything too big for the last real bucket goes into overflow
+    const auto overflow = TimingHistogram::NumBuckets - 1;
+    EXPECT_EQ(overflow, TimingHistogram::getBucketIndex(uint64_t(1) << 40));
+    EXPECT_EQ(0, TimingHistogram::getBucketHigh(overflow));
+}
+
+// The relative error of a bucket is bounded by the number of sub buckets
+TEST(TimingHistogramTest, Resolution) {
+    for (size_t ii = TimingHistogram::LinearBuckets;
+         ii < TimingHistogram::NumBuckets - 1;
+         ++ii) {
+        const auto low = TimingHistogram::getBucketLow(ii);
+        const auto high = TimingHistogram::getBucketHigh(ii);
+        EXPECT_LE((high - low + 1) * TimingHistogram::SubBuckets, low * 2)
+                << "bucket " << ii;
+    }
+}
+
+TEST(TimingHistogramTest, Percentiles) {
+    TimingHistogram histogram;
+    for (int ii = 0; ii < 99; ++ii) {
+        histogram.add(usec(10));
+    }
+    histogram.add(usec(1000));
+    EXPECT_EQ(100, histogram.get_total());
+
+    unique_cJSON_ptr json(cJSON_Parse(histogram.to_string().c_str()));
+    ASSERT_NE(nullptr, json);
+    EXPECT_EQ(100, cJSON_GetObjectItem(json.get(), "total")->valueint);
+    auto* percentiles = cJSON_GetObjectItem(json.get(), "percentiles");
+    ASSERT_NE(nullptr, percentiles);
+    EXPECT_EQ(10, cJSON_GetObjectItem(percentiles, "50")->valueint);
+    EXPECT_EQ(10, cJSON_GetObjectItem(percentiles, "99")->valueint);
+    const auto max = cJSON_GetObjectItem(percentiles, "100")->valueint;
+    EXPECT_LE(1000, max);
+    EXPECT_EQ(TimingHistogram::getBucketHigh(
+                      TimingHistogram::getBucketIndex(1000)),
+              uint64_t(max));
+
+    // Only the two non-empty buckets are listed
+    EXPECT_EQ(2, cJSON_GetArraySize(cJSON_GetObjectItem(json.get(),
+                                                        "buckets")));
+}
+
+// Samples recorded on different threads (and so different shards) are all
+// included when the histogram is read, copied or reset.
+TEST(TimingHistogramTest, MultipleThreads) {
+    TimingHistogram histogram;
+    const int numThreads = 8;
+    const int numSamples = 1000;
+    std::vector<std::thread> threads;
+    for (int ii = 0; ii < numThreads; ++ii) {
+        threads.emplace_back([&histogram, ii]() {
+            for (int jj = 0; jj < numSamples; ++jj) {
+                histogram.add(usec(ii * 100 + jj));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(numThreads * numSamples, histogram.get_total());
+
+    TimingHistogram copy(histogram);
+    EXPECT_EQ(numThreads * numSamples, copy.get_total());
+    copy += histogram;
+    EXPECT_EQ(2 * numThreads * numSamples, copy.get_total());
+
+    histogram.reset();
+    EXPECT_EQ(0, histogram.get_total());
+    EXPECT_EQ(2 * numThreads * numSamples, copy.get_total());
+}
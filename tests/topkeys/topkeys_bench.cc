@@ -16,18 +16,28 @@
  */
 #include "daemon/topkeys.h"
 
+#include <utilities/thread_slot.h>
+
 #include <gtest/gtest.h>
+#include <map>
 #include <memory>
+#include <thread>
 
 
 class TopKeysTest : public ::testing::Test {
 protected:
     void SetUp() {
+        numWorkerThreads = settings.getNumWorkerThreads();
         settings.setTopkeysEnabled(true);
         topkeys.reset(new TopKeys(10));
     }
 
+    void TearDown() {
+        settings.setNumWorkerThreads(numWorkerThreads);
+    }
+
     std::unique_ptr<TopKeys> topkeys;
+    int numWorkerThreads;
 };
 
 static void dump_key(const char* key,
@@ -53,8 +63,55 @@ TEST_F(TopKeysTest, Basic) {
         }
     }
 
-    // Verify we hit all shards inside TopKeys
+    // Verify we track (and report) the expected number of keys
     size_t count = 0;
     topkeys->stats(&count, 0, dump_key);
     EXPECT_EQ(80, count);
 }
+
+static void count_key(const char* key,
+                      const uint16_t klen,
+                      const char* val,
+                      const uint32_t vlen,
+                      gsl::not_null<const void*> cookie) {
+    auto* counts = static_cast<std::map<std::string, int>*>(
+            const_cast<void*>(cookie.get()));
+    // val starts with "get_hits=<count>,"
+    (*counts)[std::string(key, klen)] = std::stoi(std::string(val + 9, vlen - 9));
+}
+
+// Check that the counts of a key accessed by several worker threads are
+// merged, and a hot key stands out from a long tail of other keys.
+TEST_F(TopKeysTest, HotKeyOverThreads) {
+    const int threads = 4;
+    settings.setNumWorkerThreads(threads);
+    topkeys.reset(new TopKeys(10));
+
+    std::vector<std::thread> workers;
+    for (int tt = 0; tt < threads; ++tt) {
+        workers.emplace_back([this, tt]() {
+            // Act as worker thread tt
+            cb::setThreadSlot(tt);
+            const std::string hot("hot_key");
+            for (int jj = 0; jj < 10000; jj++) {
+                topkeys->updateKey(hot.data(), hot.size(), 0);
+                const auto cold = "cold_key_" + std::to_string(tt) + "_" +
+                                  std::to_string(jj);
+                topkeys->updateKey(cold.data(), cold.size(), 0);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    std::map<std::string, int> counts;
+    topkeys->stats(&counts, 0, count_key);
+    EXPECT_EQ(80, counts.size());
+    ASSERT_EQ(1, counts.count("hot_key"));
+    // Space-Saving never under-estimates a tracked key's count
+    EXPECT_LE(threads * 10000, counts["hot_key"]);
+    for (const auto& entry : counts) {
+        EXPECT_LE(entry.second, counts["hot_key"]) << entry.first;
+    }
+}
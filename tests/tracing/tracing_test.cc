@@ -68,3 +68,46 @@ TEST_F(TracingTest, ErrorRate) {
         EXPECT_LE((micros - decoded) * 100.0 / micros, 0.1);
     }
 }
+
+TEST_F(TracingTest, RepeatedCode) {
+    using cb::tracing::TraceCode;
+    const auto start = ProcessClock::now();
+    tracer.begin(TraceCode::REQUEST, start);
+
+    // A blocked command is executed twice; each end() should end the
+    // latest of the spans and the durations should be summed
+    tracer.begin(TraceCode::EXECUTE, start);
+    EXPECT_TRUE(tracer.end(TraceCode::EXECUTE,
+                           start + std::chrono::microseconds(10)));
+    tracer.begin(TraceCode::EXECUTE, start + std::chrono::microseconds(100));
+    EXPECT_TRUE(tracer.end(TraceCode::EXECUTE,
+                           start + std::chrono::microseconds(130)));
+
+    // The span is already ended
+    EXPECT_FALSE(tracer.end(TraceCode::EXECUTE));
+
+    std::chrono::microseconds duration;
+    EXPECT_TRUE(tracer.getDuration(TraceCode::EXECUTE, duration));
+    EXPECT_EQ(40, duration.count());
+    EXPECT_FALSE(tracer.getDuration(TraceCode::TRANSMIT, duration));
+
+    // The request itself is still running
+    EXPECT_FALSE(tracer.getDuration(TraceCode::REQUEST, duration));
+    EXPECT_EQ(3, tracer.getDurations().size());
+}
+
+TEST_F(TracingTest, MaxSpans) {
+    using cb::tracing::Tracer;
+    using cb::tracing::TraceCode;
+    for (size_t ii = 0; ii < Tracer::MaxSpans; ++ii) {
+        EXPECT_EQ(ii, tracer.begin(TraceCode::GET));
+    }
+    // Spans beyond the capacity are dropped
+    EXPECT_EQ(Tracer::invalidSpanId(), tracer.begin(TraceCode::STORE));
+    EXPECT_FALSE(tracer.end(TraceCode::STORE));
+    EXPECT_EQ(Tracer::MaxSpans, tracer.getDurations().size());
+
+    tracer.clear();
+    EXPECT_TRUE(tracer.getDurations().empty());
+    EXPECT_EQ(0, tracer.begin(TraceCode::STORE));
+}
@@ -519,21 +519,77 @@ static enum test_result lru_test(ENGINE_HANDLE *h, ENGINE_HANDLE_V1 *h1) {
     }
 
     cb_assert(ii < 250);
+
+    // The items are evicted from the LRU of the partition the key belongs
+    // to, so we can't tell which of the keys went; but the key we kept
+    // reading must still be there
+    ret = h1->get(h, cookie, hot_key, 0, DocStateFilter::Alive);
+    cb_assert(ret.first == cb::engine_errc::success);
+
+    int missing = 0;
     for (jj = 0; jj <= ii; ++jj) {
         uint8_t key[1024];
         DocKey get_key(key,
                        snprintf(reinterpret_cast<char*>(key), sizeof(key),
                                 "lru_test_key_%08d", jj),
                        test_harness.doc_namespace);
-        if (jj == 0 || jj == 1) {
-            ret = h1->get(h, cookie, get_key, 0, DocStateFilter::Alive);
-            cb_assert(ret.first == cb::engine_errc::no_such_key);
+        ret = h1->get(h, cookie, get_key, 0, DocStateFilter::Alive);
+        if (ret.first == cb::engine_errc::no_such_key) {
+            ++missing;
         } else {
-            ret = h1->get(h, cookie, get_key, 0, DocStateFilter::Alive);
             cb_assert(ret.first == cb::engine_errc::success);
             cb_assert(ret.second != nullptr);
         }
     }
+    cb_assert(missing == 2);
+
+    test_harness.destroy_cookie(cookie);
+    return SUCCESS;
+}
+
+static uint64_t crawler_reclaimed;
+
+static void crawler_stats_handler(const char* key,
+                                  const uint16_t klen,
+                                  const char* val,
+                                  const uint32_t vlen,
+                                  gsl::not_null<const void*>) {
+    if (std::string(key, klen) == "crawler:reclaimed") {
+        crawler_reclaimed = std::stoull(std::string(val, vlen));
+    }
+}
+
+/*
+ * Make sure that the crawler reclaims the expired items without anyone
+ * trying to access them
+ */
+static enum test_result crawler_test(ENGINE_HANDLE *h, ENGINE_HANDLE_V1 *h1) {
+    uint64_t cas = 0;
+    const auto* cookie = test_harness.create_cookie();
+
+    for (int ii = 0; ii < 10; ++ii) {
+        const std::string name = "crawler_test_key_" + std::to_string(ii);
+        DocKey key(name, test_harness.doc_namespace);
+        auto ret = h1->allocate(
+                h, cookie, key, 1, 0, 10, PROTOCOL_BINARY_RAW_BYTES, 0);
+        cb_assert(ret.first == cb::engine_errc::success);
+        cb_assert(h1->store(h,
+                            cookie,
+                            ret.second.get(),
+                            cas,
+                            OPERATION_SET,
+                            DocumentState::Alive) == ENGINE_SUCCESS);
+    }
+    test_harness.time_travel(11);
+
+    // The crawler runs every second; give it plenty of time
+    crawler_reclaimed = 0;
+    for (int ii = 0; ii < 100 && crawler_reclaimed < 10; ++ii) {
+        usleep(100000);
+        cb_assert(h1->get_stats(h, cookie, "scrub"_ccb,
+                                crawler_stats_handler) == ENGINE_SUCCESS);
+    }
+    cb_assert(crawler_reclaimed == 10);
 
     test_harness.destroy_cookie(cookie);
     return SUCCESS;
@@ -696,6 +752,7 @@ engine_test_t* get_tests(void) {
 #ifndef VALGRIND
         // this test is disabled for VALGRIND because cache_size=48 and using malloc don't work.
         TEST_CASE("LRU test", lru_test, NULL, NULL, "cache_size=48", NULL, NULL),
+        TEST_CASE("crawler test", crawler_test, NULL, NULL, NULL, NULL, NULL),
 #endif
         TEST_CASE("get stats test", get_stats_test, NULL, NULL, NULL, NULL, NULL),
         TEST_CASE("reset stats test", reset_stats_test, NULL, NULL, NULL, NULL, NULL),
@@ -31,49 +31,103 @@ std::chrono::microseconds to_micros(const ProcessClock::time_point tp) {
 namespace cb {
 namespace tracing {
 
+Tracer::Tracer() : numSpans(0) {
+    for (auto& state : states) {
+        state.store(State::Free, std::memory_order_relaxed);
+    }
+}
+
 Tracer::SpanId Tracer::invalidSpanId() {
     return std::numeric_limits<SpanId>::max();
 }
 
-Tracer::SpanId Tracer::begin(const TraceCode tracecode) {
-    std::lock_guard<std::mutex> lock(spanMutex);
-    auto t = to_micros(ProcessClock::now());
-    vecSpans.push_back(Span(tracecode, t));
-    return vecSpans.size() - 1;
+size_t Tracer::size() const {
+    return std::min(numSpans.load(std::memory_order_acquire), MaxSpans);
+}
+
+Tracer::SpanId Tracer::begin(const TraceCode tracecode,
+                             ProcessClock::time_point start) {
+    const auto spanId = numSpans.fetch_add(1, std::memory_order_acq_rel);
+    if (spanId >= MaxSpans) {
+        return invalidSpanId();
+    }
+    spans[spanId] = Span(tracecode, to_micros(start));
+    states[spanId].store(State::Open, std::memory_order_release);
+    return spanId;
 }
 
-bool Tracer::end(SpanId spanId) {
-    std::lock_guard<std::mutex> lock(spanMutex);
-    if (spanId >= vecSpans.size())
+bool Tracer::end(SpanId spanId, ProcessClock::time_point end) {
+    if (spanId >= size()) {
+        return false;
+    }
+    auto expected = State::Open;
+    if (!states[spanId].compare_exchange_strong(expected, State::Ending)) {
+        // Not begun, or already ended
         return false;
-    auto& span = vecSpans[spanId];
-    span.duration = to_micros(ProcessClock::now()) - span.start;
+    }
+    auto& span = spans[spanId];
+    span.duration = to_micros(end) - span.start;
+    states[spanId].store(State::Ended, std::memory_order_release);
     return true;
 }
 
-bool Tracer::end(const TraceCode tracecode) {
-    SpanId spanId = 0;
-    {
-        std::lock_guard<std::mutex> lock(spanMutex);
-        for (const auto& span : vecSpans) {
-            if (span.code == tracecode) {
-                break;
-            }
-            spanId++;
+bool Tracer::end(const TraceCode tracecode, ProcessClock::time_point end) {
+    // Search backwards so that a code used more than once in a request
+    // (e.g. every time a blocked command is executed) ends the latest one
+    for (auto spanId = size(); spanId > 0; --spanId) {
+        if (states[spanId - 1].load(std::memory_order_acquire) !=
+                    State::Free &&
+            spans[spanId - 1].code == tracecode) {
+            return Tracer::end(spanId - 1, end);
         }
     }
-    return end(spanId);
+    return false;
 }
 
-const std::vector<Span>& Tracer::getDurations() const {
-    return vecSpans;
+std::vector<Span> Tracer::getDurations() const {
+    std::vector<Span> ret;
+    const auto count = size();
+    ret.reserve(count);
+    for (size_t ii = 0; ii < count; ++ii) {
+        const auto state = states[ii].load(std::memory_order_acquire);
+        if (state == State::Ended) {
+            ret.push_back(spans[ii]);
+        } else if (state != State::Free) {
+            ret.emplace_back(spans[ii].code, spans[ii].start);
+        }
+    }
+    return ret;
+}
+
+bool Tracer::getDuration(const TraceCode tracecode,
+                         std::chrono::microseconds& duration) const {
+    bool found = false;
+    duration = std::chrono::microseconds(0);
+    const auto count = size();
+    for (size_t ii = 0; ii < count; ++ii) {
+        if (states[ii].load(std::memory_order_acquire) == State::Ended &&
+            spans[ii].code == tracecode) {
+            duration += spans[ii].duration;
+            found = true;
+        }
+    }
+    return found;
 }
 
 std::chrono::microseconds Tracer::getTotalMicros() const {
-    if (vecSpans.empty()) {
+    if (size() == 0) {
         return std::chrono::microseconds(0);
     }
-    return vecSpans[0].duration;
+    switch (states[0].load(std::memory_order_acquire)) {
+    case State::Free:
+        break;
+    case State::Open:
+    case State::Ending:
+        return to_micros(ProcessClock::now()) - spans[0].start;
+    case State::Ended:
+        return spans[0].duration;
+    }
+    return std::chrono::microseconds(0);
 }
 
 /**
@@ -96,6 +150,9 @@ uint16_t Tracer::getEncodedMicros(uint64_t actual) const {
 
     if (0 == actual) {
         actual = getTotalMicros().count();
+        if (0 == actual) {
+            return 0;
+        }
     }
 
     auto repMicros = std::log(actual) / ln11;
@@ -129,7 +186,11 @@ std::chrono::microseconds Tracer::decodeMicros(uint16_t encoded) const {
 }
 
 void Tracer::clear() {
-    vecSpans.clear();
+    const auto count = size();
+    for (size_t ii = 0; ii < count; ++ii) {
+        states[ii].store(State::Free, std::memory_order_relaxed);
+    }
+    numSpans.store(0, std::memory_order_release);
 }
 
 } // end namespace tracing
@@ -142,7 +203,7 @@ MEMCACHED_PUBLIC_API std::ostream& operator<<(
 
 MEMCACHED_PUBLIC_API std::string to_string(const cb::tracing::Tracer& tracer,
                                            bool raw) {
-    const auto& vecSpans = tracer.getDurations();
+    const auto vecSpans = tracer.getDurations();
     std::ostringstream os;
     auto size = vecSpans.size();
     for (const auto& span : vecSpans) {
@@ -163,6 +224,17 @@ MEMCACHED_PUBLIC_API std::string to_string(
     case TraceCode::REQUEST:
         return "request";
 
+    case TraceCode::VALIDATE:
+        return "validate";
+    case TraceCode::EXECUTE:
+        return "execute";
+    case TraceCode::WOULDBLOCK:
+        return "wouldblock";
+    case TraceCode::NOTIFY:
+        return "notify";
+    case TraceCode::TRANSMIT:
+        return "transmit";
+
     case TraceCode::ALLOCATE:
         return "allocate";
     case TraceCode::BGFETCH:
@@ -179,6 +251,8 @@ MEMCACHED_PUBLIC_API std::string to_string(
         return "get.locked";
     case TraceCode::GETMETA:
         return "get.meta";
+    case TraceCode::GETMULTI:
+        return "get.multi";
     case TraceCode::GETSTATS:
         return "get.stats";
     case TraceCode::ITEMDELETE:
@@ -15,8 +15,9 @@
  *   limitations under the License.
  */
 #pragma once
+#include <array>
+#include <atomic>
 #include <cstddef>
-#include <mutex>
 #include <ostream>
 #include <stdexcept>
 #include <string>
@@ -47,6 +48,11 @@ namespace tracing {
 
 class MEMCACHED_PUBLIC_CLASS Span {
 public:
+    Span()
+        : code(TraceCode::REQUEST),
+          start(std::chrono::microseconds(0)),
+          duration(std::chrono::microseconds(0)) {
+    }
     Span(TraceCode code,
          std::chrono::microseconds start,
          std::chrono::microseconds duration = std::chrono::microseconds(0))
@@ -58,22 +64,49 @@ public:
 };
 
 /**
- * Tracer maintains an ordered vector of tracepoints
+ * Tracer maintains an ordered list of tracepoints
  * with name:time(micros)
+ *
+ * The spans live in a preallocated array (spans begun once it is full are
+ * dropped), and are begun and ended without locking so that the tracer
+ * may be used for every request. The engine may record spans from its own
+ * threads (while the request is blocked, or when notifying that it may
+ * continue) concurrently with the worker thread; each span is only ended
+ * by one thread.
  */
 class MEMCACHED_PUBLIC_CLASS Tracer {
 public:
     using SpanId = std::size_t;
 
+    /// The maximum number of spans recorded for a single request
+    static const size_t MaxSpans = 32;
+
+    Tracer();
+
     static SpanId invalidSpanId();
 
-    SpanId begin(const TraceCode tracecode);
-    bool end(SpanId spanId);
-    bool end(const TraceCode tracecode);
+    SpanId begin(const TraceCode tracecode,
+                 ProcessClock::time_point start = ProcessClock::now());
+    bool end(SpanId spanId, ProcessClock::time_point end = ProcessClock::now());
+
+    /// End the most recently begun span with the given code
+    bool end(const TraceCode tracecode,
+             ProcessClock::time_point end = ProcessClock::now());
 
     // get the tracepoints as ordered durations
-    const std::vector<Span>& getDurations() const;
+    std::vector<Span> getDurations() const;
+
+    /**
+     * Get the total time spent in the spans with the given code (spans
+     * which haven't ended yet don't count)
+     *
+     * @return false if no span with the given code has ended
+     */
+    bool getDuration(const TraceCode tracecode,
+                     std::chrono::microseconds& duration) const;
 
+    /// Get the duration of the first span (the whole request); if it
+    /// hasn't ended yet the time elapsed since it began
     std::chrono::microseconds getTotalMicros() const;
 
     /**
@@ -95,8 +128,25 @@ public:
                                     bool raw);
 
 protected:
-    std::vector<Span> vecSpans;
-    std::mutex spanMutex;
+    enum class State : uint8_t {
+        /// The slot is reserved, but the span isn't written yet
+        Free,
+        /// The span is begun
+        Open,
+        /// The duration of the span is being written
+        Ending,
+        /// The span is ended
+        Ended
+    };
+
+    /// The number of slots in use
+    size_t size() const;
+
+    std::array<Span, MaxSpans> spans;
+    std::array<std::atomic<State>, MaxSpans> states;
+    /// The next slot to use; incremented to reserve a slot (so it may
+    /// exceed MaxSpans)
+    std::atomic<size_t> numSpans;
 };
 
 struct MEMCACHED_PUBLIC_CLASS Traceable {
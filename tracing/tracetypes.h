@@ -26,6 +26,13 @@ namespace tracing {
 enum class TraceCode {
     REQUEST, /* Whole Request */
 
+    /* The phases of a request in the core (recorded for every request) */
+    VALIDATE, /* Privilege check and validation of the packet */
+    EXECUTE, /* Running the command (including the engine call) */
+    WOULDBLOCK, /* Blocked until the engine notifies that it may continue */
+    NOTIFY, /* From the notification until the worker thread resumes */
+    TRANSMIT, /* Sending the response to the client */
+
     ALLOCATE,
     BGFETCH,
     FLUSH,
@@ -34,6 +41,7 @@ enum class TraceCode {
     GETIF,
     GETLOCKED,
     GETMETA,
+    GETMULTI,
     GETSTATS,
     ITEMDELETE,
     LOCK,
@@ -174,7 +174,8 @@ static const std::map<uint8_t, std::string> commandmap{
         {PROTOCOL_BINARY_CMD_COLLECTIONS_SET_MANIFEST,
          "COLLECTIONS_SET_MANIFEST"},
         {PROTOCOL_BINARY_CMD_COLLECTIONS_GET_MANIFEST,
-         "COLLECTIONS_GET_MANIFEST"}};
+         "COLLECTIONS_GET_MANIFEST"},
+        {PROTOCOL_BINARY_CMD_GET_MULTI, "GET_MULTI"}};
 
 const char *memcached_opcode_2_text(uint8_t opcode) {
     auto ii = commandmap.find(opcode);
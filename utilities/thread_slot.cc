@@ -0,0 +1,43 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2018 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#include "config.h"
+
+#include "thread_slot.h"
+
+#include <atomic>
+#include <limits>
+
+static const size_t NoSlot = std::numeric_limits<size_t>::max();
+
+// The slot handed to the next thread which isn't a worker thread
+static std::atomic<size_t> nextThreadSlot{0};
+static thread_local size_t threadSlot = NoSlot;
+
+namespace cb {
+
+void setThreadSlot(size_t slot) {
+    threadSlot = slot;
+}
+
+size_t getThreadSlot() {
+    if (threadSlot == NoSlot) {
+        threadSlot = nextThreadSlot++;
+    }
+    return threadSlot;
+}
+
+} // namespace cb
@@ -0,0 +1,48 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2018 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#pragma once
+
+#include <memcached/visibility.h>
+
+#include <cstddef>
+
+/**
+ * Slot numbers for spreading per-thread state (such as the topkeys
+ * sketches, timing histogram shards and slab caches) over a fixed number
+ * of slots; a thread uses the slot at (getThreadSlot() % number of slots).
+ *
+ * The front-end worker threads use their worker index as their slot, so
+ * each gets a slot of its own as long as there are at least as many slots
+ * as worker threads. Any other thread is given a slot on first use, which
+ * it may share with a worker thread.
+ */
+namespace cb {
+
+/**
+ * Set the calling thread's slot; called by each worker thread with its
+ * index (0 <= index < number of worker threads) when it starts.
+ */
+MEMCACHED_PUBLIC_API
+void setThreadSlot(size_t slot);
+
+/**
+ * Get the calling thread's slot.
+ */
+MEMCACHED_PUBLIC_API
+size_t getThreadSlot();
+
+} // namespace cb